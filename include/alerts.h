@@ -0,0 +1,86 @@
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Store of active SWPC space weather alerts.
+// Each product message is parsed for its code, serial number, NOAA scale and
+// validity, deduplicated by a hash of code + serial, classified, and its full
+// text kept in a fixed pool with a phrase-dictionary compression (SWPC
+// messages are mostly boilerplate, so the common phrases become one byte).
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#ifndef ALERT_CAPACITY
+#define ALERT_CAPACITY 16
+#endif
+
+#ifndef ALERT_TEXT_BUDGET
+#define ALERT_TEXT_BUDGET 6144        // Compressed text pool shared by all entries
+#endif
+
+#define ALERT_DEFAULT_LIFETIME 86400  // Alerts and summaries without a validity line (s)
+#define ALERT_WATCH_LIFETIME 259200   // Watches cover the next three days (s)
+
+enum AlertKind : uint8_t {
+  ALERT_KIND_ALERT = 0,
+  ALERT_KIND_WARNING,
+  ALERT_KIND_WATCH,
+  ALERT_KIND_SUMMARY,
+  ALERT_KIND_OTHER
+};
+
+enum AlertTopic : uint8_t {
+  ALERT_TOPIC_GEOMAGNETIC = 0,  // K-index, A-index, storms, sudden impulses
+  ALERT_TOPIC_XRAY,             // Radio blackouts
+  ALERT_TOPIC_PROTON,
+  ALERT_TOPIC_ELECTRON,
+  ALERT_TOPIC_RADIO,            // Type II/IV radio bursts, 10 cm bursts
+  ALERT_TOPIC_OTHER
+};
+
+struct AlertEntry {
+  uint32_t hash;           // FNV-1a of code and serial number
+  uint32_t serial;
+  uint32_t issued;         // Unix time
+  uint32_t expires;
+  char code[8];            // "ALTK04", "WARK05", ...
+  char scale[3];           // NOAA scale "G2", "R1", "S1" or ""
+  uint8_t kind;            // AlertKind
+  uint8_t topic;           // AlertTopic
+  uint8_t severity;        // 0-5, scale digit or derived from the code
+  uint16_t textOffset;     // Compressed message in the pool
+  uint16_t textLength;
+};
+
+struct AlertStore {
+  AlertEntry entries[ALERT_CAPACITY];  // Newest issue time first
+  uint8_t count;
+  uint16_t textUsed;
+  uint8_t text[ALERT_TEXT_BUDGET];
+  // Hashes of products cancelled or superseded by an extension. The feed is
+  // newest first, so these usually arrive before the product they retire.
+  uint32_t retired[ALERT_CAPACITY];
+  uint8_t retiredNext;
+};
+
+enum AlertResult : uint8_t {
+  ALERT_ADDED = 0,
+  ALERT_DUPLICATE,
+  ALERT_EXPIRED,
+  ALERT_CANCELLED,         // A cancel message, or a product already cancelled or extended
+  ALERT_REJECTED           // No message code, or older than everything kept
+};
+
+// Function declarations
+void alertStoreClear(AlertStore& store);
+// issued = the product's issue_datetime; now = wall clock (0 = unknown, skips expiry)
+AlertResult alertStoreAdd(AlertStore& store, const char* message, uint32_t issued, uint32_t now);
+uint8_t alertStoreExpire(AlertStore& store, uint32_t now);  // Returns entries removed
+bool alertStoreHasTopic(const AlertStore& store, AlertTopic topic);
+// Decompress an entry's text (lines separated by '\n'), returns its length
+size_t alertText(const AlertStore& store, uint8_t index, char* buffer, size_t size);
+const char* alertKindText(AlertKind kind);
+uint32_t alertHash(const char* code, uint32_t serial);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef AURORA_H
+#define AURORA_H
+
+// Aurora geometry for the configured location.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+// Where aurora can be seen from a location, relative to the auroral oval
+enum AuroraSighting {
+  SIGHTING_NONE = 0,        // Oval below the horizon
+  SIGHTING_HORIZON,         // Low on the poleward horizon
+  SIGHTING_OVERHEAD         // Location is under the oval
+};
+
+// Function declarations
+float geomagneticLatitude(float latitude, float longitude);  // Centered dipole, degrees
+float auroraBoundaryLatitude(float kp);                      // Oval's equatorward edge, geomagnetic degrees
+AuroraSighting auroraSightingFromKp(float kp, float latitude, float longitude);
+int auroraLikelihood(float kp, float latitude, float longitude);  // 0-100, continuous in kp
+AuroraSighting auroraSightingFromViewline(float latitude, int ovalEdgeLatitude, int viewlineLatitude);
+const char* auroraSightingText(AuroraSighting sighting, float latitude);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "eventlog.h"
+#include "wire.h"
+
+// Binary bundle of everything a station would otherwise fetch upstream.
+// The aggregator (src/aggregator/) runs the same ingest code once per site
+// and encodes one bundle per location; a station with AGGREGATOR_URL set
+// applies it instead of making a dozen upstream requests. A station also
+// parks the weather of the locations it is not showing as small bundles
+// (main.cpp, see locations.h). Like the ingests, encoding reads and applying
+// writes the weather.h globals.
+//
+// The container is wire.h: one section per weather.h struct (records of
+// fixed-width fields, strings in the shared table) plus the series the
+// ingests keep. BUNDLE_SOURCES holds, per LogSource, the UTC epoch of that
+// upstream's last good ingest (0 = never); a section is only written when
+// one of the sources filling it has data, and only applied for the sources
+// that are newer than what the station already has. Fields the station
+// derives itself (astronomy, aurora forecast, Kp coupling) are carried for
+// other readers but never applied. New fields go at the end of a record and
+// new kinds get a new number, so older stations keep working; BUNDLE_VERSION
+// only changes when an existing field moves.
+
+#define BUNDLE_VERSION WIRE_VERSION
+
+#ifndef BUNDLE_MAX_SIZE
+#define BUNDLE_MAX_SIZE 20480          // Worst case is ~15 KB (full alert pool and solar wind day)
+#endif
+
+#ifndef BUNDLE_STRINGS_SIZE
+#define BUNDLE_STRINGS_SIZE 4096       // String table while encoding; ~600 B in practice
+#endif
+
+enum BundleSection : uint8_t {
+  BUNDLE_SOURCES = 1,                  // u32 per LogSource, required
+  BUNDLE_CURRENT,                      // WeatherData
+  BUNDLE_HOURLY,                       // HourlyForecast, next hour first
+  BUNDLE_DAILY,                        // DayForecast, today first
+  BUNDLE_AIR,                          // AirQualityData
+  BUNDLE_SPACE,                        // SpaceWeatherData
+  BUNDLE_NOAA,                         // NOAASpaceWeatherData
+  BUNDLE_AURORA_FORECAST,              // AuroraForecastData, today and tomorrow
+  BUNDLE_NOWCAST,                      // AuroraNowcastData
+  BUNDLE_KP_FORECAST,                  // KpForecastPoint, oldest first
+  BUNDLE_SOLAR_WIND,                   // SolarWindBin, filled bins only
+  BUNDLE_FLARES,                       // FlareEvent, oldest first
+  BUNDLE_ALERTS,                       // AlertEntry, newest first
+  BUNDLE_ALERT_TEXT,                   // Compressed alert pool, one byte per record
+  BUNDLE_ALERT_RETIRED,                // Retired alert hashes, oldest first
+  BUNDLE_SECTION_LAST = BUNDLE_ALERT_RETIRED
+};
+
+struct BundleInfo {
+  uint32_t generated;
+  uint32_t updated[SRC_COUNT];         // Per source, 0 = not applied
+};
+
+// Record layouts, for wireOpen() and wireToJson()
+extern const WireSchema bundleSchemas[];
+extern const uint8_t bundleSchemaCount;
+
+// Function declarations
+// updated[source] = epoch of that source's last good ingest, 0 leaves it out.
+// Returns the bundle length, 0 when out is too small.
+size_t bundleEncode(uint8_t* out, size_t size, uint32_t generated, const uint32_t updated[SRC_COUNT]);
+// Checks the whole bundle first and only then writes the globals, so a
+// damaged one changes nothing. Sources whose updated is not newer than
+// applied[source] are skipped; applied is advanced for the rest. now is UTC
+// epoch seconds (0 = unknown) and dates each lastUpdate by the data's age.
+bool bundleApply(const uint8_t* data, size_t length, uint32_t now, uint32_t applied[SRC_COUNT], BundleInfo& info);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include <stdint.h>
+
+// Keep-alive HTTPS connections shared by the fetch tasks.
+// Most of a refresh goes to one host (services.swpc.noaa.gov), and the full
+// TLS handshake is the slowest part of each small request. A fetch borrows
+// a connection for its URL's host, and HTTPClient reuses it when it is still
+// open, so a refresh does a handful of handshakes instead of one per
+// endpoint. There are FETCH_MAX_WORKERS slots, one per fetch task, so the
+// idle sessions never hold more heap than the fetch pool budgets for.
+// refreshAllData() closes them all after the batch; the servers would drop
+// them long before the next refresh anyway. What carries over to the next
+// refresh is each host's TLS session, so its first connections resume with
+// an abbreviated handshake (no certificate or key exchange), and its
+// address, looked up again after CONNECTION_DNS_TTL or a failed connect.
+
+class WiFiClientSecure;
+class HTTPClient;
+
+struct ConnectionStats {
+  uint16_t requests;       // Borrowed connections since the last close
+  uint16_t handshakes;     // Of those, the ones that had to connect
+  uint16_t resumed;        // Of those, the ones that resumed a saved session
+};
+
+// Function declarations
+// Client for the URL's host; reused is set when it is still connected from an
+// earlier request. nullptr for plain http:// URLs or when every slot is busy
+// (the caller connects on its own).
+WiFiClientSecure* connectionAcquire(const char* url, bool& reused);
+// http.GET(); a reused connection the server already dropped is retried once on a new one
+int connectionGet(HTTPClient& http, WiFiClientSecure* client, bool reused);
+// reusable: the whole response was read and the server left the connection open
+void connectionRelease(WiFiClientSecure* client, bool reusable);
+ConnectionStats connectionCloseAll();
+
+#endif
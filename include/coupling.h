@@ -0,0 +1,49 @@
+#ifndef COUPLING_H
+#define COUPLING_H
+
+#include <stdint.h>
+#include "solar_wind.h"
+
+// Solar wind - magnetosphere coupling from the binned IMF and plasma series.
+// Each step feeds one sample into two recursive filters:
+//  - the Newell et al. (2007) coupling function
+//    dPhi/dt = v^4/3 Bt^2/3 sin^8/3(theta/2), smoothed over the last hour,
+//    which gives a Kp-equivalent through Newell's Kp regression;
+//  - a Burton-type ring current proxy with the O'Brien & McPherron (2000)
+//    injection and decay, pressure-corrected into a Dst estimate.
+// Both filters use the exact solution over the step, so data gaps of any
+// length just decay the state. Pure C++, builds on a host.
+
+#ifndef COUPLING_TAU
+#define COUPLING_TAU 3600.0f     // Smoothing of the coupling function (s)
+#endif
+
+class CouplingEngine {
+public:
+  CouplingEngine() { reset(); }
+
+  void reset();
+  // One sample: speed km/s, density cm-3, IMF By/Bz GSM nT; time must increase
+  void step(uint32_t time, float speed, float density, float by, float bz);
+  // Step through every bin newer than the last one processed that has both
+  // mag and plasma data, holding back the newest bin since it may still fill
+  uint16_t update(const SolarWindSeries& series);
+
+  bool valid() const { return lastTime != 0; }
+  uint32_t time() const { return lastTime; }
+  float coupling() const { return couplingMean; }      // (km/s)^4/3 nT^2/3, hour mean
+  float dst() const { return dstEstimate; }            // nT
+  float kpEquivalent() const;                          // 0-9 from coupling and Dst
+
+private:
+  uint32_t lastTime;
+  float couplingMean;
+  float viscousMean;       // sqrt(n) v^2, hour mean (viscous term of the Kp regression)
+  float dstStar;           // Pressure-corrected ring current index, nT
+  float dstEstimate;
+};
+
+// Function declarations
+float newellCoupling(float speed, float by, float bz);
+
+#endif
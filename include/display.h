@@ -18,13 +18,20 @@ void updateAstronomyDisplay();
 void updateSpaceWeatherDisplay();
 void updateAuroraTodayDisplay();
 void updateAuroraTomorrowDisplay();
+void updateHistoryDisplay();
+void nextHistoryGraph();
+void updateAlertsDisplay();
+void scrollAlerts();
+void updateLocationsDisplay();
 void drawWeatherIcon(int x, int y, String iconCode);
 void drawTemperature(int x, int y, float temp);
 void drawHumidity(int x, int y, int humidity);
 void drawPressure(int x, int y, float pressure);
 void drawWind(int x, int y, float speed, int direction);
+void drawTodayRange(int x, int y);
+void drawPressureTendency(int x, int y);
 void drawBackground();
-String formatTime(unsigned long timestamp);
+void formatEventTime(unsigned long timestamp, char* buffer, size_t size);
 void drawWeatherIconLarge(int x, int y, String iconCode);
 void drawMoonPhase(int x, int y);
 void drawMoonPhaseBitmap(int x, int y);
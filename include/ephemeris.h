@@ -0,0 +1,46 @@
+#ifndef EPHEMERIS_H
+#define EPHEMERIS_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Low-precision sun and moon ephemeris (Montenbruck & Pfleger series).
+// Positions are good to about 1 arcminute, which puts rise/set/twilight
+// times within a minute or two of published tables for 1950-2050.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+// Events found in a 24 hour window; 0 means the event does not occur
+// in that window (polar day/night, or the moon skipping a rise or set)
+struct SunTimes {
+  time_t rise;
+  time_t set;
+  time_t transit;           // Solar noon
+  time_t civilDawn;         // Sun 6 degrees below horizon
+  time_t civilDusk;
+  time_t nauticalDawn;      // Sun 12 degrees below horizon
+  time_t nauticalDusk;
+  time_t astronomicalDawn;  // Sun 18 degrees below horizon
+  time_t astronomicalDusk;
+};
+
+struct MoonTimes {
+  time_t rise;
+  time_t set;
+  time_t transit;
+};
+
+struct MoonPhaseInfo {
+  float phase;              // 0-1 (0=new moon, 0.25=first quarter, 0.5=full, 0.75=last quarter)
+  float illumination;       // Illuminated fraction 0-1
+  float age;                // Days since new moon
+};
+
+// Function declarations
+// start is the beginning of the window (normally local midnight), latitude and
+// longitude are in degrees with north and east positive
+void computeSunTimes(time_t start, double latitude, double longitude, SunTimes& out);
+void computeMoonTimes(time_t start, double latitude, double longitude, MoonTimes& out);
+void computeMoonPhase(time_t t, MoonPhaseInfo& out);
+double sunAltitude(time_t t, double latitude, double longitude);  // Degrees, no refraction
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Compact binary event log kept in a RAM ring buffer.
+// Hot paths only store a fixed-size record (timestamp, event id, up to 3 integer args);
+// text formatting is deferred until the log is drained over Serial.
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
+
+#ifndef EVENT_LOG_LEVEL
+#define EVENT_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef EVENT_LOG_CAPACITY
+#define EVENT_LOG_CAPACITY 256  // Records, must be a power of two
+#endif
+
+// Event identifiers - keep in sync with the descriptor table in eventlog.cpp
+enum EventId : uint16_t {
+  EV_BOOT = 0,
+  EV_WIFI_CONNECTED,       // ip (packed), outage ms, attempts
+  EV_WIFI_FAILED,          // attempts
+  EV_HTTP_ERROR,           // source, http code
+  EV_JSON_ERROR,           // source, DeserializationError code
+  EV_TIME_SYNCED,          // hour, minute, second
+  EV_WEATHER_UPDATED,      // temp x10, uvi, api calls today
+  EV_HOURLY_ENTRY,         // index, local hour, temp x10
+  EV_MOON_UPDATED,         // phase x1000, illumination x10
+  EV_AIR_QUALITY_UPDATED,  // aqi
+  EV_SPACE_WEATHER_UPDATED,// kp x10, bz x10, solar wind speed
+  EV_NOAA_UPDATED,         // sfi x10, a-index x10, sunspots
+  EV_AURORA_UPDATED,       // today kp x10, tomorrow kp x10
+  EV_API_LIMIT,            // QuotaProvider, calls today, tokens left
+  EV_SCREEN_CHANGED,       // screen
+  EV_ICON_DRAWN,           // night flag, icon code (packed 2 chars)
+  EV_FRAME,                // screen, microseconds
+  EV_SCHEMA_ERROR,         // source, SchemaError
+  EV_INGEST,               // source, bytes, microseconds
+  EV_EPHEMERIS,            // microseconds
+  EV_AURORA_NOWCAST,       // probability, oval edge latitude, grid cells
+  EV_SOLAR_WIND_BINNED,    // source, rows, southward Bz minutes
+  EV_COUPLING_UPDATED,     // bins stepped, Kp-equivalent x10, Dst nT
+  EV_FLARES_DETECTED,      // samples, flares kept, latest peak flux x1e8 (A1 = 1)
+  EV_ALERTS_INGESTED,      // added, duplicates, kept
+  EV_SUNSPOTS_AGGREGATED,  // rows, regions on the latest date, sunspot number
+  EV_WIFI_LOST,            // disconnect reason
+  EV_CIRCUIT_CHANGED,      // source, CircuitState, seconds until the next probe
+  EV_FETCH_SKIPPED,        // source, requests skipped so far
+  EV_REFRESH_DONE,         // fetch tasks, wall milliseconds, lowest free heap
+  EV_INFLATED,             // source, compressed bytes, inflated bytes
+  EV_CONNECTIONS,          // pooled requests, TLS handshakes, of those resumed
+  EV_LOCAL_API,            // port, listening
+  EV_SNAPSHOT_PUBLISHED,   // API requests answered so far, of those 304s, connections
+  EV_SNAPSHOT_SKIPPED,     // API requests answered so far (a slow client held the spare slot)
+  EV_BUNDLE_APPLIED,       // bytes, sections newer than ours, seconds since the aggregator built it
+  EV_BUNDLE_REJECTED,      // bytes
+  EV_LOCATION_CHANGED,     // location, parked bytes restored, weather age s (-1 = never fetched)
+  EV_LOCATION_REFRESHED,   // location, parked bytes, weather age s (-1 = never fetched)
+  EV_LOCATION_OVERFLOW,    // location, LOCATION_PARK_SIZE (its weather did not fit and was dropped)
+  EV_COUNT
+};
+
+// Data sources reported with HTTP/JSON errors
+enum LogSource : uint8_t {
+  SRC_TIME = 0,
+  SRC_ONECALL,
+  SRC_AIR_QUALITY,
+  SRC_KP_INDEX,
+  SRC_SOLAR_WIND_MAG,
+  SRC_SOLAR_WIND_PLASMA,
+  SRC_SOLAR_FLUX,
+  SRC_GEOMAG_INDICES,
+  SRC_XRAY,
+  SRC_SOLAR_REGIONS,
+  SRC_ALERTS,
+  SRC_KP_FORECAST,
+  SRC_OVATION,
+  SRC_AGGREGATOR,          // Bundle of all of the above (AGGREGATOR_URL)
+  SRC_COUNT
+};
+
+struct EventRecord {
+  uint32_t timestamp;      // micros()
+  uint16_t id;             // EventId
+  uint8_t level;           // LOG_LEVEL_*
+  uint8_t argCount;
+  int32_t args[3];
+  uint32_t sequence;       // Slot index + 1 once complete, 0 while being written
+};
+
+extern EventRecord eventLogBuffer[EVENT_LOG_CAPACITY];
+extern volatile uint32_t eventLogHead;     // Total records ever written
+extern uint32_t eventLogTail;              // First record not yet drained
+
+// Reserve a slot without locking; the oldest record is overwritten when full.
+// The record is only read back after eventLogCommit() publishes it.
+inline EventRecord* eventLogReserve(uint8_t level, uint16_t id, uint8_t argCount, uint32_t& sequence) {
+  uint32_t index = __atomic_fetch_add(&eventLogHead, 1, __ATOMIC_RELAXED);
+  EventRecord* record = &eventLogBuffer[index & (EVENT_LOG_CAPACITY - 1)];
+  __atomic_store_n(&record->sequence, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  record->timestamp = micros();
+  record->id = id;
+  record->level = level;
+  record->argCount = argCount;
+  sequence = index + 1;
+  return record;
+}
+
+inline void eventLogCommit(EventRecord* record, uint32_t sequence) {
+  __atomic_store_n(&record->sequence, sequence, __ATOMIC_RELEASE);
+}
+
+inline void eventLogWrite(uint8_t level, uint16_t id) {
+  uint32_t sequence;
+  EventRecord* record = eventLogReserve(level, id, 0, sequence);
+  eventLogCommit(record, sequence);
+}
+
+inline void eventLogWrite(uint8_t level, uint16_t id, int32_t a) {
+  uint32_t sequence;
+  EventRecord* record = eventLogReserve(level, id, 1, sequence);
+  record->args[0] = a;
+  eventLogCommit(record, sequence);
+}
+
+inline void eventLogWrite(uint8_t level, uint16_t id, int32_t a, int32_t b) {
+  uint32_t sequence;
+  EventRecord* record = eventLogReserve(level, id, 2, sequence);
+  record->args[0] = a;
+  record->args[1] = b;
+  eventLogCommit(record, sequence);
+}
+
+inline void eventLogWrite(uint8_t level, uint16_t id, int32_t a, int32_t b, int32_t c) {
+  uint32_t sequence;
+  EventRecord* record = eventLogReserve(level, id, 3, sequence);
+  record->args[0] = a;
+  record->args[1] = b;
+  record->args[2] = c;
+  eventLogCommit(record, sequence);
+}
+
+// Compile-time leveled logging macros - disabled levels compile to nothing
+#if EVENT_LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) eventLogWrite(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#if EVENT_LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) eventLogWrite(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if EVENT_LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) eventLogWrite(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+// Raw dump of the pending records for the host decoder (tools/eventlog_decode.cpp):
+// EVENT_LOG_MAGIC and a uint32 record size, then the EventRecords as stored,
+// ending with one whose sequence is 0
+#define EVENT_LOG_MAGIC 0x474C5645  // "EVLG" little-endian
+
+// Function declarations
+void eventLogDrain(Print& out);  // Format pending records as text
+void eventLogDump(Print& out);   // Write pending records as binary
+// One record as a text line, as eventLogDrain() prints it; returns its length
+size_t eventLogFormat(const EventRecord& record, char* line, size_t size);
+void eventLogClear();
+
+#endif
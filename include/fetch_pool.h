@@ -0,0 +1,26 @@
+#ifndef FETCH_POOL_H
+#define FETCH_POOL_H
+
+#include <stdint.h>
+
+// Runs independent fetch jobs concurrently so their round trips and TLS
+// handshakes overlap instead of adding up. The calling task works through
+// the job list together with up to FETCH_MAX_WORKERS - 1 helper tasks and
+// returns once every job has finished, so each job's ingest runs while the
+// display code is idle. Jobs must not share globals with each other: keep
+// dependent requests (and anything touching the same series) in one job.
+// Each TLS session costs ~40 KB of heap, so helpers are only started, and
+// only take another job, while FETCH_TLS_COST is free above FETCH_HEAP_RESERVE.
+
+typedef void (*FetchJob)();
+
+struct FetchBatchStats {
+  uint8_t workers;         // Tasks used, the caller included
+  uint32_t wallMillis;
+  uint32_t minFreeHeap;    // Heap low-water mark since boot, peaks during a batch
+};
+
+// Function declarations
+FetchBatchStats fetchRunAll(const FetchJob* jobs, uint8_t count);
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef FLARE_H
+#define FLARE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Solar flare detection over the GOES X-ray series, one sample at a time.
+// Uses the SWPC event-list rules on the long (0.1-0.8 nm) channel:
+//  - start: first of 4 consecutive minutes of rising flux where the 4th
+//    minute is at least 1.4x the 1st;
+//  - peak: highest flux before the end;
+//  - end: flux back down halfway between the peak and the pre-flare level.
+// The short (0.05-0.4 nm) channel peak is kept alongside. Memory is constant
+// whatever the length of the series.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#ifndef FLARE_EVENT_CAPACITY
+#define FLARE_EVENT_CAPACITY 8
+#endif
+
+#define FLARE_RISE_MINUTES 4
+#define FLARE_RISE_RATIO 1.4f
+
+enum XrayChannel : uint8_t {
+  XRAY_LONG = 0,           // 0.1-0.8 nm, defines the flare class
+  XRAY_SHORT               // 0.05-0.4 nm
+};
+
+struct FlareEvent {
+  uint32_t start;          // Unix time
+  uint32_t peak;
+  uint32_t end;            // 0 = still in progress at the end of the data
+  float peakFlux;          // Long channel, W/m2
+  float shortPeakFlux;     // Short channel, W/m2
+};
+
+struct FlareEventList {
+  FlareEvent events[FLARE_EVENT_CAPACITY];  // Oldest first
+  uint8_t count;
+};
+
+class FlareDetector {
+public:
+  void begin(float minimumPeak);           // Flares peaking below minimumPeak are not reported
+  void sample(XrayChannel channel, uint32_t time, float flux);
+  // Merge the events found into list: events starting before the first
+  // sample scanned are kept, the rest are replaced by this scan
+  void finish(FlareEventList& list);
+
+  uint32_t samples() const { return sampleCount; }
+  float latestFlux() const { return lastFlux; }     // Long channel
+  uint32_t latestTime() const { return lastTime; }
+
+private:
+  void emit(uint32_t end);
+
+  float minimumPeak;
+  uint32_t sampleCount;
+  uint32_t firstTime;
+  uint32_t lastTime;
+  float lastFlux;
+  // Sliding window of the latest long channel minutes while looking for a rise
+  uint32_t riseTimes[FLARE_RISE_MINUTES];
+  float riseFlux[FLARE_RISE_MINUTES];
+  uint8_t riseLength;
+  // Recent short channel minutes, so a flare's short peak during the rise is kept
+  uint32_t shortTimes[FLARE_RISE_MINUTES];
+  float shortFlux[FLARE_RISE_MINUTES];
+  uint8_t shortNext;
+  // Flare in progress
+  bool active;
+  FlareEvent current;
+  float startFlux;
+  FlareEventList found;
+};
+
+// Function declarations
+size_t flareClassText(float flux, char* buffer, size_t size);  // "M1.2", "X10.3", "A0.5"
+
+#endif
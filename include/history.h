@@ -0,0 +1,110 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Compressed observation history in fixed RAM (Gorilla-style).
+// Each series stores fixed-point values in a ring of small blocks; inside a
+// block timestamps are delta-of-delta coded and values delta coded with
+// variable-length bit buckets, so a regular 10 minute cadence with slowly
+// changing values costs a handful of bits per sample. When the ring is full
+// the oldest block is dropped as a whole.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#ifndef HISTORY_BLOCK_COUNT
+#define HISTORY_BLOCK_COUNT 16      // Ring length; the oldest block is recycled when full
+#endif
+
+#ifndef HISTORY_BLOCK_BYTES
+#define HISTORY_BLOCK_BYTES 128     // Compressed payload per block
+#endif
+
+// Observation channels recorded by the station
+enum HistoryChannel : uint8_t {
+  HISTORY_TEMPERATURE = 0,          // F
+  HISTORY_PRESSURE,                 // hPa
+  HISTORY_HUMIDITY,                 // %
+  HISTORY_WIND_SPEED,               // mph
+  HISTORY_KP,
+  HISTORY_BZ,                       // nT
+  HISTORY_SOLAR_WIND_SPEED,         // km/s
+  HISTORY_CHANNEL_COUNT
+};
+
+class HistorySeries {
+public:
+  // Values are stored as round(value * scale)
+  explicit HistorySeries(float scale);
+
+  void clear();
+  bool append(uint32_t time, float value);  // False if time goes backwards
+
+  uint32_t count() const;
+  uint32_t firstTime() const;
+  uint32_t lastTime() const { return prevTime; }
+  float lastValue() const { return prevValue / scale; }
+  size_t bytesUsed() const;                 // Compressed payload in use
+
+  // Forward iterator, oldest sample first; invalidated by append()
+  class Iterator {
+  public:
+    bool next(uint32_t& time, float& value);
+
+  private:
+    friend class HistorySeries;
+    Iterator(const HistorySeries& series);
+    bool readBits(uint8_t count, uint32_t& out);
+    bool readSigned(const uint8_t* widths, int32_t& out);
+
+    const HistorySeries* series;
+    uint8_t blocksLeft;
+    uint8_t block;
+    uint16_t sampleInBlock;
+    uint16_t bitPosition;
+    uint32_t time;
+    int32_t delta;
+    int32_t value;
+  };
+
+  Iterator begin() const { return Iterator(*this); }
+
+private:
+  struct Block {
+    uint32_t firstTime;
+    int32_t firstValue;
+    uint16_t count;
+    uint16_t bitLength;
+    uint8_t data[HISTORY_BLOCK_BYTES];
+  };
+
+  void startBlock(uint32_t time, int32_t value);
+  void writeBits(uint32_t bits, uint8_t count);
+  void writeSigned(const uint8_t* widths, int32_t value);
+
+  Block blocks[HISTORY_BLOCK_COUNT];
+  float scale;
+  uint8_t head;                     // Block being written
+  uint8_t used;                     // Blocks holding data
+  uint32_t prevTime;
+  int32_t prevDelta;
+  int32_t prevValue;
+};
+
+// Min/max/last of the samples that fall in one pixel column
+struct HistoryColumn {
+  float min;
+  float max;
+  float last;
+  uint16_t count;                   // 0 = no samples in this column
+};
+
+// Decimate [start, end) into width columns in a single pass over the series,
+// so a graph costs one vertical span per column however many samples it holds.
+// Returns the number of samples placed.
+uint32_t historyDecimate(const HistorySeries& series, uint32_t start, uint32_t end,
+                         HistoryColumn* columns, uint16_t width);
+
+extern HistorySeries history[HISTORY_CHANNEL_COUNT];
+
+#endif
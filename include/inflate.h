@@ -0,0 +1,114 @@
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Push-based inflater for gzip / deflate encoded HTTP bodies (RFC 1951/1952).
+// Compressed bytes are fed in arbitrary chunks as they arrive and the output
+// is handed on in window-sized pieces, so nothing but the 32 KB history
+// window is held. A decode step only consumes its bits once all of them are
+// available, which lets the stream stop anywhere without extra state. The
+// trailer checksum is verified, so finish() only succeeds on an intact body.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#define INFLATE_WINDOW_SIZE 32768      // Largest back-reference deflate allows
+#define INFLATE_FAST_BITS 9            // Codes up to this long decode with one table lookup
+
+enum InflateFormat : uint8_t {
+  INFLATE_GZIP = 0,        // Content-Encoding: gzip
+  INFLATE_ZLIB_OR_RAW      // Content-Encoding: deflate, zlib wrapped or (from some servers) raw
+};
+
+class InflateOutput {
+public:
+  virtual ~InflateOutput() {}
+  // Return false to abort, e.g. when the JSON parser found a syntax error
+  virtual bool inflated(const uint8_t* data, size_t length) = 0;
+};
+
+class Inflater {
+public:
+  explicit Inflater(InflateOutput& output);
+
+  void reset(InflateFormat format);
+  bool feed(const uint8_t* data, size_t length);  // False once the stream is corrupt or the output refused
+  bool finish();                                  // True when the final block (and trailer) arrived
+
+  bool failed() const { return state == STATE_ERROR; }
+  uint32_t consumed() const { return inBytes; }   // Compressed bytes fed so far
+  uint32_t produced() const { return outBytes; }  // Inflated bytes so far
+
+private:
+  enum State : uint8_t {
+    STATE_HEADER = 0,        // gzip / zlib header, byte by byte
+    STATE_BLOCK_HEADER,
+    STATE_STORED_LENGTH,
+    STATE_STORED_COPY,
+    STATE_TABLE_COUNTS,      // Dynamic block: HLIT, HDIST, HCLEN
+    STATE_CODE_LENGTH_CODES,
+    STATE_CODE_LENGTHS,
+    STATE_CODES,             // Literal/length + distance symbols
+    STATE_TRAILER,
+    STATE_DONE,
+    STATE_ERROR
+  };
+
+  // Canonical Huffman code: counts and symbols for the slow path, plus a
+  // lookup table of (length << 9) | symbol indexed by the next FAST_BITS bits
+  struct Huffman {
+    uint16_t count[16];
+    uint16_t symbol[288];
+    uint16_t fast[1 << INFLATE_FAST_BITS];
+  };
+
+  bool headerByte(uint8_t c);
+  bool step();
+  bool ensure(uint8_t bits);
+  uint32_t peek(uint8_t position, uint8_t bits) const {
+    return (uint32_t)(bitBuffer >> position) & ((1UL << bits) - 1);
+  }
+  void drop(uint8_t bits) { bitBuffer >>= bits; bitCount -= bits; }
+  int decode(const Huffman& code, uint8_t position, uint8_t& used);
+  bool build(Huffman& code, const uint8_t* lengths, uint16_t count);
+  bool decodeCodes();
+  void endBlock();
+  bool put(uint8_t c);
+  bool flush();
+  void updateChecksum(const uint8_t* data, size_t length);
+
+  InflateOutput& output;
+  const uint8_t* in;
+  const uint8_t* inEnd;
+  uint64_t bitBuffer;
+  uint8_t bitCount;
+  State state;
+  InflateFormat format;
+  bool finalBlock;
+  // Header / trailer progress
+  uint8_t headerBytes[2];
+  uint8_t headerFlags;
+  uint16_t headerPosition;
+  uint16_t extraLeft;
+  uint8_t trailerLength;     // 8 for gzip (CRC-32, size), 4 for zlib (Adler-32), 0 for raw
+  uint8_t trailerPosition;
+  uint32_t trailerSize;      // gzip ISIZE
+  uint32_t trailerCheck;
+  uint32_t checksum;         // Running CRC-32 / Adler-32 of the output
+  // Block progress
+  uint16_t storedLeft;
+  uint16_t literalCount;     // HLIT
+  uint16_t distanceCount;    // HDIST
+  uint16_t lengthIndex;
+  uint8_t codeLengthCount;   // HCLEN
+  uint32_t inBytes;
+  uint32_t outBytes;
+  uint16_t windowPosition;
+  uint16_t flushed;          // Window bytes up to here went to the output
+  uint8_t lengths[320];
+  Huffman literalCode;       // Also holds the code length code while reading a dynamic header
+  Huffman distanceCode;
+  uint8_t window[INFLATE_WINDOW_SIZE];
+};
+
+#endif
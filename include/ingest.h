@@ -0,0 +1,269 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "json_stream.h"
+#include "kp_forecast.h"
+#include "solar_wind.h"
+#include "flare.h"
+#include "alerts.h"
+#include "sunspots.h"
+#include "weather.h"
+
+// JSON ingest routines for every upstream payload.
+// Each routine takes the raw response body, validates its shape and only
+// updates the matching globals from weather.h when valid data was found,
+// so an upstream format change keeps the last good values instead of zeros.
+// They have no network dependencies and can be driven from a host harness.
+
+typedef bool (*IngestFunction)(const char* json, size_t length);
+
+// Schema problems reported with EV_SCHEMA_ERROR
+enum SchemaError : uint8_t {
+  SCHEMA_NOT_ARRAY = 0,    // Top level is not the expected array
+  SCHEMA_NOT_OBJECT,       // Expected object missing
+  SCHEMA_MISSING_COLUMN,   // Header row lacks a required column
+  SCHEMA_NO_VALID_ROWS     // No row contained an in-range value
+};
+
+// Streaming ingest for payloads too large to hold in RAM: the transport calls
+// begin(), feeds the body through a JsonStreamParser driving this handler,
+// then finish() validates what was collected and publishes it
+class StreamIngest : public JsonStreamHandler {
+public:
+  virtual void begin() = 0;
+  virtual bool finish(bool parsed) = 0;  // parsed = the parser accepted a complete document
+  // Token buffer for ingests needing strings longer than JSON_TOKEN_SIZE (nullptr = default)
+  virtual char* tokenBuffer(size_t& size) { (void)size; return nullptr; }
+};
+
+// OVATION aurora nowcast grid - keeps only the longitude columns of up to
+// LOCATION_MAX locations out of ~65k cells, so one pass serves them all
+class OvationIngest : public StreamIngest {
+public:
+  OvationIngest() : targetCount(0) {}
+  // Grid cell to report from the next begin() on, into auroraNowcast (the aggregator serves several sites)
+  void setLocation(float latitude, float longitude);
+  // Further cells scanned in the same pass, each reported into its own nowcast
+  void clearLocations();
+  bool addLocation(float latitude, float longitude, AuroraNowcastData& nowcast);
+
+  void begin() override;
+  bool finish(bool parsed) override;
+  void startObject() override;
+  void endObject() override;
+  void startArray() override;
+  void endArray() override;
+  void key(const char* name) override;
+  void value(const char* text, JsonValueType type) override;
+
+private:
+  struct Target {
+    float latitude;
+    float longitude;
+    AuroraNowcastData* nowcast;
+    int32_t gridLongitude;   // 0-359
+    int32_t gridLatitude;
+    int32_t probability;
+    int32_t polewardMax;
+    int32_t ovalEdge;
+  };
+
+  void cell(int32_t longitude, int32_t latitude, int32_t probability);
+
+  Target targets[LOCATION_MAX];
+  uint8_t targetCount;
+  uint8_t depth;
+  bool inCoordinates;
+  bool wantForecastTime;
+  uint8_t fieldCount;
+  int32_t fields[3];         // Longitude, latitude, probability
+  uint32_t cells;
+  char forecastTime[24];
+};
+
+extern OvationIngest ovationIngest;
+
+// SWPC 3-day Kp forecast - every slot goes into a fixed-size series.
+// Accepts both the table form ([["time_tag","kp","observed",...], [...]])
+// and the object form ([{"time_tag": ..., "kp": ..., "observed": ...}]).
+class KpForecastIngest : public StreamIngest {
+public:
+  void begin() override;
+  bool finish(bool parsed) override;
+  void startObject() override;
+  void endObject() override;
+  void startArray() override;
+  void endArray() override;
+  void key(const char* name) override;
+  void value(const char* text, JsonValueType type) override;
+
+private:
+  enum Field : int8_t { FIELD_NONE = -1, FIELD_TIME, FIELD_KP, FIELD_SOURCE };
+
+  void field(Field which, const char* text, JsonValueType type);
+  void endRow();
+
+  KpForecastSeries staging;  // Swapped into kpForecast only when the parse succeeds
+  uint8_t depth;
+  bool topIsArray;
+  bool headerSeen;
+  int8_t columns[3];         // Table column of each Field
+  uint8_t column;
+  bool rowIsObject;
+  Field currentKey;
+  bool rowHasTime;
+  bool rowHasKp;
+  time_t rowTime;
+  float rowKp;
+  KpSource rowSource;
+};
+
+extern KpForecastIngest kpForecastIngest;
+
+// SWPC 1-day solar wind tables (mag-1-day / plasma-1-day, ~1440 minute rows).
+// Every valid row is folded into the 5-minute bins of solarWind and the newest
+// one becomes the current value in currentSpaceWeather.
+class SolarWindIngest : public StreamIngest {
+public:
+  explicit SolarWindIngest(SolarWindKind kind) : kind(kind) {}
+
+  void begin() override;
+  bool finish(bool parsed) override;
+  void startObject() override {}
+  void endObject() override {}
+  void startArray() override;
+  void endArray() override;
+  void key(const char*) override {}
+  void value(const char* text, JsonValueType type) override;
+
+private:
+  enum Field : uint8_t { FIELD_TIME = 0, FIELD_PRIMARY, FIELD_SECONDARY, FIELD_COUNT };
+
+  void endRow();
+
+  SolarWindKind kind;
+  SolarWindBinner binner;
+  uint8_t depth;
+  bool topIsArray;
+  bool headerSeen;
+  int8_t columns[FIELD_COUNT];
+  uint8_t column;
+  uint8_t rowFields;         // Bit per Field parsed in this row
+  time_t rowTime;
+  float rowPrimary;
+  float rowSecondary;
+  uint16_t rows;             // Valid rows
+  time_t latestTime;
+  float latestPrimary;
+  float latestSecondary;
+};
+
+extern SolarWindIngest solarWindMagIngest;
+extern SolarWindIngest solarWindPlasmaIngest;
+
+// GOES xrays-1-day ([{"time_tag": ..., "flux": ..., "energy": "0.1-0.8nm"}, ...],
+// both channels interleaved, ~1 MB). Every sample runs through a FlareDetector;
+// the flares found are merged into flareEvents and the newest long channel
+// flux becomes the current X-ray class.
+class XrayIngest : public StreamIngest {
+public:
+  void begin() override;
+  bool finish(bool parsed) override;
+  void startObject() override;
+  void endObject() override;
+  void startArray() override;
+  void endArray() override;
+  void key(const char* name) override;
+  void value(const char* text, JsonValueType type) override;
+
+private:
+  enum Field : int8_t { FIELD_NONE = -1, FIELD_TIME, FIELD_FLUX, FIELD_ENERGY };
+
+  FlareDetector detector;
+  uint8_t depth;
+  bool topIsArray;
+  Field currentKey;
+  bool rowHasTime;
+  bool rowHasFlux;
+  int8_t rowChannel;         // XrayChannel, -1 = unknown band
+  time_t rowTime;
+  float rowFlux;
+};
+
+extern XrayIngest xrayIngest;
+
+// SWPC solar_regions.json ([{"observed_date": ..., "region": ..., "number_spots": ...,
+// "area": ...}, ...], several weeks of daily region rows). Only the latest
+// observation date is summed, into the sunspot fields of noaaSpaceWeather.
+class SolarRegionIngest : public StreamIngest {
+public:
+  void begin() override;
+  bool finish(bool parsed) override;
+  void startObject() override;
+  void endObject() override;
+  void startArray() override;
+  void endArray() override;
+  void key(const char* name) override;
+  void value(const char* text, JsonValueType type) override;
+
+private:
+  enum Field : int8_t { FIELD_NONE = -1, FIELD_DATE, FIELD_REGION, FIELD_SPOTS, FIELD_AREA };
+
+  SunspotAggregator aggregator;
+  uint8_t depth;
+  bool topIsArray;
+  Field currentKey;
+  time_t rowObserved;
+  int32_t rowRegion;
+  int32_t rowSpots;
+  int32_t rowArea;
+};
+
+extern SolarRegionIngest solarRegionIngest;
+
+// SWPC alerts.json ([{"product_id": ..., "issue_datetime": ..., "message": ...}, ...]).
+// Every product goes through alertStoreAdd, which deduplicates it against what
+// is already held, so repeated fetches only add what is new; expired entries
+// are dropped at the end of each scan.
+class AlertIngest : public StreamIngest {
+public:
+  void begin() override;
+  bool finish(bool parsed) override;
+  char* tokenBuffer(size_t& size) override;
+  void startObject() override;
+  void endObject() override;
+  void startArray() override;
+  void endArray() override;
+  void key(const char* name) override;
+  void value(const char* text, JsonValueType type) override;
+
+private:
+  enum Field : int8_t { FIELD_NONE = -1, FIELD_PRODUCT, FIELD_ISSUED, FIELD_MESSAGE };
+
+  uint8_t depth;
+  bool topIsArray;
+  Field currentKey;
+  bool rowHasProduct;
+  bool rowHasIssued;
+  bool rowHasMessage;
+  time_t rowIssued;
+  uint32_t now;
+  uint16_t rows;
+  uint16_t added;
+  uint16_t duplicates;
+  char token[ALERT_MESSAGE_SIZE];   // Whole message strings arrive as one token
+  char message[ALERT_MESSAGE_SIZE]; // Copy kept until the row's object closes
+};
+
+extern AlertIngest alertIngest;
+
+// Function declarations
+bool ingestOneCall(const char* json, size_t length);
+bool ingestAirQuality(const char* json, size_t length);
+bool ingestKpIndex(const char* json, size_t length);
+bool ingestSolarFlux(const char* json, size_t length);
+bool ingestGeomagIndices(const char* json, size_t length);
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Push-based (SAX style) JSON tokenizer for payloads too large to buffer.
+// Bytes are fed in arbitrary chunks as they arrive from the network and the
+// handler sees one callback per token, so memory use is a fixed token buffer
+// plus whatever the handler decides to keep.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+enum JsonValueType : uint8_t {
+  JSON_STRING = 0,
+  JSON_NUMBER,              // Raw text, convert with jsonToInt()/jsonToFloat()
+  JSON_TRUE,
+  JSON_FALSE,
+  JSON_NULL
+};
+
+class JsonStreamHandler {
+public:
+  virtual ~JsonStreamHandler() {}
+  virtual void startObject() {}
+  virtual void endObject() {}
+  virtual void startArray() {}
+  virtual void endArray() {}
+  virtual void key(const char* name) { (void)name; }
+  virtual void value(const char* text, JsonValueType type) { (void)text; (void)type; }
+};
+
+class JsonStreamParser {
+public:
+  // Strings longer than tokenSize - 1 bytes are truncated (see truncated());
+  // numbers that long are a syntax error, as they would read as another value
+  JsonStreamParser(JsonStreamHandler& handler, char* tokenBuffer, size_t tokenSize);
+
+  void reset();
+  bool feed(const char* data, size_t length);   // False once a syntax error was found
+  bool finish();                                // True when one complete document was parsed
+
+  bool failed() const { return state == STATE_ERROR; }
+  bool truncated() const { return tokenTruncated; }
+  uint8_t depth() const { return level; }       // 1 inside the top-level container
+  size_t position() const { return consumed; }  // Bytes accepted so far
+
+private:
+  enum State : uint8_t {
+    STATE_VALUE = 0,
+    STATE_VALUE_OR_END,     // After '['
+    STATE_KEY,              // After ',' in an object
+    STATE_KEY_OR_END,       // After '{'
+    STATE_COLON,
+    STATE_AFTER_VALUE,
+    STATE_STRING,
+    STATE_STRING_ESCAPE,
+    STATE_STRING_UNICODE,
+    STATE_NUMBER,
+    STATE_LITERAL,
+    STATE_DONE,
+    STATE_ERROR
+  };
+
+  static const uint8_t MAX_DEPTH = 32;        // One bit per level in containerBits
+
+  bool process(char c);
+  bool beginValue(char c);
+  bool push(bool object);
+  bool pop(bool object);
+  void endValue();
+  void append(char c);
+  bool appendDigit(char c);
+  void appendCodepoint(uint16_t codepoint);
+  bool emitScalar();
+
+  JsonStreamHandler& handler;
+  char* token;
+  size_t tokenSize;
+  size_t tokenLength;
+  size_t consumed;
+  uint32_t containerBits;   // Bit n set when level n+1 is an object
+  uint8_t level;
+  State state;
+  bool stringIsKey;
+  bool tokenTruncated;
+  uint8_t unicodeDigits;
+  uint16_t unicodeValue;
+};
+
+// Number helpers for JSON_NUMBER tokens (and numeric strings)
+bool jsonToInt(const char* text, int32_t& out);    // Rounded; false outside the int32_t range
+bool jsonToFloat(const char* text, float& out);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef KP_FORECAST_H
+#define KP_FORECAST_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Compact Kp time series from SWPC's 3-day forecast product plus per-night
+// analysis against local darkness from the ephemeris.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#ifndef KP_FORECAST_CAPACITY
+#define KP_FORECAST_CAPACITY 96    // 3-hour slots; the product holds ~1 week observed + 3 days predicted
+#endif
+
+#define KP_SLOT_SECONDS 10800
+
+enum KpSource : uint8_t {
+  KP_OBSERVED = 0,
+  KP_ESTIMATED,
+  KP_PREDICTED
+};
+
+struct KpForecastPoint {
+  uint32_t time;           // Slot start, Unix time
+  uint8_t kpTenths;        // Kp x10 (0-90)
+  uint8_t source;          // KpSource
+};
+
+struct KpForecastSeries {
+  KpForecastPoint points[KP_FORECAST_CAPACITY];  // Oldest first
+  uint8_t count;
+};
+
+struct AuroraNight {
+  time_t darkStart;        // Dusk to dawn window used for the night (0 = no darkness)
+  time_t darkEnd;
+  time_t peakStart;        // Dark part of the slot(s) with the highest Kp
+  time_t peakEnd;
+  float maxKp;             // Highest Kp over the dark window, -1 when no slot covers it
+  KpSource source;         // Least certain source among the slots used
+};
+
+// Function declarations
+void kpSeriesClear(KpForecastSeries& series);
+void kpSeriesAppend(KpForecastSeries& series, time_t time, float kp, KpSource source);  // Drops the oldest when full
+// evening is any time on the local day the night starts; needs timeZoneInit()
+bool analyzeAuroraNight(const KpForecastSeries& series, time_t evening, double latitude, double longitude,
+                        AuroraNight& out);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef LOCAL_API_H
+#define LOCAL_API_H
+
+#include <stdint.h>
+
+// Small HTTP/1.1 server for other devices on the LAN (second displays,
+// dashboards), so they read the station's data instead of each polling
+// OpenWeather and NOAA themselves.
+//   GET|HEAD /api/snapshot        JSON, or CBOR when Accept names application/cbor
+//   GET|HEAD /api/snapshot.json
+//   GET|HEAD /api/snapshot.cbor
+// Bodies come straight from the published snapshot (see snapshot.h) with its
+// ETag; If-None-Match answers 304, and 503 until the first refresh is in.
+// One task drives every connection through select() on non-blocking
+// sockets: up to LOCAL_API_MAX_CLIENTS keep-alive clients, pipelined
+// requests answered in order, idle ones dropped after LOCAL_API_IDLE_TIMEOUT
+// (or sooner when another device is waiting for a slot).
+// Nothing is allocated after localApiOpen().
+// Plain BSD sockets, so it builds on lwIP and on a host alike.
+
+#ifndef LOCAL_API_MAX_CLIENTS
+#define LOCAL_API_MAX_CLIENTS 4
+#endif
+
+#ifndef LOCAL_API_REQUEST_SIZE
+#define LOCAL_API_REQUEST_SIZE 1024    // Longest request head, larger ones get 431
+#endif
+
+#ifndef LOCAL_API_IDLE_TIMEOUT
+#define LOCAL_API_IDLE_TIMEOUT 15000   // ms without progress before a client is dropped
+#endif
+
+#ifndef LOCAL_API_EVICT_IDLE
+#define LOCAL_API_EVICT_IDLE 100       // ms idle after which a keep-alive client yields its slot to a new one
+#endif
+
+struct LocalApiStats {
+  uint32_t connections;    // Accepted
+  uint32_t requests;       // Answered, any status
+  uint32_t notModified;    // Of those, 304s
+  uint32_t errors;         // Of those, 4xx/5xx
+};
+
+// Function declarations
+// Listen on all interfaces; false when the socket cannot be bound
+bool localApiOpen(uint16_t port);
+// Wait up to waitMillis for socket activity and serve it; now is a millisecond clock
+void localApiPoll(uint32_t now, uint32_t waitMillis);
+LocalApiStats localApiStats();
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef LOCATIONS_H
+#define LOCATIONS_H
+
+#include <stdint.h>
+
+// Several configured places sharing one OpenWeather call budget.
+// The displayed (active) location gets LOCATION_ACTIVE_WEIGHT shares of the
+// day's remaining calls and every background one a single share, so adding
+// places first slows the background ones down and only then the active one.
+// Neither ever refreshes faster than its floor: the base interval for the
+// active location, activeWeight times that in the background. The SWPC data
+// and the OVATION grid are global and fetched once for all of them.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#define LOCATION_NONE 0xFF
+
+struct Location {
+  const char* name;
+  float latitude;
+  float longitude;
+  const char* timeZone;    // POSIX TZ rule, nullptr = TIME_ZONE
+};
+
+// Kept per location while another one is displayed
+struct LocationStatus {
+  float temperature;       // From the last OneCall, for the locations screen
+  uint32_t weatherUpdated; // millis() of that OneCall, 0 = never
+  uint32_t refreshedAt;    // millis() of the last background refresh attempt, 0 = never
+};
+
+extern const Location locations[];
+extern const uint8_t locationCount;
+extern uint8_t activeLocation;                 // Index of the displayed location
+extern LocationStatus locationStatus[];
+
+// Function declarations
+// Seconds between refreshes of the active or of one background location out
+// of count; sharedInterval is the quota's interval for a single location
+// refreshing as often as the budget allows (quotaInterval() with a 1 s base)
+uint32_t locationInterval(uint8_t count, uint8_t activeWeight, bool active, uint32_t sharedInterval,
+                          uint32_t baseInterval);
+// Background location to refresh now: never refreshed first, then the one
+// refreshed longest ago once interval (ms) has passed, at most one per
+// interval / background count; LOCATION_NONE if none
+uint8_t locationDue(const LocationStatus status[], uint8_t count, uint8_t active, uint32_t now, uint32_t interval);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef QUOTA_H
+#define QUOTA_H
+
+#include <stdint.h>
+
+// Per-provider API call budget that survives reboots.
+// Two limits apply to every request, and both are charged before it goes out,
+// so failed and interrupted requests count too:
+//  - the provider's daily allowance, reset at 00:00 UTC like OpenWeather's;
+//  - a token bucket refilled at dailyLimit per day and holding at most
+//    `burst` calls, so a reboot loop or a run of catch-up refreshes cannot
+//    spend the day's allowance in minutes.
+// Without a set clock (now == 0) nothing refills and the day does not roll
+// over, so a device rebooting before SNTP can only spend what the bucket
+// still holds.
+// The persisted copy is written ahead of the spending: each write charges
+// QUOTA_WRITE_AHEAD calls at once and the next ones are taken from that
+// reserve, so flash sees one write per QUOTA_WRITE_AHEAD calls and an
+// unplanned reboot forgets none of them (it wastes at most the reserve). A
+// new UTC day starts a fresh copy, and quotaFlush() writes the exact state
+// before a deliberate restart.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#define QUOTA_DAY_SECONDS 86400UL
+#define QUOTA_TOKEN_SCALE 1000         // Tokens are kept in thousandths of a call
+
+#ifndef QUOTA_WRITE_AHEAD
+#define QUOTA_WRITE_AHEAD 4            // Calls charged by one write of the persisted copy
+#endif
+
+enum QuotaProvider : uint8_t {
+  QUOTA_OPENWEATHER = 0,   // OneCall + air quality, one key
+  QUOTA_SWPC,              // NOAA SWPC JSON products
+  QUOTA_PROVIDER_COUNT
+};
+
+struct QuotaPolicy {
+  uint16_t dailyLimit;
+  uint16_t burst;          // Bucket capacity, calls
+};
+
+// Persisted as raw bytes, so fields are only ever appended
+struct QuotaBucket {
+  uint32_t day;            // UTC day number used counts, 0 = clock not seen yet
+  uint32_t refilledAt;     // Epoch seconds of the last refill, 0 = never
+  uint32_t tokens;         // Thousandths of a call
+  uint16_t used;           // Calls charged on `day`
+  uint16_t denied;         // Calls refused on `day`
+};
+
+// RAM side of the persisted copy
+struct QuotaJournal {
+  uint32_t day;            // bucket.day when the copy was written
+  uint8_t ahead;           // Calls charged in the copy and not spent yet
+};
+
+// Function declarations
+void quotaInit(QuotaBucket& bucket, const QuotaPolicy& policy);
+// False when persisted bytes cannot be a bucket for this policy
+bool quotaValid(const QuotaBucket& bucket, const QuotaPolicy& policy);
+// Refill and roll the day over; now is UTC epoch seconds, 0 while unknown
+void quotaAdvance(QuotaBucket& bucket, const QuotaPolicy& policy, uint32_t now);
+// Charge one call if both limits allow it
+bool quotaTake(QuotaBucket& bucket, const QuotaPolicy& policy, uint32_t now);
+// After quotaTake(): true when the persisted copy no longer covers the calls
+// charged, with stored set to the copy to write (charged ahead)
+bool quotaJournal(QuotaJournal& journal, const QuotaBucket& bucket, const QuotaPolicy& policy, bool charged,
+                  QuotaBucket& stored);
+// The exact state to write before a deliberate restart; the reserve is released
+void quotaFlush(QuotaJournal& journal, const QuotaBucket& bucket, QuotaBucket& stored);
+// Seconds between refreshes of callsPerRefresh calls that spreads the rest of
+// today's allowance until the reset, never below baseInterval or the refill rate
+uint32_t quotaInterval(const QuotaBucket& bucket, const QuotaPolicy& policy, uint32_t now,
+                       uint32_t baseInterval, uint8_t callsPerRefresh);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Incremental hourly and daily min/max/mean buckets for one observation channel.
+// Each sample updates the open bucket in O(1); a new bucket is opened when the
+// sample crosses a local hour or local midnight of the home zone (ZONE_HOME in
+// timezone.h, DST-aware, unaffected by the displayed location), so the
+// display can ask for "today's high" or a 3 hour tendency without rescanning
+// raw history.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#ifndef ROLLUP_HOURS
+#define ROLLUP_HOURS 26             // Hourly buckets kept (covers a full 24 h look-back)
+#endif
+
+#ifndef ROLLUP_DAYS
+#define ROLLUP_DAYS 8               // Daily buckets kept
+#endif
+
+struct RollupBucket {
+  uint32_t start;                   // Local hour or local midnight, Unix time
+  uint32_t end;                     // Exclusive
+  float min;
+  float max;
+  float mean;
+  uint16_t count;
+};
+
+class Rollup {
+public:
+  Rollup();
+
+  void clear();
+  bool add(uint32_t time, float value);     // False if older than the open buckets
+
+  // Buckets by age, 0 = the open one; nullptr when not kept
+  const RollupBucket* hour(uint8_t ago) const;
+  const RollupBucket* day(uint8_t ago) const;
+  // Bucket containing time, nullptr when not kept
+  const RollupBucket* hourAt(uint32_t time) const;
+  const RollupBucket* dayAt(uint32_t time) const;
+
+  bool hasData() const { return hourCount > 0; }
+  uint32_t lastTime() const { return latestTime; }
+  float lastValue() const { return latestValue; }
+
+private:
+  static void openBucket(RollupBucket& bucket, uint32_t start, uint32_t end, float value);
+  static void addToBucket(RollupBucket& bucket, float value);
+
+  RollupBucket hours[ROLLUP_HOURS];
+  RollupBucket days[ROLLUP_DAYS];
+  uint8_t hourHead;
+  uint8_t hourCount;
+  uint8_t dayHead;
+  uint8_t dayCount;
+  uint32_t latestTime;
+  float latestValue;
+};
+
+// Change from the mean of the hour seconds ago to the latest value, false without data
+bool rollupChange(const Rollup& rollup, uint32_t now, uint32_t seconds, float& change);
+
+#endif
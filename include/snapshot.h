@@ -0,0 +1,141 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Immutable copy of the station's current data for the local API.
+// The loop task fills a StationSnapshot from the weather.h globals after each
+// refresh and publishes it: both representations (compact JSON and CBOR) are
+// encoded once into fixed buffers, each with an ETag, and requests are then
+// served straight from those bytes. There are two slots; readers pin the
+// published one with a counter, and the publisher only writes into the other
+// slot while nobody holds it, so a response never sees a half-written body
+// and nothing is copied per request. Only one task may publish.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#ifndef SNAPSHOT_JSON_SIZE
+#define SNAPSHOT_JSON_SIZE 3584
+#endif
+
+#ifndef SNAPSHOT_CBOR_SIZE
+#define SNAPSHOT_CBOR_SIZE 2560
+#endif
+
+#define SNAPSHOT_TEXT_SIZE 32
+#define SNAPSHOT_WORD_SIZE 16
+#define SNAPSHOT_ICON_SIZE 4
+#define SNAPSHOT_DAYS 7
+#define SNAPSHOT_HOURS 12
+#define SNAPSHOT_ALERTS 16
+
+enum SnapshotFormat : uint8_t {
+  SNAPSHOT_JSON = 0,
+  SNAPSHOT_CBOR,
+  SNAPSHOT_FORMAT_COUNT
+};
+
+struct SnapshotDay {
+  char name[SNAPSHOT_ICON_SIZE];     // "Mon"
+  float high;
+  float low;
+  int16_t precipChance;
+  char icon[SNAPSHOT_ICON_SIZE];
+};
+
+struct SnapshotHour {
+  char time[6];            // "2PM"
+  float temperature;
+  int16_t precipChance;
+  char icon[SNAPSHOT_ICON_SIZE];
+};
+
+struct SnapshotAlert {
+  char code[8];
+  char scale[3];
+  uint32_t issued;
+  uint32_t expires;
+};
+
+// Times are UTC epoch seconds, 0 = unknown. Unknown floats are NaN; both
+// encode as null.
+struct StationSnapshot {
+  uint32_t generated;
+
+  char city[SNAPSHOT_TEXT_SIZE];
+  float temperature;
+  int16_t humidity;
+  float pressure;
+  float windSpeed;
+  int16_t windDirection;
+  char description[SNAPSHOT_TEXT_SIZE];
+  char icon[SNAPSHOT_ICON_SIZE];
+  uint32_t weatherUpdated;
+
+  int16_t aqi;
+  float pm2_5;
+  float pm10;
+  float o3;
+  float no2;
+  int16_t uvIndex;
+  uint32_t airUpdated;
+
+  uint32_t sunrise;
+  uint32_t sunset;
+  uint32_t moonrise;
+  uint32_t moonset;
+  float moonPhase;
+  float moonIllumination;
+  char moonPhaseName[SNAPSHOT_WORD_SIZE];
+
+  float kpIndex;
+  float bz;
+  float by;
+  float solarWindSpeed;
+  float solarWindDensity;
+  float couplingKp;
+  float dst;
+  int16_t auroraScore;
+  char geomagStatus[SNAPSHOT_WORD_SIZE];
+  float solarFlux;
+  float aIndex;
+  char xrayClass[8];
+  int16_t sunspotNumber;
+  int16_t activeRegions;
+  uint32_t spaceUpdated;
+
+  float kpToday;
+  float kpTomorrow;
+  int16_t nowcastProbability;
+  int16_t viewlineLatitude;
+
+  SnapshotDay days[SNAPSHOT_DAYS];
+  SnapshotHour hours[SNAPSHOT_HOURS];
+  uint8_t alertCount;
+  SnapshotAlert alerts[SNAPSHOT_ALERTS];
+};
+
+struct SnapshotBody {
+  const uint8_t* data;
+  uint16_t length;
+  uint32_t etag;           // FNV-1a of the body
+};
+
+struct SnapshotSlot;
+
+// Function declarations
+// Encode into the slot readers are not using and make it the published one.
+// False when a slow reader still holds that slot or a body did not fit; the
+// previous snapshot stays published.
+bool snapshotPublish(const StationSnapshot& snapshot);
+// Pin the published slot, nullptr before the first publish. Every non-null
+// result must go back through snapshotRelease().
+const SnapshotSlot* snapshotAcquire();
+void snapshotRelease(const SnapshotSlot* slot);
+SnapshotBody snapshotBody(const SnapshotSlot* slot, SnapshotFormat format);
+// Encode without publishing; 0 when the buffer is too small
+size_t snapshotEncode(const StationSnapshot& snapshot, SnapshotFormat format, uint8_t* out, size_t size);
+// strlcpy that never cuts a UTF-8 sequence in half (CBOR text must be valid UTF-8)
+void snapshotCopyText(char* dest, size_t size, const char* src);
+
+#endif
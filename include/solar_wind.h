@@ -0,0 +1,69 @@
+#ifndef SOLAR_WIND_H
+#define SOLAR_WIND_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Day-long solar wind and IMF series reduced from SWPC's minute tables into
+// fixed 5-minute bins (min/mean/max), plus the derived quantities that
+// actually drive aurora onset, such as how long Bz has stayed southward.
+// Bins are slotted by absolute time, so the mag and plasma products fill
+// the same bins independently and a refetch simply overwrites them.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#define SOLAR_WIND_BIN_SECONDS 300
+#define SOLAR_WIND_BINS 288              // 24 hours, the span of the 1-day products
+
+#ifndef SOLAR_WIND_GAP_BINS
+#define SOLAR_WIND_GAP_BINS 3            // Empty bins bridged by the southward-duration scan
+#endif
+
+struct SolarWindBin {
+  uint32_t start;          // Bin start, Unix time (0 = never filled)
+  int16_t bzMin;           // IMF Bz GSM, 0.1 nT
+  int16_t bzMean;
+  int16_t bzMax;
+  int16_t byMean;          // IMF By GSM, 0.1 nT
+  uint16_t speedMin;       // km/s
+  uint16_t speedMean;
+  uint16_t speedMax;
+  uint16_t densityMean;    // 0.01 protons/cm3
+  uint8_t magSamples;      // Minute rows folded in, 0 = no data
+  uint8_t plasmaSamples;
+};
+
+struct SolarWindSeries {
+  SolarWindBin bins[SOLAR_WIND_BINS];  // Slot = (start / SOLAR_WIND_BIN_SECONDS) % SOLAR_WIND_BINS
+};
+
+enum SolarWindKind : uint8_t {
+  SOLAR_WIND_MAG = 0,      // primary = Bz, secondary = By (nT)
+  SOLAR_WIND_PLASMA        // primary = speed (km/s), secondary = density (cm-3)
+};
+
+// Folds time-ordered minute rows of one product into bins
+class SolarWindBinner {
+public:
+  void begin(SolarWindKind kind);
+  void add(SolarWindSeries& series, uint32_t time, float primary, float secondary);
+  void flush(SolarWindSeries& series);   // Write the open bin; call after the last row
+
+private:
+  SolarWindKind kind;
+  uint32_t binStart;       // 0 = no open bin
+  float primaryMin;
+  float primaryMax;
+  float primarySum;
+  float secondarySum;
+  uint8_t count;
+};
+
+// Function declarations
+void solarWindClear(SolarWindSeries& series);
+// Bin holding time, nullptr if that bin was never filled or has been overwritten
+const SolarWindBin* solarWindBinAt(const SolarWindSeries& series, uint32_t time);
+// How long the 5-minute mean Bz has stayed below threshold (nT) up to the newest
+// mag bin at or before now; gaps of up to SOLAR_WIND_GAP_BINS empty bins don't break the run
+uint32_t solarWindSouthwardSeconds(const SolarWindSeries& series, uint32_t now, float threshold);
+
+#endif
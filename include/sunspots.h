@@ -0,0 +1,46 @@
+#ifndef SUNSPOTS_H
+#define SUNSPOTS_H
+
+#include <stdint.h>
+
+// Daily sunspot summary from the SWPC active region list.
+// solar_regions.json holds one row per region per observation date over
+// several weeks; only the rows of the latest date describe today's disk.
+// Rows are folded in one at a time whatever their order: a newer date
+// restarts the sums, older dates are ignored. The derived sunspot number is
+// the Wolf formula R = 10 g + s, with g the regions showing spots (plage-only
+// regions have none) and s the total spot count.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#ifndef SUNSPOT_REGION_CAPACITY
+#define SUNSPOT_REGION_CAPACITY 48   // Region numbers remembered to skip repeated rows
+#endif
+
+struct SunspotSummary {
+  uint32_t observed;       // Unix time of the observation date (00:00 UTC), 0 = none
+  uint16_t regions;        // Numbered regions on the disk, plage included
+  uint16_t spotGroups;     // Regions with at least one spot
+  uint16_t spots;          // Total spot count
+  uint16_t area;           // Total spot area, millionths of the hemisphere
+  uint16_t sunspotNumber;  // 10 * spotGroups + spots
+  uint16_t largestRegion;  // Region number with the largest area, 0 = none
+  uint16_t largestArea;
+};
+
+class SunspotAggregator {
+public:
+  void begin();
+  // One region row; spots and area < 0 when the row has no value
+  void add(uint32_t observed, int32_t region, int32_t spots, int32_t area);
+  bool finish(SunspotSummary& summary) const;  // False when no row was usable
+
+  uint16_t rows() const { return rowCount; }
+
+private:
+  uint16_t rowCount;
+  SunspotSummary current;
+  uint16_t regionNumbers[SUNSPOT_REGION_CAPACITY];
+  uint8_t regionCount;
+};
+
+#endif
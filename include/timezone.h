@@ -0,0 +1,51 @@
+#ifndef TIMEZONE_H
+#define TIMEZONE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// Small POSIX TZ rule engine ("CST6CDT,M3.2.0,M11.1.0").
+// The DST transitions for a year are computed once and cached, so converting
+// a timestamp is a couple of integer comparisons plus a civil-from-days split.
+// Formatting writes into caller buffers - no String or heap allocation.
+// Conversions work on a private copy of the rule and may run on any task at
+// once; timeZoneInit() must only be called from one task (the loop).
+// Two zones are kept: the displayed location's, which every call uses unless
+// told otherwise, and home's, which the history and its rollups stay on
+// while another location is shown.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+enum ZoneId : uint8_t {
+  ZONE_DISPLAYED = 0,       // Clock, hour and day labels, astronomy
+  ZONE_HOME,                // History, rollups and their midnights
+  ZONE_COUNT
+};
+
+struct LocalTime {
+  int16_t year;
+  uint8_t month;            // 1-12
+  uint8_t day;              // 1-31
+  uint8_t hour;             // 0-23
+  uint8_t minute;
+  uint8_t second;
+  uint8_t weekday;          // 0=Sunday
+  bool dst;
+};
+
+// Function declarations
+// Parse a POSIX TZ rule into a zone, false if malformed (that zone falls back to UTC)
+bool timeZoneInit(const char* rule, ZoneId zone = ZONE_DISPLAYED);
+int32_t timeZoneOffset(time_t utc, ZoneId zone = ZONE_DISPLAYED);  // Seconds east of UTC, including DST
+void toLocalTime(time_t utc, LocalTime& out, ZoneId zone = ZONE_DISPLAYED);
+time_t localMidnight(time_t utc, ZoneId zone = ZONE_DISPLAYED);    // Start of the local day containing utc
+bool parseUtcTimestamp(const char* text, time_t& out);  // "2025-10-24 21:00:00", "2025-10-24T21:00Z", ...
+
+// Formatting into caller buffers, each returns the string length
+size_t formatClock(time_t utc, char* buffer, size_t size);       // "7:05 PM"
+size_t formatClockCompact(time_t utc, char* buffer, size_t size); // "7:05PM"
+size_t formatHour(time_t utc, char* buffer, size_t size);        // "7PM"
+size_t formatDate(time_t utc, char* buffer, size_t size);        // "10/24/2025"
+size_t formatUptime(uint64_t microseconds, char* buffer, size_t size); // "1193h2m", before SNTP has synced
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef UPSTREAM_H
+#define UPSTREAM_H
+
+#include <stdint.h>
+
+// Health of one upstream endpoint, as a circuit breaker.
+//  - closed: requests go out; a single failure waits for the next tick,
+//    UPSTREAM_FAILURE_THRESHOLD consecutive failures open the circuit;
+//  - open: requests are skipped until retryAt, which backs off
+//    exponentially (with jitter so endpoints sharing a host spread out);
+//  - half-open: one probe request; success closes, failure reopens with
+//    the next longer backoff.
+// Client errors other than 429 (bad key, missing product) will not clear up
+// on their own and open the circuit straight to the longest backoff.
+// The ingests keep the last good values; lastSuccess says how old they are.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#ifndef UPSTREAM_FAILURE_THRESHOLD
+#define UPSTREAM_FAILURE_THRESHOLD 2
+#endif
+
+#ifndef UPSTREAM_BACKOFF_MIN
+#define UPSTREAM_BACKOFF_MIN 600000UL    // First open period (ms), doubles per failed probe
+#endif
+
+#ifndef UPSTREAM_BACKOFF_MAX
+#define UPSTREAM_BACKOFF_MAX 3600000UL
+#endif
+
+#define UPSTREAM_JITTER_PERCENT 20       // Backoff randomized by +-20%
+
+enum CircuitState : uint8_t {
+  CIRCUIT_CLOSED = 0,
+  CIRCUIT_OPEN,
+  CIRCUIT_HALF_OPEN
+};
+
+enum FetchOutcome : uint8_t {
+  FETCH_OK = 0,
+  FETCH_TRANSPORT_ERROR,   // Connect/TLS failure or timeout (HTTPClient codes < 0)
+  FETCH_SERVER_ERROR,      // 5xx or 429
+  FETCH_CLIENT_ERROR,      // Other 4xx
+  FETCH_BAD_DATA           // 200, but the ingest rejected the body
+};
+
+struct EndpointHealth {
+  uint8_t state;           // CircuitState
+  uint8_t failures;        // Consecutive failed requests
+  int16_t lastCode;        // Last HTTP status or HTTPClient error
+  uint32_t backoff;        // Current open period, ms
+  uint32_t retryAt;        // millis() when an open circuit lets a probe through
+  uint32_t lastSuccess;    // millis() of the last good ingest, 0 = never
+  uint16_t requests;       // Requests sent
+  uint16_t skipped;        // Requests avoided while open
+};
+
+extern EndpointHealth upstreamHealth[];  // Indexed by LogSource
+
+// Function declarations
+FetchOutcome fetchOutcome(int httpCode, bool ingested);
+// True when a request may go out now; moves open to half-open once retryAt passed
+bool endpointAllow(EndpointHealth& health, uint32_t now);
+// Record a request's outcome; random feeds the jitter. Returns true when the circuit state changed.
+bool endpointRecord(EndpointHealth& health, uint32_t now, int httpCode, FetchOutcome outcome, uint32_t random);
+// Last good data older than maxAge (or none yet)
+bool endpointStale(const EndpointHealth& health, uint32_t now, uint32_t maxAge);
+
+#endif
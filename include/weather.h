@@ -2,6 +2,12 @@
 #define WEATHER_H
 
 #include <Arduino.h>
+#include "kp_forecast.h"
+#include "history.h"
+#include "rollup.h"
+#include "solar_wind.h"
+#include "flare.h"
+#include "alerts.h"
 
 struct WeatherData {
   float temperature;
@@ -13,11 +19,19 @@ struct WeatherData {
   float windSpeed;
   int windDirection;
   unsigned long lastUpdate;
-  // Astronomical data (Unix timestamps)
+  // Astronomical data (Unix timestamps, computed on-device by the ephemeris; 0 = no event today)
   unsigned long sunrise;
   unsigned long sunset;
   unsigned long moonrise;
   unsigned long moonset;
+  unsigned long solarNoon;
+  unsigned long moonTransit;
+  unsigned long civilDawn;        // Twilight boundaries (sun 6/12/18 degrees below horizon)
+  unsigned long civilDusk;
+  unsigned long nauticalDawn;
+  unsigned long nauticalDusk;
+  unsigned long astronomicalDawn;
+  unsigned long astronomicalDusk;
   // Moon phase data
   float moonPhase;         // 0-1 (0=new moon, 0.25=first quarter, 0.5=full, 0.75=last quarter)
   String moonPhaseName;    // "New Moon", "First Quarter", etc.
@@ -31,6 +45,11 @@ struct SpaceWeatherData {
   float solarWindSpeed;    // km/s (typical: 300-800)
   float solarWindDensity;  // protons/cm³
   float magneticFieldBz;   // nT (southward = negative, aurora favorable)
+  float magneticFieldBy;   // nT
+  uint16_t bzSouthwardMinutes; // How long the 5-minute mean Bz has stayed southward
+  float couplingKp;        // Kp-equivalent from the Newell coupling function and Dst proxy
+  float dstEstimate;       // nT, ring current proxy (storm when below -50)
+  int auroraScore;         // 0-100 likelihood of aurora reaching our latitude
   String auroraForecast;   // Text forecast
   String geomagStatus;     // Quiet/Unsettled/Active/Storm
   unsigned long lastUpdate;
@@ -60,8 +79,17 @@ struct AuroraForecastData {
   unsigned long lastUpdate;
 };
 
+struct AuroraNowcastData {
+  int probability;         // OVATION aurora probability (%) at our grid cell
+  int polewardMax;         // Highest probability in our longitude column, poleward of us
+  int ovalEdgeLatitude;    // Equatorward edge of the oval at our longitude (0 = no oval)
+  int viewlineLatitude;    // Furthest from the oval it can be seen on the horizon
+  char forecastTime[24];   // "2025-10-24T10:45:00Z"
+  unsigned long lastUpdate;
+};
+
 struct HourlyForecast {
-  String time;             // "2PM", "3PM", etc.
+  char time[6];            // "2PM", "3PM", etc.
   float temperature;       // Temperature
   String icon;             // Weather icon
   String description;      // Short description
@@ -93,11 +121,12 @@ struct NOAASpaceWeatherData {
   float aIndex;            // A-index (daily geomagnetic activity)
   float kpIndex;           // Kp index (3-hour geomagnetic activity)
   String xrayFlux;         // Current X-ray flux level (A, B, C, M, X class)
-  String protonFlux;       // Proton flux level
-  String electronFlux;     // Electron flux level
-  int sunspotNumber;       // Daily sunspot number
-  String alerts[5];        // Space weather alerts/warnings
-  int alertCount;          // Number of active alerts
+  String protonFlux;       // Proton flux level (from active alerts)
+  String electronFlux;     // Electron flux level (from active alerts)
+  int sunspotNumber;       // Derived daily sunspot number (10 * spotted regions + spots)
+  int activeRegions;       // Numbered regions on the latest observation date
+  int sunspotArea;         // Total spot area, millionths of the hemisphere
+  int alertCount;          // Number of active alerts (details in alertStore)
   String summary;          // Current conditions summary
   unsigned long lastUpdate;
 };
@@ -107,16 +136,20 @@ extern SpaceWeatherData currentSpaceWeather;
 extern WeeklyForecast weeklyForecast;
 extern AuroraForecastData auroraToday;
 extern AuroraForecastData auroraTomorrow;
+extern AuroraNowcastData auroraNowcast;
+extern KpForecastSeries kpForecast;
+extern SolarWindSeries solarWind;
+extern FlareEventList flareEvents;
+extern AlertStore alertStore;
 extern HourlyForecastData hourlyForecast;
 extern AirQualityData airQuality;
 extern NOAASpaceWeatherData noaaSpaceWeather;
+extern Rollup rollups[HISTORY_CHANNEL_COUNT];  // Hourly/daily stats per HistoryChannel
 
 // Function declarations
 void parseWeatherData(String jsonString);
 void updateWeatherData();
-void updateSpaceWeatherData();
 void update7DayForecast();
-void updateAuroraForecast();
-void updateNOAASpaceWeatherData();
+void refreshAllData();
 
 #endif
\ No newline at end of file
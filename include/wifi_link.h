@@ -0,0 +1,105 @@
+#ifndef WIFI_LINK_H
+#define WIFI_LINK_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Wi-Fi connection manager.
+// The Wi-Fi event callback (running in the system event task) only records
+// what happened with notify(); loop() calls poll(), which runs the state
+// machine: connect with a per-attempt timeout, exponential backoff between
+// failed attempts, and on a drop a quick retry pinned to the BSSID and
+// channel of the last good association, which skips the channel scan. The
+// radio is reached through WifiDriver so the machine also runs on a host
+// against a simulated driver.
+
+#ifndef WIFI_LINK_ATTEMPT_TIMEOUT
+#define WIFI_LINK_ATTEMPT_TIMEOUT 10000  // Give up on one association attempt (ms)
+#endif
+
+#ifndef WIFI_LINK_BACKOFF_MIN
+#define WIFI_LINK_BACKOFF_MIN 1000       // Wait after the first failed attempt (ms), doubles per failure
+#endif
+
+#ifndef WIFI_LINK_BACKOFF_MAX
+#define WIFI_LINK_BACKOFF_MAX 30000
+#endif
+
+#define WIFI_LINK_SETTLE 100             // Pause before reassociating after a drop (ms)
+
+enum WifiLinkState : uint8_t {
+  WIFI_LINK_IDLE = 0,      // begin() not called yet
+  WIFI_LINK_CONNECTING,    // Attempt in progress
+  WIFI_LINK_CONNECTED,     // Associated and holding an IP address
+  WIFI_LINK_BACKOFF        // Waiting before the next attempt
+};
+
+// Events reported by the driver's callback
+enum WifiLinkEvent : uint8_t {
+  WIFI_EVENT_GOT_IP = 0,
+  WIFI_EVENT_DISCONNECTED
+};
+
+class WifiDriver {
+public:
+  virtual ~WifiDriver() {}
+  // Start associating; bssid/channel pin the access point (nullptr/0 = scan)
+  virtual void connect(const uint8_t* bssid, int32_t channel) = 0;
+  virtual void disconnect() = 0;
+  // Access point of the current association
+  virtual bool accessPoint(uint8_t bssid[6], int32_t& channel) = 0;
+};
+
+class WifiLink;
+typedef void (*WifiLinkHook)(const WifiLink& link);
+
+class WifiLink {
+public:
+  explicit WifiLink(WifiDriver& driver) : driver(driver) {}
+
+  void begin(uint32_t now);
+  void notify(WifiLinkEvent event, uint8_t reason = 0);  // Safe from any task
+  void poll(uint32_t now);                               // loop() only
+  void onUp(WifiLinkHook hook) { upHook = hook; }        // Called from poll()
+  void onDown(WifiLinkHook hook) { downHook = hook; }
+  void forgetAccessPoint() { cached = false; }
+
+  WifiLinkState state() const { return linkState; }
+  bool connected() const { return linkState == WIFI_LINK_CONNECTED; }
+  uint16_t attempts() const { return attemptCount; }     // Attempts of the last (re)connection
+  uint32_t outage() const { return outageMillis; }       // Last drop (or boot) to IP, ms
+  uint8_t reason() const { return lastReason; }          // Last disconnect reason code
+  bool fastReconnect() const { return lastFast; }        // Last connection used the cached AP
+
+private:
+  void attempt(uint32_t now);
+  void failed(uint32_t now);
+  void gotIp(uint32_t now);
+  void lost(uint32_t now);
+
+  WifiDriver& driver;
+  WifiLinkHook upHook = nullptr;
+  WifiLinkHook downHook = nullptr;
+  // Written by notify(): bit per WifiLinkEvent, plus which one came last
+  std::atomic<uint32_t> pending{0};
+  std::atomic<uint8_t> lastEvent{0};
+  std::atomic<uint8_t> pendingReason{0};
+
+  WifiLinkState linkState = WIFI_LINK_IDLE;
+  uint32_t attemptStart = 0;
+  uint32_t retryAt = 0;
+  uint32_t downSince = 0;
+  uint32_t backoff = 0;
+  uint32_t outageMillis = 0;
+  uint16_t attemptCount = 0;
+  uint8_t lastReason = 0;
+  bool attemptFast = false;
+  bool lastFast = false;
+  bool cached = false;
+  uint8_t bssid[6] = {0};
+  int32_t channel = 0;
+};
+
+extern WifiLink wifiLink;
+
+#endif
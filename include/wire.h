@@ -0,0 +1,144 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Binary container for station data, read in place.
+// Each section is an array of fixed-width records whose layout is given by
+// a WireSchema (field name, type, offset). Strings are u16 offsets into one
+// deduplicated, NUL-terminated string table, so a reader gets a const char*
+// straight into the buffer. wireOpen() checks the CRC and every offset once,
+// after which the accessors below cannot read out of bounds and nothing is
+// copied or allocated.
+//
+// Layout, little-endian, records 4-byte aligned:
+//   header     "WXB", version u8, length u32 (whole buffer), crc u32 (CRC-32
+//              of everything after it), generated u32 (UTC epoch),
+//              sectionCount u16, reserved u16, strings u32 (table offset)
+//   directory  per section: kind u8, reserved u8, recordSize u16, count u16,
+//              reserved u16, offset u32
+//   records    count * recordSize bytes per section
+//   strings    "\0" first (offset 0 = empty string), runs to the end
+// A record may be longer than the reader's schema (fields appended by a newer
+// writer are ignored); a shorter one makes the buffer invalid. Sections of
+// kinds the reader has no schema for are skipped.
+// Pure C++ with no Arduino dependencies so it also builds on a host.
+
+#define WIRE_MAGIC "WXB"
+#define WIRE_VERSION 2
+#define WIRE_HEADER_SIZE 24
+#define WIRE_DIRECTORY_ENTRY_SIZE 12
+#define WIRE_STRINGS_MAX 65535          // String offsets are u16
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "wire records are read in place and assume a little-endian CPU"
+#endif
+
+enum WireType : uint8_t {
+  WIRE_U8 = 0,
+  WIRE_I8,
+  WIRE_U16,
+  WIRE_I16,
+  WIRE_U32,
+  WIRE_I32,
+  WIRE_F32,
+  WIRE_STRING              // u16 offset into the string table
+};
+
+struct WireField {
+  const char* name;
+  uint8_t type;            // WireType
+  uint16_t offset;
+};
+
+struct WireSchema {
+  uint8_t kind;
+  const char* name;
+  uint16_t recordSize;
+  const WireField* fields;
+  uint8_t fieldCount;
+};
+
+struct WireSection {
+  const uint8_t* records;  // nullptr when the section is absent
+  uint16_t count;
+  uint16_t recordSize;
+};
+
+struct WireView {
+  const uint8_t* data;
+  uint32_t length;
+  uint32_t generated;
+  uint16_t sectionCount;
+  const char* strings;
+  uint32_t stringsLength;
+};
+
+// Appends sections and strings into caller buffers; strings are kept apart
+// until finish() places them after the last section
+class WireWriter {
+public:
+  WireWriter(uint8_t* out, size_t size, char* strings, size_t stringsSize, uint8_t maxSections);
+
+  // Zeroed room for count records, nullptr when out of space
+  uint8_t* section(uint8_t kind, uint16_t recordSize, uint16_t count);
+  uint16_t string(const char* text);   // Offset of text in the table, stored once
+  size_t finish(uint32_t generated);   // Buffer length, 0 when anything did not fit
+
+private:
+  uint8_t* out;
+  size_t size;
+  char* strings;
+  size_t stringsSize;
+  size_t stringsUsed;
+  uint8_t maxSections;
+  uint16_t sections;
+  size_t used;             // Directory space for maxSections is reserved up front
+  bool overflow;
+};
+
+// Reading a field of a validated record
+inline uint8_t wireU8(const uint8_t* record, uint16_t offset) { return record[offset]; }
+inline int8_t wireI8(const uint8_t* record, uint16_t offset) { return (int8_t)record[offset]; }
+inline uint16_t wireU16(const uint8_t* record, uint16_t offset) {
+  uint16_t value;
+  memcpy(&value, record + offset, sizeof(value));
+  return value;
+}
+inline int16_t wireI16(const uint8_t* record, uint16_t offset) { return (int16_t)wireU16(record, offset); }
+inline uint32_t wireU32(const uint8_t* record, uint16_t offset) {
+  uint32_t value;
+  memcpy(&value, record + offset, sizeof(value));
+  return value;
+}
+inline int32_t wireI32(const uint8_t* record, uint16_t offset) { return (int32_t)wireU32(record, offset); }
+inline float wireF32(const uint8_t* record, uint16_t offset) {
+  float value;
+  memcpy(&value, record + offset, sizeof(value));
+  return value;
+}
+inline const char* wireString(const WireView& view, const uint8_t* record, uint16_t offset) {
+  return view.strings + wireU16(record, offset);
+}
+inline const uint8_t* wireRecord(const WireSection& section, uint16_t index) {
+  return section.records + (size_t)index * section.recordSize;
+}
+
+// Writing a field of a record from WireWriter::section()
+inline void wirePut16(uint8_t* record, uint16_t offset, uint16_t value) { memcpy(record + offset, &value, sizeof(value)); }
+inline void wirePut32(uint8_t* record, uint16_t offset, uint32_t value) { memcpy(record + offset, &value, sizeof(value)); }
+inline void wirePutF32(uint8_t* record, uint16_t offset, float value) { memcpy(record + offset, &value, sizeof(value)); }
+
+// Function declarations
+uint32_t wireCrc32(const uint8_t* data, size_t length);
+// Checks header, CRC, directory and, for kinds with a schema, every record
+bool wireOpen(WireView& view, const uint8_t* data, size_t length, const WireSchema* schemas, uint8_t schemaCount);
+// Section of that kind, records == nullptr when absent
+WireSection wireSection(const WireView& view, uint8_t kind);
+// Render every section with a schema as one JSON object (NaN as null);
+// returns the length, 0 when it did not fit
+size_t wireToJson(const WireView& view, const WireSchema* schemas, uint8_t schemaCount, char* out, size_t size);
+
+#endif
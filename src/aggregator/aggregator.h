@@ -0,0 +1,73 @@
+#ifndef AGGREGATOR_H
+#define AGGREGATOR_H
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "weather.h"
+#include "eventlog.h"
+
+// Companion aggregator for a fleet of stations on one network. It runs the
+// firmware's own ingest code on Linux, fetches every SWPC product once per
+// refresh whatever the number of stations, OpenWeather once per location,
+// and serves each location's data as one binary bundle (bundle.h):
+//   GET|HEAD /bundle/<id>        with an ETag; If-None-Match answers 304
+//   GET|HEAD /bundle/<id>.json   the same data rendered as JSON, for tools
+// Stations point AGGREGATOR_URL at their location's bundle.
+
+#define AGGREGATOR_PORT 8080
+#define AGGREGATOR_INTERVAL 600        // Seconds between upstream refreshes
+#define AGGREGATOR_MAX_CLIENTS 4096    // Open station connections
+#define AGGREGATOR_REQUEST_SIZE 1024   // Longest request head, larger ones get 431
+#define AGGREGATOR_IDLE_TIMEOUT 30000  // ms without progress before a connection is dropped
+#define AGGREGATOR_JSON_SIZE 131072    // Largest JSON rendering of a bundle
+
+// One location and the globals that depend on it, swapped in while its
+// OpenWeather data are ingested (OVATION passes write nowcast directly)
+struct Site {
+  std::string id;                      // URL path component
+  std::string name;                    // Shown as the city name
+  float latitude;
+  float longitude;
+  std::string timeZone;                // POSIX TZ rule for the hour and day labels
+  WeatherData weather;
+  HourlyForecastData hourly;
+  WeeklyForecast weekly;
+  AirQualityData air;
+  AuroraNowcastData nowcast;
+  uint32_t updated[SRC_COUNT];         // UTC epoch of the last good ingest per source
+};
+
+struct PublishedBundle {
+  std::vector<uint8_t> data;
+  char etag[11];                       // Quoted FNV-1a of data
+  const char* contentType;
+};
+
+// Upstream requests over libcurl; one handle, so connections are kept alive
+class UpstreamFetcher {
+public:
+  UpstreamFetcher();
+  ~UpstreamFetcher();
+  // Whole (inflated) body into out. HTTP status, 200 for a readable file://
+  // URL, negative on transport errors.
+  int get(const std::string& url, std::string& out);
+
+  uint32_t requests = 0;
+  uint64_t bytes = 0;                  // As received, before inflating
+
+private:
+  void* handle;
+};
+
+// Function declarations
+bool serverOpen(uint16_t port);
+// Serve until stop is set; polls at least every waitMillis
+void serverRun(const std::atomic<bool>& stop, uint32_t waitMillis);
+// Make a site's bundle the one served, replacing the previous one atomically
+void serverPublish(const std::string& id, std::shared_ptr<const PublishedBundle> bundle);
+void serverAddSite(const std::string& id);  // Known id, 503 until its first bundle
+
+#endif
@@ -0,0 +1,274 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <map>
+#include <mutex>
+#include "aggregator.h"
+
+struct StationClient {
+  int fd;
+  unsigned long lastActive;
+  uint16_t received;
+  char request[AGGREGATOR_REQUEST_SIZE];
+  // Response in flight: our head, then the pinned bundle's bytes
+  std::string head;
+  std::shared_ptr<const PublishedBundle> bundle;
+  size_t sent;
+  bool sending;
+  bool closeAfter;
+};
+
+static int listener = -1;
+static std::vector<StationClient*> clients;
+static std::mutex bundlesLock;  // Published from the refresh thread
+static std::map<std::string, std::shared_ptr<const PublishedBundle>> bundles;
+
+static bool setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool serverOpen(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return false;
+  int yes = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0 ||
+      !setNonBlocking(fd)) {
+    close(fd);
+    return false;
+  }
+  listener = fd;
+  return true;
+}
+
+void serverAddSite(const std::string& id) {
+  std::lock_guard<std::mutex> guard(bundlesLock);
+  bundles.emplace(id, nullptr);
+}
+
+void serverPublish(const std::string& id, std::shared_ptr<const PublishedBundle> bundle) {
+  std::lock_guard<std::mutex> guard(bundlesLock);
+  bundles[id] = std::move(bundle);
+}
+
+// bundle's bytes follow the head unless headOnly; a 304 carries only its validator
+static void respond(StationClient& client, const char* status, const char* headers,
+                    std::shared_ptr<const PublishedBundle> bundle, bool keepAlive, bool headOnly = false) {
+  char line[160];
+  int length = snprintf(line, sizeof(line), "HTTP/1.1 %s\r\nConnection: %s\r\n",
+                        status, keepAlive ? "keep-alive" : "close");
+  if (strncmp(status, "304", 3) != 0) {
+    snprintf(line + length, sizeof(line) - length, "Content-Length: %zu\r\n", bundle ? bundle->data.size() : 0);
+  }
+  client.head = line;
+  client.head += headers;
+  client.head += "\r\n";
+  client.bundle = headOnly ? nullptr : std::move(bundle);
+  client.sent = 0;
+  client.sending = true;
+  client.closeAfter = !keepAlive;
+}
+
+static bool headerHas(const char* value, const char* token) {
+  if (value == nullptr) return false;
+  size_t length = strlen(token);
+  for (const char* p = value; *p; p++) {
+    if (strncasecmp(p, token, length) == 0) return true;
+  }
+  return false;
+}
+
+// Handles the complete request head in client.request[0, headLength)
+static void handleRequest(StationClient& client, uint16_t headLength) {
+  char* head = client.request;
+  head[headLength - 2] = '\0';
+
+  char* lineEnd = strstr(head, "\r\n");
+  char* target = strchr(head, ' ');
+  char* version = target != nullptr ? strchr(target + 1, ' ') : nullptr;
+  if (lineEnd == nullptr || version == nullptr || version > lineEnd || strncmp(version + 1, "HTTP/1.", 7) != 0) {
+    respond(client, "400 Bad Request", "", nullptr, false);
+    return;
+  }
+  *lineEnd = '\0';
+  *target++ = '\0';
+  *version++ = '\0';
+
+  const char* connection = nullptr;
+  const char* ifNoneMatch = nullptr;
+  bool hasBody = false;
+  for (char* line = lineEnd + 2; *line != '\0';) {
+    char* end = strstr(line, "\r\n");
+    if (end == nullptr) break;
+    *end = '\0';
+    char* colon = strchr(line, ':');
+    if (colon != nullptr) {
+      *colon = '\0';
+      char* value = colon + 1;
+      while (*value == ' ' || *value == '\t') value++;
+      if (strcasecmp(line, "Connection") == 0) connection = value;
+      else if (strcasecmp(line, "If-None-Match") == 0) ifNoneMatch = value;
+      else if (strcasecmp(line, "Content-Length") == 0 || strcasecmp(line, "Transfer-Encoding") == 0) {
+        hasBody = strcmp(value, "0") != 0;
+      }
+    }
+    line = end + 2;
+  }
+  bool keepAlive = strcmp(version, "HTTP/1.0") == 0 ? headerHas(connection, "keep-alive")
+                                                    : !headerHas(connection, "close");
+  if (hasBody) keepAlive = false;  // Request bodies are never read
+
+  bool headOnly = strcmp(head, "HEAD") == 0;
+  if (!headOnly && strcmp(head, "GET") != 0) {
+    respond(client, "405 Method Not Allowed", "Allow: GET, HEAD\r\n", nullptr, keepAlive);
+    return;
+  }
+  if (strncmp(target, "/bundle/", 8) != 0) {
+    respond(client, "404 Not Found", "", nullptr, keepAlive);
+    return;
+  }
+
+  std::shared_ptr<const PublishedBundle> bundle;
+  bool known;
+  {
+    std::lock_guard<std::mutex> guard(bundlesLock);
+    auto found = bundles.find(target + 8);
+    known = found != bundles.end();
+    if (known) bundle = found->second;
+  }
+  if (!known) {
+    respond(client, "404 Not Found", "", nullptr, keepAlive);
+    return;
+  }
+  if (!bundle) {
+    respond(client, "503 Service Unavailable", "Retry-After: 30\r\n", nullptr, keepAlive);
+    return;
+  }
+
+  char headers[96];
+  snprintf(headers, sizeof(headers), "Content-Type: %s\r\nETag: %s\r\n", bundle->contentType, bundle->etag);
+  if (ifNoneMatch != nullptr && (strcmp(ifNoneMatch, "*") == 0 || strstr(ifNoneMatch, bundle->etag) != nullptr)) {
+    snprintf(headers, sizeof(headers), "ETag: %s\r\n", bundle->etag);
+    respond(client, "304 Not Modified", headers, nullptr, keepAlive);
+    return;
+  }
+  respond(client, "200 OK", headers, std::move(bundle), keepAlive, headOnly);
+}
+
+// Sends what the socket takes; false when the client is gone or the
+// response asked for the connection to be closed
+static bool sendPending(StationClient& client, unsigned long now) {
+  size_t total = client.head.size() + (client.bundle ? client.bundle->data.size() : 0);
+  while (client.sent < total) {
+    bool inHead = client.sent < client.head.size();
+    const char* data = inHead ? client.head.data() + client.sent
+                              : (const char*)client.bundle->data.data() + (client.sent - client.head.size());
+    size_t count = inHead ? client.head.size() - client.sent : total - client.sent;
+    ssize_t sent = send(client.fd, data, count, MSG_NOSIGNAL | (inHead && client.bundle ? MSG_MORE : 0));
+    if (sent < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    client.lastActive = now;
+    client.sent += sent;
+  }
+  client.sending = false;
+  client.bundle.reset();  // An older bundle is freed once its last reader is done
+  return !client.closeAfter;
+}
+
+// Answers every complete request in the buffer, in order, until one has to
+// wait for the socket; false when the client is gone
+static bool serveBuffered(StationClient& client, unsigned long now) {
+  while (!client.sending) {
+    client.request[client.received] = '\0';
+    char* end = strstr(client.request, "\r\n\r\n");
+    if (end == nullptr) {
+      if (client.received < sizeof(client.request) - 1) return true;
+      respond(client, "431 Request Header Fields Too Large", "", nullptr, false);
+      client.received = 0;
+      return sendPending(client, now);
+    }
+    uint16_t headLength = end + 4 - client.request;
+    handleRequest(client, headLength);
+    memmove(client.request, client.request + headLength, client.received - headLength);
+    client.received -= headLength;
+    if (!sendPending(client, now)) return false;
+  }
+  return true;
+}
+
+static void acceptClients(unsigned long now) {
+  while (clients.size() < AGGREGATOR_MAX_CLIENTS) {
+    int fd = accept(listener, nullptr, nullptr);
+    if (fd < 0) return;
+    int yes = 1;
+    if (!setNonBlocking(fd)) {
+      close(fd);
+      continue;
+    }
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    StationClient* client = new StationClient();
+    client->fd = fd;
+    client->lastActive = now;
+    client->received = 0;
+    client->sending = false;
+    clients.push_back(client);
+  }
+}
+
+void serverRun(const std::atomic<bool>& stop, uint32_t waitMillis) {
+  std::vector<struct pollfd> polled;
+  while (!stop) {
+    polled.clear();
+    for (StationClient* client : clients) {
+      // A client mid-response is not read, which also throttles pipelining
+      polled.push_back({client->fd, (short)(client->sending ? POLLOUT : POLLIN), 0});
+    }
+    // With every slot busy new connections wait in the listen backlog
+    polled.push_back({clients.size() < AGGREGATOR_MAX_CLIENTS ? listener : -1, POLLIN, 0});
+    if (poll(polled.data(), polled.size(), waitMillis) < 0 && errno != EINTR) return;
+
+    unsigned long now = millis();
+    size_t kept = 0;
+    for (size_t i = 0; i < clients.size(); i++) {
+      StationClient& client = *clients[i];
+      short events = polled[i].revents;
+      bool alive = true;
+      if (events & POLLOUT) {
+        alive = sendPending(client, now);
+        if (alive && !client.sending) alive = serveBuffered(client, now);
+      } else if (events & (POLLIN | POLLHUP | POLLERR)) {
+        ssize_t count = recv(client.fd, client.request + client.received,
+                             sizeof(client.request) - 1 - client.received, 0);
+        if (count > 0) {
+          client.received += count;
+          client.lastActive = now;
+          alive = serveBuffered(client, now);
+        } else {
+          alive = count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+        }
+      } else if (now - client.lastActive > AGGREGATOR_IDLE_TIMEOUT) {
+        alive = false;
+      }
+      if (alive) {
+        clients[kept++] = &client;
+      } else {
+        close(client.fd);
+        delete &client;
+      }
+    }
+    clients.resize(kept);
+
+    if (polled.back().revents & POLLIN) acceptClients(now);
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef AGGREGATOR_ARDUINO_H
+#define AGGREGATOR_ARDUINO_H
+
+// Just enough of the Arduino core for the shared ingest code to build on
+// Linux: String over std::string, Print, the millis()/micros() clocks.
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+class String {
+public:
+  String(const char* text = "") : text(text ? text : "") {}
+  String(const std::string& text) : text(text) {}
+
+  String& operator=(const char* value) {
+    text = value ? value : "";
+    return *this;
+  }
+  String& operator+=(const String& other) {
+    text += other.text;
+    return *this;
+  }
+  String operator+(const String& other) const { return String(text + other.text); }
+  String operator+(const char* other) const { return String(text + other); }
+  bool operator==(const String& other) const { return text == other.text; }
+  bool operator==(const char* other) const { return text == other; }
+  bool operator!=(const char* other) const { return text != other; }
+
+  const char* c_str() const { return text.c_str(); }
+  size_t length() const { return text.size(); }
+
+private:
+  std::string text;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(const uint8_t* data, size_t size) = 0;
+
+  size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+  size_t println(const char* text) { return print(text) + print("\n"); }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    return length > 0 ? print(line) : 0;
+  }
+};
+
+unsigned long millis();
+unsigned long micros();
+
+#if !defined(__GLIBC__) || __GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+inline size_t strlcpy(char* dest, const char* src, size_t size) {
+  size_t length = strlen(src);
+  if (size > 0) {
+    size_t count = length < size - 1 ? length : size - 1;
+    memcpy(dest, src, count);
+    dest[count] = '\0';
+  }
+  return length;
+}
+#endif
+
+#endif
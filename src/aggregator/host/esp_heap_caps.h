@@ -0,0 +1,38 @@
+#ifndef AGGREGATOR_ESP_HEAP_CAPS_H
+#define AGGREGATOR_ESP_HEAP_CAPS_H
+
+// The ESP-IDF heap queries fetch_pool.cpp sizes its helpers by, answered
+// from a simulated heap: a host test moves hostHeapFree as its fake TLS
+// sessions open and close (and lowers hostHeapMinimum to match).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+
+inline std::atomic<int64_t> hostHeapFree{200000};
+inline std::atomic<int64_t> hostHeapMinimum{200000};
+
+// Take or give back heap, keeping the low-water mark
+inline void hostHeapUse(int64_t bytes) {
+  int64_t free = hostHeapFree.fetch_sub(bytes) - bytes;
+  int64_t minimum = hostHeapMinimum.load();
+  while (free < minimum && !hostHeapMinimum.compare_exchange_weak(minimum, free)) {
+  }
+}
+
+inline size_t heap_caps_get_free_size(uint32_t) {
+  int64_t free = hostHeapFree.load();
+  return free > 0 ? (size_t)free : 0;
+}
+// Fragmented like a device after a few hours
+inline size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  return heap_caps_get_free_size(caps) * 7 / 10;
+}
+inline size_t heap_caps_get_minimum_free_size(uint32_t) {
+  int64_t minimum = hostHeapMinimum.load();
+  return minimum > 0 ? (size_t)minimum : 0;
+}
+
+#endif
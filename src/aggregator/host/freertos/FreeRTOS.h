@@ -0,0 +1,18 @@
+#ifndef AGGREGATOR_FREERTOS_H
+#define AGGREGATOR_FREERTOS_H
+
+// Just enough FreeRTOS for fetch_pool.cpp to build on Linux: tasks are
+// detached std::threads and semaphores a mutex and condition variable.
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdPASS 1
+#define pdTRUE 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef AGGREGATOR_FREERTOS_SEMPHR_H
+#define AGGREGATOR_FREERTOS_SEMPHR_H
+
+#include <condition_variable>
+#include <mutex>
+#include "FreeRTOS.h"
+
+struct HostSemaphore {
+  std::mutex mutex;
+  std::condition_variable changed;
+  unsigned count;
+  unsigned limit;
+};
+
+typedef HostSemaphore* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateCounting(unsigned limit, unsigned initial) {
+  return new HostSemaphore{{}, {}, initial, limit};
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  std::lock_guard<std::mutex> lock(semaphore->mutex);
+  if (semaphore->count >= semaphore->limit) return 0;
+  semaphore->count++;
+  semaphore->changed.notify_one();
+  return pdTRUE;
+}
+
+// Waits forever whatever the timeout; fetch_pool.cpp only uses portMAX_DELAY
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t) {
+  std::unique_lock<std::mutex> lock(semaphore->mutex);
+  semaphore->changed.wait(lock, [semaphore] { return semaphore->count > 0; });
+  semaphore->count--;
+  return pdTRUE;
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef AGGREGATOR_FREERTOS_TASK_H
+#define AGGREGATOR_FREERTOS_TASK_H
+
+#include <thread>
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// Thrown by vTaskDelete() to unwind out of the task function
+struct HostTaskExit {};
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char*, uint32_t, void* parameter,
+                                          UBaseType_t, TaskHandle_t*, BaseType_t) {
+  std::thread([function, parameter] {
+    try {
+      function(parameter);
+    } catch (HostTaskExit&) {
+    }
+  }).detach();
+  return pdPASS;
+}
+
+// Only a task deleting itself (nullptr) is supported
+inline void vTaskDelete(TaskHandle_t) {
+  throw HostTaskExit();
+}
+
+#endif
@@ -0,0 +1,29 @@
+#include <chrono>
+#include "weather.h"
+
+// The globals the ingests and bundleEncode() work on, for every Linux build
+// of the shared code (the aggregator, the host tests, fuzz targets and
+// benchmarks). The aggregator swaps the location-dependent ones per site.
+WeatherData currentWeather;
+SpaceWeatherData currentSpaceWeather;
+WeeklyForecast weeklyForecast;
+AuroraForecastData auroraToday;        // Derived on the station; encoded empty
+AuroraForecastData auroraTomorrow;
+AuroraNowcastData auroraNowcast;
+KpForecastSeries kpForecast;
+SolarWindSeries solarWind;
+FlareEventList flareEvents;
+AlertStore alertStore;
+HourlyForecastData hourlyForecast;
+AirQualityData airQuality;
+NOAASpaceWeatherData noaaSpaceWeather;
+
+static const auto processStart = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - processStart).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - processStart).count();
+}
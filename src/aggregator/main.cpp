@@ -0,0 +1,285 @@
+#include <getopt.h>
+#include <signal.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "aggregator.h"
+#include "ingest.h"
+#include "timezone.h"
+#include "bundle.h"
+
+class StdoutPrint : public Print {
+public:
+  size_t write(const uint8_t* data, size_t size) override { return fwrite(data, 1, size, stdout); }
+};
+
+// The firmware's upstreams, relative to a base so fixtures can stand in (-s, -o)
+struct SwpcProduct {
+  LogSource source;
+  const char* path;
+  IngestFunction ingest;   // Small bodies, parsed whole
+  StreamIngest* stream;    // Large ones, through the streaming parser
+};
+
+static const SwpcProduct swpcProducts[] = {
+  {SRC_KP_INDEX, "/products/noaa-planetary-k-index.json", ingestKpIndex, nullptr},
+  {SRC_SOLAR_WIND_MAG, "/products/solar-wind/mag-1-day.json", nullptr, &solarWindMagIngest},
+  {SRC_SOLAR_WIND_PLASMA, "/products/solar-wind/plasma-1-day.json", nullptr, &solarWindPlasmaIngest},
+  {SRC_SOLAR_FLUX, "/json/f107_cm_flux.json", ingestSolarFlux, nullptr},
+  {SRC_GEOMAG_INDICES, "/products/daily-geomagnetic-indices.json", ingestGeomagIndices, nullptr},
+  {SRC_XRAY, "/json/goes/primary/xrays-1-day.json", nullptr, &xrayIngest},
+  {SRC_SOLAR_REGIONS, "/json/solar_regions.json", nullptr, &solarRegionIngest},
+  {SRC_ALERTS, "/products/alerts.json", nullptr, &alertIngest},
+  {SRC_KP_FORECAST, "/products/noaa-planetary-k-index-forecast.json", nullptr, &kpForecastIngest},
+};
+static const char* const ovationPath = "/json/ovation_aurora_latest.json";
+
+struct Options {
+  uint16_t port = AGGREGATOR_PORT;
+  uint32_t interval = AGGREGATOR_INTERVAL;
+  std::string swpcBase = "https://services.swpc.noaa.gov";
+  std::string openWeatherBase = "https://api.openweathermap.org";
+  std::string apiKey;
+  bool once = false;       // One refresh, then exit (fixture runs)
+};
+
+// Set by the signal handler, read by the refresher and the server loop;
+// lock-free, so it is safe to store from a handler
+static std::atomic<bool> stopping(false);
+
+static void onSignal(int) {
+  stopping = true;
+}
+
+// One site per line: id latitude longitude TZ-rule name...
+static bool loadSites(const char* path, std::vector<Site>& sites) {
+  std::ifstream file(path);
+  if (!file) return false;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    Site site = Site();
+    if (!(fields >> site.id >> site.latitude >> site.longitude >> site.timeZone)) {
+      fprintf(stderr, "%s: bad site line: %s\n", path, line.c_str());
+      return false;
+    }
+    std::getline(fields >> std::ws, site.name);
+    if (site.name.empty()) site.name = site.id;
+    sites.push_back(site);
+  }
+  return !sites.empty();
+}
+
+static bool streamIngest(StreamIngest& ingest, const std::string& body) {
+  char token[JSON_TOKEN_SIZE];
+  size_t tokenSize = sizeof(token);
+  char* buffer = ingest.tokenBuffer(tokenSize);
+  JsonStreamParser parser(ingest, buffer ? buffer : token, tokenSize);
+  ingest.begin();
+  bool parsed = parser.feed(body.data(), body.size()) && parser.finish();
+  return ingest.finish(parsed);
+}
+
+static void loadSite(const Site& site) {
+  currentWeather = site.weather;
+  hourlyForecast = site.hourly;
+  weeklyForecast = site.weekly;
+  airQuality = site.air;
+  auroraNowcast = site.nowcast;
+}
+
+static void saveSite(Site& site) {
+  site.weather = currentWeather;
+  site.hourly = hourlyForecast;
+  site.weekly = weeklyForecast;
+  site.air = airQuality;
+  site.nowcast = auroraNowcast;
+}
+
+static uint32_t fnv1a(const uint8_t* data, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) hash = (hash ^ data[i]) * 16777619u;
+  return hash;
+}
+
+// The OVATION grid is fetched once and scanned once per LOCATION_MAX sites,
+// each pass collecting every one of their columns into the sites' nowcasts
+static void ingestOvation(std::vector<Site>& sites, const std::string& ovation, uint32_t now) {
+  for (size_t first = 0; first < sites.size(); first += LOCATION_MAX) {
+    size_t last = std::min(sites.size(), first + LOCATION_MAX);
+    ovationIngest.clearLocations();
+    for (size_t i = first; i < last; i++) {
+      ovationIngest.addLocation(sites[i].latitude, sites[i].longitude, sites[i].nowcast);
+    }
+    if (!streamIngest(ovationIngest, ovation)) continue;
+    for (size_t i = first; i < last; i++) sites[i].updated[SRC_OVATION] = now;
+  }
+}
+
+// OpenWeather for one site, then its bundle
+static void refreshSite(Site& site, UpstreamFetcher& fetcher, const Options& options,
+                        const uint32_t shared[SRC_COUNT], uint32_t now) {
+  loadSite(site);
+  timeZoneInit(site.timeZone.c_str());  // Hour and day labels are local to the site
+  std::string body;
+  char query[96];
+  snprintf(query, sizeof(query), "?lat=%.4f&lon=%.4f&appid=", site.latitude, site.longitude);
+
+  if (!options.apiKey.empty()) {
+    std::string url = options.openWeatherBase + "/data/3.0/onecall" + query + options.apiKey +
+                      "&units=imperial&exclude=minutely,alerts";
+    if (fetcher.get(url, body) == 200 && ingestOneCall(body.data(), body.size())) {
+      currentWeather.cityName = site.name.c_str();
+      site.updated[SRC_ONECALL] = now;
+    }
+    url = options.openWeatherBase + "/data/2.5/air_pollution" + query + options.apiKey;
+    if (fetcher.get(url, body) == 200 && ingestAirQuality(body.data(), body.size())) {
+      site.updated[SRC_AIR_QUALITY] = now;
+    }
+  }
+
+  saveSite(site);
+
+  uint32_t updated[SRC_COUNT];
+  for (uint8_t source = 0; source < SRC_COUNT; source++) {
+    bool local = source == SRC_ONECALL || source == SRC_AIR_QUALITY || source == SRC_OVATION;
+    updated[source] = local ? site.updated[source] : shared[source];
+  }
+  std::shared_ptr<PublishedBundle> bundle = std::make_shared<PublishedBundle>();
+  bundle->data.resize(BUNDLE_MAX_SIZE);
+  size_t length = bundleEncode(bundle->data.data(), bundle->data.size(), now, updated);
+  if (length == 0) {
+    fprintf(stderr, "site %s: bundle does not fit in %d bytes\n", site.id.c_str(), BUNDLE_MAX_SIZE);
+    return;
+  }
+  bundle->data.resize(length);
+  bundle->data.shrink_to_fit();
+  snprintf(bundle->etag, sizeof(bundle->etag), "\"%08x\"", fnv1a(bundle->data.data(), length));
+  bundle->contentType = "application/octet-stream";
+
+  // The JSON rendering comes from the encoded bundle, so both always agree
+  std::shared_ptr<PublishedBundle> json = std::make_shared<PublishedBundle>();
+  WireView view;
+  json->data.resize(AGGREGATOR_JSON_SIZE);
+  length = wireOpen(view, bundle->data.data(), bundle->data.size(), bundleSchemas, bundleSchemaCount)
+             ? wireToJson(view, bundleSchemas, bundleSchemaCount, (char*)json->data.data(), json->data.size())
+             : 0;
+  json->data.resize(length);
+  json->data.shrink_to_fit();
+  snprintf(json->etag, sizeof(json->etag), "\"%08x\"", fnv1a(json->data.data(), length));
+  json->contentType = "application/json";
+
+  serverPublish(site.id, bundle);
+  if (length > 0) serverPublish(site.id + ".json", json);
+}
+
+static void refreshAll(std::vector<Site>& sites, UpstreamFetcher& fetcher, const Options& options,
+                       uint32_t shared[SRC_COUNT]) {
+  unsigned long start = millis();
+  uint32_t requests = fetcher.requests;
+  uint64_t bytes = fetcher.bytes;
+  uint32_t now = (uint32_t)time(nullptr);
+  std::string body;
+
+  for (const SwpcProduct& product : swpcProducts) {
+    if (fetcher.get(options.swpcBase + product.path, body) != 200) continue;
+    bool ingested = product.stream ? streamIngest(*product.stream, body) : product.ingest(body.data(), body.size());
+    if (ingested) shared[product.source] = now;
+  }
+  std::string ovation;
+  if (fetcher.get(options.swpcBase + ovationPath, ovation) != 200) ovation.clear();
+
+  if (!ovation.empty()) ingestOvation(sites, ovation, now);
+  for (Site& site : sites) refreshSite(site, fetcher, options, shared, now);
+
+  printf("refresh: %zu sites, %u upstream requests, %llu KB, %lu ms\n", sites.size(), fetcher.requests - requests,
+         (unsigned long long)((fetcher.bytes - bytes) / 1024), millis() - start);
+  StdoutPrint out;
+  eventLogDrain(out);
+  fflush(stdout);
+}
+
+static void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s [-p port] [-i seconds] [-s swpc-base] [-o openweather-base] [-1] sites.conf\n"
+          "  OPENWEATHER_API_KEY in the environment enables weather and air quality\n",
+          program);
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  int option;
+  while ((option = getopt(argc, argv, "p:i:s:o:1")) != -1) {
+    switch (option) {
+      case 'p': options.port = (uint16_t)atoi(optarg); break;
+      case 'i': options.interval = (uint32_t)atoi(optarg); break;
+      case 's': options.swpcBase = optarg; break;
+      case 'o': options.openWeatherBase = optarg; break;
+      case '1': options.once = true; break;
+      default: usage(argv[0]); return 2;
+    }
+  }
+  if (optind != argc - 1) {
+    usage(argv[0]);
+    return 2;
+  }
+  const char* key = getenv("OPENWEATHER_API_KEY");
+  if (key != nullptr) options.apiKey = key;
+
+  std::vector<Site> sites;
+  if (!loadSites(argv[optind], sites)) {
+    fprintf(stderr, "%s: no sites\n", argv[optind]);
+    return 1;
+  }
+  for (const Site& site : sites) {
+    serverAddSite(site.id);
+    serverAddSite(site.id + ".json");
+  }
+
+  kpSeriesClear(kpForecast);
+  solarWindClear(solarWind);
+  alertStoreClear(alertStore);
+  UpstreamFetcher fetcher;
+  uint32_t shared[SRC_COUNT] = {0};
+  if (options.once) {
+    refreshAll(sites, fetcher, options, shared);
+    return 0;
+  }
+
+  if (!serverOpen(options.port)) {
+    perror("listen");
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  printf("serving %zu sites on port %u\n", sites.size(), options.port);
+
+  // Upstream refreshes on their own thread; the server only takes the
+  // published bundles, so a slow upstream never holds a station up
+  std::mutex wakeLock;
+  std::condition_variable wake;
+  std::thread refresher([&]() {
+    std::unique_lock<std::mutex> lock(wakeLock);
+    while (!stopping) {
+      lock.unlock();
+      refreshAll(sites, fetcher, options, shared);
+      lock.lock();
+      wake.wait_for(lock, std::chrono::seconds(options.interval), []() { return stopping.load(); });
+    }
+  });
+  serverRun(stopping, 1000);
+  {
+    std::lock_guard<std::mutex> guard(wakeLock);
+    stopping = true;
+  }
+  wake.notify_all();
+  refresher.join();
+  return 0;
+}
@@ -0,0 +1,43 @@
+#include <curl/curl.h>
+#include "aggregator.h"
+
+static size_t appendBody(char* data, size_t size, size_t count, void* user) {
+  static_cast<std::string*>(user)->append(data, size * count);
+  return size * count;
+}
+
+UpstreamFetcher::UpstreamFetcher() {
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+  handle = curl_easy_init();
+}
+
+UpstreamFetcher::~UpstreamFetcher() {
+  curl_easy_cleanup(static_cast<CURL*>(handle));
+  curl_global_cleanup();
+}
+
+int UpstreamFetcher::get(const std::string& url, std::string& out) {
+  CURL* curl = static_cast<CURL*>(handle);
+  if (curl == nullptr) return -1;
+  out.clear();
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendBody);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &out);
+  curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");  // Everything curl can inflate
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 30000L);
+  curl_easy_setopt(curl, CURLOPT_USERAGENT, "weather-station-aggregator");
+
+  CURLcode result = curl_easy_perform(curl);
+  requests++;
+  if (result != CURLE_OK) {
+    fprintf(stderr, "fetch %s: %s\n", url.c_str(), curl_easy_strerror(result));
+    return -1;
+  }
+  curl_off_t received = 0;
+  curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &received);
+  bytes += received;
+  long code = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+  return url.compare(0, 7, "file://") == 0 ? 200 : (int)code;
+}
@@ -0,0 +1,356 @@
+#include "alerts.h"
+#include "timezone.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Phrases replaced by one byte (0x80 + index) in the stored text. SWPC
+// messages are plain ASCII, so bytes >= 0x80 are free for tokens.
+static const char* const ALERT_PHRASES[] = {
+  "NOAA Space Weather Scale descriptions can be found at\n",
+  "www.swpc.noaa.gov/noaa-scales-explanation\n",
+  "Potential Impacts: Area of impact primarily poleward of ",
+  " degrees Geomagnetic Latitude.\n",
+  "Induced Currents - Weak power grid fluctuations can occur.\n",
+  "Spacecraft - Minor impact on satellite operations possible.\n",
+  "Aurora - Aurora may be visible at high latitudes",
+  "northern tier of the U.S. such as ",
+  "northern Michigan and Maine.",
+  "Weak power grid fluctuations",
+  "Limited blackout of HF (high frequency) radio communication",
+  "Potential Impacts: Extends below ",
+  "Highest Storm Level Predicted by Day:",
+  "greater than or equal to ",
+  "Geomagnetic K-index of ",
+  "Geomagnetic Storm Category ",
+  "Space Weather Message Code: ",
+  "Type II Radio Emission",
+  "Type IV Radio Emission",
+  "Warning Condition: ",
+  "Extension to Serial Number: ",
+  "Cancel Serial Number: ",
+  "Threshold Reached: ",
+  "Estimated Velocity: ",
+  "Potential Impacts: ",
+  "Induced Currents - ",
+  "Now Valid Until: ",
+  "Synoptic Period: ",
+  "Active Warning: ",
+  "Serial Number: ",
+  "Sudden Impulse",
+  "Maximum Time: ",
+  "X-ray Class: ",
+  "Issue Time: ",
+  "Begin Time: ",
+  "Valid From: ",
+  "NOAA Scale: ",
+  "Spacecraft - ",
+  "Persistence",
+  "Navigation - ",
+  "Geomagnetic ",
+  "Valid To: ",
+  "End Time: ",
+  "Location: ",
+  "Comment: ",
+  "Aurora - ",
+  "Radio - ",
+  "satellite",
+  "Predicted",
+  "Observed",
+  "Moderate",
+  "expected",
+  "Electron",
+  "electron",
+  "Extreme",
+  "Warning",
+  "WARNING",
+  "Integral",
+  "exceeded",
+  "Proton",
+  "proton",
+  "Strong",
+  "Severe",
+  "Minor",
+  "Onset",
+  "power",
+  "Flux",
+  "flux",
+  " UTC\n",
+  " UTC",
+  "Jan ", "Feb ", "Mar ", "Apr ", "May ", "Jun ",
+  "Jul ", "Aug ", "Sep ", "Oct ", "Nov ", "Dec ",
+  " - ",
+  "the ",
+  "and ",
+  "ion",
+  "ing",
+  " of ",
+  " to ",
+  " at ",
+  " be ",
+  ":\n",
+  ".\n"
+};
+static const uint8_t ALERT_PHRASE_COUNT = sizeof(ALERT_PHRASES) / sizeof(ALERT_PHRASES[0]);
+static_assert(sizeof(ALERT_PHRASES) / sizeof(ALERT_PHRASES[0]) <= 128, "Phrase tokens must fit in 0x80-0xFF");
+
+static uint8_t phraseLengths[ALERT_PHRASE_COUNT];
+
+static const char* const MONTHS = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+uint32_t alertHash(const char* code, uint32_t serial) {
+  uint32_t hash = 2166136261u;  // FNV-1a
+  for (const char* p = code; *p; p++) {
+    hash ^= (uint8_t)*p;
+    hash *= 16777619u;
+  }
+  for (uint8_t i = 0; i < 4; i++) {
+    hash ^= (serial >> (8 * i)) & 0xFF;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Value after "label" at the start of a line, nullptr if no such line
+static const char* findField(const char* message, const char* label) {
+  size_t labelLength = strlen(label);
+  for (const char* line = message; line && *line; ) {
+    while (*line == '\r' || *line == '\n' || *line == ' ') line++;
+    if (strncmp(line, label, labelLength) == 0) return line + labelLength;
+    line = strchr(line, '\n');
+  }
+  return nullptr;
+}
+
+// "2025 Oct 24 1800 UTC"
+static bool parseAlertTime(const char* text, uint32_t& out) {
+  if (!text) return false;
+  int year, day, hhmm;
+  char month[4];
+  if (sscanf(text, "%d %3s %d %d", &year, month, &day, &hhmm) != 4) return false;
+  if (year < 1970 || year > 9999 || day < 1 || day > 31 || hhmm < 0 || hhmm > 2359) return false;
+  const char* found = strstr(MONTHS, month);
+  if (!found || strlen(month) != 3 || (found - MONTHS) % 3 != 0) return false;
+
+  char iso[32];
+  int length = snprintf(iso, sizeof(iso), "%04d-%02d-%02d %02d:%02d", year, (int)(found - MONTHS) / 3 + 1, day,
+                        hhmm / 100, hhmm % 100);
+  time_t parsed;
+  if (length < 0 || length >= (int)sizeof(iso) || !parseUtcTimestamp(iso, parsed)) return false;
+  out = (uint32_t)parsed;
+  return true;
+}
+
+static AlertTopic topicFromCode(const char* code) {
+  const char* type = code + 3;  // After ALT/WAR/WAT/SUM
+  if (type[0] == 'K' || type[0] == 'A' || strncmp(type, "SUD", 3) == 0) return ALERT_TOPIC_GEOMAGNETIC;
+  if (type[0] == 'X') return ALERT_TOPIC_XRAY;
+  if (type[0] == 'P') return ALERT_TOPIC_PROTON;
+  if (type[0] == 'E') return ALERT_TOPIC_ELECTRON;
+  if (type[0] == 'T' || strncmp(type, "10R", 3) == 0) return ALERT_TOPIC_RADIO;
+  return ALERT_TOPIC_OTHER;
+}
+
+static AlertKind kindFromCode(const char* code) {
+  if (strncmp(code, "ALT", 3) == 0) return ALERT_KIND_ALERT;
+  if (strncmp(code, "WAR", 3) == 0) return ALERT_KIND_WARNING;
+  if (strncmp(code, "WAT", 3) == 0) return ALERT_KIND_WATCH;
+  if (strncmp(code, "SUM", 3) == 0) return ALERT_KIND_SUMMARY;
+  return ALERT_KIND_OTHER;
+}
+
+const char* alertKindText(AlertKind kind) {
+  switch (kind) {
+    case ALERT_KIND_ALERT: return "ALERT";
+    case ALERT_KIND_WARNING: return "WARNING";
+    case ALERT_KIND_WATCH: return "WATCH";
+    case ALERT_KIND_SUMMARY: return "SUMMARY";
+    default: return "NOTICE";
+  }
+}
+
+// Greedy longest-phrase compression; drops '\r' and the header lines
+// already held in the entry. Returns the compressed length.
+static size_t compressText(const char* text, uint8_t* out, size_t size) {
+  if (phraseLengths[0] == 0) {
+    for (uint8_t i = 0; i < ALERT_PHRASE_COUNT; i++) phraseLengths[i] = strlen(ALERT_PHRASES[i]);
+  }
+
+  size_t length = 0;
+  const char* p = text;
+  while (*p && length < size) {
+    if (*p == '\r' || (uint8_t)*p >= 0x80) {
+      p++;
+      continue;
+    }
+    uint8_t best = 0;
+    uint8_t bestLength = 0;
+    for (uint8_t i = 0; i < ALERT_PHRASE_COUNT; i++) {
+      if (ALERT_PHRASES[i][0] == *p && phraseLengths[i] > bestLength &&
+          strncmp(p, ALERT_PHRASES[i], phraseLengths[i]) == 0) {
+        best = i;
+        bestLength = phraseLengths[i];
+      }
+    }
+    if (bestLength > 1) {
+      out[length++] = 0x80 + best;
+      p += bestLength;
+    } else {
+      out[length++] = (uint8_t)*p++;
+    }
+  }
+  while (length > 0 && (out[length - 1] == '\n' || out[length - 1] == ' ')) length--;
+  return length;
+}
+
+size_t alertText(const AlertStore& store, uint8_t index, char* buffer, size_t size) {
+  if (index >= store.count || size == 0) return 0;
+  const AlertEntry& entry = store.entries[index];
+  size_t length = 0;
+  for (uint16_t i = 0; i < entry.textLength; i++) {
+    uint8_t byte = store.text[entry.textOffset + i];
+    const char* piece = nullptr;
+    char single[2] = {(char)byte, '\0'};
+    if (byte >= 0x80 && byte - 0x80 < ALERT_PHRASE_COUNT) piece = ALERT_PHRASES[byte - 0x80];
+    else piece = single;
+    for (; *piece && length < size - 1; piece++) buffer[length++] = *piece;
+  }
+  buffer[length] = '\0';
+  return length;
+}
+
+void alertStoreClear(AlertStore& store) {
+  store.count = 0;
+  store.textUsed = 0;
+  memset(store.retired, 0, sizeof(store.retired));
+  store.retiredNext = 0;
+}
+
+static void removeEntry(AlertStore& store, uint8_t index) {
+  AlertEntry& entry = store.entries[index];
+  uint16_t offset = entry.textOffset;
+  uint16_t length = entry.textLength;
+
+  // Close the hole in the text pool
+  memmove(&store.text[offset], &store.text[offset + length], store.textUsed - offset - length);
+  store.textUsed -= length;
+  for (uint8_t i = 0; i < store.count; i++) {
+    if (store.entries[i].textOffset > offset) store.entries[i].textOffset -= length;
+  }
+
+  memmove(&store.entries[index], &store.entries[index + 1], (store.count - index - 1) * sizeof(AlertEntry));
+  store.count--;
+}
+
+// Drop the product with this hash now and whenever it shows up again
+static void retire(AlertStore& store, uint32_t hash) {
+  for (uint8_t i = 0; i < store.count; i++) {
+    if (store.entries[i].hash == hash) {
+      removeEntry(store, i);
+      break;
+    }
+  }
+  for (uint8_t i = 0; i < ALERT_CAPACITY; i++) {
+    if (store.retired[i] == hash) return;
+  }
+  store.retired[store.retiredNext] = hash;
+  store.retiredNext = (store.retiredNext + 1) % ALERT_CAPACITY;
+}
+
+uint8_t alertStoreExpire(AlertStore& store, uint32_t now) {
+  uint8_t removed = 0;
+  for (uint8_t i = store.count; i > 0; i--) {
+    if (store.entries[i - 1].expires <= now) {
+      removeEntry(store, i - 1);
+      removed++;
+    }
+  }
+  return removed;
+}
+
+bool alertStoreHasTopic(const AlertStore& store, AlertTopic topic) {
+  for (uint8_t i = 0; i < store.count; i++) {
+    if (store.entries[i].topic == topic) return true;
+  }
+  return false;
+}
+
+AlertResult alertStoreAdd(AlertStore& store, const char* message, uint32_t issued, uint32_t now) {
+  AlertEntry entry;
+  memset(&entry, 0, sizeof(entry));
+
+  const char* code = findField(message, "Space Weather Message Code: ");
+  if (!code) return ALERT_REJECTED;
+  size_t codeLength = strcspn(code, "\r\n ");
+  if (codeLength < 4 || codeLength >= sizeof(entry.code)) return ALERT_REJECTED;
+  memcpy(entry.code, code, codeLength);
+
+  const char* serial = findField(message, "Serial Number: ");
+  entry.serial = serial ? strtoul(serial, nullptr, 10) : 0;
+  entry.hash = alertHash(entry.code, entry.serial);
+  for (uint8_t i = 0; i < store.count; i++) {
+    if (store.entries[i].hash == entry.hash) return ALERT_DUPLICATE;
+  }
+
+  for (uint8_t i = 0; i < ALERT_CAPACITY; i++) {
+    if (store.retired[i] == entry.hash) return ALERT_CANCELLED;
+  }
+
+  // A cancellation retires the product it names (same code) and is not kept
+  // itself; an extension retires the product it replaces and is kept
+  const char* cancel = findField(message, "Cancel Serial Number: ");
+  if (cancel) {
+    retire(store, alertHash(entry.code, strtoul(cancel, nullptr, 10)));
+    return ALERT_CANCELLED;
+  }
+  const char* extended = findField(message, "Extension to Serial Number: ");
+  if (extended) retire(store, alertHash(entry.code, strtoul(extended, nullptr, 10)));
+
+  entry.issued = issued;
+  entry.kind = kindFromCode(entry.code);
+  entry.topic = topicFromCode(entry.code);
+
+  // Validity: explicit end time, else a default per kind
+  if (!parseAlertTime(findField(message, "Now Valid Until: "), entry.expires) &&
+      !parseAlertTime(findField(message, "Valid To: "), entry.expires)) {
+    entry.expires = issued + (entry.kind == ALERT_KIND_WATCH ? ALERT_WATCH_LIFETIME : ALERT_DEFAULT_LIFETIME);
+  }
+  if (now != 0 && entry.expires <= now) return ALERT_EXPIRED;
+
+  // Severity from the NOAA scale line ("G2 - Moderate"), else from a K-index code
+  const char* scale = findField(message, "NOAA Scale: ");
+  if (scale && (scale[0] == 'G' || scale[0] == 'R' || scale[0] == 'S') && scale[1] >= '1' && scale[1] <= '5') {
+    entry.scale[0] = scale[0];
+    entry.scale[1] = scale[1];
+    entry.severity = scale[1] - '0';
+  } else if (entry.topic == ALERT_TOPIC_GEOMAGNETIC && entry.code[3] == 'K' && entry.code[5] >= '5') {
+    entry.severity = entry.code[5] - '4';  // K5 = G1 ... K9 = G5
+  }
+
+  // Store the text from the headline on; the header lines live in the entry
+  const char* body = findField(message, "Issue Time: ");
+  body = body ? strchr(body, '\n') : message;
+  if (!body) body = message;
+  while (*body == '\r' || *body == '\n') body++;
+
+  uint8_t compressed[ALERT_TEXT_BUDGET / 2];  // One message may use at most half the pool
+  size_t length = compressText(body, compressed, sizeof(compressed));
+
+  // Newest first; find the slot, and evict the oldest entries to make room
+  uint8_t position = 0;
+  while (position < store.count && store.entries[position].issued >= issued) position++;
+  while (store.count > 0 && (store.count == ALERT_CAPACITY || store.textUsed + length > ALERT_TEXT_BUDGET)) {
+    if (position >= store.count) return ALERT_REJECTED;  // Older than everything kept
+    removeEntry(store, store.count - 1);
+  }
+
+  entry.textOffset = store.textUsed;
+  entry.textLength = length;
+  memcpy(&store.text[store.textUsed], compressed, length);
+  store.textUsed += length;
+
+  memmove(&store.entries[position + 1], &store.entries[position], (store.count - position) * sizeof(AlertEntry));
+  store.entries[position] = entry;
+  store.count++;
+  return ALERT_ADDED;
+}
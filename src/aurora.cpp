@@ -0,0 +1,51 @@
+#include "aurora.h"
+#include "config.h"
+#include <math.h>
+#include <stdlib.h>
+
+// North geomagnetic pole (IGRF, epoch 2025)
+static const float POLE_LATITUDE = 80.8f;
+static const float POLE_LONGITUDE = -72.7f;
+static const float RAD = 0.017453293f;
+
+float geomagneticLatitude(float latitude, float longitude) {
+  float lat = latitude * RAD;
+  float poleLat = POLE_LATITUDE * RAD;
+  float sinMag = sinf(lat) * sinf(poleLat) + cosf(lat) * cosf(poleLat) * cosf((longitude - POLE_LONGITUDE) * RAD);
+  return asinf(sinMag) / RAD;
+}
+
+float auroraBoundaryLatitude(float kp) {
+  // Empirical fit: ~66.5 degrees at Kp 0, two degrees equatorward per Kp step
+  return 66.5f - 2.0f * kp;
+}
+
+AuroraSighting auroraSightingFromKp(float kp, float latitude, float longitude) {
+  float margin = fabsf(geomagneticLatitude(latitude, longitude)) - auroraBoundaryLatitude(kp);
+  if (margin >= 0) return SIGHTING_OVERHEAD;
+  if (margin >= -AURORA_HORIZON_DISTANCE) return SIGHTING_HORIZON;
+  return SIGHTING_NONE;
+}
+
+int auroraLikelihood(float kp, float latitude, float longitude) {
+  // Logistic in the distance from the oval edge: 50% halfway out to the horizon
+  // viewline, ~93% with the edge overhead, a continuous score instead of three bands
+  float margin = fabsf(geomagneticLatitude(latitude, longitude)) - auroraBoundaryLatitude(kp);
+  float score = 100.0f / (1.0f + expf(-(margin + AURORA_HORIZON_DISTANCE / 2.0f) / 1.5f));
+  return (int)lroundf(score);
+}
+
+AuroraSighting auroraSightingFromViewline(float latitude, int ovalEdgeLatitude, int viewlineLatitude) {
+  if (ovalEdgeLatitude == 0) return SIGHTING_NONE;  // No oval cell above the threshold
+  if (fabsf(latitude) >= abs(ovalEdgeLatitude)) return SIGHTING_OVERHEAD;
+  if (fabsf(latitude) >= abs(viewlineLatitude)) return SIGHTING_HORIZON;
+  return SIGHTING_NONE;
+}
+
+const char* auroraSightingText(AuroraSighting sighting, float latitude) {
+  switch (sighting) {
+    case SIGHTING_OVERHEAD: return "Overhead possible";
+    case SIGHTING_HORIZON: return latitude >= 0 ? "Low on N horizon" : "Low on S horizon";
+    default: return "Not likely visible";
+  }
+}
@@ -0,0 +1,689 @@
+#include <string.h>
+#include "weather.h"
+#include "bundle.h"
+
+#define BUNDLE_TEXT_SIZE 64            // Longest string kept from a bundle
+
+// ============================================================================
+// Record layouts: 4-byte fields first, then 2-byte ones, records padded to 4
+// ============================================================================
+
+enum CurrentField : uint16_t {
+  CUR_TEMPERATURE = 0, CUR_PRESSURE = 4, CUR_WIND_SPEED = 8, CUR_HUMIDITY = 12, CUR_WIND_DIRECTION = 14,
+  CUR_DESCRIPTION = 16, CUR_ICON = 18, CUR_CITY = 20, CUR_MOON_PHASE_NAME = 22,
+  CUR_SUNRISE = 24, CUR_SUNSET = 28, CUR_MOONRISE = 32, CUR_MOONSET = 36, CUR_SOLAR_NOON = 40,
+  CUR_MOON_TRANSIT = 44, CUR_CIVIL_DAWN = 48, CUR_CIVIL_DUSK = 52, CUR_NAUTICAL_DAWN = 56,
+  CUR_NAUTICAL_DUSK = 60, CUR_ASTRONOMICAL_DAWN = 64, CUR_ASTRONOMICAL_DUSK = 68,
+  CUR_MOON_PHASE = 72, CUR_MOON_ILLUMINATION = 76, CUR_MOON_AGE = 80, CUR_MOON_EMOJI = 84,
+  CUR_SIZE = 88
+};
+
+enum HourlyField : uint16_t {
+  HOUR_TEMPERATURE = 0, HOUR_TIME = 4, HOUR_ICON = 6, HOUR_DESCRIPTION = 8, HOUR_PRECIP = 10,
+  HOUR_HUMIDITY = 12, HOUR_SIZE = 16
+};
+
+enum DailyField : uint16_t {
+  DAY_HIGH = 0, DAY_LOW = 4, DAY_NAME = 8, DAY_ICON = 10, DAY_DESCRIPTION = 12, DAY_PRECIP = 14, DAY_SIZE = 16
+};
+
+enum AirField : uint16_t {
+  AIR_CO = 0, AIR_NO2 = 4, AIR_O3 = 8, AIR_PM2_5 = 12, AIR_PM10 = 16, AIR_VISIBILITY = 20, AIR_AQI = 24,
+  AIR_UV_INDEX = 26, AIR_STATUS = 28, AIR_UV_RISK = 30, AIR_SIZE = 32
+};
+
+enum SpaceField : uint16_t {
+  SPACE_KP = 0, SPACE_SPEED = 4, SPACE_DENSITY = 8, SPACE_BZ = 12, SPACE_BY = 16, SPACE_COUPLING_KP = 20,
+  SPACE_DST = 24, SPACE_SOUTHWARD = 28, SPACE_AURORA_SCORE = 30, SPACE_AURORA_FORECAST = 32,
+  SPACE_GEOMAG_STATUS = 34, SPACE_SIZE = 36
+};
+
+enum NoaaField : uint16_t {
+  NOAA_FLUX = 0, NOAA_A_INDEX = 4, NOAA_KP = 8, NOAA_SUNSPOT_AREA = 12, NOAA_SUNSPOT_NUMBER = 16,
+  NOAA_ACTIVE_REGIONS = 18, NOAA_ALERT_COUNT = 20, NOAA_XRAY = 22, NOAA_PROTON = 24, NOAA_ELECTRON = 26,
+  NOAA_SUMMARY = 28, NOAA_SIZE = 32
+};
+
+enum AuroraForecastField : uint16_t {
+  AF_KP = 0, AF_DATE = 4, AF_ACTIVITY = 6, AF_VISIBILITY = 8, AF_PEAK_TIME = 10, AF_CONFIDENCE = 12, AF_SIZE = 16
+};
+
+enum NowcastField : uint16_t {
+  NOW_PROBABILITY = 0, NOW_POLEWARD_MAX = 2, NOW_OVAL_EDGE = 4, NOW_VIEWLINE = 6, NOW_FORECAST_TIME = 8,
+  NOW_SIZE = 12
+};
+
+enum KpForecastField : uint16_t { KPF_TIME = 0, KPF_KP_TENTHS = 4, KPF_SOURCE = 5, KPF_SIZE = 8 };
+
+enum SolarWindField : uint16_t {
+  SW_START = 0, SW_BZ_MIN = 4, SW_BZ_MEAN = 6, SW_BZ_MAX = 8, SW_BY_MEAN = 10, SW_SPEED_MIN = 12,
+  SW_SPEED_MEAN = 14, SW_SPEED_MAX = 16, SW_DENSITY_MEAN = 18, SW_MAG_SAMPLES = 20, SW_PLASMA_SAMPLES = 21,
+  SW_SIZE = 24
+};
+
+enum FlareField : uint16_t {
+  FL_START = 0, FL_PEAK = 4, FL_END = 8, FL_PEAK_FLUX = 12, FL_SHORT_PEAK_FLUX = 16, FL_SIZE = 20
+};
+
+enum AlertField : uint16_t {
+  AL_HASH = 0, AL_SERIAL = 4, AL_ISSUED = 8, AL_EXPIRES = 12, AL_TEXT_OFFSET = 16, AL_TEXT_LENGTH = 18,
+  AL_CODE = 20, AL_SCALE = 22, AL_KIND = 24, AL_TOPIC = 25, AL_SEVERITY = 26, AL_SIZE = 28
+};
+
+static const WireField sourceFields[] = {{"updated", WIRE_U32, 0}};
+
+static const WireField currentFields[] = {
+  {"temperature", WIRE_F32, CUR_TEMPERATURE}, {"humidity", WIRE_I16, CUR_HUMIDITY},
+  {"pressure", WIRE_F32, CUR_PRESSURE}, {"description", WIRE_STRING, CUR_DESCRIPTION},
+  {"icon", WIRE_STRING, CUR_ICON}, {"cityName", WIRE_STRING, CUR_CITY},
+  {"windSpeed", WIRE_F32, CUR_WIND_SPEED}, {"windDirection", WIRE_I16, CUR_WIND_DIRECTION},
+  {"sunrise", WIRE_U32, CUR_SUNRISE}, {"sunset", WIRE_U32, CUR_SUNSET},
+  {"moonrise", WIRE_U32, CUR_MOONRISE}, {"moonset", WIRE_U32, CUR_MOONSET},
+  {"solarNoon", WIRE_U32, CUR_SOLAR_NOON}, {"moonTransit", WIRE_U32, CUR_MOON_TRANSIT},
+  {"civilDawn", WIRE_U32, CUR_CIVIL_DAWN}, {"civilDusk", WIRE_U32, CUR_CIVIL_DUSK},
+  {"nauticalDawn", WIRE_U32, CUR_NAUTICAL_DAWN}, {"nauticalDusk", WIRE_U32, CUR_NAUTICAL_DUSK},
+  {"astronomicalDawn", WIRE_U32, CUR_ASTRONOMICAL_DAWN}, {"astronomicalDusk", WIRE_U32, CUR_ASTRONOMICAL_DUSK},
+  {"moonPhase", WIRE_F32, CUR_MOON_PHASE}, {"moonPhaseName", WIRE_STRING, CUR_MOON_PHASE_NAME},
+  {"moonIllumination", WIRE_F32, CUR_MOON_ILLUMINATION}, {"moonAge", WIRE_F32, CUR_MOON_AGE},
+  {"moonEmoji", WIRE_STRING, CUR_MOON_EMOJI},
+};
+
+static const WireField hourlyFields[] = {
+  {"time", WIRE_STRING, HOUR_TIME}, {"temperature", WIRE_F32, HOUR_TEMPERATURE},
+  {"icon", WIRE_STRING, HOUR_ICON}, {"description", WIRE_STRING, HOUR_DESCRIPTION},
+  {"precipChance", WIRE_I16, HOUR_PRECIP}, {"humidity", WIRE_I16, HOUR_HUMIDITY},
+};
+
+static const WireField dailyFields[] = {
+  {"dayName", WIRE_STRING, DAY_NAME}, {"tempHigh", WIRE_F32, DAY_HIGH}, {"tempLow", WIRE_F32, DAY_LOW},
+  {"icon", WIRE_STRING, DAY_ICON}, {"description", WIRE_STRING, DAY_DESCRIPTION},
+  {"precipChance", WIRE_I16, DAY_PRECIP},
+};
+
+static const WireField airFields[] = {
+  {"aqi", WIRE_I16, AIR_AQI}, {"status", WIRE_STRING, AIR_STATUS}, {"co", WIRE_F32, AIR_CO},
+  {"no2", WIRE_F32, AIR_NO2}, {"o3", WIRE_F32, AIR_O3}, {"pm2_5", WIRE_F32, AIR_PM2_5},
+  {"pm10", WIRE_F32, AIR_PM10}, {"uvIndex", WIRE_I16, AIR_UV_INDEX}, {"uvRisk", WIRE_STRING, AIR_UV_RISK},
+  {"visibility", WIRE_F32, AIR_VISIBILITY},
+};
+
+static const WireField spaceFields[] = {
+  {"kpIndex", WIRE_F32, SPACE_KP}, {"solarWindSpeed", WIRE_F32, SPACE_SPEED},
+  {"solarWindDensity", WIRE_F32, SPACE_DENSITY}, {"magneticFieldBz", WIRE_F32, SPACE_BZ},
+  {"magneticFieldBy", WIRE_F32, SPACE_BY}, {"bzSouthwardMinutes", WIRE_U16, SPACE_SOUTHWARD},
+  {"couplingKp", WIRE_F32, SPACE_COUPLING_KP}, {"dstEstimate", WIRE_F32, SPACE_DST},
+  {"auroraScore", WIRE_I16, SPACE_AURORA_SCORE}, {"auroraForecast", WIRE_STRING, SPACE_AURORA_FORECAST},
+  {"geomagStatus", WIRE_STRING, SPACE_GEOMAG_STATUS},
+};
+
+static const WireField noaaFields[] = {
+  {"solarFluxIndex", WIRE_F32, NOAA_FLUX}, {"aIndex", WIRE_F32, NOAA_A_INDEX}, {"kpIndex", WIRE_F32, NOAA_KP},
+  {"xrayFlux", WIRE_STRING, NOAA_XRAY}, {"protonFlux", WIRE_STRING, NOAA_PROTON},
+  {"electronFlux", WIRE_STRING, NOAA_ELECTRON}, {"sunspotNumber", WIRE_I16, NOAA_SUNSPOT_NUMBER},
+  {"activeRegions", WIRE_I16, NOAA_ACTIVE_REGIONS}, {"sunspotArea", WIRE_I32, NOAA_SUNSPOT_AREA},
+  {"alertCount", WIRE_I16, NOAA_ALERT_COUNT}, {"summary", WIRE_STRING, NOAA_SUMMARY},
+};
+
+static const WireField auroraForecastFields[] = {
+  {"date", WIRE_STRING, AF_DATE}, {"kpPredicted", WIRE_F32, AF_KP}, {"activity", WIRE_STRING, AF_ACTIVITY},
+  {"visibility", WIRE_STRING, AF_VISIBILITY}, {"peakTime", WIRE_STRING, AF_PEAK_TIME},
+  {"confidence", WIRE_STRING, AF_CONFIDENCE},
+};
+
+static const WireField nowcastFields[] = {
+  {"probability", WIRE_I16, NOW_PROBABILITY}, {"polewardMax", WIRE_I16, NOW_POLEWARD_MAX},
+  {"ovalEdgeLatitude", WIRE_I16, NOW_OVAL_EDGE}, {"viewlineLatitude", WIRE_I16, NOW_VIEWLINE},
+  {"forecastTime", WIRE_STRING, NOW_FORECAST_TIME},
+};
+
+static const WireField kpForecastFields[] = {
+  {"time", WIRE_U32, KPF_TIME}, {"kpTenths", WIRE_U8, KPF_KP_TENTHS}, {"source", WIRE_U8, KPF_SOURCE},
+};
+
+static const WireField solarWindFields[] = {
+  {"start", WIRE_U32, SW_START}, {"bzMin", WIRE_I16, SW_BZ_MIN}, {"bzMean", WIRE_I16, SW_BZ_MEAN},
+  {"bzMax", WIRE_I16, SW_BZ_MAX}, {"byMean", WIRE_I16, SW_BY_MEAN}, {"speedMin", WIRE_U16, SW_SPEED_MIN},
+  {"speedMean", WIRE_U16, SW_SPEED_MEAN}, {"speedMax", WIRE_U16, SW_SPEED_MAX},
+  {"densityMean", WIRE_U16, SW_DENSITY_MEAN}, {"magSamples", WIRE_U8, SW_MAG_SAMPLES},
+  {"plasmaSamples", WIRE_U8, SW_PLASMA_SAMPLES},
+};
+
+static const WireField flareFields[] = {
+  {"start", WIRE_U32, FL_START}, {"peak", WIRE_U32, FL_PEAK}, {"end", WIRE_U32, FL_END},
+  {"peakFlux", WIRE_F32, FL_PEAK_FLUX}, {"shortPeakFlux", WIRE_F32, FL_SHORT_PEAK_FLUX},
+};
+
+static const WireField alertFields[] = {
+  {"hash", WIRE_U32, AL_HASH}, {"serial", WIRE_U32, AL_SERIAL}, {"issued", WIRE_U32, AL_ISSUED},
+  {"expires", WIRE_U32, AL_EXPIRES}, {"code", WIRE_STRING, AL_CODE}, {"scale", WIRE_STRING, AL_SCALE},
+  {"kind", WIRE_U8, AL_KIND}, {"topic", WIRE_U8, AL_TOPIC}, {"severity", WIRE_U8, AL_SEVERITY},
+  {"textOffset", WIRE_U16, AL_TEXT_OFFSET}, {"textLength", WIRE_U16, AL_TEXT_LENGTH},
+};
+
+static const WireField retiredFields[] = {{"hash", WIRE_U32, 0}};
+
+#define FIELDS(list) list, (uint8_t)(sizeof(list) / sizeof(list[0]))
+
+// The compressed alert pool has no schema: it is checked as raw bytes and
+// left out of the JSON rendering
+const WireSchema bundleSchemas[] = {
+  {BUNDLE_SOURCES, "sources", 4, FIELDS(sourceFields)},
+  {BUNDLE_CURRENT, "current", CUR_SIZE, FIELDS(currentFields)},
+  {BUNDLE_HOURLY, "hourly", HOUR_SIZE, FIELDS(hourlyFields)},
+  {BUNDLE_DAILY, "daily", DAY_SIZE, FIELDS(dailyFields)},
+  {BUNDLE_AIR, "air", AIR_SIZE, FIELDS(airFields)},
+  {BUNDLE_SPACE, "space", SPACE_SIZE, FIELDS(spaceFields)},
+  {BUNDLE_NOAA, "noaa", NOAA_SIZE, FIELDS(noaaFields)},
+  {BUNDLE_AURORA_FORECAST, "auroraForecast", AF_SIZE, FIELDS(auroraForecastFields)},
+  {BUNDLE_NOWCAST, "nowcast", NOW_SIZE, FIELDS(nowcastFields)},
+  {BUNDLE_KP_FORECAST, "kpForecast", KPF_SIZE, FIELDS(kpForecastFields)},
+  {BUNDLE_SOLAR_WIND, "solarWind", SW_SIZE, FIELDS(solarWindFields)},
+  {BUNDLE_FLARES, "flares", FL_SIZE, FIELDS(flareFields)},
+  {BUNDLE_ALERTS, "alerts", AL_SIZE, FIELDS(alertFields)},
+  {BUNDLE_ALERT_RETIRED, "alertRetired", 4, FIELDS(retiredFields)},
+};
+const uint8_t bundleSchemaCount = sizeof(bundleSchemas) / sizeof(bundleSchemas[0]);
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+static void putText(WireWriter& writer, uint8_t* record, uint16_t offset, const char* value) {
+  wirePut16(record, offset, writer.string(value));
+}
+
+static void encodeWeather(WireWriter& writer) {
+  uint8_t* record = writer.section(BUNDLE_CURRENT, CUR_SIZE, 1);
+  if (record != nullptr) {
+    const WeatherData& weather = currentWeather;
+    wirePutF32(record, CUR_TEMPERATURE, weather.temperature);
+    wirePutF32(record, CUR_PRESSURE, weather.pressure);
+    wirePutF32(record, CUR_WIND_SPEED, weather.windSpeed);
+    wirePut16(record, CUR_HUMIDITY, (uint16_t)weather.humidity);
+    wirePut16(record, CUR_WIND_DIRECTION, (uint16_t)weather.windDirection);
+    putText(writer, record, CUR_DESCRIPTION, weather.description.c_str());
+    putText(writer, record, CUR_ICON, weather.icon.c_str());
+    putText(writer, record, CUR_CITY, weather.cityName.c_str());
+    putText(writer, record, CUR_MOON_PHASE_NAME, weather.moonPhaseName.c_str());
+    const unsigned long times[] = {weather.sunrise, weather.sunset, weather.moonrise, weather.moonset,
+                                   weather.solarNoon, weather.moonTransit, weather.civilDawn, weather.civilDusk,
+                                   weather.nauticalDawn, weather.nauticalDusk, weather.astronomicalDawn,
+                                   weather.astronomicalDusk};
+    for (uint8_t i = 0; i < 12; i++) wirePut32(record, CUR_SUNRISE + 4 * i, (uint32_t)times[i]);
+    wirePutF32(record, CUR_MOON_PHASE, weather.moonPhase);
+    wirePutF32(record, CUR_MOON_ILLUMINATION, weather.moonIllumination);
+    wirePutF32(record, CUR_MOON_AGE, weather.moonAge);
+    putText(writer, record, CUR_MOON_EMOJI, weather.moonEmoji.c_str());
+  }
+
+  record = writer.section(BUNDLE_HOURLY, HOUR_SIZE, 12);
+  for (uint8_t i = 0; record != nullptr && i < 12; i++, record += HOUR_SIZE) {
+    const HourlyForecast& hour = hourlyForecast.hours[i];
+    wirePutF32(record, HOUR_TEMPERATURE, hour.temperature);
+    putText(writer, record, HOUR_TIME, hour.time);
+    putText(writer, record, HOUR_ICON, hour.icon.c_str());
+    putText(writer, record, HOUR_DESCRIPTION, hour.description.c_str());
+    wirePut16(record, HOUR_PRECIP, (uint16_t)hour.precipChance);
+    wirePut16(record, HOUR_HUMIDITY, (uint16_t)hour.humidity);
+  }
+
+  record = writer.section(BUNDLE_DAILY, DAY_SIZE, 7);
+  for (uint8_t i = 0; record != nullptr && i < 7; i++, record += DAY_SIZE) {
+    const DayForecast& day = weeklyForecast.days[i];
+    wirePutF32(record, DAY_HIGH, day.tempHigh);
+    wirePutF32(record, DAY_LOW, day.tempLow);
+    putText(writer, record, DAY_NAME, day.dayName.c_str());
+    putText(writer, record, DAY_ICON, day.icon.c_str());
+    putText(writer, record, DAY_DESCRIPTION, day.description.c_str());
+    wirePut16(record, DAY_PRECIP, (uint16_t)day.precipChance);
+  }
+}
+
+static void encodeAir(WireWriter& writer) {
+  uint8_t* record = writer.section(BUNDLE_AIR, AIR_SIZE, 1);
+  if (record == nullptr) return;
+  wirePutF32(record, AIR_CO, airQuality.co);
+  wirePutF32(record, AIR_NO2, airQuality.no2);
+  wirePutF32(record, AIR_O3, airQuality.o3);
+  wirePutF32(record, AIR_PM2_5, airQuality.pm2_5);
+  wirePutF32(record, AIR_PM10, airQuality.pm10);
+  wirePutF32(record, AIR_VISIBILITY, airQuality.visibility);
+  wirePut16(record, AIR_AQI, (uint16_t)airQuality.aqi);
+  wirePut16(record, AIR_UV_INDEX, (uint16_t)airQuality.uvIndex);
+  putText(writer, record, AIR_STATUS, airQuality.status.c_str());
+  putText(writer, record, AIR_UV_RISK, airQuality.uvRisk.c_str());
+}
+
+static void encodeSpace(WireWriter& writer) {
+  uint8_t* record = writer.section(BUNDLE_SPACE, SPACE_SIZE, 1);
+  if (record == nullptr) return;
+  const SpaceWeatherData& space = currentSpaceWeather;
+  wirePutF32(record, SPACE_KP, space.kpIndex);
+  wirePutF32(record, SPACE_SPEED, space.solarWindSpeed);
+  wirePutF32(record, SPACE_DENSITY, space.solarWindDensity);
+  wirePutF32(record, SPACE_BZ, space.magneticFieldBz);
+  wirePutF32(record, SPACE_BY, space.magneticFieldBy);
+  wirePutF32(record, SPACE_COUPLING_KP, space.couplingKp);
+  wirePutF32(record, SPACE_DST, space.dstEstimate);
+  wirePut16(record, SPACE_SOUTHWARD, space.bzSouthwardMinutes);
+  wirePut16(record, SPACE_AURORA_SCORE, (uint16_t)space.auroraScore);
+  putText(writer, record, SPACE_AURORA_FORECAST, space.auroraForecast.c_str());
+  putText(writer, record, SPACE_GEOMAG_STATUS, space.geomagStatus.c_str());
+}
+
+static void encodeNoaa(WireWriter& writer) {
+  uint8_t* record = writer.section(BUNDLE_NOAA, NOAA_SIZE, 1);
+  if (record == nullptr) return;
+  const NOAASpaceWeatherData& noaa = noaaSpaceWeather;
+  wirePutF32(record, NOAA_FLUX, noaa.solarFluxIndex);
+  wirePutF32(record, NOAA_A_INDEX, noaa.aIndex);
+  wirePutF32(record, NOAA_KP, noaa.kpIndex);
+  wirePut32(record, NOAA_SUNSPOT_AREA, (uint32_t)noaa.sunspotArea);
+  wirePut16(record, NOAA_SUNSPOT_NUMBER, (uint16_t)noaa.sunspotNumber);
+  wirePut16(record, NOAA_ACTIVE_REGIONS, (uint16_t)noaa.activeRegions);
+  wirePut16(record, NOAA_ALERT_COUNT, (uint16_t)noaa.alertCount);
+  putText(writer, record, NOAA_XRAY, noaa.xrayFlux.c_str());
+  putText(writer, record, NOAA_PROTON, noaa.protonFlux.c_str());
+  putText(writer, record, NOAA_ELECTRON, noaa.electronFlux.c_str());
+  putText(writer, record, NOAA_SUMMARY, noaa.summary.c_str());
+}
+
+static void encodeAurora(WireWriter& writer, bool nowcast) {
+  const AuroraForecastData* nights[] = {&auroraToday, &auroraTomorrow};
+  uint8_t* record = writer.section(BUNDLE_AURORA_FORECAST, AF_SIZE, 2);
+  for (uint8_t i = 0; record != nullptr && i < 2; i++, record += AF_SIZE) {
+    wirePutF32(record, AF_KP, nights[i]->kpPredicted);
+    putText(writer, record, AF_DATE, nights[i]->date.c_str());
+    putText(writer, record, AF_ACTIVITY, nights[i]->activity.c_str());
+    putText(writer, record, AF_VISIBILITY, nights[i]->visibility.c_str());
+    putText(writer, record, AF_PEAK_TIME, nights[i]->peakTime.c_str());
+    putText(writer, record, AF_CONFIDENCE, nights[i]->confidence.c_str());
+  }
+  if (!nowcast) return;
+
+  record = writer.section(BUNDLE_NOWCAST, NOW_SIZE, 1);
+  if (record == nullptr) return;
+  wirePut16(record, NOW_PROBABILITY, (uint16_t)auroraNowcast.probability);
+  wirePut16(record, NOW_POLEWARD_MAX, (uint16_t)auroraNowcast.polewardMax);
+  wirePut16(record, NOW_OVAL_EDGE, (uint16_t)auroraNowcast.ovalEdgeLatitude);
+  wirePut16(record, NOW_VIEWLINE, (uint16_t)auroraNowcast.viewlineLatitude);
+  putText(writer, record, NOW_FORECAST_TIME, auroraNowcast.forecastTime);
+}
+
+static void encodeKpForecast(WireWriter& writer) {
+  uint8_t* record = writer.section(BUNDLE_KP_FORECAST, KPF_SIZE, kpForecast.count);
+  for (uint8_t i = 0; record != nullptr && i < kpForecast.count; i++, record += KPF_SIZE) {
+    wirePut32(record, KPF_TIME, kpForecast.points[i].time);
+    record[KPF_KP_TENTHS] = kpForecast.points[i].kpTenths;
+    record[KPF_SOURCE] = kpForecast.points[i].source;
+  }
+}
+
+static void encodeSolarWind(WireWriter& writer) {
+  uint16_t count = 0;
+  for (const SolarWindBin& bin : solarWind.bins) {
+    if (bin.start != 0) count++;
+  }
+  uint8_t* record = writer.section(BUNDLE_SOLAR_WIND, SW_SIZE, count);
+  if (record == nullptr) return;
+  for (const SolarWindBin& bin : solarWind.bins) {
+    if (bin.start == 0) continue;
+    wirePut32(record, SW_START, bin.start);
+    wirePut16(record, SW_BZ_MIN, (uint16_t)bin.bzMin);
+    wirePut16(record, SW_BZ_MEAN, (uint16_t)bin.bzMean);
+    wirePut16(record, SW_BZ_MAX, (uint16_t)bin.bzMax);
+    wirePut16(record, SW_BY_MEAN, (uint16_t)bin.byMean);
+    wirePut16(record, SW_SPEED_MIN, bin.speedMin);
+    wirePut16(record, SW_SPEED_MEAN, bin.speedMean);
+    wirePut16(record, SW_SPEED_MAX, bin.speedMax);
+    wirePut16(record, SW_DENSITY_MEAN, bin.densityMean);
+    record[SW_MAG_SAMPLES] = bin.magSamples;
+    record[SW_PLASMA_SAMPLES] = bin.plasmaSamples;
+    record += SW_SIZE;
+  }
+}
+
+static void encodeFlares(WireWriter& writer) {
+  uint8_t* record = writer.section(BUNDLE_FLARES, FL_SIZE, flareEvents.count);
+  for (uint8_t i = 0; record != nullptr && i < flareEvents.count; i++, record += FL_SIZE) {
+    const FlareEvent& event = flareEvents.events[i];
+    wirePut32(record, FL_START, event.start);
+    wirePut32(record, FL_PEAK, event.peak);
+    wirePut32(record, FL_END, event.end);
+    wirePutF32(record, FL_PEAK_FLUX, event.peakFlux);
+    wirePutF32(record, FL_SHORT_PEAK_FLUX, event.shortPeakFlux);
+  }
+}
+
+static void encodeAlerts(WireWriter& writer) {
+  uint8_t* record = writer.section(BUNDLE_ALERTS, AL_SIZE, alertStore.count);
+  for (uint8_t i = 0; record != nullptr && i < alertStore.count; i++, record += AL_SIZE) {
+    const AlertEntry& entry = alertStore.entries[i];
+    wirePut32(record, AL_HASH, entry.hash);
+    wirePut32(record, AL_SERIAL, entry.serial);
+    wirePut32(record, AL_ISSUED, entry.issued);
+    wirePut32(record, AL_EXPIRES, entry.expires);
+    wirePut16(record, AL_TEXT_OFFSET, entry.textOffset);
+    wirePut16(record, AL_TEXT_LENGTH, entry.textLength);
+    putText(writer, record, AL_CODE, entry.code);
+    putText(writer, record, AL_SCALE, entry.scale);
+    record[AL_KIND] = entry.kind;
+    record[AL_TOPIC] = entry.topic;
+    record[AL_SEVERITY] = entry.severity;
+  }
+
+  record = writer.section(BUNDLE_ALERT_TEXT, 1, alertStore.textUsed);
+  if (record != nullptr) memcpy(record, alertStore.text, alertStore.textUsed);
+
+  // Unrolled from the ring so a store of another capacity keeps the newest
+  record = writer.section(BUNDLE_ALERT_RETIRED, 4, ALERT_CAPACITY);
+  for (uint8_t i = 0; record != nullptr && i < ALERT_CAPACITY; i++, record += 4) {
+    wirePut32(record, 0, alertStore.retired[(alertStore.retiredNext + i) % ALERT_CAPACITY]);
+  }
+}
+
+size_t bundleEncode(uint8_t* out, size_t size, uint32_t generated, const uint32_t updated[SRC_COUNT]) {
+  static char strings[BUNDLE_STRINGS_SIZE];  // Off the loop task's stack; one encoder at a time
+  WireWriter writer(out, size, strings, sizeof(strings), BUNDLE_SECTION_LAST);
+
+  uint8_t* record = writer.section(BUNDLE_SOURCES, 4, SRC_COUNT);
+  for (uint8_t source = 0; record != nullptr && source < SRC_COUNT; source++) {
+    wirePut32(record, 4 * source, updated[source]);
+  }
+
+  // A section goes in when any source filling it has data
+  bool oneCall = updated[SRC_ONECALL] != 0;
+  if (oneCall) encodeWeather(writer);
+  if (oneCall || updated[SRC_AIR_QUALITY] != 0) encodeAir(writer);
+  if (updated[SRC_KP_INDEX] || updated[SRC_SOLAR_WIND_MAG] || updated[SRC_SOLAR_WIND_PLASMA]) encodeSpace(writer);
+  if (updated[SRC_SOLAR_FLUX] || updated[SRC_GEOMAG_INDICES] || updated[SRC_XRAY] || updated[SRC_SOLAR_REGIONS] ||
+      updated[SRC_ALERTS]) {
+    encodeNoaa(writer);
+  }
+  if (updated[SRC_KP_FORECAST] != 0 || updated[SRC_OVATION] != 0) encodeAurora(writer, updated[SRC_OVATION] != 0);
+  if (updated[SRC_KP_FORECAST] != 0) encodeKpForecast(writer);
+  if (updated[SRC_SOLAR_WIND_MAG] != 0 || updated[SRC_SOLAR_WIND_PLASMA] != 0) encodeSolarWind(writer);
+  if (updated[SRC_XRAY] != 0) encodeFlares(writer);
+  if (updated[SRC_ALERTS] != 0) encodeAlerts(writer);
+  return writer.finish(generated);
+}
+
+// ============================================================================
+// Applying: wireOpen() has bounded every record and string, checkSections()
+// the values the globals rely on, so committing cannot fail half way
+// ============================================================================
+
+// Single-record sections are only used when present with a record
+static const uint8_t* single(const WireView& view, uint8_t kind) {
+  WireSection section = wireSection(view, kind);
+  return section.count > 0 ? section.records : nullptr;
+}
+
+static bool checkSections(const WireView& view) {
+  WireSection sources = wireSection(view, BUNDLE_SOURCES);
+  if (sources.records == nullptr) return false;
+
+  const uint8_t* nowcast = single(view, BUNDLE_NOWCAST);
+  if (nowcast != nullptr) {
+    int16_t probability = wireI16(nowcast, NOW_PROBABILITY);
+    if (probability < 0 || probability > 100) return false;
+  }
+
+  WireSection points = wireSection(view, BUNDLE_KP_FORECAST);
+  for (uint16_t i = 0; i < points.count; i++) {
+    const uint8_t* point = wireRecord(points, i);
+    if (wireU8(point, KPF_KP_TENTHS) > 90 || wireU8(point, KPF_SOURCE) > KP_PREDICTED) return false;
+  }
+
+  WireSection bins = wireSection(view, BUNDLE_SOLAR_WIND);
+  for (uint16_t i = 0; i < bins.count; i++) {
+    uint32_t start = wireU32(wireRecord(bins, i), SW_START);
+    if (start == 0 || start % SOLAR_WIND_BIN_SECONDS != 0) return false;
+  }
+
+  // Every kept entry has to find its message in the pool
+  WireSection alerts = wireSection(view, BUNDLE_ALERTS);
+  WireSection text = wireSection(view, BUNDLE_ALERT_TEXT);
+  if (text.records != nullptr && (text.recordSize != 1 || text.count > ALERT_TEXT_BUDGET)) return false;
+  for (uint16_t i = 0; i < alerts.count; i++) {
+    const uint8_t* entry = wireRecord(alerts, i);
+    if ((uint32_t)wireU16(entry, AL_TEXT_OFFSET) + wireU16(entry, AL_TEXT_LENGTH) > text.count) return false;
+  }
+  return true;
+}
+
+static void copyText(String& out, const char* value) {
+  char text[BUNDLE_TEXT_SIZE];
+  strlcpy(text, value, sizeof(text));
+  out = text;
+}
+
+// millis() the data would have been ingested at, given its age
+static unsigned long ingestStamp(uint32_t updated, uint32_t now) {
+  unsigned long age = now > updated ? (now - updated) * 1000UL : 0;
+  unsigned long current = millis();
+  return age < current ? current - age : 1;  // 0 means "never updated"
+}
+
+static void applyWeather(const WireView& view, unsigned long stamp) {
+  const uint8_t* record = single(view, BUNDLE_CURRENT);
+  if (record != nullptr) {
+    currentWeather.temperature = wireF32(record, CUR_TEMPERATURE);
+    currentWeather.humidity = wireI16(record, CUR_HUMIDITY);
+    currentWeather.pressure = wireF32(record, CUR_PRESSURE);
+    currentWeather.windSpeed = wireF32(record, CUR_WIND_SPEED);
+    currentWeather.windDirection = wireI16(record, CUR_WIND_DIRECTION);
+    copyText(currentWeather.description, wireString(view, record, CUR_DESCRIPTION));
+    copyText(currentWeather.icon, wireString(view, record, CUR_ICON));
+    copyText(currentWeather.cityName, wireString(view, record, CUR_CITY));
+    currentWeather.lastUpdate = stamp;
+  }
+
+  // A bundle with fewer rows than we keep leaves the rest as they were
+  WireSection hours = wireSection(view, BUNDLE_HOURLY);
+  for (uint16_t i = 0; i < hours.count && i < 12; i++) {
+    const uint8_t* row = wireRecord(hours, i);
+    HourlyForecast& hour = hourlyForecast.hours[i];
+    strlcpy(hour.time, wireString(view, row, HOUR_TIME), sizeof(hour.time));
+    hour.temperature = wireF32(row, HOUR_TEMPERATURE);
+    copyText(hour.icon, wireString(view, row, HOUR_ICON));
+    copyText(hour.description, wireString(view, row, HOUR_DESCRIPTION));
+    hour.precipChance = wireI16(row, HOUR_PRECIP);
+    hour.humidity = wireI16(row, HOUR_HUMIDITY);
+  }
+  if (hours.count > 0) hourlyForecast.lastUpdate = stamp;
+
+  WireSection days = wireSection(view, BUNDLE_DAILY);
+  for (uint16_t i = 0; i < days.count && i < 7; i++) {
+    const uint8_t* row = wireRecord(days, i);
+    DayForecast& day = weeklyForecast.days[i];
+    copyText(day.dayName, wireString(view, row, DAY_NAME));
+    day.tempHigh = wireF32(row, DAY_HIGH);
+    day.tempLow = wireF32(row, DAY_LOW);
+    copyText(day.icon, wireString(view, row, DAY_ICON));
+    copyText(day.description, wireString(view, row, DAY_DESCRIPTION));
+    day.precipChance = wireI16(row, DAY_PRECIP);
+  }
+  if (days.count > 0) weeklyForecast.lastUpdate = stamp;
+}
+
+static void applySolarWind(const WireView& view, bool mag, bool plasma) {
+  WireSection bins = wireSection(view, BUNDLE_SOLAR_WIND);
+  for (uint16_t i = 0; i < bins.count; i++) {
+    const uint8_t* record = wireRecord(bins, i);
+    uint32_t start = wireU32(record, SW_START);
+    uint8_t magSamples = wireU8(record, SW_MAG_SAMPLES);
+    uint8_t plasmaSamples = wireU8(record, SW_PLASMA_SAMPLES);
+    bool takeMag = mag && magSamples > 0;
+    bool takePlasma = plasma && plasmaSamples > 0;
+    if (!takeMag && !takePlasma) continue;
+
+    // Same slot rules as SolarWindBinner::flush()
+    SolarWindBin& bin = solarWind.bins[(start / SOLAR_WIND_BIN_SECONDS) % SOLAR_WIND_BINS];
+    if (bin.start != start) {
+      if (bin.start > start) continue;
+      memset(&bin, 0, sizeof(bin));
+      bin.start = start;
+    }
+    if (takeMag) {
+      bin.bzMin = wireI16(record, SW_BZ_MIN);
+      bin.bzMean = wireI16(record, SW_BZ_MEAN);
+      bin.bzMax = wireI16(record, SW_BZ_MAX);
+      bin.byMean = wireI16(record, SW_BY_MEAN);
+      bin.magSamples = magSamples;
+    }
+    if (takePlasma) {
+      bin.speedMin = wireU16(record, SW_SPEED_MIN);
+      bin.speedMean = wireU16(record, SW_SPEED_MEAN);
+      bin.speedMax = wireU16(record, SW_SPEED_MAX);
+      bin.densityMean = wireU16(record, SW_DENSITY_MEAN);
+      bin.plasmaSamples = plasmaSamples;
+    }
+  }
+}
+
+static void applyAlerts(const WireView& view) {
+  // Newest first, so a smaller store keeps the head
+  WireSection alerts = wireSection(view, BUNDLE_ALERTS);
+  uint8_t count = alerts.count < ALERT_CAPACITY ? alerts.count : ALERT_CAPACITY;
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t* record = wireRecord(alerts, i);
+    AlertEntry& entry = alertStore.entries[i];
+    entry.hash = wireU32(record, AL_HASH);
+    entry.serial = wireU32(record, AL_SERIAL);
+    entry.issued = wireU32(record, AL_ISSUED);
+    entry.expires = wireU32(record, AL_EXPIRES);
+    strlcpy(entry.code, wireString(view, record, AL_CODE), sizeof(entry.code));
+    strlcpy(entry.scale, wireString(view, record, AL_SCALE), sizeof(entry.scale));
+    entry.kind = wireU8(record, AL_KIND);
+    entry.topic = wireU8(record, AL_TOPIC);
+    entry.severity = wireU8(record, AL_SEVERITY);
+    entry.textOffset = wireU16(record, AL_TEXT_OFFSET);
+    entry.textLength = wireU16(record, AL_TEXT_LENGTH);
+  }
+  alertStore.count = count;
+  noaaSpaceWeather.alertCount = count;
+
+  WireSection text = wireSection(view, BUNDLE_ALERT_TEXT);
+  alertStore.textUsed = text.count;
+  if (text.count > 0) memcpy(alertStore.text, text.records, text.count);
+
+  // Oldest first: keep the newest that fit, the next write replaces the oldest
+  WireSection retired = wireSection(view, BUNDLE_ALERT_RETIRED);
+  uint16_t skip = retired.count > ALERT_CAPACITY ? retired.count - ALERT_CAPACITY : 0;
+  uint8_t kept = 0;
+  memset(alertStore.retired, 0, sizeof(alertStore.retired));
+  for (uint16_t i = skip; i < retired.count; i++) alertStore.retired[kept++] = wireU32(wireRecord(retired, i), 0);
+  alertStore.retiredNext = kept % ALERT_CAPACITY;
+}
+
+bool bundleApply(const uint8_t* data, size_t length, uint32_t now, uint32_t applied[SRC_COUNT], BundleInfo& info) {
+  memset(&info, 0, sizeof(info));
+  WireView view;
+  if (!wireOpen(view, data, length, bundleSchemas, bundleSchemaCount) || !checkSections(view)) return false;
+  info.generated = view.generated;
+
+  // Sources we do not have yet; a newer writer's extra sources are ignored
+  uint32_t updated[SRC_COUNT] = {0};
+  bool fresh[SRC_COUNT] = {false};
+  WireSection sources = wireSection(view, BUNDLE_SOURCES);
+  for (uint8_t source = 0; source < SRC_COUNT && source < sources.count; source++) {
+    updated[source] = wireU32(wireRecord(sources, source), 0);
+    fresh[source] = updated[source] > applied[source];
+  }
+
+  if (fresh[SRC_ONECALL]) applyWeather(view, ingestStamp(updated[SRC_ONECALL], now));
+
+  const uint8_t* record = single(view, BUNDLE_AIR);
+  if (record != nullptr && fresh[SRC_ONECALL]) {
+    airQuality.uvIndex = wireI16(record, AIR_UV_INDEX);  // OneCall fills these on the air quality screen
+    copyText(airQuality.uvRisk, wireString(view, record, AIR_UV_RISK));
+    airQuality.visibility = wireF32(record, AIR_VISIBILITY);
+  }
+  if (record != nullptr && fresh[SRC_AIR_QUALITY]) {
+    airQuality.aqi = wireI16(record, AIR_AQI);
+    copyText(airQuality.status, wireString(view, record, AIR_STATUS));
+    airQuality.co = wireF32(record, AIR_CO);
+    airQuality.no2 = wireF32(record, AIR_NO2);
+    airQuality.o3 = wireF32(record, AIR_O3);
+    airQuality.pm2_5 = wireF32(record, AIR_PM2_5);
+    airQuality.pm10 = wireF32(record, AIR_PM10);
+    airQuality.lastUpdate = ingestStamp(updated[SRC_AIR_QUALITY], now);
+  }
+
+  record = single(view, BUNDLE_SPACE);
+  if (record != nullptr && fresh[SRC_KP_INDEX]) currentSpaceWeather.kpIndex = wireF32(record, SPACE_KP);
+  if (record != nullptr && fresh[SRC_SOLAR_WIND_MAG]) {
+    currentSpaceWeather.magneticFieldBz = wireF32(record, SPACE_BZ);
+    currentSpaceWeather.magneticFieldBy = wireF32(record, SPACE_BY);
+    currentSpaceWeather.bzSouthwardMinutes = wireU16(record, SPACE_SOUTHWARD);
+  }
+  if (record != nullptr && fresh[SRC_SOLAR_WIND_PLASMA]) {
+    currentSpaceWeather.solarWindSpeed = wireF32(record, SPACE_SPEED);
+    currentSpaceWeather.solarWindDensity = wireF32(record, SPACE_DENSITY);
+  }
+  if (fresh[SRC_SOLAR_WIND_MAG] || fresh[SRC_SOLAR_WIND_PLASMA]) {
+    applySolarWind(view, fresh[SRC_SOLAR_WIND_MAG], fresh[SRC_SOLAR_WIND_PLASMA]);
+  }
+
+  record = single(view, BUNDLE_NOAA);
+  if (record != nullptr && fresh[SRC_SOLAR_FLUX]) noaaSpaceWeather.solarFluxIndex = wireF32(record, NOAA_FLUX);
+  if (record != nullptr && fresh[SRC_GEOMAG_INDICES]) noaaSpaceWeather.aIndex = wireF32(record, NOAA_A_INDEX);
+  if (record != nullptr && fresh[SRC_XRAY]) copyText(noaaSpaceWeather.xrayFlux, wireString(view, record, NOAA_XRAY));
+  if (record != nullptr && fresh[SRC_SOLAR_REGIONS]) {
+    noaaSpaceWeather.sunspotNumber = wireI16(record, NOAA_SUNSPOT_NUMBER);
+    noaaSpaceWeather.activeRegions = wireI16(record, NOAA_ACTIVE_REGIONS);
+    noaaSpaceWeather.sunspotArea = wireI32(record, NOAA_SUNSPOT_AREA);
+  }
+
+  if (fresh[SRC_XRAY]) {
+    // Oldest first: a smaller list keeps the most recent flares
+    WireSection flares = wireSection(view, BUNDLE_FLARES);
+    uint16_t skip = flares.count > FLARE_EVENT_CAPACITY ? flares.count - FLARE_EVENT_CAPACITY : 0;
+    uint8_t count = 0;
+    for (uint16_t i = skip; i < flares.count; i++) {
+      const uint8_t* event = wireRecord(flares, i);
+      FlareEvent& flare = flareEvents.events[count++];
+      flare.start = wireU32(event, FL_START);
+      flare.peak = wireU32(event, FL_PEAK);
+      flare.end = wireU32(event, FL_END);
+      flare.peakFlux = wireF32(event, FL_PEAK_FLUX);
+      flare.shortPeakFlux = wireF32(event, FL_SHORT_PEAK_FLUX);
+    }
+    flareEvents.count = count;
+  }
+
+  if (fresh[SRC_ALERTS]) applyAlerts(view);
+
+  if (fresh[SRC_KP_FORECAST]) {
+    WireSection points = wireSection(view, BUNDLE_KP_FORECAST);
+    uint16_t skip = points.count > KP_FORECAST_CAPACITY ? points.count - KP_FORECAST_CAPACITY : 0;
+    uint8_t count = 0;
+    for (uint16_t i = skip; i < points.count; i++) {
+      const uint8_t* point = wireRecord(points, i);
+      kpForecast.points[count].time = wireU32(point, KPF_TIME);
+      kpForecast.points[count].kpTenths = wireU8(point, KPF_KP_TENTHS);
+      kpForecast.points[count].source = wireU8(point, KPF_SOURCE);
+      count++;
+    }
+    kpForecast.count = count;
+  }
+
+  record = single(view, BUNDLE_NOWCAST);
+  if (record != nullptr && fresh[SRC_OVATION]) {
+    auroraNowcast.probability = wireI16(record, NOW_PROBABILITY);
+    auroraNowcast.polewardMax = wireI16(record, NOW_POLEWARD_MAX);
+    auroraNowcast.ovalEdgeLatitude = wireI16(record, NOW_OVAL_EDGE);
+    auroraNowcast.viewlineLatitude = wireI16(record, NOW_VIEWLINE);
+    strlcpy(auroraNowcast.forecastTime, wireString(view, record, NOW_FORECAST_TIME),
+            sizeof(auroraNowcast.forecastTime));
+    auroraNowcast.lastUpdate = ingestStamp(updated[SRC_OVATION], now);
+  }
+
+  for (uint8_t source = 0; source < SRC_COUNT; source++) {
+    if (!fresh[source]) continue;
+    applied[source] = updated[source];
+    info.updated[source] = updated[source];
+  }
+  return true;
+}
@@ -48,6 +48,46 @@
 // Common configuration that doesn't need to be secret
 #define RAPIDAPI_HOST "moon-phase.p.rapidapi.com"
 
+// ============================================================================
+// Time Zone - POSIX TZ rule for your location (override in config_local.h)
+// ============================================================================
+// Examples: "EST5EDT,M3.2.0,M11.1.0" (Eastern), "CST6CDT,M3.2.0,M11.1.0" (Central),
+//           "MST7MDT,M3.2.0,M11.1.0" (Mountain), "PST8PDT,M3.2.0,M11.1.0" (Pacific),
+//           "CET-1CEST,M3.5.0,M10.5.0/3" (Central Europe)
+#ifndef TIME_ZONE
+    #define TIME_ZONE "CST6CDT,M3.2.0,M11.1.0"
+#endif
+
+// ============================================================================
+// Locations - up to LOCATION_MAX places, cycled on the locations screen
+// (override in config_local.h); the first one is home and keeps the history
+// ============================================================================
+// Example: {"Madison, WI", 43.0731, -89.4012}, {"Fairbanks, AK", 64.8378, -147.7164, "AKST9AKDT,M3.2.0,M11.1.0"}
+// The optional fourth entry is that place's TZ rule, otherwise TIME_ZONE applies.
+// Only the first one is used with AGGREGATOR_URL, which serves a single site.
+#ifndef LOCATIONS
+    #define LOCATIONS {LOCATION_NAME, LATITUDE, LONGITUDE, nullptr}
+#endif
+#ifndef LOCATION_MAX
+    #define LOCATION_MAX 4              // Each extra one costs ~1.6 KB of RAM and 48 OpenWeather calls/day
+#endif
+#ifndef LOCATION_ACTIVE_WEIGHT
+    #define LOCATION_ACTIVE_WEIGHT 6    // Share of the call budget of the displayed location vs one in the background
+#endif
+#ifndef LOCATION_PARK_SIZE
+    #define LOCATION_PARK_SIZE 1536     // Bytes per location for its weather while not displayed
+#endif
+
+// ============================================================================
+// Aggregator - optional LAN server (src/aggregator/) that fetches every
+// upstream once for many stations (override in config_local.h)
+// ============================================================================
+// Example: "http://192.168.1.20:8080/bundle/home" - one request per refresh
+// instead of a dozen; empty fetches OpenWeather and NOAA directly
+#ifndef AGGREGATOR_URL
+    #define AGGREGATOR_URL ""
+#endif
+
 // ============================================================================
 // System Configuration (DO NOT CHANGE)
 // ============================================================================
@@ -59,13 +99,61 @@
 // Debug Configuration
 #define DEBUG_SERIAL true
 #define SERIAL_BAUD 115200
+#define EVENT_LOG_LEVEL 2               // 0=off, 1=errors, 2=info, 3=debug (adds per-frame timing)
+#define EVENT_LOG_CAPACITY 256          // Ring buffer records (power of two, 24 bytes each)
+#define EVENT_LOG_DRAIN_KEY 'l'         // Send this over Serial to print the event log
+#define EVENT_LOG_DUMP_KEY 'b'          // Send this over Serial to dump it as binary (tools/eventlog_decode.cpp)
+#define HISTORY_EXPORT_KEY 'h'          // Send this over Serial to dump the observation history as CSV
 
 // Network Configuration
 #define WIFI_TIMEOUT 20000              // 20 seconds
+#define WIFI_SETUP_WAIT 8000            // Longest setup() waits for the first connection, loop() keeps trying (ms)
+#define WIFI_CATCH_UP_OUTAGE 60000      // Refresh all data on reconnect after an outage this long (ms)
 #define HTTP_TIMEOUT 10000              // 10 seconds
+#define HTTP_CIRCUIT_OPEN -100          // fetch return code when the circuit breaker or the API quota skipped it
+#define UPSTREAM_STALE_AFTER 1800000    // Values not refreshed for this long are drawn as stale (ms)
+#define JSON_TOKEN_SIZE 64              // Longest string kept by the streaming JSON parser
+#define ALERT_MESSAGE_SIZE 2048         // Longest alert message text kept while streaming alerts.json
+#define QUOTA_OPENWEATHER_DAILY 600      // OneCall + air quality calls per UTC day (free tier allows 1000)
+#define QUOTA_OPENWEATHER_BURST 8       // Calls that may go out back to back before the daily rate applies
+#define QUOTA_SWPC_DAILY 3000           // SWPC has no published limit; ~2x a day of 10 minute refreshes
+#define QUOTA_SWPC_BURST 40
+#define FETCH_MAX_WORKERS 3             // Upstream fetches in flight at once, the loop task included
+#define FETCH_TLS_COST 45000            // Heap one HTTPS session needs (mbedTLS buffers + handshake), bytes
+#define FETCH_HEAP_RESERVE 40000        // Heap kept free for everything else while fetching in parallel
+#define FETCH_WORKER_STACK 10240        // Fetch task stack, the TLS handshake needs most of it
+#define CONNECTION_HOST_MAX 4           // Hosts whose TLS session and address are kept (~2 KB each with the peer cert)
+#define CONNECTION_DNS_TTL 3600         // Seconds a looked-up address is reused; lwIP keeps the record's TTL to itself
+// SWPC_BASE_URL can point at tools/swpc_standin.py to replay the fixtures over keep-alive TLS
+#ifndef SWPC_BASE_URL
+    #define SWPC_BASE_URL "https://services.swpc.noaa.gov"
+#endif
+#define LOCAL_API_PORT 80               // LAN HTTP API with the current snapshot (GET /api/snapshot)
+#define LOCAL_API_STACK 4096            // Local API task stack
+
+// Time Configuration (SNTP keeps the RTC in sync, the RTC is the time source)
+// NTP_SERVER_1 can point at tools/ntp_standin.py to test DST changes on the device
+#ifndef NTP_SERVER_1
+    #define NTP_SERVER_1 "pool.ntp.org"
+#endif
+#define NTP_SERVER_2 "time.nist.gov"
+#define NTP_SYNC_WAIT 5000              // Max wait for first sync during setup (ms)
+#define MIN_VALID_EPOCH 1700000000      // RTC times before this mean "not synced yet"
+#define TIME_STRING_SIZE 16             // Buffer size for the header clock ("12:59 PM")
+
+// Aurora Configuration
+#define AURORA_OVAL_THRESHOLD 10        // OVATION probability (%) counted as inside the oval
+#define AURORA_HORIZON_DISTANCE 8       // Degrees equatorward of the oval where it still shows on the horizon
+#define AURORA_NOWCAST_MAX_AGE 7200000  // Prefer the OVATION nowcast over Kp while younger than this (ms)
+#define BZ_SOUTHWARD_THRESHOLD 0.0      // 5-minute mean Bz (nT) below which the IMF counts as southward
+#define FLARE_MIN_FLUX 1e-6             // Smallest flare peak kept (W/m2, 1e-6 = C1)
+
+// History Configuration
+#define PRESSURE_TENDENCY_STEADY 1.0    // 3-hour pressure change (hPa) below which the tendency shows steady
+#define HISTORY_GRAPH_SPAN 604800       // Longest window plotted on the history screen (s)
 
 // Screen Configuration
-#define TOTAL_SCREENS 8
+#define TOTAL_SCREENS 11
 
 // Screen constants (for main.cpp compatibility)
 #define SCREEN_WEATHER 0
@@ -76,6 +164,9 @@
 #define SCREEN_SPACE_WEATHER 5
 #define SCREEN_AURORA_TODAY 6
 #define SCREEN_AURORA_TOMORROW 7
+#define SCREEN_HISTORY 8
+#define SCREEN_ALERTS 9
+#define SCREEN_LOCATIONS 10
 
 // Alternative screen names
 #define CURRENT_WEATHER_SCREEN 0
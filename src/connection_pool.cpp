@@ -0,0 +1,321 @@
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+#include <lwip/sockets.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ssl_internal.h>
+#include <errno.h>
+#include <string.h>
+#include "config.h"
+#include "connection_pool.h"
+
+#define CONNECTION_HOST_SIZE 40
+
+// A host's address and TLS session outlive its connections, so the next
+// refresh skips the lookup and resumes with an abbreviated handshake
+struct HostCache {
+  char host[CONNECTION_HOST_SIZE];   // Empty = unused; a station talks to two or three hosts
+  uint32_t address;                  // IPv4, network order, 0 = look it up
+  unsigned long resolvedAt;
+  mbedtls_ssl_session session;
+  bool hasSession;
+  bool busy;                         // Session being copied in or out
+};
+
+// WiFiClientSecure whose connect() offers the host's saved session and
+// uses its cached address. The rest (reads, writes, stop()) is the stock
+// client's, which keeps its socket and mbedTLS state in sslclient. Written
+// against the 2.x core (mbedTLS 2.28) that the espressif32 platform brings.
+class ResumingClient : public WiFiClientSecure {
+public:
+  using WiFiClientSecure::connect;
+  int connect(const char* host, uint16_t port) override;
+private:
+  bool openSocket(uint32_t address, uint16_t port);
+};
+
+struct ConnectionSlot {
+  ResumingClient* client;     // Created on first use, kept for the slot's lifetime
+  char host[CONNECTION_HOST_SIZE];
+  unsigned long lastUsed;
+  bool busy;
+};
+
+static ConnectionSlot slots[FETCH_MAX_WORKERS];
+static HostCache hosts[CONNECTION_HOST_MAX];
+static ConnectionStats stats = {0, 0, 0};
+static portMUX_TYPE slotLock = portMUX_INITIALIZER_UNLOCKED;  // Held only for the table, never across I/O
+
+// "https://host[:port]/path" -> host; false for other schemes or overlong hosts
+static bool urlHost(const char* url, char* host, size_t size) {
+  static const char scheme[] = "https://";
+  if (strncmp(url, scheme, sizeof(scheme) - 1) != 0) return false;
+  const char* start = url + sizeof(scheme) - 1;
+  size_t length = strcspn(start, ":/");
+  if (length == 0 || length >= size) return false;
+  memcpy(host, start, length);
+  host[length] = '\0';
+  return true;
+}
+
+// Entry for host, claiming a free one if create is set; -1 if none.
+// Called with slotLock held. Entries are never reassigned.
+static int8_t hostEntry(const char* host, bool create) {
+  for (uint8_t i = 0; i < CONNECTION_HOST_MAX; i++) {
+    if (strcmp(hosts[i].host, host) == 0) return i;
+    if (hosts[i].host[0] == '\0') {
+      if (!create) return -1;
+      strlcpy(hosts[i].host, host, sizeof(hosts[i].host));
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Cached address while younger than CONNECTION_DNS_TTL, else a fresh lookup
+static uint32_t hostAddress(const char* host) {
+  portENTER_CRITICAL(&slotLock);
+  int8_t entry = hostEntry(host, false);
+  uint32_t address = 0;
+  if (entry >= 0 && millis() - hosts[entry].resolvedAt < CONNECTION_DNS_TTL * 1000UL) {
+    address = hosts[entry].address;
+  }
+  portEXIT_CRITICAL(&slotLock);
+  if (address != 0) return address;
+
+  IPAddress resolved;
+  if (!WiFi.hostByName(host, resolved)) return 0;
+  address = (uint32_t)resolved;
+  portENTER_CRITICAL(&slotLock);
+  entry = hostEntry(host, true);
+  if (entry >= 0) {
+    hosts[entry].address = address;
+    hosts[entry].resolvedAt = millis();
+  }
+  portEXIT_CRITICAL(&slotLock);
+  return address;
+}
+
+// A failed connect may mean the host moved, so the next one looks it up again
+static void hostForget(const char* host) {
+  portENTER_CRITICAL(&slotLock);
+  int8_t entry = hostEntry(host, false);
+  if (entry >= 0) hosts[entry].address = 0;
+  portEXIT_CRITICAL(&slotLock);
+}
+
+// Claims the host's entry for copying its session; -1 when there is none,
+// or another task is copying it (that connect just does a full handshake)
+static int8_t sessionClaim(const char* host, bool needSession) {
+  portENTER_CRITICAL(&slotLock);
+  int8_t entry = hostEntry(host, !needSession);
+  if (entry >= 0 && (hosts[entry].busy || (needSession && !hosts[entry].hasSession))) entry = -1;
+  if (entry >= 0) hosts[entry].busy = true;
+  portEXIT_CRITICAL(&slotLock);
+  return entry;
+}
+
+static void sessionRelease(int8_t entry) {
+  portENTER_CRITICAL(&slotLock);
+  hosts[entry].busy = false;
+  portEXIT_CRITICAL(&slotLock);
+}
+
+// Non-blocking connect bounded by the client's timeout, like start_ssl_client()
+bool ResumingClient::openSocket(uint32_t address, uint16_t port) {
+  int fd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return false;
+  sslclient->socket = fd;
+  struct sockaddr_in server;
+  memset(&server, 0, sizeof(server));
+  server.sin_family = AF_INET;
+  server.sin_addr.s_addr = address;
+  server.sin_port = htons(port);
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  if (lwip_connect(fd, (struct sockaddr*)&server, sizeof(server)) < 0 && errno != EINPROGRESS) return false;
+
+  int timeout = _timeout > 0 ? _timeout : 30000;
+  struct timeval tv = {timeout / 1000, (timeout % 1000) * 1000};
+  fd_set writable;
+  FD_ZERO(&writable);
+  FD_SET(fd, &writable);
+  if (select(fd + 1, nullptr, &writable, nullptr, &tv) <= 0) return false;
+  int error = 0;
+  socklen_t length = sizeof(error);
+  if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) return false;
+
+  int enable = 1;
+  lwip_setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  lwip_setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  lwip_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+  lwip_setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+  return true;
+}
+
+// start_ssl_client() for setInsecure() clients, with the saved session set
+// between mbedtls_ssl_setup() and the handshake where it has no hook
+int ResumingClient::connect(const char* host, uint16_t port) {
+  stop();
+  sslclient->socket = -1;  // stop() leaves 0, a valid descriptor
+  uint32_t address = hostAddress(host);
+  if (address == 0) return 0;
+  if (!openSocket(address, port)) {
+    hostForget(host);
+    stop();
+    return 0;
+  }
+
+  sslclient_context* tls = sslclient;
+  static const char personalization[] = "connection_pool";
+  mbedtls_ssl_init(&tls->ssl_ctx);
+  mbedtls_ssl_config_init(&tls->ssl_conf);
+  mbedtls_ctr_drbg_init(&tls->drbg_ctx);
+  mbedtls_entropy_init(&tls->entropy_ctx);
+  int result = mbedtls_ctr_drbg_seed(&tls->drbg_ctx, mbedtls_entropy_func, &tls->entropy_ctx,
+                                     (const unsigned char*)personalization, sizeof(personalization) - 1);
+  if (result == 0) {
+    result = mbedtls_ssl_config_defaults(&tls->ssl_conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                         MBEDTLS_SSL_PRESET_DEFAULT);
+  }
+  if (result == 0) {
+    mbedtls_ssl_conf_authmode(&tls->ssl_conf, MBEDTLS_SSL_VERIFY_NONE);
+    mbedtls_ssl_conf_rng(&tls->ssl_conf, mbedtls_ctr_drbg_random, &tls->drbg_ctx);
+    result = mbedtls_ssl_setup(&tls->ssl_ctx, &tls->ssl_conf);
+  }
+  if (result == 0) result = mbedtls_ssl_set_hostname(&tls->ssl_ctx, host);
+
+  // Offer the last session; a server that forgot it just does a full handshake
+  int8_t entry = result == 0 ? sessionClaim(host, true) : -1;
+  if (entry >= 0) {
+    mbedtls_ssl_set_session(&tls->ssl_ctx, &hosts[entry].session);
+    sessionRelease(entry);
+  }
+
+  // mbedtls_ssl_handshake() one step at a time, to see whether the server
+  // accepted the session before the handshake state is freed
+  bool resumed = false;
+  if (result == 0) {
+    mbedtls_ssl_set_bio(&tls->ssl_ctx, &tls->socket, mbedtls_net_send, mbedtls_net_recv, nullptr);
+    unsigned long start = millis();
+    while (tls->ssl_ctx.state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+      result = mbedtls_ssl_handshake_step(&tls->ssl_ctx);
+      if (tls->ssl_ctx.handshake != nullptr && tls->ssl_ctx.handshake->resume) resumed = true;
+      if (result == 0) continue;
+      if (result != MBEDTLS_ERR_SSL_WANT_READ && result != MBEDTLS_ERR_SSL_WANT_WRITE) break;
+      if (millis() - start > tls->handshake_timeout) break;
+      result = 0;
+      delay(2);
+    }
+  }
+  if (result != 0) {
+    _lastError = result;
+    stop();
+    return 0;
+  }
+
+  // Saved now rather than when the connection closes, since a body read
+  // short or a host switch closes it too
+  entry = sessionClaim(host, false);
+  if (entry >= 0) {
+    mbedtls_ssl_session& saved = hosts[entry].session;
+    mbedtls_ssl_session_free(&saved);
+    mbedtls_ssl_session_init(&saved);
+    hosts[entry].hasSession = mbedtls_ssl_get_session(&tls->ssl_ctx, &saved) == 0;
+    sessionRelease(entry);
+  }
+  if (resumed) {
+    portENTER_CRITICAL(&slotLock);
+    stats.resumed++;
+    portEXIT_CRITICAL(&slotLock);
+  }
+  _connected = true;
+  return 1;
+}
+
+WiFiClientSecure* connectionAcquire(const char* url, bool& reused) {
+  reused = false;
+  char host[CONNECTION_HOST_SIZE];
+  if (!urlHost(url, host, sizeof(host))) return nullptr;
+
+  // Prefer an idle connection to the same host, then an unused slot, then
+  // the least recently used idle one
+  int8_t pick = -1;
+  bool sameHost = false;
+  portENTER_CRITICAL(&slotLock);
+  for (uint8_t i = 0; i < FETCH_MAX_WORKERS; i++) {
+    ConnectionSlot& slot = slots[i];
+    if (slot.busy) continue;
+    if (slot.client != nullptr && strcmp(slot.host, host) == 0) {
+      pick = i;
+      sameHost = true;
+      break;
+    }
+    if (pick < 0 || slot.client == nullptr ||
+        (slots[pick].client != nullptr && slot.lastUsed < slots[pick].lastUsed)) {
+      pick = i;
+    }
+  }
+  if (pick >= 0) slots[pick].busy = true;
+  portEXIT_CRITICAL(&slotLock);
+  if (pick < 0) return nullptr;
+
+  // The slot is ours now, so the network calls happen outside the lock
+  ConnectionSlot& slot = slots[pick];
+  if (slot.client == nullptr) {
+    slot.client = new ResumingClient();
+    slot.client->setInsecure();  // Same as HTTPClient's own TLS client without a CA
+  }
+  reused = sameHost && slot.client->connected();
+  if (!reused) {
+    slot.client->stop();  // Another host, or the server closed it
+    strlcpy(slot.host, host, sizeof(slot.host));
+  }
+
+  portENTER_CRITICAL(&slotLock);
+  stats.requests++;
+  if (!reused) stats.handshakes++;
+  portEXIT_CRITICAL(&slotLock);
+  return slot.client;
+}
+
+int connectionGet(HTTPClient& http, WiFiClientSecure* client, bool reused) {
+  int httpCode = http.GET();
+  if (httpCode < 0 && reused) {
+    client->stop();
+    portENTER_CRITICAL(&slotLock);
+    stats.handshakes++;
+    portEXIT_CRITICAL(&slotLock);
+    httpCode = http.GET();
+  }
+  return httpCode;
+}
+
+void connectionRelease(WiFiClientSecure* client, bool reusable) {
+  if (client == nullptr) return;
+  // An unread or half-read body would be taken for the next response
+  if (!reusable) client->stop();
+  for (uint8_t i = 0; i < FETCH_MAX_WORKERS; i++) {
+    if (slots[i].client != client) continue;
+    portENTER_CRITICAL(&slotLock);
+    slots[i].lastUsed = millis();
+    slots[i].busy = false;
+    portEXIT_CRITICAL(&slotLock);
+    return;
+  }
+}
+
+// Frees the connections between refreshes; called when no fetch is running.
+// The hosts' sessions and addresses stay for the next refresh.
+ConnectionStats connectionCloseAll() {
+  for (uint8_t i = 0; i < FETCH_MAX_WORKERS; i++) {
+    if (slots[i].client != nullptr) slots[i].client->stop();
+    slots[i].host[0] = '\0';
+  }
+  ConnectionStats result = stats;
+  stats.requests = 0;
+  stats.handshakes = 0;
+  stats.resumed = 0;
+  return result;
+}
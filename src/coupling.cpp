@@ -0,0 +1,112 @@
+#include "coupling.h"
+#include <math.h>
+
+// Newell et al. Kp regression on the coupling function and viscous term
+#define KP_INTERCEPT 0.05f
+#define KP_PER_COUPLING 2.244e-4f
+#define KP_PER_VISCOUS 2.844e-6f
+
+// O'Brien & McPherron (2000) ring current model, Dst = Dst* + b sqrt(P) - c
+#define DST_INJECTION -4.4f      // nT/h per mV/m of VBs above the threshold
+#define DST_VBS_THRESHOLD 0.49f  // mV/m
+#define DST_PRESSURE_B 7.26f     // nT/sqrt(nPa)
+#define DST_PRESSURE_C 11.0f     // nT
+#define PROTON_MASS_FACTOR 1.6726e-6f  // n [cm-3] * v^2 [km/s] -> nPa
+
+// Dst levels reached at each Kp on average (NOAA G-scale correspondence)
+static const float DST_TABLE[][2] = {
+  {-30.0f, 4.0f}, {-50.0f, 5.0f}, {-100.0f, 7.0f}, {-250.0f, 9.0f}
+};
+
+float newellCoupling(float speed, float by, float bz) {
+  float bt = sqrtf(by * by + bz * bz);
+  if (bt <= 0 || speed <= 0) return 0;
+  float clockAngle = atan2f(by, bz);  // 0 = due north, pi = due south
+  float halfSine = fabsf(sinf(clockAngle / 2));
+  return powf(speed, 4.0f / 3.0f) * powf(bt, 2.0f / 3.0f) * powf(halfSine, 8.0f / 3.0f);
+}
+
+void CouplingEngine::reset() {
+  lastTime = 0;
+  couplingMean = 0;
+  viscousMean = 0;
+  dstStar = 0;
+  dstEstimate = 0;
+}
+
+void CouplingEngine::step(uint32_t time, float speed, float density, float by, float bz) {
+  float coupling = newellCoupling(speed, by, bz);
+  float viscous = sqrtf(density) * speed * speed;
+  float pressure = PROTON_MASS_FACTOR * density * speed * speed;
+
+  // Ring current injection from the dawn-dusk electric field VBs (mV/m)
+  float vbs = bz < 0 ? speed * -bz * 1e-3f : 0;
+  float injection = vbs > DST_VBS_THRESHOLD ? DST_INJECTION * (vbs - DST_VBS_THRESHOLD) : 0;
+  float tauHours = 2.40f * expf(9.74f / (4.69f + vbs));
+
+  if (lastTime == 0) {
+    couplingMean = coupling;
+    viscousMean = viscous;
+  } else if (time > lastTime) {
+    float dt = (float)(time - lastTime);
+    float alpha = 1 - expf(-dt / COUPLING_TAU);
+    couplingMean += alpha * (coupling - couplingMean);
+    viscousMean += alpha * (viscous - viscousMean);
+
+    // Exact solution of dDst*/dt = Q - Dst*/tau for Q constant over the step
+    float equilibrium = injection * tauHours;
+    dstStar = equilibrium + (dstStar - equilibrium) * expf(-dt / 3600.0f / tauHours);
+  } else {
+    return;  // Out of order
+  }
+
+  dstEstimate = dstStar + DST_PRESSURE_B * sqrtf(pressure) - DST_PRESSURE_C;
+  lastTime = time;
+}
+
+uint16_t CouplingEngine::update(const SolarWindSeries& series) {
+  // Newest bin carrying both products
+  uint32_t newest = 0;
+  for (uint16_t i = 0; i < SOLAR_WIND_BINS; i++) {
+    const SolarWindBin& bin = series.bins[i];
+    if (bin.magSamples && bin.plasmaSamples && bin.start > newest) newest = bin.start;
+  }
+  if (newest == 0) return 0;
+
+  uint32_t oldest = newest - (SOLAR_WIND_BINS - 1) * SOLAR_WIND_BIN_SECONDS;
+  uint32_t start = lastTime >= oldest ? lastTime + SOLAR_WIND_BIN_SECONDS : oldest;
+
+  uint16_t steps = 0;
+  for (uint32_t binStart = start; binStart < newest; binStart += SOLAR_WIND_BIN_SECONDS) {
+    const SolarWindBin* bin = solarWindBinAt(series, binStart);
+    if (!bin || !bin->magSamples || !bin->plasmaSamples) continue;
+    step(binStart, bin->speedMean, bin->densityMean / 100.0f, bin->byMean / 10.0f, bin->bzMean / 10.0f);
+    steps++;
+  }
+  return steps;
+}
+
+float CouplingEngine::kpEquivalent() const {
+  if (!valid()) return 0;
+  float kp = KP_INTERCEPT + KP_PER_COUPLING * couplingMean + KP_PER_VISCOUS * viscousMean;
+
+  // A deep ring current keeps the oval expanded into the recovery phase
+  // after the driving has stopped, which the hour-mean coupling misses
+  const uint8_t entries = sizeof(DST_TABLE) / sizeof(DST_TABLE[0]);
+  float dstKp = 0;
+  if (dstEstimate <= DST_TABLE[entries - 1][0]) {
+    dstKp = DST_TABLE[entries - 1][1];
+  } else {
+    for (uint8_t i = 1; i < entries; i++) {
+      if (dstEstimate <= DST_TABLE[i - 1][0] && dstEstimate > DST_TABLE[i][0]) {
+        float fraction = (dstEstimate - DST_TABLE[i - 1][0]) / (DST_TABLE[i][0] - DST_TABLE[i - 1][0]);
+        dstKp = DST_TABLE[i - 1][1] + fraction * (DST_TABLE[i][1] - DST_TABLE[i - 1][1]);
+        break;
+      }
+    }
+  }
+  if (dstKp > kp) kp = dstKp;
+
+  if (kp < 0) return 0;
+  return kp > 9 ? 9 : kp;
+}
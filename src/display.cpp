@@ -1,6 +1,10 @@
 #include "display.h"
 #include "weather.h"
-#include <WiFi.h>
+#include "eventlog.h"
+#include "timezone.h"
+#include "wifi_link.h"
+#include "upstream.h"
+#include "locations.h"
 
 extern TFT_eSPI tft;
 
@@ -152,12 +156,12 @@ void displayMessage(String message) {
 
 void updateDisplay() {
   static unsigned long lastDisplayUpdate = 0;
-  static String lastDisplayedTime = "";
+  static char lastDisplayedTime[TIME_STRING_SIZE] = "";
   
   // Update display every 5 seconds OR when time changes OR on startup OR when forced
-  extern String currentTime;
+  extern char currentTime[];
   extern bool forceDisplayUpdate;
-  bool timeChanged = (currentTime != lastDisplayedTime);
+  bool timeChanged = (strcmp(currentTime, lastDisplayedTime) != 0);
   static bool firstRun = true;
   
   if (millis() - lastDisplayUpdate < 5000 && !timeChanged && !firstRun && !forceDisplayUpdate) {
@@ -165,7 +169,7 @@ void updateDisplay() {
   }
   
   firstRun = false;
-  lastDisplayedTime = currentTime;
+  strlcpy(lastDisplayedTime, currentTime, sizeof(lastDisplayedTime));
   
   drawBackground();
   
@@ -210,6 +214,10 @@ void updateDisplay() {
     drawHumidity(5, 95, currentWeather.humidity);  // Moved down to 95
     drawPressure(120, 105, currentWeather.pressure); // Aligned with wind at y=105
     drawWind(5, 105, currentWeather.windSpeed, currentWeather.windDirection); // Moved up from 110 to 105
+    if (activeLocation == 0) { // Both come from home's history, not this location's
+      drawTodayRange(60, 95);
+      drawPressureTendency(200, 105);
+    }
     
     // Add standardized update time and WiFi status
     drawUpdateTime(currentWeather.lastUpdate);
@@ -285,6 +293,35 @@ void drawPressure(int x, int y, float pressure) {
   tft.drawString(pressureStr, x, y);
 }
 
+// Today's high/low so far from the daily rollup
+void drawTodayRange(int x, int y) {
+  const RollupBucket* today = rollups[HISTORY_TEMPERATURE].day(0);
+  time_t now = time(nullptr);
+  if (!today || now < (time_t)today->start || now >= (time_t)today->end) return;
+  
+  tft.setTextColor(COLOR_TEMP, COLOR_BACKGROUND);
+  tft.setTextDatum(TL_DATUM);
+  tft.setTextSize(1);
+  
+  char rangeStr[24];
+  snprintf(rangeStr, sizeof(rangeStr), "Hi %d Lo %d", (int)lroundf(today->max), (int)lroundf(today->min));
+  tft.drawString(rangeStr, x, y);
+}
+
+// Three hour pressure tendency (rising/falling/steady), blank until 3 h of data
+void drawPressureTendency(int x, int y) {
+  float change;
+  if (!rollupChange(rollups[HISTORY_PRESSURE], time(nullptr), 3 * 3600, change)) return;
+  
+  tft.setTextColor(COLOR_PRESSURE, COLOR_BACKGROUND);
+  tft.setTextDatum(TL_DATUM);
+  tft.setTextSize(1);
+  
+  // WMO treats under 1 hPa per 3 hours as steady
+  const char* tendency = change >= PRESSURE_TENDENCY_STEADY ? "^" : (change <= -PRESSURE_TENDENCY_STEADY ? "v" : "-");
+  tft.drawString(tendency, x, y);
+}
+
 void drawWind(int x, int y, float speed, int direction) {
   tft.setTextColor(COLOR_WIND, COLOR_BACKGROUND);
   tft.setTextDatum(TL_DATUM);
@@ -298,12 +335,12 @@ void drawWind(int x, int y, float speed, int direction) {
 
 void updateAstronomyDisplay() {
   static unsigned long lastAstronomyUpdate = 0;
-  static String lastAstronomyTime = "";
+  static char lastAstronomyTime[TIME_STRING_SIZE] = "";
   
   // Update display every 5 seconds OR when time changes OR on startup OR when forced
-  extern String currentTime;
+  extern char currentTime[];
   extern bool forceDisplayUpdate;
-  bool timeChanged = (currentTime != lastAstronomyTime);
+  bool timeChanged = (strcmp(currentTime, lastAstronomyTime) != 0);
   static bool firstAstronomyRun = true;
   
   if (millis() - lastAstronomyUpdate < 5000 && !timeChanged && !firstAstronomyRun && !forceDisplayUpdate) {
@@ -311,7 +348,7 @@ void updateAstronomyDisplay() {
   }
   
   firstAstronomyRun = false;
-  lastAstronomyTime = currentTime;
+  strlcpy(lastAstronomyTime, currentTime, sizeof(lastAstronomyTime));
   
   drawBackground();
   
@@ -323,8 +360,10 @@ void updateAstronomyDisplay() {
   tft.setTextSize(1);
   tft.setTextDatum(TL_DATUM);
   
-  // Check if we have astronomical data
-  if (currentWeather.sunrise > 0) {
+  // Check if the ephemeris has run (needs a synced clock)
+  if (currentWeather.moonPhaseName.length() > 0) {
+    char timeBuffer[TIME_STRING_SIZE];
+
     // Use larger text size for better readability
     tft.setTextSize(2);
     
@@ -333,14 +372,16 @@ void updateAstronomyDisplay() {
     tft.setTextColor(COLOR_TEMP, COLOR_BACKGROUND);
     tft.drawString("Sunrise:", 25, 40);
     tft.setTextColor(COLOR_TEXT, COLOR_BACKGROUND);
-    tft.drawString(formatTime(currentWeather.sunrise), 25, 55);
+    formatEventTime(currentWeather.sunrise, timeBuffer, sizeof(timeBuffer));
+    tft.drawString(timeBuffer, 25, 55);
     
     // Sunset - aligned with moonset
     drawSmallIcon(5, 75, "sunset");
     tft.setTextColor(COLOR_TEMP, COLOR_BACKGROUND);
     tft.drawString("Sunset:", 25, 75);
     tft.setTextColor(COLOR_TEXT, COLOR_BACKGROUND);
-    tft.drawString(formatTime(currentWeather.sunset), 25, 90);
+    formatEventTime(currentWeather.sunset, timeBuffer, sizeof(timeBuffer));
+    tft.drawString(timeBuffer, 25, 90);
     
     // Right column for moon data - aligned with sun data
     tft.setTextSize(2); // Match sunrise/sunset text size
@@ -351,7 +392,8 @@ void updateAstronomyDisplay() {
       tft.setTextColor(COLOR_HUMIDITY, COLOR_BACKGROUND);
       tft.drawString("Moonrise:", 180, 40);
       tft.setTextColor(COLOR_TEXT, COLOR_BACKGROUND);
-      tft.drawString(formatTime(currentWeather.moonrise), 180, 55);
+      formatEventTime(currentWeather.moonrise, timeBuffer, sizeof(timeBuffer));
+      tft.drawString(timeBuffer, 180, 55);
     }
     
     // Moonset (if available) - aligned with sunset
@@ -360,16 +402,15 @@ void updateAstronomyDisplay() {
       tft.setTextColor(COLOR_HUMIDITY, COLOR_BACKGROUND);
       tft.drawString("Moonset:", 180, 75);
       tft.setTextColor(COLOR_TEXT, COLOR_BACKGROUND);
-      tft.drawString(formatTime(currentWeather.moonset), 180, 90);
+      formatEventTime(currentWeather.moonset, timeBuffer, sizeof(timeBuffer));
+      tft.drawString(timeBuffer, 180, 90);
     }
     
     // Moon phase display - positioned between sunrise/sunset and moonrise/moonset
     if (currentWeather.moonPhaseName.length() > 0) {
-      Serial.println("Displaying simple moon graphic for phase: " + currentWeather.moonPhaseName);
       drawMoonPhaseBitmap(115, 60); // Centered horizontally, positioned between sun and moon times
     } else {
       // Fallback to simple graphic moon
-      Serial.println("No moon data available, using fallback graphic");
       drawMoonPhase(115, 60);
     }
     
@@ -417,25 +458,13 @@ void updateAstronomyDisplay() {
   }
 }
 
-String formatTime(unsigned long timestamp) {
-  // The timestamp from OpenWeatherMap is already in UTC
-  // We need to convert it to local time
-  // Adjust timezone offset as needed for your location
-  // Let's assume daylight saving time for now (October should be CDT)
-  timestamp -= 5 * 3600; // Adjust for Central Daylight Time (UTC-5)
-  
-  int hours = (timestamp % 86400) / 3600;
-  int minutes = (timestamp % 3600) / 60;
-  
-  String ampm = hours >= 12 ? "PM" : "AM";
-  if (hours > 12) hours -= 12;
-  if (hours == 0) hours = 12;
-  
-  String timeStr = String(hours) + ":";
-  if (minutes < 10) timeStr += "0";
-  timeStr += String(minutes) + ampm;
-  
-  return timeStr;
+void formatEventTime(unsigned long timestamp, char* buffer, size_t size) {
+  // Unix timestamps are converted with the configured TIME_ZONE rule, 0 means no event today
+  if (timestamp == 0) {
+    strlcpy(buffer, "--", size);
+  } else {
+    formatClockCompact(timestamp, buffer, size);
+  }
 }
 
 void drawWeatherIconLarge(int x, int y, String iconCode) {
@@ -448,24 +477,6 @@ void drawWeatherIconLarge(int x, int y, String iconCode) {
   time_t now;
   time(&now);
   
-  // Debug output
-  Serial.print("Current time: "); Serial.println(now);
-  Serial.print("Sunrise: "); Serial.println(currentWeather.sunrise);
-  Serial.print("Sunset: "); Serial.println(currentWeather.sunset);
-  Serial.print("Icon code: "); Serial.println(iconCode);
-  
-  // Convert to readable times for debug
-  if (currentWeather.sunrise > 0) {
-    struct tm* sr = localtime((time_t*)&currentWeather.sunrise);
-    Serial.printf("Sunrise: %02d:%02d\n", sr->tm_hour, sr->tm_min);
-  }
-  if (currentWeather.sunset > 0) {
-    struct tm* ss = localtime((time_t*)&currentWeather.sunset);
-    Serial.printf("Sunset: %02d:%02d\n", ss->tm_hour, ss->tm_min);
-  }
-  struct tm* ct = localtime(&now);
-  Serial.printf("Current: %02d:%02d\n", ct->tm_hour, ct->tm_min);
-  
   // Check if current time is between sunset and sunrise (nighttime)
   bool isNightTime = false;
   if (currentWeather.sunset > 0 && currentWeather.sunrise > 0) {
@@ -473,25 +484,22 @@ void drawWeatherIconLarge(int x, int y, String iconCode) {
     isNightTime = (now < currentWeather.sunrise || now > currentWeather.sunset);
   }
   
-  Serial.print("Is night time: "); Serial.println(isNightTime ? "YES" : "NO");
-  
   // Strip the day/night indicator from icon code for consistent logic
   String baseIcon = iconCode;
   if (baseIcon.length() >= 3) {
     baseIcon = baseIcon.substring(0, 2); // Remove 'd' or 'n' suffix
   }
   
-  Serial.print("Base icon code: "); Serial.println(baseIcon);
-  
   // FORCE DAY MODE FOR TESTING - Override the night logic using actual sunrise/sunset times
   if (currentWeather.sunrise > 0 && currentWeather.sunset > 0) {
     // Use actual sunrise/sunset times for forced day mode
     if (now >= currentWeather.sunrise && now <= currentWeather.sunset) {
       isNightTime = false;
-      Serial.println("FORCED DAY MODE (Between actual sunrise and sunset)");
     }
   }
   
+  LOG_DEBUG(EV_ICON_DRAWN, isNightTime, iconCode.length() >= 2 ? (iconCode[0] << 8) | iconCode[1] : 0);
+  
   if (baseIcon.startsWith("01")) {
     // Clear sky - Sun during day, Moon at night
     if (isNightTime) {
@@ -618,11 +626,9 @@ void drawWeatherIconLarge(int x, int y, String iconCode) {
 }
 
 void drawMoonPhase(int x, int y) {
-  // Calculate moon phase with realistic lunar cycle
+  // Moon phase from the ephemeris: 0 = new moon, 0.5 = full moon
   extern WeatherData currentWeather;
-  unsigned long currentTime = millis() / 1000 + 1697900000;
-  unsigned long daysSinceNewMoon = (currentTime / 86400) % 29;
-  float phase = (float)daysSinceNewMoon / 29.0; // 0 = new moon, 0.5 = full moon
+  float phase = currentWeather.moonPhase;
   
   // Draw realistic moon phases with proper lighting effects (50x50px)
   int radius = 22;
@@ -775,15 +781,20 @@ void drawSmallIcon(int x, int y, String iconType) {
   }
 }
 
+// Values whose endpoint has not delivered for UPSTREAM_STALE_AFTER are drawn gray
+static bool sourceStale(LogSource source) {
+  return endpointStale(upstreamHealth[source], millis(), UPSTREAM_STALE_AFTER);
+}
+
 void updateSpaceWeatherDisplay() {
   static unsigned long lastSpaceWeatherUpdate = 0;
-  static String lastSpaceWeatherTime = "";
+  static char lastSpaceWeatherTime[TIME_STRING_SIZE] = "";
   
   // Update display every 5 seconds OR when time changes OR on startup OR when forced
-  extern String currentTime;
+  extern char currentTime[];
   extern bool forceDisplayUpdate;
   extern SpaceWeatherData currentSpaceWeather;
-  bool timeChanged = (currentTime != lastSpaceWeatherTime);
+  bool timeChanged = (strcmp(currentTime, lastSpaceWeatherTime) != 0);
   static bool firstSpaceWeatherRun = true;
   
   if (millis() - lastSpaceWeatherUpdate < 5000 && !timeChanged && !firstSpaceWeatherRun && !forceDisplayUpdate) {
@@ -791,7 +802,7 @@ void updateSpaceWeatherDisplay() {
   }
   
   firstSpaceWeatherRun = false;
-  lastSpaceWeatherTime = currentTime;
+  strlcpy(lastSpaceWeatherTime, currentTime, sizeof(lastSpaceWeatherTime));
   
   drawBackground();
   
@@ -854,14 +865,27 @@ void updateSpaceWeatherDisplay() {
     bzColor = 0xFFE0; // Yellow for somewhat favorable
   }
   
-  tft.setTextColor(bzColor, COLOR_BACKGROUND);
+  bool magStale = sourceStale(SRC_SOLAR_WIND_MAG);
+  tft.setTextColor(magStale ? 0x7BEF : bzColor, COLOR_BACKGROUND);
   tft.drawString(String(currentSpaceWeather.magneticFieldBz, 1) + "nT", 25, 65);
   
+  // How long Bz has held southward - sustained southward IMF is what drives substorms
+  if (currentSpaceWeather.bzSouthwardMinutes > 0) {
+    char southStr[12];
+    snprintf(southStr, sizeof(southStr), "S %um", currentSpaceWeather.bzSouthwardMinutes);
+    tft.drawString(southStr, 75, 65);
+  }
+  
   // Solar Wind Speed
   tft.setTextColor(COLOR_PRESSURE, COLOR_BACKGROUND);
   tft.drawString("SW:", 5, 80);
-  tft.setTextColor(COLOR_TEXT, COLOR_BACKGROUND);
-  tft.drawString(String(currentSpaceWeather.solarWindSpeed, 0), 25, 80);
+  if (upstreamHealth[SRC_SOLAR_WIND_PLASMA].lastSuccess == 0) {
+    tft.setTextColor(0x7BEF, COLOR_BACKGROUND);
+    tft.drawString("--", 25, 80); // Nothing received yet
+  } else {
+    tft.setTextColor(sourceStale(SRC_SOLAR_WIND_PLASMA) ? 0x7BEF : COLOR_TEXT, COLOR_BACKGROUND);
+    tft.drawString(String(currentSpaceWeather.solarWindSpeed, 0), 25, 80);
+  }
   
   // Right Column - Solar Data (NOAA)
   // Solar Flux Index
@@ -882,11 +906,13 @@ void updateSpaceWeatherDisplay() {
   tft.setTextColor(COLOR_TEXT, COLOR_BACKGROUND);
   tft.drawString(String(noaaSpaceWeather.aIndex, 0), 155, 65);
   
-  // Sunspots
+  // Sunspot number with the region count of the same day
+  char spotsStr[16];
+  snprintf(spotsStr, sizeof(spotsStr), "%d (%dR)", noaaSpaceWeather.sunspotNumber, noaaSpaceWeather.activeRegions);
   tft.setTextColor(COLOR_PRESSURE, COLOR_BACKGROUND);
-  tft.drawString("Spots:", 120, 80);
+  tft.drawString("SSN:", 120, 80);
   tft.setTextColor(COLOR_TEXT, COLOR_BACKGROUND);
-  tft.drawString(String(noaaSpaceWeather.sunspotNumber), 160, 80);
+  tft.drawString(spotsStr, 148, 80);
   
   // Alerts (if any)
   if (noaaSpaceWeather.alertCount > 0) {
@@ -897,6 +923,24 @@ void updateSpaceWeatherDisplay() {
     tft.drawString("No Alerts", 5, 95);
   }
   
+  // Ring current proxy and continuous aurora likelihood from the coupling engine
+  char couplingStr[24];
+  snprintf(couplingStr, sizeof(couplingStr), "Dst:%d Aur:%d%%", (int)lroundf(currentSpaceWeather.dstEstimate),
+           currentSpaceWeather.auroraScore);
+  tft.setTextColor(currentSpaceWeather.dstEstimate <= -50 ? 0xFD20 : COLOR_TEXT, COLOR_BACKGROUND);
+  tft.drawString(couplingStr, 120, 95);
+  
+  // Most recent flare from the X-ray detector
+  if (flareEvents.count > 0) {
+    const FlareEvent& flare = flareEvents.events[flareEvents.count - 1];
+    char flareClass[8], peakTime[10], flareStr[40];
+    flareClassText(flare.peakFlux, flareClass, sizeof(flareClass));
+    formatClockCompact(flare.peak, peakTime, sizeof(peakTime));
+    snprintf(flareStr, sizeof(flareStr), "Flare: %s peak %s%s", flareClass, peakTime, flare.end ? "" : " (ongoing)");
+    tft.setTextColor(flare.peakFlux >= 1e-5f ? 0xFD20 : COLOR_TEXT, COLOR_BACKGROUND);
+    tft.drawString(flareStr, 5, 105);
+  }
+  
   // Last update time
   drawUpdateTime(currentSpaceWeather.lastUpdate);
   
@@ -905,13 +949,13 @@ void updateSpaceWeatherDisplay() {
 
 void update7DayForecastDisplay() {
   static unsigned long last7DayUpdate = 0;
-  static String last7DayTime = "";
+  static char last7DayTime[TIME_STRING_SIZE] = "";
   
   // Update display every 5 seconds OR when time changes OR on startup OR when forced
-  extern String currentTime;
+  extern char currentTime[];
   extern bool forceDisplayUpdate;
   extern WeeklyForecast weeklyForecast;
-  bool timeChanged = (currentTime != last7DayTime);
+  bool timeChanged = (strcmp(currentTime, last7DayTime) != 0);
   static bool first7DayRun = true;
   
   if (millis() - last7DayUpdate < 5000 && !timeChanged && !first7DayRun && !forceDisplayUpdate) {
@@ -919,7 +963,7 @@ void update7DayForecastDisplay() {
   }
   
   first7DayRun = false;
-  last7DayTime = currentTime;
+  strlcpy(last7DayTime, currentTime, sizeof(last7DayTime));
   
   drawBackground();
   
@@ -974,13 +1018,13 @@ void update7DayForecastDisplay() {
 
 void updateAuroraTodayDisplay() {
   static unsigned long lastAuroraTodayUpdate = 0;
-  static String lastAuroraTodayTime = "";
+  static char lastAuroraTodayTime[TIME_STRING_SIZE] = "";
   
   // Update display every 5 seconds OR when time changes OR on startup OR when forced
-  extern String currentTime;
+  extern char currentTime[];
   extern bool forceDisplayUpdate;
   extern AuroraForecastData auroraToday;
-  bool timeChanged = (currentTime != lastAuroraTodayTime);
+  bool timeChanged = (strcmp(currentTime, lastAuroraTodayTime) != 0);
   static bool firstAuroraTodayRun = true;
   
   if (millis() - lastAuroraTodayUpdate < 5000 && !timeChanged && !firstAuroraTodayRun && !forceDisplayUpdate) {
@@ -988,7 +1032,7 @@ void updateAuroraTodayDisplay() {
   }
   
   firstAuroraTodayRun = false;
-  lastAuroraTodayTime = currentTime;
+  strlcpy(lastAuroraTodayTime, currentTime, sizeof(lastAuroraTodayTime));
   
   drawBackground();
   
@@ -1002,12 +1046,10 @@ void updateAuroraTodayDisplay() {
   
   // Current date and forecast timeframe - moved down to avoid blue line
   time_t now = time(nullptr);
-  if (now < 1000000000) { // If time is not set properly, use approximate current time
-    now = millis() / 1000 + 1729800000; // Approximate Oct 2024 timestamp
+  char dateBuffer[20] = "--";
+  if (now > MIN_VALID_EPOCH) {
+    formatDate(now, dateBuffer, sizeof(dateBuffer));
   }
-  struct tm* timeinfo = localtime(&now);
-  char dateBuffer[20];
-  strftime(dateBuffer, sizeof(dateBuffer), "%m/%d/%Y", timeinfo);
   
   tft.setTextColor(COLOR_ACCENT, COLOR_BACKGROUND);
   tft.drawString("Today: " + String(dateBuffer), 5, 30); // Moved down from 25
@@ -1032,6 +1074,14 @@ void updateAuroraTodayDisplay() {
   tft.setTextColor(kpColor, COLOR_BACKGROUND);
   tft.drawString(String(auroraToday.kpPredicted, 1), 120, 52); // Moved down from 47
   
+  // OVATION nowcast probability for our grid cell
+  extern AuroraNowcastData auroraNowcast;
+  if (auroraNowcast.lastUpdate > 0) {
+    tft.setTextSize(1);
+    tft.setTextColor(COLOR_HUMIDITY, COLOR_BACKGROUND);
+    tft.drawString("Now: " + String(auroraNowcast.probability) + "%", 170, 57);
+  }
+  
   // Activity Level and Visibility on same line to save space
   tft.setTextSize(1);
   tft.setTextColor(COLOR_ACCENT, COLOR_BACKGROUND);
@@ -1053,13 +1103,13 @@ void updateAuroraTodayDisplay() {
 
 void updateAuroraTomorrowDisplay() {
   static unsigned long lastAuroraTomorrowUpdate = 0;
-  static String lastAuroraTomorrowTime = "";
+  static char lastAuroraTomorrowTime[TIME_STRING_SIZE] = "";
   
   // Update display every 5 seconds OR when time changes OR on startup OR when forced
-  extern String currentTime;
+  extern char currentTime[];
   extern bool forceDisplayUpdate;
   extern AuroraForecastData auroraTomorrow;
-  bool timeChanged = (currentTime != lastAuroraTomorrowTime);
+  bool timeChanged = (strcmp(currentTime, lastAuroraTomorrowTime) != 0);
   static bool firstAuroraTomorrowRun = true;
   
   if (millis() - lastAuroraTomorrowUpdate < 5000 && !timeChanged && !firstAuroraTomorrowRun && !forceDisplayUpdate) {
@@ -1067,7 +1117,7 @@ void updateAuroraTomorrowDisplay() {
   }
   
   firstAuroraTomorrowRun = false;
-  lastAuroraTomorrowTime = currentTime;
+  strlcpy(lastAuroraTomorrowTime, currentTime, sizeof(lastAuroraTomorrowTime));
   
   drawBackground();
   
@@ -1081,13 +1131,10 @@ void updateAuroraTomorrowDisplay() {
   
   // Tomorrow's date and forecast timeframe - moved down and fixed date
   time_t now = time(nullptr);
-  if (now < 1000000000) { // If time is not set properly, use approximate current time
-    now = millis() / 1000 + 1729800000; // Approximate Oct 2024 timestamp
+  char dateBuffer[20] = "--";
+  if (now > MIN_VALID_EPOCH) {
+    formatDate(localMidnight(now) + 36 * 3600, dateBuffer, sizeof(dateBuffer)); // Midday tomorrow, safe across DST
   }
-  time_t tomorrow = now + 86400; // Add 24 hours
-  struct tm* timeinfo = localtime(&tomorrow);
-  char dateBuffer[20];
-  strftime(dateBuffer, sizeof(dateBuffer), "%m/%d/%Y", timeinfo);
   
   tft.setTextColor(COLOR_ACCENT, COLOR_BACKGROUND);
   tft.drawString("Tomorrow: " + String(dateBuffer), 5, 30); // Moved down from 25
@@ -1134,13 +1181,13 @@ void updateAuroraTomorrowDisplay() {
 // Hourly Forecast Display
 void updateHourlyForecastDisplay() {
   static unsigned long lastHourlyUpdate = 0;
-  static String lastHourlyTime = "";
+  static char lastHourlyTime[TIME_STRING_SIZE] = "";
   
   // Update display every 5 seconds OR when time changes OR on startup OR when forced
-  extern String currentTime;
+  extern char currentTime[];
   extern bool forceDisplayUpdate;
   extern HourlyForecastData hourlyForecast;
-  bool timeChanged = (currentTime != lastHourlyTime);
+  bool timeChanged = (strcmp(currentTime, lastHourlyTime) != 0);
   static bool firstHourlyRun = true;
   
   if (!firstHourlyRun && !forceDisplayUpdate && !timeChanged && 
@@ -1190,8 +1237,8 @@ void updateHourlyForecastDisplay() {
     // Hour label (every other hour to avoid crowding)
     if (i % 2 == 0) {
       tft.setTextColor(COLOR_ACCENT, COLOR_BACKGROUND);
-      String timeStr = hourlyForecast.hours[i].time;
-      if (timeStr.length() > 2) timeStr = timeStr.substring(0, 2);
+      char timeStr[3];
+      strlcpy(timeStr, hourlyForecast.hours[i].time, sizeof(timeStr));
       tft.drawString(timeStr, xPos, 70);
     }
     
@@ -1218,7 +1265,7 @@ void updateHourlyForecastDisplay() {
   drawUpdateTime(hourlyForecast.lastUpdate);
   
   lastHourlyUpdate = millis();
-  lastHourlyTime = currentTime;
+  strlcpy(lastHourlyTime, currentTime, sizeof(lastHourlyTime));
   firstHourlyRun = false;
   
   tft.setTextDatum(TL_DATUM);
@@ -1227,13 +1274,13 @@ void updateHourlyForecastDisplay() {
 // Air Quality & UV Index Display
 void updateAirQualityDisplay() {
   static unsigned long lastAirQualityUpdate = 0;
-  static String lastAirQualityTime = "";
+  static char lastAirQualityTime[TIME_STRING_SIZE] = "";
   
   // Update display every 5 seconds OR when time changes OR on startup OR when forced
-  extern String currentTime;
+  extern char currentTime[];
   extern bool forceDisplayUpdate;
   extern AirQualityData airQuality;
-  bool timeChanged = (currentTime != lastAirQualityTime);
+  bool timeChanged = (strcmp(currentTime, lastAirQualityTime) != 0);
   static bool firstAirQualityRun = true;
   
   if (!firstAirQualityRun && !forceDisplayUpdate && !timeChanged && 
@@ -1290,15 +1337,372 @@ void updateAirQualityDisplay() {
   drawUpdateTime(airQuality.lastUpdate);
   
   lastAirQualityUpdate = millis();
-  lastAirQualityTime = currentTime;
+  strlcpy(lastAirQualityTime, currentTime, sizeof(lastAirQualityTime));
   firstAirQualityRun = false;
   
   tft.setTextDatum(TL_DATUM);
 }
 
 // Standardized header function for all screens
+// Series selectable on the history screen (left button cycles)
+struct HistoryGraph {
+  HistoryChannel channel;
+  const char* name;
+  const char* unit;
+  uint8_t decimals;
+  uint16_t color;
+};
+
+static const HistoryGraph HISTORY_GRAPHS[] = {
+  {HISTORY_PRESSURE, "Pressure", "hPa", 1, COLOR_PRESSURE},
+  {HISTORY_TEMPERATURE, "Temp", "F", 1, COLOR_TEMP},
+  {HISTORY_BZ, "Bz", "nT", 1, COLOR_WIND},
+  {HISTORY_SOLAR_WIND_SPEED, "Solar wind", "km/s", 0, COLOR_HUMIDITY},
+  {HISTORY_KP, "Kp", "", 1, COLOR_ACCENT}
+};
+static const uint8_t HISTORY_GRAPH_COUNT = sizeof(HISTORY_GRAPHS) / sizeof(HISTORY_GRAPHS[0]);
+static uint8_t historyGraph = 0;
+
+// Plot area (the axis labels sit left of it)
+#define GRAPH_LEFT 30
+#define GRAPH_TOP 42
+#define GRAPH_WIDTH (SCREEN_WIDTH - GRAPH_LEFT - 4)
+#define GRAPH_HEIGHT 68
+
+void nextHistoryGraph() {
+  historyGraph = (historyGraph + 1) % HISTORY_GRAPH_COUNT;
+}
+
+static int graphY(float value, float low, float high) {
+  return GRAPH_TOP + GRAPH_HEIGHT - 1 - (int)lroundf((value - low) * (GRAPH_HEIGHT - 1) / (high - low));
+}
+
+// History Graph Display
+void updateHistoryDisplay() {
+  static unsigned long lastHistoryUpdate = 0;
+  static char lastHistoryTime[TIME_STRING_SIZE] = "";
+  static HistoryColumn columns[GRAPH_WIDTH];  // Static keeps ~2.5 KB off the loop task stack
+  
+  // Update display every 5 seconds OR when time changes OR on startup OR when forced
+  extern char currentTime[];
+  extern bool forceDisplayUpdate;
+  bool timeChanged = (strcmp(currentTime, lastHistoryTime) != 0);
+  static bool firstHistoryRun = true;
+  
+  if (!firstHistoryRun && !forceDisplayUpdate && !timeChanged &&
+      (millis() - lastHistoryUpdate < 5000)) {
+    return;
+  }
+  
+  drawBackground();
+  drawStandardHeader("HISTORY");
+  
+  const HistoryGraph& graph = HISTORY_GRAPHS[historyGraph];
+  const HistorySeries& series = history[graph.channel];
+  bool spaceChannel = graph.channel >= HISTORY_KP;
+  
+  tft.setTextSize(1);
+  tft.setTextDatum(TL_DATUM);
+  
+  // Series name and latest value
+  char label[40];
+  tft.setTextColor(graph.color, COLOR_BACKGROUND);
+  if (series.count() > 0) {
+    snprintf(label, sizeof(label), "%s: %.*f %s", graph.name, graph.decimals, series.lastValue(), graph.unit);
+  } else {
+    snprintf(label, sizeof(label), "%s", graph.name);
+  }
+  tft.drawString(label, 5, 30);
+  
+  // Window: everything stored, up to HISTORY_GRAPH_SPAN
+  uint32_t end = series.lastTime() + 1;
+  uint32_t start = series.firstTime();
+  if (end - start > HISTORY_GRAPH_SPAN) start = end - HISTORY_GRAPH_SPAN;
+  
+  uint32_t placed = 0;
+  if (series.count() >= 2) {
+    placed = historyDecimate(series, start, end, columns, GRAPH_WIDTH);
+  }
+  
+  if (placed < 2) {
+    tft.setTextColor(COLOR_TEXT, COLOR_BACKGROUND);
+    tft.setTextDatum(MC_DATUM);
+    tft.drawString("Collecting history...", SCREEN_WIDTH/2, GRAPH_TOP + GRAPH_HEIGHT/2);
+  } else {
+    // Span label, e.g. "18h" or "7d"
+    uint32_t hours = (end - start + 1800) / 3600;
+    snprintf(label, sizeof(label), hours < 48 ? "%luh" : "%lud",
+             (unsigned long)(hours < 48 ? hours : (hours + 12) / 24));
+    tft.setTextColor(COLOR_TEXT, COLOR_BACKGROUND);
+    tft.setTextDatum(TR_DATUM);
+    tft.drawString(label, SCREEN_WIDTH - 5, 30);
+    
+    // Vertical scale from the decimated columns
+    float low = 1e30f, high = -1e30f;
+    for (uint16_t x = 0; x < GRAPH_WIDTH; x++) {
+      if (columns[x].count == 0) continue;
+      if (columns[x].min < low) low = columns[x].min;
+      if (columns[x].max > high) high = columns[x].max;
+    }
+    if (high - low < 1.0f) {
+      float middle = (high + low) / 2;
+      low = middle - 0.5f;
+      high = middle + 0.5f;
+    }
+    
+    tft.setTextColor(0x7BEF, COLOR_BACKGROUND); // Gray
+    tft.setTextDatum(TR_DATUM);
+    snprintf(label, sizeof(label), "%.0f", high);
+    tft.drawString(label, GRAPH_LEFT - 3, GRAPH_TOP);
+    snprintf(label, sizeof(label), "%.0f", low);
+    tft.drawString(label, GRAPH_LEFT - 3, GRAPH_TOP + GRAPH_HEIGHT - 8);
+    
+    tft.drawFastVLine(GRAPH_LEFT - 1, GRAPH_TOP, GRAPH_HEIGHT, 0x7BEF);
+    
+    // Dotted markers at home's midnights, like the history's daily rollups
+    uint32_t span = end - start;
+    for (time_t midnight = localMidnight(end, ZONE_HOME); midnight > (time_t)start;
+         midnight = localMidnight(midnight - 3600, ZONE_HOME)) {
+      int x = GRAPH_LEFT + (int)((uint64_t)(midnight - start) * GRAPH_WIDTH / span);
+      for (int y = GRAPH_TOP; y < GRAPH_TOP + GRAPH_HEIGHT; y += 4) {
+        tft.drawPixel(x, y, 0x4208);
+      }
+    }
+    
+    // One vertical span per column, joined to the previous column's last sample
+    bool previous = false;
+    float previousLast = 0;
+    for (uint16_t x = 0; x < GRAPH_WIDTH; x++) {
+      const HistoryColumn& column = columns[x];
+      if (column.count == 0) {
+        previous = false;
+        continue;
+      }
+      float top = column.max;
+      float bottom = column.min;
+      if (previous) {
+        if (previousLast > top) top = previousLast;
+        if (previousLast < bottom) bottom = previousLast;
+      }
+      int yTop = graphY(top, low, high);
+      int yBottom = graphY(bottom, low, high);
+      tft.drawFastVLine(GRAPH_LEFT + x, yTop, yBottom - yTop + 1, graph.color);
+      previous = true;
+      previousLast = column.last;
+    }
+  }
+  
+  drawUpdateTime(spaceChannel ? currentSpaceWeather.lastUpdate : currentWeather.lastUpdate);
+  
+  lastHistoryUpdate = millis();
+  strlcpy(lastHistoryTime, currentTime, sizeof(lastHistoryTime));
+  firstHistoryRun = false;
+  
+  tft.setTextDatum(TL_DATUM);
+}
+
+// Alerts screen: one alert at a time, word-wrapped, paged with the left button
+#define ALERT_LINE_CHARS 38
+#define ALERT_PAGE_LINES 8
+#define ALERT_TEXT_TOP 42
+#define ALERT_LINE_HEIGHT 9
+
+static uint8_t alertIndex = 0;
+static uint16_t alertLine = 0;       // First wrapped line shown
+static uint16_t alertLineCount = 0;  // Wrapped lines in the current alert
+
+void scrollAlerts() {
+  // Next page, then the next alert once the last page was shown
+  alertLine += ALERT_PAGE_LINES;
+  if (alertLine >= alertLineCount) {
+    alertLine = 0;
+    alertIndex = alertStore.count ? (alertIndex + 1) % alertStore.count : 0;
+  }
+}
+
+static uint16_t colorOfAlert(const AlertEntry& entry) {
+  if (entry.severity >= 3) return 0xF800;  // Red
+  switch (entry.kind) {
+    case ALERT_KIND_ALERT: return 0xFD20;  // Orange
+    case ALERT_KIND_WARNING: return COLOR_PRESSURE;
+    case ALERT_KIND_WATCH: return COLOR_HUMIDITY;
+    default: return COLOR_TEXT;
+  }
+}
+
+// Alerts Display
+void updateAlertsDisplay() {
+  static unsigned long lastAlertsUpdate = 0;
+  static char lastAlertsTime[TIME_STRING_SIZE] = "";
+  static char text[ALERT_MESSAGE_SIZE];  // Static keeps the decompressed message off the stack
+  
+  // Update display every 5 seconds OR when time changes OR on startup OR when forced
+  extern char currentTime[];
+  extern bool forceDisplayUpdate;
+  bool timeChanged = (strcmp(currentTime, lastAlertsTime) != 0);
+  static bool firstAlertsRun = true;
+  
+  if (!firstAlertsRun && !forceDisplayUpdate && !timeChanged &&
+      (millis() - lastAlertsUpdate < 5000)) {
+    return;
+  }
+  
+  drawBackground();
+  drawStandardHeader("ALERTS");
+  
+  tft.setTextSize(1);
+  tft.setTextDatum(TL_DATUM);
+  
+  if (alertStore.count == 0) {
+    alertIndex = 0;
+    alertLine = 0;
+    tft.setTextColor(COLOR_WIND, COLOR_BACKGROUND);
+    tft.setTextDatum(MC_DATUM);
+    tft.drawString("No active alerts", SCREEN_WIDTH/2, 70);
+  } else {
+    if (alertIndex >= alertStore.count) {  // Entries expired since the last scroll
+      alertIndex = 0;
+      alertLine = 0;
+    }
+    const AlertEntry& entry = alertStore.entries[alertIndex];
+    
+    // Position, kind and scale on the left, issue time on the right
+    char label[40];
+    snprintf(label, sizeof(label), "%u/%u %s %s", alertIndex + 1, alertStore.count,
+             alertKindText((AlertKind)entry.kind), entry.scale);
+    tft.setTextColor(colorOfAlert(entry), COLOR_BACKGROUND);
+    tft.drawString(label, 5, 30);
+    
+    char date[12], clock[10];
+    formatDate(entry.issued, date, sizeof(date));
+    formatClockCompact(entry.issued, clock, sizeof(clock));
+    snprintf(label, sizeof(label), "%s %s", date, clock);
+    tft.setTextColor(0x7BEF, COLOR_BACKGROUND); // Gray
+    tft.setTextDatum(TR_DATUM);
+    tft.drawString(label, SCREEN_WIDTH - 5, 30);
+    tft.setTextDatum(TL_DATUM);
+    
+    // Word-wrap the message, drawing only the lines of the current page
+    alertText(alertStore, alertIndex, text, sizeof(text));
+    tft.setTextColor(COLOR_TEXT, COLOR_BACKGROUND);
+    const char* p = text;
+    uint16_t line = 0;
+    bool previousBlank = true;  // Also drops leading blank lines
+    while (*p) {
+      const char* end = strchr(p, '\n');
+      size_t length = end ? (size_t)(end - p) : strlen(p);
+      if (length == 0) {
+        p++;
+        if (previousBlank) continue;  // Collapse runs of blank lines
+        previousBlank = true;
+      } else {
+        previousBlank = false;
+        if (length > ALERT_LINE_CHARS) {
+          length = ALERT_LINE_CHARS;  // Hard break unless a space is found
+          for (size_t i = ALERT_LINE_CHARS; i > ALERT_LINE_CHARS / 2; i--) {
+            if (p[i] == ' ') {
+              length = i;
+              break;
+            }
+          }
+        }
+        if (line >= alertLine && line < alertLine + ALERT_PAGE_LINES) {
+          char row[ALERT_LINE_CHARS + 1];
+          memcpy(row, p, length);
+          row[length] = '\0';
+          tft.drawString(row, 5, ALERT_TEXT_TOP + (line - alertLine) * ALERT_LINE_HEIGHT);
+        }
+        p += length;
+        if (*p == ' ' || *p == '\n') p++;
+      }
+      line++;
+    }
+    alertLineCount = line;
+    
+    // Page indicator when the message continues
+    if (alertLineCount > ALERT_PAGE_LINES) {
+      snprintf(label, sizeof(label), "%u/%u", alertLine / ALERT_PAGE_LINES + 1,
+               (alertLineCount + ALERT_PAGE_LINES - 1) / ALERT_PAGE_LINES);
+      tft.setTextColor(0x7BEF, COLOR_BACKGROUND);
+      tft.setTextDatum(TR_DATUM);
+      tft.drawString(label, SCREEN_WIDTH - 5, 18);
+    }
+  }
+  
+  drawUpdateTime(noaaSpaceWeather.lastUpdate);
+  
+  lastAlertsUpdate = millis();
+  strlcpy(lastAlertsTime, currentTime, sizeof(lastAlertsTime));
+  firstAlertsRun = false;
+  
+  tft.setTextDatum(TL_DATUM);
+}
+
+// Locations screen: every configured place with its last temperature, the
+// displayed one marked; the left button switches to the next one
+#define LOCATION_ROW_TOP 34
+#define LOCATION_ROW_HEIGHT 18
+
+void updateLocationsDisplay() {
+  static unsigned long lastLocationsUpdate = 0;
+  static char lastLocationsTime[TIME_STRING_SIZE] = "";
+  
+  // Update display every 5 seconds OR when time changes OR on startup OR when forced
+  extern char currentTime[];
+  extern bool forceDisplayUpdate;
+  bool timeChanged = (strcmp(currentTime, lastLocationsTime) != 0);
+  static bool firstLocationsRun = true;
+  
+  if (!firstLocationsRun && !forceDisplayUpdate && !timeChanged &&
+      (millis() - lastLocationsUpdate < 5000)) {
+    return;
+  }
+  
+  drawBackground();
+  drawStandardHeader("LOCATIONS");
+  
+  tft.setTextSize(1);
+  char text[16];
+  for (uint8_t i = 0; i < locationCount; i++) {
+    int y = LOCATION_ROW_TOP + i * LOCATION_ROW_HEIGHT;
+    bool active = i == activeLocation;
+    // The displayed location's data is in the globals, the others' in their status
+    float temperature = active ? currentWeather.temperature : locationStatus[i].temperature;
+    unsigned long updated = active ? currentWeather.lastUpdate : locationStatus[i].weatherUpdated;
+    
+    tft.setTextColor(active ? COLOR_ACCENT : COLOR_TEXT, COLOR_BACKGROUND);
+    tft.setTextDatum(TL_DATUM);
+    if (active) tft.drawString(">", 5, y);
+    tft.drawString(locations[i].name, 15, y);
+    
+    tft.setTextDatum(TR_DATUM);
+    if (updated == 0) {
+      strlcpy(text, "--", sizeof(text));
+    } else {
+      snprintf(text, sizeof(text), "%dF", (int)temperature);
+    }
+    tft.drawString(text, 180, y);
+    
+    tft.setTextColor(0x7BEF, COLOR_BACKGROUND); // Gray
+    if (updated == 0) {
+      strlcpy(text, "never", sizeof(text));
+    } else {
+      snprintf(text, sizeof(text), "%lum ago", (millis() - updated) / 60000);
+    }
+    tft.drawString(text, SCREEN_WIDTH - 5, y);
+  }
+  
+  drawUpdateTime(currentWeather.lastUpdate);
+  
+  lastLocationsUpdate = millis();
+  strlcpy(lastLocationsTime, currentTime, sizeof(lastLocationsTime));
+  firstLocationsRun = false;
+  
+  tft.setTextDatum(TL_DATUM);
+}
+
 void drawStandardHeader(String title) {
-  extern String currentTime;
+  extern char currentTime[];
   
   // Title - large and consistent
   tft.setTextColor(COLOR_ACCENT, COLOR_BACKGROUND);
@@ -1332,9 +1736,12 @@ void drawUpdateTime(unsigned long lastUpdate) {
   
   // WiFi status in lower right
   tft.setTextDatum(TR_DATUM);
-  if (WiFi.status() == WL_CONNECTED) {
+  if (wifiLink.connected()) {
     tft.setTextColor(COLOR_WIND, COLOR_BACKGROUND); // Green for connected
     tft.drawString("WiFi", SCREEN_WIDTH - 5, 120); // WiFi connected
+  } else if (wifiLink.state() == WIFI_LINK_CONNECTING) {
+    tft.setTextColor(COLOR_PRESSURE, COLOR_BACKGROUND); // Yellow while reconnecting
+    tft.drawString("WiFi...", SCREEN_WIDTH - 5, 120);
   } else {
     tft.setTextColor(0xF800, COLOR_BACKGROUND); // Red for disconnected
     tft.drawString("NO WiFi", SCREEN_WIDTH - 5, 120); // Disconnected
@@ -0,0 +1,238 @@
+#include "ephemeris.h"
+#include <math.h>
+
+static const double PI2 = 6.283185307179586;
+static const double RAD = PI2 / 360.0;
+static const double ARCSEC = PI2 / 1296000.0;        // Radians per arcsecond
+static const double COS_OBLIQUITY = 0.91748206;      // Obliquity of the ecliptic, J2000
+static const double SIN_OBLIQUITY = 0.39777716;
+static const double SYNODIC_MONTH = 29.530589;       // Days
+
+// Altitudes (degrees) at which events happen, including refraction and semi-diameter
+static const double SUN_RISE_ALTITUDE = -0.833;
+static const double MOON_RISE_ALTITUDE = 0.133;      // Parallax lifts the moon above the refracted horizon
+static const double CIVIL_ALTITUDE = -6.0;
+static const double NAUTICAL_ALTITUDE = -12.0;
+static const double ASTRONOMICAL_ALTITUDE = -18.0;
+
+// Hourly samples over the window, searched in overlapping 2 hour parabolas
+static const int SAMPLE_COUNT = 25;
+
+enum Body { BODY_SUN, BODY_MOON };
+
+static double frac(double x) {
+  return x - floor(x);
+}
+
+// Julian centuries since J2000.0 (UT, the ~70s TT offset is below our accuracy)
+static double centuries(time_t t) {
+  return ((double)t / 86400.0 - 10957.5) / 36525.0;
+}
+
+// Greenwich mean sidereal time in radians
+static double siderealTime(time_t t) {
+  double days = (double)t / 86400.0 - 10957.5;
+  return PI2 * frac(0.7790572732500 + 1.0027379093508 * days);
+}
+
+static void sunEcliptic(double T, double& lon) {
+  double M = PI2 * frac(0.993133 + 99.997361 * T);
+  float m = (float)M;
+  lon = PI2 * frac(0.7859453 + M / PI2 + (6893.0f * sinf(m) + 72.0f * sinf(2 * m) + 6191.2 * T) / 1296000.0);
+}
+
+static void moonEcliptic(double T, double& lon, double& lat) {
+  // Fundamental arguments need double precision (T is multiplied by ~1300 revolutions),
+  // the periodic terms are evaluated in float since the ESP32 FPU is single precision
+  double L0 = frac(0.606433 + 1336.855225 * T);               // Mean longitude (revolutions)
+  float l = (float)(PI2 * frac(0.374897 + 1325.552410 * T));  // Moon mean anomaly
+  float ls = (float)(PI2 * frac(0.993133 + 99.997361 * T));   // Sun mean anomaly
+  float D = (float)(PI2 * frac(0.827361 + 1236.853086 * T));  // Elongation
+  float F = (float)(PI2 * frac(0.259086 + 1342.227825 * T));  // Distance from ascending node
+
+  float dL = 22640.0f * sinf(l) - 4586.0f * sinf(l - 2 * D) + 2370.0f * sinf(2 * D)
+           + 769.0f * sinf(2 * l) - 668.0f * sinf(ls) - 412.0f * sinf(2 * F)
+           - 212.0f * sinf(2 * l - 2 * D) - 206.0f * sinf(l + ls - 2 * D)
+           + 192.0f * sinf(l + 2 * D) - 165.0f * sinf(ls - 2 * D) - 125.0f * sinf(D)
+           - 110.0f * sinf(l + ls) + 148.0f * sinf(l - ls) - 55.0f * sinf(2 * F - 2 * D);
+
+  float S = F + (dL + 412.0f * sinf(2 * F) + 541.0f * sinf(ls)) * (float)ARCSEC;
+  float h = F - 2 * D;
+  float N = -526.0f * sinf(h) + 44.0f * sinf(l + h) - 31.0f * sinf(-l + h) - 23.0f * sinf(ls + h)
+          + 11.0f * sinf(-ls + h) - 25.0f * sinf(-2 * l + F) + 21.0f * sinf(-l + F);
+
+  lon = PI2 * frac(L0 + dL / 1296000.0);
+  lat = (18520.0 * sin(S) + N) * ARCSEC;
+}
+
+static void eclipticToEquatorial(double lon, double lat, double& ra, double& dec) {
+  double x = cos(lat) * cos(lon);
+  double y = cos(lat) * sin(lon);
+  double z = sin(lat);
+  double yEq = COS_OBLIQUITY * y - SIN_OBLIQUITY * z;
+  double zEq = SIN_OBLIQUITY * y + COS_OBLIQUITY * z;
+  ra = atan2(yEq, x);
+  dec = atan2(zEq, sqrt(x * x + yEq * yEq));
+}
+
+static void bodyPosition(Body body, time_t t, double& ra, double& dec) {
+  double T = centuries(t);
+  double lon, lat = 0;
+  if (body == BODY_SUN) {
+    sunEcliptic(T, lon);
+  } else {
+    moonEcliptic(T, lon, lat);
+  }
+  eclipticToEquatorial(lon, lat, ra, dec);
+}
+
+// Hour angle wrapped to -PI..PI
+static double hourAngle(Body body, time_t t, double longitude) {
+  double ra, dec;
+  bodyPosition(body, t, ra, dec);
+  double tau = siderealTime(t) + longitude * RAD - ra;
+  return tau - PI2 * floor(tau / PI2 + 0.5);
+}
+
+static double sinAltitude(Body body, time_t t, double sinLat, double cosLat, double longitude) {
+  double ra, dec;
+  bodyPosition(body, t, ra, dec);
+  double tau = siderealTime(t) + longitude * RAD - ra;
+  return sinLat * sin(dec) + cosLat * cos(dec) * cos(tau);
+}
+
+static void sampleAltitudes(Body body, time_t start, double latitude, double longitude,
+                            double samples[SAMPLE_COUNT]) {
+  double sinLat = sin(latitude * RAD);
+  double cosLat = cos(latitude * RAD);
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    samples[i] = sinAltitude(body, start + i * 3600, sinLat, cosLat, longitude);
+  }
+}
+
+// Find the first upward and downward crossing of an altitude by fitting a parabola
+// through each consecutive sample triple; a parabola catches two crossings inside
+// one 2 hour step, which plain sign checks on hourly samples would miss
+static void findCrossings(const double samples[SAMPLE_COUNT], double altitude, time_t start,
+                          time_t& rise, time_t& set) {
+  double offset = sin(altitude * RAD);
+  rise = 0;
+  set = 0;
+
+  for (int i = 1; i < SAMPLE_COUNT - 1 && (rise == 0 || set == 0); i += 2) {
+    double ym = samples[i - 1] - offset;
+    double y0 = samples[i] - offset;
+    double yp = samples[i + 1] - offset;
+
+    double a = 0.5 * (yp + ym) - y0;
+    double b = 0.5 * (yp - ym);
+    double c = y0;
+
+    double root1 = 0, root2 = 0;
+    int roots = 0;
+    double extremum = y0;
+
+    if (fabs(a) < 1e-12) {
+      // Straight line through the samples
+      if (b != 0) {
+        root1 = -c / b;
+        if (fabs(root1) <= 1) roots = 1;
+      }
+    } else {
+      double xe = -b / (2 * a);
+      extremum = (a * xe + b) * xe + c;
+      double discriminant = b * b - 4 * a * c;
+      if (discriminant >= 0) {
+        double dx = 0.5 * sqrt(discriminant) / fabs(a);
+        root1 = xe - dx;
+        root2 = xe + dx;
+        if (fabs(root1) <= 1) roots++;
+        if (fabs(root2) <= 1) roots++;
+        if (root1 < -1) root1 = root2;
+      }
+    }
+
+    time_t center = start + i * 3600;
+    if (roots == 1) {
+      time_t t = center + (time_t)lround(root1 * 3600);
+      if (ym < 0) {
+        if (rise == 0) rise = t;
+      } else {
+        if (set == 0) set = t;
+      }
+    } else if (roots == 2) {
+      time_t t1 = center + (time_t)lround(root1 * 3600);
+      time_t t2 = center + (time_t)lround(root2 * 3600);
+      if (extremum < 0) {
+        if (rise == 0) rise = t2;
+        if (set == 0) set = t1;
+      } else {
+        if (rise == 0) rise = t1;
+        if (set == 0) set = t2;
+      }
+    }
+  }
+}
+
+// Meridian transit by Newton iteration on the hour angle
+static time_t newtonTransit(Body body, double t, double longitude) {
+  // Hour angle rate in radians per second (the moon lags ~50 minutes a day)
+  double rate = PI2 / (body == BODY_SUN ? 86400.0 : 89428.0);
+  for (int i = 0; i < 4; i++) {
+    double step = hourAngle(body, (time_t)t, longitude) / rate;
+    t -= step;
+    if (fabs(step) < 1) break;
+  }
+  return (time_t)lround(t);
+}
+
+static time_t findTransit(Body body, time_t start, double longitude) {
+  // Each seed converges to the transit within half a day of it, so seeds at 6h
+  // and 18h cover the whole window; keep the earliest one that lands inside
+  time_t transit = 0;
+  for (int seed = 6; seed <= 18; seed += 12) {
+    time_t t = newtonTransit(body, (double)start + seed * 3600.0, longitude);
+    if (t >= start && t < start + 86400 && (transit == 0 || t < transit)) {
+      transit = t;
+    }
+  }
+  return transit;
+}
+
+void computeSunTimes(time_t start, double latitude, double longitude, SunTimes& out) {
+  // One set of samples serves the horizon and all three twilight altitudes
+  double samples[SAMPLE_COUNT];
+  sampleAltitudes(BODY_SUN, start, latitude, longitude, samples);
+
+  findCrossings(samples, SUN_RISE_ALTITUDE, start, out.rise, out.set);
+  findCrossings(samples, CIVIL_ALTITUDE, start, out.civilDawn, out.civilDusk);
+  findCrossings(samples, NAUTICAL_ALTITUDE, start, out.nauticalDawn, out.nauticalDusk);
+  findCrossings(samples, ASTRONOMICAL_ALTITUDE, start, out.astronomicalDawn, out.astronomicalDusk);
+  out.transit = findTransit(BODY_SUN, start, longitude);
+}
+
+void computeMoonTimes(time_t start, double latitude, double longitude, MoonTimes& out) {
+  double samples[SAMPLE_COUNT];
+  sampleAltitudes(BODY_MOON, start, latitude, longitude, samples);
+
+  findCrossings(samples, MOON_RISE_ALTITUDE, start, out.rise, out.set);
+  out.transit = findTransit(BODY_MOON, start, longitude);
+}
+
+void computeMoonPhase(time_t t, MoonPhaseInfo& out) {
+  double T = centuries(t);
+  double sunLon, moonLon, moonLat;
+  sunEcliptic(T, sunLon);
+  moonEcliptic(T, moonLon, moonLat);
+
+  // Phase follows the ecliptic longitude difference, illumination the true elongation
+  double elongation = moonLon - sunLon;
+  out.phase = (float)frac(elongation / PI2);
+  out.illumination = (float)(0.5 * (1 - cos(moonLat) * cos(elongation)));
+  out.age = out.phase * (float)SYNODIC_MONTH;
+}
+
+double sunAltitude(time_t t, double latitude, double longitude) {
+  double sinAlt = sinAltitude(BODY_SUN, t, sin(latitude * RAD), cos(latitude * RAD), longitude);
+  return asin(sinAlt) / RAD;
+}
@@ -0,0 +1,141 @@
+#include "eventlog.h"
+#include <string.h>
+
+EventRecord eventLogBuffer[EVENT_LOG_CAPACITY];
+volatile uint32_t eventLogHead = 0;
+uint32_t eventLogTail = 0;
+
+struct EventDescriptor {
+  const char* name;
+  const char* args[3];   // Argument labels, "x10" suffix means fixed-point tenths
+};
+
+// Indexed by EventId
+static const EventDescriptor eventDescriptors[EV_COUNT] = {
+  {"boot",                 {nullptr, nullptr, nullptr}},
+  {"wifi_connected",       {"ip", "outage_ms", "attempts"}},
+  {"wifi_failed",          {"attempts", nullptr, nullptr}},
+  {"http_error",           {"source", "code", nullptr}},
+  {"json_error",           {"source", "code", nullptr}},
+  {"time_synced",          {"hour", "minute", "second"}},
+  {"weather_updated",      {"temp_x10", "uvi", "api_calls"}},
+  {"hourly_entry",         {"index", "hour", "temp_x10"}},
+  {"moon_updated",         {"phase_x1000", "illum_x10", nullptr}},
+  {"air_quality_updated",  {"aqi", nullptr, nullptr}},
+  {"space_weather_updated",{"kp_x10", "bz_x10", "speed"}},
+  {"noaa_updated",         {"sfi_x10", "a_index_x10", "sunspots"}},
+  {"aurora_updated",       {"today_kp_x10", "tomorrow_kp_x10", nullptr}},
+  {"api_limit",            {"provider", "used", "tokens"}},
+  {"screen_changed",       {"screen", nullptr, nullptr}},
+  {"icon_drawn",           {"night", "icon", nullptr}},
+  {"frame",                {"screen", "us", nullptr}},
+  {"schema_error",         {"source", "reason", nullptr}},
+  {"ingest",               {"source", "bytes", "us"}},
+  {"ephemeris",            {"us", nullptr, nullptr}},
+  {"aurora_nowcast",       {"probability", "oval_edge", "cells"}},
+  {"solar_wind_binned",    {"source", "rows", "south_min"}},
+  {"coupling_updated",     {"steps", "kp_x10", "dst"}},
+  {"flares_detected",      {"samples", "flares", "peak_x1e8"}},
+  {"alerts_ingested",      {"added", "duplicates", "kept"}},
+  {"sunspots_aggregated",  {"rows", "regions", "ssn"}},
+  {"wifi_lost",            {"reason", nullptr, nullptr}},
+  {"circuit_changed",      {"source", "state", "retry_s"}},
+  {"fetch_skipped",        {"source", "skipped", nullptr}},
+  {"refresh_done",         {"workers", "wall_ms", "min_heap"}},
+  {"inflated",             {"source", "compressed", "inflated"}},
+  {"connections",          {"requests", "handshakes", "resumed"}},
+  {"local_api",            {"port", "listening", nullptr}},
+  {"snapshot_published",   {"requests", "not_modified", "connections"}},
+  {"snapshot_skipped",     {"requests", nullptr, nullptr}},
+  {"bundle_applied",       {"bytes", "sections", "age_s"}},
+  {"bundle_rejected",      {"bytes", nullptr, nullptr}},
+  {"location_changed",     {"location", "bytes", "age_s"}},
+  {"location_refreshed",   {"location", "bytes", "age_s"}},
+  {"location_overflow",    {"location", "capacity", nullptr}},
+};
+
+static const char* levelName(uint8_t level) {
+  switch (level) {
+    case LOG_LEVEL_ERROR: return "ERR";
+    case LOG_LEVEL_INFO: return "INF";
+    case LOG_LEVEL_DEBUG: return "DBG";
+    default: return "???";
+  }
+}
+
+// Records older than one buffer length have been overwritten; returns how many
+static uint32_t skipOverwritten(uint32_t head) {
+  if (head - eventLogTail <= EVENT_LOG_CAPACITY) return 0;
+  uint32_t lost = head - eventLogTail - EVENT_LOG_CAPACITY;
+  eventLogTail = head - EVENT_LOG_CAPACITY;
+  return lost;
+}
+
+enum TakeResult : uint8_t { TAKE_OK, TAKE_LOST, TAKE_PENDING };
+
+// Copy the record at eventLogTail without holding up the writers: it is only
+// used when its sequence shows it complete both before and after the copy,
+// so a writer lapping the drain cannot hand out a torn record
+static TakeResult takeRecord(EventRecord& copy) {
+  const EventRecord& slot = eventLogBuffer[eventLogTail & (EVENT_LOG_CAPACITY - 1)];
+  uint32_t expected = eventLogTail + 1;
+  uint32_t before = __atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE);
+  if (before == 0 || (int32_t)(before - expected) < 0) return TAKE_PENDING;  // Not published yet
+  memcpy(&copy, &slot, sizeof(copy));
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  uint32_t after = __atomic_load_n(&slot.sequence, __ATOMIC_RELAXED);
+  eventLogTail++;
+  return before == expected && after == expected ? TAKE_OK : TAKE_LOST;
+}
+
+size_t eventLogFormat(const EventRecord& record, char* line, size_t size) {
+  const char* name = record.id < EV_COUNT ? eventDescriptors[record.id].name : "unknown";
+  int length = snprintf(line, size, "%10lu %s %s", (unsigned long)record.timestamp, levelName(record.level), name);
+
+  for (int i = 0; i < record.argCount && i < 3 && length < (int)size; i++) {
+    const char* label = record.id < EV_COUNT ? eventDescriptors[record.id].args[i] : nullptr;
+    length += snprintf(line + length, size - length, " %s=%ld", label ? label : "arg", (long)record.args[i]);
+  }
+  return length < (int)size ? length : size - 1;
+}
+
+void eventLogDrain(Print& out) {
+  uint32_t head = eventLogHead;
+  uint32_t lost = skipOverwritten(head);
+  if (lost > 0) out.printf("-- %lu events dropped --\n", (unsigned long)lost);
+
+  EventRecord record;
+  char line[128];
+  lost = 0;
+  while (eventLogTail != head) {
+    TakeResult result = takeRecord(record);
+    if (result == TAKE_PENDING) break;  // Left for the next drain
+    if (result == TAKE_LOST) {
+      lost++;
+      continue;
+    }
+    eventLogFormat(record, line, sizeof(line));
+    out.println(line);
+  }
+  if (lost > 0) out.printf("-- %lu events overwritten while draining --\n", (unsigned long)lost);
+}
+
+void eventLogDump(Print& out) {
+  uint32_t head = eventLogHead;
+  skipOverwritten(head);
+
+  uint32_t header[2] = {EVENT_LOG_MAGIC, sizeof(EventRecord)};
+  out.write((const uint8_t*)header, sizeof(header));
+  EventRecord record;
+  while (eventLogTail != head) {
+    TakeResult result = takeRecord(record);
+    if (result == TAKE_PENDING) break;
+    if (result == TAKE_OK) out.write((const uint8_t*)&record, sizeof(record));
+  }
+  memset(&record, 0, sizeof(record));
+  out.write((const uint8_t*)&record, sizeof(record));
+}
+
+void eventLogClear() {
+  eventLogTail = eventLogHead;
+}
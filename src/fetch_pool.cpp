@@ -0,0 +1,75 @@
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <esp_heap_caps.h>
+#include "config.h"
+#include "fetch_pool.h"
+
+static const FetchJob* batchJobs = nullptr;
+static uint8_t batchCount = 0;
+static volatile uint8_t batchNext = 0;     // Next job to hand out
+static volatile uint8_t batchRunning = 0;  // Jobs in progress
+static SemaphoreHandle_t workerDone = nullptr;
+
+static bool heapAllowsSession() {
+  return heap_caps_get_free_size(MALLOC_CAP_8BIT) >= FETCH_TLS_COST + FETCH_HEAP_RESERVE &&
+         heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) >= FETCH_TLS_COST;
+}
+
+// Take jobs until none are left. A helper also stops when the heap has no
+// room for another session while others are running; the caller never
+// stops early, so the batch always completes.
+static void drainJobs(bool helper) {
+  for (;;) {
+    if (helper && __atomic_load_n(&batchRunning, __ATOMIC_RELAXED) > 0 && !heapAllowsSession()) return;
+    uint8_t index = __atomic_fetch_add(&batchNext, 1, __ATOMIC_RELAXED);
+    if (index >= batchCount) return;
+
+    __atomic_fetch_add(&batchRunning, 1, __ATOMIC_RELAXED);
+    batchJobs[index]();
+    __atomic_fetch_sub(&batchRunning, 1, __ATOMIC_RELAXED);
+  }
+}
+
+static void fetchWorker(void* parameter) {
+  (void)parameter;
+  drainJobs(true);
+  xSemaphoreGive(workerDone);
+  vTaskDelete(nullptr);
+}
+
+FetchBatchStats fetchRunAll(const FetchJob* jobs, uint8_t count) {
+  FetchBatchStats stats = {1, 0, 0};
+  unsigned long start = millis();
+  if (workerDone == nullptr) workerDone = xSemaphoreCreateCounting(FETCH_MAX_WORKERS, 0);
+
+  batchJobs = jobs;
+  batchCount = count;
+  batchNext = 0;
+  batchRunning = 0;
+
+  // Helpers the heap can carry right now, one session each plus the caller's
+  uint32_t available = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  uint8_t helpers = 0;
+  while (helpers + 1 < FETCH_MAX_WORKERS && helpers + 1 < count &&
+         available >= (uint32_t)(helpers + 2) * FETCH_TLS_COST + FETCH_HEAP_RESERVE) {
+    helpers++;
+  }
+
+  uint8_t started = 0;
+  for (uint8_t i = 0; i < helpers; i++) {
+    if (xTaskCreatePinnedToCore(fetchWorker, "fetch", FETCH_WORKER_STACK, nullptr, 1, nullptr,
+                                tskNO_AFFINITY) == pdPASS) {
+      started++;
+    }
+  }
+
+  drainJobs(false);
+  for (uint8_t i = 0; i < started; i++) xSemaphoreTake(workerDone, portMAX_DELAY);
+
+  stats.workers = started + 1;
+  stats.wallMillis = millis() - start;
+  stats.minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  return stats;
+}
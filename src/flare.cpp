@@ -0,0 +1,114 @@
+#include "flare.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FLARE_MAX_STEP 90  // Longest gap (s) between minutes that still counts as consecutive
+
+void FlareDetector::begin(float minimum) {
+  minimumPeak = minimum;
+  sampleCount = 0;
+  firstTime = 0;
+  lastTime = 0;
+  lastFlux = 0;
+  riseLength = 0;
+  shortNext = 0;
+  memset(shortTimes, 0, sizeof(shortTimes));
+  active = false;
+  found.count = 0;
+}
+
+void FlareDetector::sample(XrayChannel channel, uint32_t time, float flux) {
+  if (!(flux > 0)) return;  // Rejects NaN and the negative fill values
+  if (sampleCount++ == 0) firstTime = time;
+
+  if (channel == XRAY_SHORT) {
+    shortTimes[shortNext] = time;
+    shortFlux[shortNext] = flux;
+    shortNext = (shortNext + 1) % FLARE_RISE_MINUTES;
+    if (active && time >= current.start && flux > current.shortPeakFlux) current.shortPeakFlux = flux;
+    return;
+  }
+
+  lastTime = time;
+  lastFlux = flux;
+
+  if (active) {
+    if (flux > current.peakFlux) {
+      current.peakFlux = flux;
+      current.peak = time;
+    }
+    if (flux > (current.peakFlux + startFlux) / 2) return;
+    emit(time);
+    riseLength = 0;  // The decay minute can open the next rise
+  }
+
+  // Look for FLARE_RISE_MINUTES consecutive minutes of rising flux
+  if (riseLength > 0 &&
+      (time - riseTimes[riseLength - 1] > FLARE_MAX_STEP || flux <= riseFlux[riseLength - 1])) {
+    riseLength = 0;
+  }
+  if (riseLength == FLARE_RISE_MINUTES) {
+    memmove(&riseTimes[0], &riseTimes[1], (FLARE_RISE_MINUTES - 1) * sizeof(riseTimes[0]));
+    memmove(&riseFlux[0], &riseFlux[1], (FLARE_RISE_MINUTES - 1) * sizeof(riseFlux[0]));
+    riseLength--;
+  }
+  riseTimes[riseLength] = time;
+  riseFlux[riseLength] = flux;
+  riseLength++;
+
+  if (riseLength == FLARE_RISE_MINUTES && flux >= FLARE_RISE_RATIO * riseFlux[0]) {
+    active = true;
+    startFlux = riseFlux[0];
+    current.start = riseTimes[0];
+    current.peak = time;
+    current.end = 0;
+    current.peakFlux = flux;
+    current.shortPeakFlux = 0;
+    for (uint8_t i = 0; i < FLARE_RISE_MINUTES; i++) {
+      if (shortTimes[i] >= current.start && shortFlux[i] > current.shortPeakFlux) {
+        current.shortPeakFlux = shortFlux[i];
+      }
+    }
+  }
+}
+
+void FlareDetector::emit(uint32_t end) {
+  active = false;
+  if (current.peakFlux < minimumPeak) return;
+
+  current.end = end;
+  if (found.count == FLARE_EVENT_CAPACITY) {
+    memmove(&found.events[0], &found.events[1], (FLARE_EVENT_CAPACITY - 1) * sizeof(FlareEvent));
+    found.count--;
+  }
+  found.events[found.count++] = current;
+}
+
+void FlareDetector::finish(FlareEventList& list) {
+  if (active) emit(0);  // Still decaying when the data ends
+  if (sampleCount == 0) return;
+
+  // Keep older events this scan no longer covers, then append the new ones
+  uint8_t kept = 0;
+  while (kept < list.count && list.events[kept].start < firstTime) kept++;
+
+  uint8_t total = kept + found.count;
+  uint8_t drop = total > FLARE_EVENT_CAPACITY ? total - FLARE_EVENT_CAPACITY : 0;
+  if (drop > kept) drop = kept;  // found.count never exceeds the capacity on its own
+  memmove(&list.events[0], &list.events[drop], (kept - drop) * sizeof(FlareEvent));
+  memcpy(&list.events[kept - drop], found.events, found.count * sizeof(FlareEvent));
+  list.count = kept - drop + found.count;
+}
+
+size_t flareClassText(float flux, char* buffer, size_t size) {
+  static const char CLASSES[] = "ABCMX";
+  int index = 0;
+  float base = 1e-8f;
+  while (index < 4 && flux >= base * 10) {
+    base *= 10;
+    index++;
+  }
+  int length = snprintf(buffer, size, "%c%.1f", CLASSES[index], flux / base);
+  if (length < 0) return 0;
+  return (size_t)length < size ? (size_t)length : (size ? size - 1 : 0);
+}
@@ -0,0 +1,242 @@
+#include "history.h"
+#include <math.h>
+#include <string.h>
+
+// Bucket payload widths after the '0', '10', '110', '1110', '1111' prefixes.
+// The widest bucket is a raw 32-bit value so any delta can be written.
+static const uint8_t TIME_WIDTHS[4] = {7, 9, 12, 32};    // Delta-of-delta, seconds
+static const uint8_t VALUE_WIDTHS[4] = {6, 10, 16, 32};  // Delta, fixed-point units
+
+#define HISTORY_BLOCK_BITS (HISTORY_BLOCK_BYTES * 8)
+#define HISTORY_MAX_GAP 0x3FFFFFFF  // Larger gaps start a new block so deltas stay in int32
+
+static inline uint32_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Prefix length plus payload for a signed value, or 1 for the zero bucket
+static uint8_t encodedBits(const uint8_t* widths, int32_t value) {
+  if (value == 0) return 1;
+  uint32_t z = zigzag(value);
+  for (uint8_t i = 0; i < 3; i++) {
+    if (z < (1UL << widths[i])) return (i + 2) + widths[i];
+  }
+  return 4 + widths[3];
+}
+
+static int32_t toFixed(float value, float scale) {
+  float scaled = roundf(value * scale);
+  if (scaled > 2147483520.0f) return 2147483520;
+  if (scaled < -2147483520.0f) return -2147483520;
+  return (int32_t)scaled;
+}
+
+HistorySeries::HistorySeries(float scale) : scale(scale) {
+  clear();
+}
+
+void HistorySeries::clear() {
+  head = 0;
+  used = 0;
+  prevTime = 0;
+  prevDelta = 0;
+  prevValue = 0;
+}
+
+uint32_t HistorySeries::count() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < used; i++) {
+    total += blocks[(head + HISTORY_BLOCK_COUNT - i) % HISTORY_BLOCK_COUNT].count;
+  }
+  return total;
+}
+
+uint32_t HistorySeries::firstTime() const {
+  if (used == 0) return 0;
+  return blocks[(head + HISTORY_BLOCK_COUNT - (used - 1)) % HISTORY_BLOCK_COUNT].firstTime;
+}
+
+size_t HistorySeries::bytesUsed() const {
+  size_t total = 0;
+  for (uint8_t i = 0; i < used; i++) {
+    const Block& block = blocks[(head + HISTORY_BLOCK_COUNT - i) % HISTORY_BLOCK_COUNT];
+    total += sizeof(block.firstTime) + sizeof(block.firstValue) + (block.bitLength + 7) / 8;
+  }
+  return total;
+}
+
+void HistorySeries::startBlock(uint32_t time, int32_t value) {
+  if (used > 0) head = (head + 1) % HISTORY_BLOCK_COUNT;
+  if (used < HISTORY_BLOCK_COUNT) used++;  // Otherwise the oldest block is overwritten
+
+  Block& block = blocks[head];
+  block.firstTime = time;
+  block.firstValue = value;
+  block.count = 1;
+  block.bitLength = 0;
+  memset(block.data, 0, sizeof(block.data));
+
+  prevTime = time;
+  prevDelta = 0;
+  prevValue = value;
+}
+
+void HistorySeries::writeBits(uint32_t bits, uint8_t count) {
+  Block& block = blocks[head];
+  while (count > 0) {
+    count--;
+    if ((bits >> count) & 1) block.data[block.bitLength >> 3] |= 0x80 >> (block.bitLength & 7);
+    block.bitLength++;
+  }
+}
+
+void HistorySeries::writeSigned(const uint8_t* widths, int32_t value) {
+  if (value == 0) {
+    writeBits(0, 1);
+    return;
+  }
+  uint32_t z = zigzag(value);
+  for (uint8_t i = 0; i < 3; i++) {
+    if (z < (1UL << widths[i])) {
+      writeBits((1UL << (i + 2)) - 2, i + 2);  // i+1 ones followed by a zero
+      writeBits(z, widths[i]);
+      return;
+    }
+  }
+  writeBits(0x0F, 4);
+  writeBits(z, widths[3]);
+}
+
+bool HistorySeries::append(uint32_t time, float value) {
+  int32_t fixed = toFixed(value, scale);
+
+  if (used == 0) {
+    startBlock(time, fixed);
+    return true;
+  }
+  if (time < prevTime) return false;
+
+  uint32_t delta = time - prevTime;
+  int64_t valueDelta = (int64_t)fixed - prevValue;
+  if (delta > HISTORY_MAX_GAP || valueDelta > INT32_MAX || valueDelta < INT32_MIN) {
+    startBlock(time, fixed);
+    return true;
+  }
+
+  int32_t deltaOfDelta = (int32_t)delta - prevDelta;
+  uint16_t needed = encodedBits(TIME_WIDTHS, deltaOfDelta) + encodedBits(VALUE_WIDTHS, (int32_t)valueDelta);
+  Block& block = blocks[head];
+  if (block.bitLength + needed > HISTORY_BLOCK_BITS || block.count == UINT16_MAX) {
+    startBlock(time, fixed);
+    return true;
+  }
+
+  writeSigned(TIME_WIDTHS, deltaOfDelta);
+  writeSigned(VALUE_WIDTHS, (int32_t)valueDelta);
+  block.count++;
+
+  prevTime = time;
+  prevDelta = (int32_t)delta;
+  prevValue = fixed;
+  return true;
+}
+
+HistorySeries::Iterator::Iterator(const HistorySeries& series)
+    : series(&series), blocksLeft(series.used), sampleInBlock(0), bitPosition(0), time(0), delta(0), value(0) {
+  block = series.used ? (series.head + HISTORY_BLOCK_COUNT - (series.used - 1)) % HISTORY_BLOCK_COUNT : 0;
+}
+
+bool HistorySeries::Iterator::readBits(uint8_t count, uint32_t& out) {
+  const Block& current = series->blocks[block];
+  if (bitPosition + count > current.bitLength) return false;
+  out = 0;
+  while (count > 0) {
+    out = (out << 1) | ((current.data[bitPosition >> 3] >> (7 - (bitPosition & 7))) & 1);
+    bitPosition++;
+    count--;
+  }
+  return true;
+}
+
+bool HistorySeries::Iterator::readSigned(const uint8_t* widths, int32_t& out) {
+  uint8_t ones = 0;
+  uint32_t bit;
+  while (ones < 4) {
+    if (!readBits(1, bit)) return false;
+    if (!bit) break;
+    ones++;
+  }
+  if (ones == 0) {
+    out = 0;
+    return true;
+  }
+
+  uint32_t z;
+  if (!readBits(widths[ones - 1], z)) return false;
+  out = unzigzag(z);
+  return true;
+}
+
+bool HistorySeries::Iterator::next(uint32_t& outTime, float& outValue) {
+  if (blocksLeft == 0) return false;
+  const Block& current = series->blocks[block];
+
+  if (sampleInBlock == 0) {
+    time = current.firstTime;
+    value = current.firstValue;
+    delta = 0;
+    bitPosition = 0;
+  } else {
+    int32_t deltaOfDelta, valueDelta;
+    if (!readSigned(TIME_WIDTHS, deltaOfDelta) || !readSigned(VALUE_WIDTHS, valueDelta)) {
+      blocksLeft = 0;  // Corrupt block - stop rather than return garbage
+      return false;
+    }
+    delta += deltaOfDelta;
+    time += delta;
+    value += valueDelta;
+  }
+
+  if (++sampleInBlock >= current.count) {
+    sampleInBlock = 0;
+    block = (block + 1) % HISTORY_BLOCK_COUNT;
+    blocksLeft--;
+  }
+
+  outTime = time;
+  outValue = value / series->scale;
+  return true;
+}
+
+uint32_t historyDecimate(const HistorySeries& series, uint32_t start, uint32_t end,
+                         HistoryColumn* columns, uint16_t width) {
+  for (uint16_t i = 0; i < width; i++) columns[i].count = 0;
+  if (width == 0 || end <= start) return 0;
+
+  uint32_t span = end - start;
+  uint32_t placed = 0;
+  uint32_t time;
+  float value;
+  HistorySeries::Iterator it = series.begin();
+  while (it.next(time, value)) {
+    if (time < start) continue;
+    if (time >= end) break;  // Samples are in time order
+
+    HistoryColumn& column = columns[(uint16_t)((uint64_t)(time - start) * width / span)];
+    if (column.count == 0) {
+      column.min = value;
+      column.max = value;
+    } else {
+      if (value < column.min) column.min = value;
+      if (value > column.max) column.max = value;
+    }
+    column.last = value;
+    if (column.count < UINT16_MAX) column.count++;
+    placed++;
+  }
+  return placed;
+}
@@ -0,0 +1,460 @@
+#include "inflate.h"
+#include <string.h>
+
+#define GZIP_HEADER_CRC 0x02
+#define GZIP_EXTRA 0x04
+#define GZIP_NAME 0x08
+#define GZIP_COMMENT 0x10
+#define GZIP_FIELDS (GZIP_HEADER_CRC | GZIP_EXTRA | GZIP_NAME | GZIP_COMMENT)
+
+#define DECODE_MORE -1      // Code runs past the bits received so far
+#define DECODE_INVALID -2   // Not a code of this table
+
+static const uint16_t lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                          257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                          8193, 12289, 16385, 24577};
+static const uint8_t distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                          7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// CRC-32 (gzip trailer), four bits at a time
+static const uint32_t crcNibble[16] = {0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+                                       0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+                                       0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+// Order the code length code lengths are sent in
+static const uint8_t codeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+Inflater::Inflater(InflateOutput& output) : output(output) {
+  reset(INFLATE_GZIP);
+}
+
+void Inflater::reset(InflateFormat streamFormat) {
+  in = nullptr;
+  inEnd = nullptr;
+  bitBuffer = 0;
+  bitCount = 0;
+  state = STATE_HEADER;
+  format = streamFormat;
+  finalBlock = false;
+  headerFlags = 0;
+  headerPosition = 0;
+  extraLeft = 0;
+  trailerLength = format == INFLATE_GZIP ? 8 : 0;
+  trailerPosition = 0;
+  trailerSize = 0;
+  trailerCheck = 0;
+  checksum = format == INFLATE_GZIP ? 0xFFFFFFFF : 1;
+  storedLeft = 0;
+  inBytes = 0;
+  outBytes = 0;
+  windowPosition = 0;
+  flushed = 0;
+}
+
+bool Inflater::feed(const uint8_t* data, size_t length) {
+  in = data;
+  inEnd = data + length;
+  inBytes += length;
+  while (state == STATE_HEADER && in < inEnd) {
+    if (!headerByte(*in++)) state = STATE_ERROR;
+  }
+  while (step()) {
+  }
+  // Hand on what this chunk produced; bytes after the end of the stream are ignored
+  if (state != STATE_ERROR) flush();
+  return state != STATE_ERROR;
+}
+
+bool Inflater::finish() {
+  if (state != STATE_ERROR) flush();
+  return state == STATE_DONE;
+}
+
+bool Inflater::headerByte(uint8_t c) {
+  if (format == INFLATE_ZLIB_OR_RAW) {
+    headerBytes[headerPosition++] = c;
+    if (headerPosition < 2) return true;
+    // zlib: deflate method, window <= 32 KB, check bits, no preset dictionary
+    uint16_t check = (uint16_t)headerBytes[0] << 8 | headerBytes[1];
+    if ((headerBytes[0] & 0x0F) == 8 && (headerBytes[0] >> 4) <= 7 && check % 31 == 0 && !(headerBytes[1] & 0x20)) {
+      trailerLength = 4;
+    } else {
+      // Raw deflate, the two bytes already belong to the first block
+      bitBuffer = headerBytes[0] | (uint64_t)headerBytes[1] << 8;
+      bitCount = 16;
+    }
+    state = STATE_BLOCK_HEADER;
+    return true;
+  }
+
+  if (headerPosition < 10) {
+    // Magic, deflate method, flags, then mtime/xfl/os which are skipped
+    if ((headerPosition == 0 && c != 0x1F) || (headerPosition == 1 && c != 0x8B) || (headerPosition == 2 && c != 8)) {
+      return false;
+    }
+    if (headerPosition == 3) {
+      if (c & 0xE0) return false;  // Reserved flags
+      headerFlags = c & GZIP_FIELDS;
+    }
+    headerPosition++;
+  } else if (headerFlags & GZIP_EXTRA) {
+    if (headerPosition < 12) {
+      extraLeft |= (uint16_t)c << ((headerPosition - 10) * 8);
+      headerPosition++;
+    } else {
+      extraLeft--;
+    }
+    if (headerPosition == 12 && extraLeft == 0) headerFlags &= ~GZIP_EXTRA;
+  } else if (headerFlags & GZIP_NAME) {
+    if (c == 0) headerFlags &= ~GZIP_NAME;
+  } else if (headerFlags & GZIP_COMMENT) {
+    if (c == 0) headerFlags &= ~GZIP_COMMENT;
+  } else if (headerFlags & GZIP_HEADER_CRC) {
+    if (++extraLeft == 2) headerFlags &= ~GZIP_HEADER_CRC;
+  }
+
+  if (headerPosition >= 10 && headerFlags == 0) state = STATE_BLOCK_HEADER;
+  return true;
+}
+
+// Pull input bytes into the bit buffer until it holds at least bits (<= 48)
+bool Inflater::ensure(uint8_t bits) {
+  while (bitCount < bits && in < inEnd) {
+    bitBuffer |= (uint64_t)*in++ << bitCount;
+    bitCount += 8;
+  }
+  return bitCount >= bits;
+}
+
+// Symbol starting position bits into the buffer, or DECODE_MORE / DECODE_INVALID
+int Inflater::decode(const Huffman& code, uint8_t position, uint8_t& used) {
+  uint8_t available = bitCount - position;
+  uint32_t bits = (uint32_t)(bitBuffer >> position);
+  uint16_t entry = code.fast[bits & ((1 << INFLATE_FAST_BITS) - 1)];
+  if (entry != 0 && (entry >> 9) <= available) {
+    used = entry >> 9;
+    return entry & 0x1FF;
+  }
+
+  // Longer codes (or too few bits for the table): canonical decode bit by bit
+  int value = 0;
+  int first = 0;
+  int index = 0;
+  for (uint8_t length = 1; length <= 15; length++) {
+    if (length > available) return DECODE_MORE;
+    value |= (bits >> (length - 1)) & 1;
+    int count = code.count[length];
+    if (value - first < count) {
+      used = length;
+      return code.symbol[index + value - first];
+    }
+    index += count;
+    first = (first + count) << 1;
+    value <<= 1;
+  }
+  return DECODE_INVALID;
+}
+
+bool Inflater::build(Huffman& code, const uint8_t* codeLengths, uint16_t count) {
+  memset(code.count, 0, sizeof(code.count));
+  for (uint16_t symbol = 0; symbol < count; symbol++) code.count[codeLengths[symbol]]++;
+
+  // Over-subscribed codes are corrupt; incomplete ones are allowed (unused codes fail in decode)
+  int left = 1;
+  for (uint8_t length = 1; length <= 15; length++) {
+    left = (left << 1) - code.count[length];
+    if (left < 0) return false;
+  }
+
+  uint16_t offsets[16];
+  offsets[1] = 0;
+  for (uint8_t length = 1; length < 15; length++) offsets[length + 1] = offsets[length] + code.count[length];
+  for (uint16_t symbol = 0; symbol < count; symbol++) {
+    if (codeLengths[symbol] != 0) code.symbol[offsets[codeLengths[symbol]]++] = symbol;
+  }
+
+  // Short codes into the lookup table, bit-reversed since deflate sends codes MSB first
+  memset(code.fast, 0, sizeof(code.fast));
+  uint16_t next = 0;
+  uint16_t index = 0;
+  for (uint8_t length = 1; length <= INFLATE_FAST_BITS; length++) {
+    for (uint16_t i = 0; i < code.count[length]; i++) {
+      uint16_t reversed = 0;
+      for (uint8_t bit = 0; bit < length; bit++) reversed |= ((next >> bit) & 1) << (length - 1 - bit);
+      uint16_t entry = (uint16_t)(length << 9) | code.symbol[index++];
+      for (uint16_t fill = reversed; fill < (1 << INFLATE_FAST_BITS); fill += 1 << length) code.fast[fill] = entry;
+      next++;
+    }
+    next <<= 1;
+  }
+  return true;
+}
+
+void Inflater::endBlock() {
+  if (finalBlock) {
+    drop(bitCount & 7);  // Trailer starts on a byte boundary
+    state = STATE_TRAILER;
+  } else {
+    state = STATE_BLOCK_HEADER;
+  }
+}
+
+// Run one state; false when it needs more input (or the stream ended / failed)
+bool Inflater::step() {
+  switch (state) {
+    case STATE_BLOCK_HEADER: {
+      if (!ensure(3)) return false;
+      finalBlock = peek(0, 1);
+      uint8_t type = peek(1, 2);
+      drop(3);
+      if (type == 0) {
+        drop(bitCount & 7);  // Stored block length is byte aligned
+        state = STATE_STORED_LENGTH;
+      } else if (type == 1) {
+        // Fixed codes
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 112);
+        memset(lengths + 256, 7, 24);
+        memset(lengths + 280, 8, 8);
+        build(literalCode, lengths, 288);
+        memset(lengths, 5, 30);
+        build(distanceCode, lengths, 30);
+        state = STATE_CODES;
+      } else if (type == 2) {
+        state = STATE_TABLE_COUNTS;
+      } else {
+        state = STATE_ERROR;
+        return false;
+      }
+      return true;
+    }
+
+    case STATE_STORED_LENGTH: {
+      if (!ensure(32)) return false;
+      uint16_t length = peek(0, 16);
+      if (length != (uint16_t)~peek(16, 16)) {
+        state = STATE_ERROR;
+        return false;
+      }
+      drop(32);
+      storedLeft = length;
+      state = STATE_STORED_COPY;
+      return true;
+    }
+
+    case STATE_STORED_COPY:
+      while (storedLeft > 0) {
+        if (!ensure(8)) return false;
+        if (!put(peek(0, 8))) return false;
+        drop(8);
+        storedLeft--;
+      }
+      endBlock();
+      return true;
+
+    case STATE_TABLE_COUNTS:
+      if (!ensure(14)) return false;
+      literalCount = 257 + peek(0, 5);
+      distanceCount = 1 + peek(5, 5);
+      codeLengthCount = 4 + peek(10, 4);
+      drop(14);
+      if (literalCount > 286 || distanceCount > 30) {
+        state = STATE_ERROR;
+        return false;
+      }
+      memset(lengths, 0, 19);
+      lengthIndex = 0;
+      state = STATE_CODE_LENGTH_CODES;
+      return true;
+
+    case STATE_CODE_LENGTH_CODES:
+      while (lengthIndex < codeLengthCount) {
+        if (!ensure(3)) return false;
+        lengths[codeLengthOrder[lengthIndex++]] = peek(0, 3);
+        drop(3);
+      }
+      if (!build(literalCode, lengths, 19)) {
+        state = STATE_ERROR;
+        return false;
+      }
+      lengthIndex = 0;
+      state = STATE_CODE_LENGTHS;
+      return true;
+
+    case STATE_CODE_LENGTHS: {
+      uint16_t total = literalCount + distanceCount;
+      while (lengthIndex < total) {
+        ensure(14);
+        uint8_t used;
+        int symbol = decode(literalCode, 0, used);
+        if (symbol == DECODE_MORE) return false;
+        if (symbol < 0) {
+          state = STATE_ERROR;
+          return false;
+        }
+        if (symbol < 16) {
+          drop(used);
+          lengths[lengthIndex++] = symbol;
+          continue;
+        }
+        // 16: repeat the previous length 3-6 times, 17: 3-10 zeros, 18: 11-138 zeros
+        uint8_t extra = symbol == 16 ? 2 : symbol == 17 ? 3 : 7;
+        if (bitCount < used + extra) return false;
+        uint16_t repeat = (symbol == 18 ? 11 : 3) + peek(used, extra);
+        if ((symbol == 16 && lengthIndex == 0) || lengthIndex + repeat > total) {
+          state = STATE_ERROR;
+          return false;
+        }
+        uint8_t length = symbol == 16 ? lengths[lengthIndex - 1] : 0;
+        drop(used + extra);
+        while (repeat--) lengths[lengthIndex++] = length;
+      }
+      // The block has to be able to end
+      if (lengths[256] == 0 || !build(literalCode, lengths, literalCount) ||
+          !build(distanceCode, lengths + literalCount, distanceCount)) {
+        state = STATE_ERROR;
+        return false;
+      }
+      state = STATE_CODES;
+      return true;
+    }
+
+    case STATE_CODES:
+      return decodeCodes();
+
+    case STATE_TRAILER:
+      // gzip: CRC-32 and size, little endian; zlib: Adler-32, big endian
+      while (trailerPosition < trailerLength) {
+        if (!ensure(8)) return false;
+        uint32_t c = peek(0, 8);
+        if (trailerPosition >= 4) {
+          trailerSize |= c << ((trailerPosition - 4) * 8);
+        } else if (format == INFLATE_GZIP) {
+          trailerCheck |= c << (trailerPosition * 8);
+        } else {
+          trailerCheck = trailerCheck << 8 | c;
+        }
+        drop(8);
+        trailerPosition++;
+      }
+      if (!flush()) return false;  // Brings the checksum up to date
+      if (format == INFLATE_GZIP) {
+        state = trailerCheck == ~checksum && trailerSize == outBytes ? STATE_DONE : STATE_ERROR;
+      } else {
+        state = trailerLength == 0 || trailerCheck == checksum ? STATE_DONE : STATE_ERROR;
+      }
+      return false;
+
+    default:
+      return false;
+  }
+}
+
+// Inner loop for compressed blocks; a symbol with its extra bits and distance is at most 48 bits
+bool Inflater::decodeCodes() {
+  for (;;) {
+    ensure(48);
+    uint8_t used;
+    int symbol = decode(literalCode, 0, used);
+    if (symbol < 0) {
+      if (symbol == DECODE_INVALID) state = STATE_ERROR;
+      return false;
+    }
+    if (symbol < 256) {
+      drop(used);
+      if (!put(symbol)) return false;
+      continue;
+    }
+    if (symbol == 256) {
+      drop(used);
+      endBlock();
+      return true;
+    }
+
+    symbol -= 257;
+    if (symbol >= 29) {
+      state = STATE_ERROR;
+      return false;
+    }
+    uint8_t position = used;
+    uint8_t extra = lengthExtra[symbol];
+    if (bitCount < position + extra) return false;
+    uint16_t length = lengthBase[symbol] + peek(position, extra);
+    position += extra;
+
+    int distanceSymbol = decode(distanceCode, position, used);
+    if (distanceSymbol < 0 || distanceSymbol >= 30) {
+      if (distanceSymbol != DECODE_MORE) state = STATE_ERROR;
+      return false;
+    }
+    position += used;
+    extra = distanceExtra[distanceSymbol];
+    if (bitCount < position + extra) return false;
+    uint16_t distance = distanceBase[distanceSymbol] + peek(position, extra);
+    position += extra;
+    if (distance > outBytes) {
+      state = STATE_ERROR;  // Reaches back before the start of the stream
+      return false;
+    }
+    drop(position);
+
+    // Read before write, so distance == window size copies correctly
+    uint16_t from = (windowPosition - distance) & (INFLATE_WINDOW_SIZE - 1);
+    while (length--) {
+      if (!put(window[from])) return false;
+      from = (from + 1) & (INFLATE_WINDOW_SIZE - 1);
+    }
+  }
+}
+
+bool Inflater::put(uint8_t c) {
+  window[windowPosition++] = c;
+  outBytes++;
+  if (windowPosition == INFLATE_WINDOW_SIZE) {
+    if (!flush()) return false;
+    windowPosition = 0;
+    flushed = 0;
+  }
+  return true;
+}
+
+bool Inflater::flush() {
+  if (windowPosition > flushed) {
+    updateChecksum(window + flushed, windowPosition - flushed);
+    if (!output.inflated(window + flushed, windowPosition - flushed)) {
+      state = STATE_ERROR;
+      return false;
+    }
+    flushed = windowPosition;
+  }
+  return true;
+}
+
+void Inflater::updateChecksum(const uint8_t* data, size_t length) {
+  if (format == INFLATE_GZIP) {
+    uint32_t crc = checksum;
+    for (size_t i = 0; i < length; i++) {
+      crc ^= data[i];
+      crc = (crc >> 4) ^ crcNibble[crc & 0x0F];
+      crc = (crc >> 4) ^ crcNibble[crc & 0x0F];
+    }
+    checksum = crc;
+  } else if (trailerLength != 0) {
+    // Adler-32; 5552 bytes is the most that can be summed before the modulo
+    uint32_t a = checksum & 0xFFFF;
+    uint32_t b = checksum >> 16;
+    while (length > 0) {
+      size_t run = length < 5552 ? length : 5552;
+      length -= run;
+      while (run--) {
+        a += *data++;
+        b += a;
+      }
+      a %= 65521;
+      b %= 65521;
+    }
+    checksum = b << 16 | a;
+  }
+}
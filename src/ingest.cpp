@@ -0,0 +1,943 @@
+#include <ArduinoJson.h>
+#include "config.h"
+#include "weather.h"
+#include "ingest.h"
+#include "eventlog.h"
+#include "timezone.h"
+
+// ============================================================================
+// Shape helpers
+// ============================================================================
+
+// Accept both JSON numbers and numeric strings (SWPC tables quote every value)
+static bool readNumber(JsonVariantConst value, float& out) {
+  if (value.is<float>()) {
+    out = value.as<float>();
+    return isfinite(out);
+  }
+  const char* text = value.as<const char*>();
+  if (text == nullptr || *text == '\0') return false;
+  char* end;
+  float parsed = strtof(text, &end);
+  if (end == text || *end != '\0' || !isfinite(parsed)) return false;
+  out = parsed;
+  return true;
+}
+
+// Find a named column in the header row of an SWPC table product
+static int findColumn(JsonArrayConst header, const char* name) {
+  int index = 0;
+  for (JsonVariantConst column : header) {
+    const char* label = column.as<const char*>();
+    if (label != nullptr && strcmp(label, name) == 0) return index;
+    index++;
+  }
+  return -1;
+}
+
+// Scan an SWPC table ([header, row, row, ...]) once and return the newest
+// in-range value of a named column; null and out-of-range rows are skipped
+static bool latestTableValue(JsonArrayConst table, const char* column,
+                             float minValue, float maxValue, float& out, uint8_t source) {
+  int columnIndex = findColumn(table[0], column);
+  if (columnIndex < 0) {
+    LOG_ERROR(EV_SCHEMA_ERROR, source, SCHEMA_MISSING_COLUMN);
+    return false;
+  }
+
+  bool found = false;
+  bool header = true;
+  for (JsonVariantConst row : table) {
+    if (header) {
+      header = false;
+      continue;
+    }
+    float value;
+    if (readNumber(row[columnIndex], value) && value >= minValue && value <= maxValue) {
+      out = value;
+      found = true;
+    }
+  }
+
+  if (!found) {
+    LOG_ERROR(EV_SCHEMA_ERROR, source, SCHEMA_NO_VALID_ROWS);
+  }
+  return found;
+}
+
+// Deserialize and require a top-level array
+static bool parseArray(JsonDocument& doc, const char* json, size_t length, uint8_t source,
+                       const JsonDocument* filter = nullptr) {
+  DeserializationError error = filter ?
+    deserializeJson(doc, json, length, DeserializationOption::Filter(*filter)) :
+    deserializeJson(doc, json, length);
+  if (error) {
+    LOG_ERROR(EV_JSON_ERROR, source, error.code());
+    return false;
+  }
+  if (!doc.is<JsonArray>() || doc.size() == 0) {
+    LOG_ERROR(EV_SCHEMA_ERROR, source, SCHEMA_NOT_ARRAY);
+    return false;
+  }
+  return true;
+}
+
+// ============================================================================
+// OpenWeatherMap
+// ============================================================================
+
+bool ingestOneCall(const char* json, size_t length) {
+  // Keep only the fields we display - cuts parse time and DOM size several-fold
+  static JsonDocument filter;
+  if (filter.isNull()) {
+    JsonObject current = filter["current"].to<JsonObject>();
+    for (const char* key : {"temp", "humidity", "pressure", "wind_speed", "wind_deg",
+                            "uvi", "visibility"}) {
+      current[key] = true;
+    }
+    current["weather"][0]["description"] = true;
+    current["weather"][0]["icon"] = true;
+
+    JsonObject hour = filter["hourly"][0].to<JsonObject>();
+    for (const char* key : {"dt", "temp", "pop", "humidity"}) {
+      hour[key] = true;
+    }
+    hour["weather"][0]["icon"] = true;
+    hour["weather"][0]["main"] = true;
+
+    JsonObject day = filter["daily"][0].to<JsonObject>();
+    for (const char* key : {"dt", "pop"}) {
+      day[key] = true;
+    }
+    day["temp"]["min"] = true;
+    day["temp"]["max"] = true;
+    day["weather"][0]["icon"] = true;
+    day["weather"][0]["description"] = true;
+  }
+
+  JsonDocument doc;
+  DeserializationError error = deserializeJson(doc, json, length, DeserializationOption::Filter(filter));
+  if (error) {
+    LOG_ERROR(EV_JSON_ERROR, SRC_ONECALL, error.code());
+    return false;
+  }
+
+  JsonObjectConst current = doc["current"];
+  if (current.isNull() || !current["temp"].is<float>()) {
+    LOG_ERROR(EV_SCHEMA_ERROR, SRC_ONECALL, SCHEMA_NOT_OBJECT);
+    return false;
+  }
+
+  // Parse current weather
+  currentWeather.temperature = current["temp"].as<float>();
+  currentWeather.humidity = current["humidity"] | currentWeather.humidity;
+  currentWeather.pressure = current["pressure"] | currentWeather.pressure;
+  currentWeather.windSpeed = current["wind_speed"] | currentWeather.windSpeed;
+  currentWeather.windDirection = current["wind_deg"] | currentWeather.windDirection;
+  currentWeather.description = current["weather"][0]["description"] | "";
+  currentWeather.icon = current["weather"][0]["icon"] | "";
+  currentWeather.lastUpdate = millis();
+
+  // Parse UV and visibility for the air quality screen
+  if (current["uvi"].is<float>()) {
+    airQuality.uvIndex = current["uvi"].as<int>();
+    if (airQuality.uvIndex <= 2) airQuality.uvRisk = "Low";
+    else if (airQuality.uvIndex <= 5) airQuality.uvRisk = "Moderate";
+    else if (airQuality.uvIndex <= 7) airQuality.uvRisk = "High";
+    else if (airQuality.uvIndex <= 10) airQuality.uvRisk = "Very High";
+    else airQuality.uvRisk = "Extreme";
+  }
+
+  if (current["visibility"].is<float>()) {
+    airQuality.visibility = current["visibility"].as<float>() / 1000.0; // Convert to km
+  }
+  airQuality.lastUpdate = millis();
+
+  // Parse hourly forecast (next 12 hours, starting from next hour)
+  JsonArrayConst hourly = doc["hourly"];
+  if (hourly.isNull()) {
+    LOG_ERROR(EV_SCHEMA_ERROR, SRC_ONECALL, SCHEMA_NOT_ARRAY);
+  } else {
+    int hourCount = 0;
+    bool skipCurrent = true;
+    for (JsonObjectConst hour : hourly) {
+      if (skipCurrent) {  // Index 0 is the current hour
+        skipCurrent = false;
+        continue;
+      }
+      if (hourCount >= 12) break;
+
+      time_t utcTime = hour["dt"] | 0UL;
+
+      HourlyForecast& entry = hourlyForecast.hours[hourCount];
+      formatHour(utcTime, entry.time, sizeof(entry.time));
+      entry.temperature = hour["temp"] | 0.0f;
+      entry.icon = hour["weather"][0]["icon"] | "";
+      entry.description = hour["weather"][0]["main"] | "";
+      entry.precipChance = (int)((hour["pop"] | 0.0f) * 100);
+      entry.humidity = hour["humidity"] | 0;
+
+      LOG_DEBUG(EV_HOURLY_ENTRY, hourCount, (int32_t)(utcTime % 86400 / 3600), (int32_t)(entry.temperature * 10));
+      hourCount++;
+    }
+    hourlyForecast.lastUpdate = millis();
+  }
+
+  // Parse daily forecast (7 days)
+  JsonArrayConst daily = doc["daily"];
+  if (daily.isNull()) {
+    LOG_ERROR(EV_SCHEMA_ERROR, SRC_ONECALL, SCHEMA_NOT_ARRAY);
+  } else {
+    static const char* const dayNames[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    int dayCount = 0;
+
+    for (JsonObjectConst day : daily) {
+      if (dayCount >= 7) break;
+
+      time_t timestamp = day["dt"] | 0UL;
+      LocalTime local;
+      toLocalTime(timestamp, local);
+
+      DayForecast& entry = weeklyForecast.days[dayCount];
+      if (dayCount == 0) {
+        entry.dayName = "Today";
+      } else if (dayCount == 1) {
+        entry.dayName = "Tomorrow";
+      } else {
+        entry.dayName = dayNames[local.weekday];
+      }
+
+      entry.tempHigh = day["temp"]["max"] | 0.0f;
+      entry.tempLow = day["temp"]["min"] | 0.0f;
+      entry.icon = day["weather"][0]["icon"] | "";
+      entry.description = day["weather"][0]["description"] | "";
+      entry.precipChance = (int)((day["pop"] | 0.0f) * 100);
+
+      dayCount++;
+    }
+    weeklyForecast.lastUpdate = millis();
+  }
+
+  return true;
+}
+
+bool ingestAirQuality(const char* json, size_t length) {
+  JsonDocument doc;
+  DeserializationError error = deserializeJson(doc, json, length);
+  if (error) {
+    LOG_ERROR(EV_JSON_ERROR, SRC_AIR_QUALITY, error.code());
+    return false;
+  }
+
+  JsonObjectConst entry = doc["list"][0];
+  JsonObjectConst components = entry["components"];
+  if (entry.isNull() || components.isNull() || !entry["main"]["aqi"].is<int>()) {
+    LOG_ERROR(EV_SCHEMA_ERROR, SRC_AIR_QUALITY, SCHEMA_NOT_OBJECT);
+    return false;
+  }
+
+  airQuality.aqi = entry["main"]["aqi"].as<int>();
+
+  // AQI status mapping
+  switch(airQuality.aqi) {
+    case 1: airQuality.status = "Good"; break;
+    case 2: airQuality.status = "Fair"; break;
+    case 3: airQuality.status = "Moderate"; break;
+    case 4: airQuality.status = "Poor"; break;
+    case 5: airQuality.status = "Very Poor"; break;
+    default: airQuality.status = "Unknown"; break;
+  }
+
+  airQuality.co = components["co"] | airQuality.co;
+  airQuality.no2 = components["no2"] | airQuality.no2;
+  airQuality.o3 = components["o3"] | airQuality.o3;
+  airQuality.pm2_5 = components["pm2_5"] | airQuality.pm2_5;
+  airQuality.pm10 = components["pm10"] | airQuality.pm10;
+
+  return true;
+}
+
+// ============================================================================
+// NOAA SWPC
+// ============================================================================
+
+bool ingestKpIndex(const char* json, size_t length) {
+  // [["time_tag","Kp","a_running","station_count"], ...]
+  JsonDocument doc;
+  if (!parseArray(doc, json, length, SRC_KP_INDEX)) return false;
+  return latestTableValue(doc.as<JsonArrayConst>(), "Kp", 0.0, 9.0,
+                          currentSpaceWeather.kpIndex, SRC_KP_INDEX);
+}
+
+bool ingestSolarFlux(const char* json, size_t length) {
+  // [{"time_tag": "...", "flux": 152.0, ...}, ...]
+  JsonDocument doc;
+  if (!parseArray(doc, json, length, SRC_SOLAR_FLUX)) return false;
+
+  bool found = false;
+  for (JsonObjectConst entry : doc.as<JsonArrayConst>()) {
+    float flux;
+    if (readNumber(entry["flux"], flux) && flux > 0 && flux < 1000) {
+      noaaSpaceWeather.solarFluxIndex = flux;
+      found = true;
+    }
+  }
+  if (!found) LOG_ERROR(EV_SCHEMA_ERROR, SRC_SOLAR_FLUX, SCHEMA_NO_VALID_ROWS);
+  return found;
+}
+
+bool ingestGeomagIndices(const char* json, size_t length) {
+  JsonDocument doc;
+  if (!parseArray(doc, json, length, SRC_GEOMAG_INDICES)) return false;
+  JsonArrayConst table = doc.as<JsonArrayConst>();
+
+  // Prefer the planetary A column by name; older layouts only have it at index 3
+  int column = findColumn(table[0], "Planetary A");
+  if (column < 0) column = 3;
+
+  bool found = false;
+  bool header = true;
+  for (JsonVariantConst row : table) {
+    if (header) {
+      header = false;
+      continue;
+    }
+    float value;
+    if (readNumber(row[column], value) && value >= 0 && value <= 400) {
+      noaaSpaceWeather.aIndex = value;
+      found = true;
+    }
+  }
+  if (!found) LOG_ERROR(EV_SCHEMA_ERROR, SRC_GEOMAG_INDICES, SCHEMA_NO_VALID_ROWS);
+  return found;
+}
+
+// ============================================================================
+// OVATION aurora nowcast (streamed)
+// ============================================================================
+
+OvationIngest ovationIngest;
+
+void OvationIngest::setLocation(float latitude, float longitude) {
+  clearLocations();
+  addLocation(latitude, longitude, auroraNowcast);
+}
+
+void OvationIngest::clearLocations() {
+  targetCount = 0;
+}
+
+bool OvationIngest::addLocation(float latitude, float longitude, AuroraNowcastData& nowcast) {
+  if (targetCount == LOCATION_MAX) return false;
+  Target& target = targets[targetCount++];
+  target.latitude = latitude;
+  target.longitude = longitude;
+  target.nowcast = &nowcast;
+  return true;
+}
+
+void OvationIngest::begin() {
+  // Grid cells are whole degrees, longitude 0-359 east
+  for (uint8_t i = 0; i < targetCount; i++) {
+    Target& target = targets[i];
+    target.gridLongitude = ((int32_t)lroundf(target.longitude) % 360 + 360) % 360;
+    target.gridLatitude = (int32_t)lroundf(target.latitude);
+    target.probability = -1;
+    target.polewardMax = 0;
+    target.ovalEdge = 0;
+  }
+  depth = 0;
+  inCoordinates = false;
+  wantForecastTime = false;
+  fieldCount = 0;
+  cells = 0;
+  forecastTime[0] = '\0';
+}
+
+void OvationIngest::startObject() {
+  depth++;
+}
+
+void OvationIngest::endObject() {
+  depth--;
+}
+
+void OvationIngest::key(const char* name) {
+  // {"Observation Time": ..., "Forecast Time": ..., "coordinates": [[lon, lat, aurora], ...]}
+  if (depth != 1) return;
+  inCoordinates = strcmp(name, "coordinates") == 0;
+  wantForecastTime = strcmp(name, "Forecast Time") == 0;
+}
+
+void OvationIngest::startArray() {
+  depth++;
+  fieldCount = 0;
+}
+
+void OvationIngest::endArray() {
+  if (inCoordinates && depth == 3 && fieldCount == 3) {
+    cell(fields[0], fields[1], fields[2]);
+  }
+  depth--;
+}
+
+void OvationIngest::value(const char* text, JsonValueType type) {
+  if (inCoordinates && depth == 3) {
+    if (fieldCount < 3 && type == JSON_NUMBER && jsonToInt(text, fields[fieldCount])) {
+      fieldCount++;
+    } else {
+      fieldCount = 4;  // Malformed triple, skip it
+    }
+  } else if (wantForecastTime && depth == 1 && type == JSON_STRING) {
+    strlcpy(forecastTime, text, sizeof(forecastTime));
+  }
+}
+
+void OvationIngest::cell(int32_t longitude, int32_t latitude, int32_t value) {
+  cells++;
+  for (uint8_t i = 0; i < targetCount; i++) {
+    Target& target = targets[i];
+    if (longitude != target.gridLongitude) continue;  // Only our meridians matter
+
+    if (latitude == target.gridLatitude) target.probability = value;
+
+    bool sameHemisphere = target.gridLatitude >= 0 ? latitude > 0 : latitude < 0;
+    if (!sameHemisphere) continue;
+
+    if (abs(latitude) > abs(target.gridLatitude) && value > target.polewardMax) {
+      target.polewardMax = value;
+    }
+    if (value >= AURORA_OVAL_THRESHOLD && (target.ovalEdge == 0 || abs(latitude) < abs(target.ovalEdge))) {
+      target.ovalEdge = latitude;
+    }
+  }
+}
+
+bool OvationIngest::finish(bool parsed) {
+  if (!parsed || targetCount == 0) return false;
+  // All or nothing, like the other ingests
+  for (uint8_t i = 0; i < targetCount; i++) {
+    if (targets[i].probability < 0 || targets[i].probability > 100) {
+      LOG_ERROR(EV_SCHEMA_ERROR, SRC_OVATION, SCHEMA_NO_VALID_ROWS);
+      return false;
+    }
+  }
+
+  for (uint8_t i = 0; i < targetCount; i++) {
+    const Target& target = targets[i];
+    AuroraNowcastData& nowcast = *target.nowcast;
+    nowcast.probability = target.probability;
+    nowcast.polewardMax = target.polewardMax;
+    nowcast.ovalEdgeLatitude = target.ovalEdge;
+    if (target.ovalEdge == 0) {
+      nowcast.viewlineLatitude = 0;
+    } else {
+      nowcast.viewlineLatitude = target.ovalEdge > 0 ? target.ovalEdge - AURORA_HORIZON_DISTANCE
+                                                     : target.ovalEdge + AURORA_HORIZON_DISTANCE;
+    }
+    strlcpy(nowcast.forecastTime, forecastTime, sizeof(nowcast.forecastTime));
+    nowcast.lastUpdate = millis();
+  }
+
+  LOG_INFO(EV_AURORA_NOWCAST, targets[0].probability, targets[0].ovalEdge, (int32_t)cells);
+  return true;
+}
+
+// ============================================================================
+// SWPC Kp forecast (streamed)
+// ============================================================================
+
+KpForecastIngest kpForecastIngest;
+
+void KpForecastIngest::begin() {
+  kpSeriesClear(staging);
+  depth = 0;
+  topIsArray = false;
+  headerSeen = false;
+  columns[FIELD_TIME] = columns[FIELD_KP] = columns[FIELD_SOURCE] = -1;
+  currentKey = FIELD_NONE;
+}
+
+void KpForecastIngest::startObject() {
+  depth++;
+  if (depth == 2) {
+    rowIsObject = true;
+    rowHasTime = false;
+    rowHasKp = false;
+    rowSource = KP_PREDICTED;
+  }
+}
+
+void KpForecastIngest::endObject() {
+  if (depth == 2) endRow();
+  depth--;
+}
+
+void KpForecastIngest::startArray() {
+  depth++;
+  if (depth == 1) topIsArray = true;
+  if (depth == 2) {
+    rowIsObject = false;
+    column = 0;
+    rowHasTime = false;
+    rowHasKp = false;
+    rowSource = KP_PREDICTED;
+  }
+}
+
+void KpForecastIngest::endArray() {
+  if (depth == 2) {
+    if (headerSeen) {
+      endRow();
+    } else {
+      headerSeen = true;  // First table row names the columns
+    }
+  }
+  depth--;
+}
+
+void KpForecastIngest::key(const char* name) {
+  if (depth != 2) return;
+  if (strcmp(name, "time_tag") == 0) currentKey = FIELD_TIME;
+  else if (strcmp(name, "kp") == 0) currentKey = FIELD_KP;
+  else if (strcmp(name, "observed") == 0) currentKey = FIELD_SOURCE;
+  else currentKey = FIELD_NONE;
+}
+
+void KpForecastIngest::value(const char* text, JsonValueType type) {
+  if (depth != 2) return;
+
+  if (rowIsObject) {
+    if (currentKey != FIELD_NONE) field(currentKey, text, type);
+    currentKey = FIELD_NONE;
+    return;
+  }
+
+  if (!headerSeen) {
+    // Header row of the table form
+    if (strcmp(text, "time_tag") == 0) columns[FIELD_TIME] = column;
+    else if (strcmp(text, "kp") == 0) columns[FIELD_KP] = column;
+    else if (strcmp(text, "observed") == 0) columns[FIELD_SOURCE] = column;
+    column++;
+    return;
+  }
+
+  for (int8_t which = FIELD_TIME; which <= FIELD_SOURCE; which++) {
+    if (columns[which] == column) field((Field)which, text, type);
+  }
+  column++;
+}
+
+void KpForecastIngest::field(Field which, const char* text, JsonValueType type) {
+  if (which == FIELD_TIME && type == JSON_STRING) {
+    rowHasTime = parseUtcTimestamp(text, rowTime);
+  } else if (which == FIELD_KP && (type == JSON_NUMBER || type == JSON_STRING)) {
+    rowHasKp = jsonToFloat(text, rowKp) && rowKp >= 0 && rowKp <= 9;
+  } else if (which == FIELD_SOURCE && type == JSON_STRING) {
+    if (strcmp(text, "observed") == 0) rowSource = KP_OBSERVED;
+    else if (strcmp(text, "estimated") == 0) rowSource = KP_ESTIMATED;
+    else rowSource = KP_PREDICTED;
+  }
+}
+
+void KpForecastIngest::endRow() {
+  if (rowHasTime && rowHasKp) {
+    kpSeriesAppend(staging, rowTime, rowKp, rowSource);
+  }
+}
+
+bool KpForecastIngest::finish(bool parsed) {
+  if (!parsed) return false;
+  if (!topIsArray) {
+    LOG_ERROR(EV_SCHEMA_ERROR, SRC_KP_FORECAST, SCHEMA_NOT_ARRAY);
+    return false;
+  }
+  if (staging.count == 0) {
+    LOG_ERROR(EV_SCHEMA_ERROR, SRC_KP_FORECAST, headerSeen && columns[FIELD_KP] < 0 ? SCHEMA_MISSING_COLUMN
+                                                                                   : SCHEMA_NO_VALID_ROWS);
+    return false;
+  }
+
+  kpForecast = staging;
+  return true;
+}
+
+// ============================================================================
+// SWPC solar wind (streamed)
+// ============================================================================
+
+// Column names and accepted ranges of the primary/secondary field per product
+static const char* const SOLAR_WIND_COLUMNS[2][2] = {
+  {"bz_gsm", "by_gsm"},
+  {"speed", "density"}
+};
+static const float SOLAR_WIND_LIMITS[2][2][2] = {
+  {{-200.0, 200.0}, {-200.0, 200.0}},
+  {{100.0, 3000.0}, {0.0, 500.0}}
+};
+
+SolarWindIngest solarWindMagIngest(SOLAR_WIND_MAG);
+SolarWindIngest solarWindPlasmaIngest(SOLAR_WIND_PLASMA);
+
+void SolarWindIngest::begin() {
+  binner.begin(kind);
+  depth = 0;
+  topIsArray = false;
+  headerSeen = false;
+  columns[FIELD_TIME] = columns[FIELD_PRIMARY] = columns[FIELD_SECONDARY] = -1;
+  rows = 0;
+}
+
+void SolarWindIngest::startArray() {
+  depth++;
+  if (depth == 1) topIsArray = true;
+  if (depth == 2) {
+    column = 0;
+    rowFields = 0;
+  }
+}
+
+void SolarWindIngest::endArray() {
+  if (depth == 2) {
+    if (headerSeen) {
+      endRow();
+    } else {
+      headerSeen = true;  // First table row names the columns
+    }
+  }
+  depth--;
+}
+
+void SolarWindIngest::value(const char* text, JsonValueType type) {
+  if (depth != 2) return;
+
+  if (!headerSeen) {
+    if (strcmp(text, "time_tag") == 0) columns[FIELD_TIME] = column;
+    else if (strcmp(text, SOLAR_WIND_COLUMNS[kind][0]) == 0) columns[FIELD_PRIMARY] = column;
+    else if (strcmp(text, SOLAR_WIND_COLUMNS[kind][1]) == 0) columns[FIELD_SECONDARY] = column;
+    column++;
+    return;
+  }
+
+  // SWPC quotes every value and uses null for missing samples
+  if (column == columns[FIELD_TIME]) {
+    if (type == JSON_STRING && parseUtcTimestamp(text, rowTime)) rowFields |= 1 << FIELD_TIME;
+  } else if (column == columns[FIELD_PRIMARY] || column == columns[FIELD_SECONDARY]) {
+    uint8_t which = column == columns[FIELD_PRIMARY] ? 0 : 1;
+    float number;
+    if ((type == JSON_STRING || type == JSON_NUMBER) && jsonToFloat(text, number) &&
+        number >= SOLAR_WIND_LIMITS[kind][which][0] && number <= SOLAR_WIND_LIMITS[kind][which][1]) {
+      if (which == 0) rowPrimary = number;
+      else rowSecondary = number;
+      rowFields |= 1 << (FIELD_PRIMARY + which);
+    }
+  }
+  column++;
+}
+
+void SolarWindIngest::endRow() {
+  if (rowFields != (1 << FIELD_COUNT) - 1) return;  // Needs time and both values
+
+  binner.add(solarWind, (uint32_t)rowTime, rowPrimary, rowSecondary);
+  if (rows == 0 || rowTime >= latestTime) {
+    latestTime = rowTime;
+    latestPrimary = rowPrimary;
+    latestSecondary = rowSecondary;
+  }
+  rows++;
+}
+
+bool SolarWindIngest::finish(bool parsed) {
+  // Bins already written hold real measurements, so keep them even on a truncated body
+  binner.flush(solarWind);
+
+  uint8_t source = kind == SOLAR_WIND_MAG ? SRC_SOLAR_WIND_MAG : SRC_SOLAR_WIND_PLASMA;
+  if (!topIsArray) {
+    if (parsed) LOG_ERROR(EV_SCHEMA_ERROR, source, SCHEMA_NOT_ARRAY);
+    return false;
+  }
+  if (rows == 0) {
+    if (parsed) {
+      LOG_ERROR(EV_SCHEMA_ERROR, source, headerSeen && columns[FIELD_PRIMARY] < 0 ? SCHEMA_MISSING_COLUMN
+                                                                                 : SCHEMA_NO_VALID_ROWS);
+    }
+    return false;
+  }
+
+  if (kind == SOLAR_WIND_MAG) {
+    currentSpaceWeather.magneticFieldBz = latestPrimary;
+    currentSpaceWeather.magneticFieldBy = latestSecondary;
+    uint32_t southward = solarWindSouthwardSeconds(solarWind, (uint32_t)latestTime, BZ_SOUTHWARD_THRESHOLD);
+    currentSpaceWeather.bzSouthwardMinutes = southward / 60;
+  } else {
+    currentSpaceWeather.solarWindSpeed = latestPrimary;
+    currentSpaceWeather.solarWindDensity = latestSecondary;
+  }
+
+  LOG_INFO(EV_SOLAR_WIND_BINNED, source, rows, kind == SOLAR_WIND_MAG ? currentSpaceWeather.bzSouthwardMinutes : 0);
+  return parsed;
+}
+
+// ============================================================================
+// GOES X-ray flux (streamed)
+// ============================================================================
+
+XrayIngest xrayIngest;
+
+void XrayIngest::begin() {
+  detector.begin(FLARE_MIN_FLUX);
+  depth = 0;
+  topIsArray = false;
+  currentKey = FIELD_NONE;
+}
+
+void XrayIngest::startObject() {
+  depth++;
+  if (depth == 2) {
+    rowHasTime = false;
+    rowHasFlux = false;
+    rowChannel = -1;
+  }
+}
+
+void XrayIngest::endObject() {
+  if (depth == 2 && rowHasTime && rowHasFlux && rowChannel >= 0) {
+    detector.sample((XrayChannel)rowChannel, (uint32_t)rowTime, rowFlux);
+  }
+  depth--;
+}
+
+void XrayIngest::startArray() {
+  depth++;
+  if (depth == 1) topIsArray = true;
+}
+
+void XrayIngest::endArray() {
+  depth--;
+}
+
+void XrayIngest::key(const char* name) {
+  if (depth != 2) return;
+  if (strcmp(name, "time_tag") == 0) currentKey = FIELD_TIME;
+  else if (strcmp(name, "flux") == 0) currentKey = FIELD_FLUX;
+  else if (strcmp(name, "energy") == 0) currentKey = FIELD_ENERGY;
+  else currentKey = FIELD_NONE;
+}
+
+void XrayIngest::value(const char* text, JsonValueType type) {
+  if (depth != 2) return;
+
+  if (currentKey == FIELD_TIME && type == JSON_STRING) {
+    rowHasTime = parseUtcTimestamp(text, rowTime);
+  } else if (currentKey == FIELD_FLUX && type == JSON_NUMBER) {
+    rowHasFlux = jsonToFloat(text, rowFlux) && rowFlux > 0 && rowFlux < 1;
+  } else if (currentKey == FIELD_ENERGY && type == JSON_STRING) {
+    // Flare classes are defined on the long (0.1-0.8 nm) channel
+    if (strcmp(text, "0.1-0.8nm") == 0) rowChannel = XRAY_LONG;
+    else if (strcmp(text, "0.05-0.4nm") == 0) rowChannel = XRAY_SHORT;
+  }
+  currentKey = FIELD_NONE;
+}
+
+bool XrayIngest::finish(bool parsed) {
+  // Only a complete scan may replace the events in the window it covers
+  if (!topIsArray) {
+    if (parsed) LOG_ERROR(EV_SCHEMA_ERROR, SRC_XRAY, SCHEMA_NOT_ARRAY);
+    return false;
+  }
+  if (detector.latestTime() == 0) {
+    if (parsed) LOG_ERROR(EV_SCHEMA_ERROR, SRC_XRAY, SCHEMA_NO_VALID_ROWS);
+    return false;
+  }
+  if (!parsed) return false;
+
+  detector.finish(flareEvents);
+
+  char flareClass[8];
+  flareClassText(detector.latestFlux(), flareClass, sizeof(flareClass));
+  noaaSpaceWeather.xrayFlux = flareClass;
+
+  const FlareEvent* latest = flareEvents.count ? &flareEvents.events[flareEvents.count - 1] : nullptr;
+  LOG_INFO(EV_FLARES_DETECTED, (int32_t)detector.samples(), flareEvents.count,
+           latest ? (int32_t)(latest->peakFlux * 1e8f) : 0);
+  return true;
+}
+
+// ============================================================================
+// SWPC active regions (streamed)
+// ============================================================================
+
+SolarRegionIngest solarRegionIngest;
+
+void SolarRegionIngest::begin() {
+  aggregator.begin();
+  depth = 0;
+  topIsArray = false;
+  currentKey = FIELD_NONE;
+}
+
+void SolarRegionIngest::startObject() {
+  depth++;
+  if (depth == 2) {
+    rowObserved = 0;
+    rowRegion = 0;
+    rowSpots = -1;
+    rowArea = -1;
+  }
+}
+
+void SolarRegionIngest::endObject() {
+  if (depth == 2) aggregator.add((uint32_t)rowObserved, rowRegion, rowSpots, rowArea);
+  depth--;
+}
+
+void SolarRegionIngest::startArray() {
+  depth++;
+  if (depth == 1) topIsArray = true;
+}
+
+void SolarRegionIngest::endArray() {
+  depth--;
+}
+
+void SolarRegionIngest::key(const char* name) {
+  if (depth != 2) return;
+  if (strcmp(name, "observed_date") == 0) currentKey = FIELD_DATE;
+  else if (strcmp(name, "region") == 0) currentKey = FIELD_REGION;
+  else if (strcmp(name, "number_spots") == 0) currentKey = FIELD_SPOTS;
+  else if (strcmp(name, "area") == 0) currentKey = FIELD_AREA;
+  else currentKey = FIELD_NONE;
+}
+
+void SolarRegionIngest::value(const char* text, JsonValueType type) {
+  if (depth != 2) return;
+
+  if (currentKey == FIELD_DATE && type == JSON_STRING) {
+    // "2025-10-24", a date only
+    char timestamp[24];
+    snprintf(timestamp, sizeof(timestamp), "%.10s 00:00", text);
+    if (!parseUtcTimestamp(timestamp, rowObserved)) rowObserved = 0;
+  } else if (currentKey != FIELD_NONE && currentKey != FIELD_DATE &&
+             (type == JSON_NUMBER || type == JSON_STRING)) {
+    int32_t number;
+    if (jsonToInt(text, number) && number >= 0) {
+      if (currentKey == FIELD_REGION) rowRegion = number;
+      else if (currentKey == FIELD_SPOTS) rowSpots = number;
+      else rowArea = number;
+    }
+  }
+  currentKey = FIELD_NONE;
+}
+
+bool SolarRegionIngest::finish(bool parsed) {
+  if (!topIsArray) {
+    if (parsed) LOG_ERROR(EV_SCHEMA_ERROR, SRC_SOLAR_REGIONS, SCHEMA_NOT_ARRAY);
+    return false;
+  }
+
+  // A cut-off transfer may have missed rows of the latest date
+  SunspotSummary summary;
+  if (!parsed) return false;
+  if (!aggregator.finish(summary)) {
+    LOG_ERROR(EV_SCHEMA_ERROR, SRC_SOLAR_REGIONS, SCHEMA_NO_VALID_ROWS);
+    return false;
+  }
+
+  noaaSpaceWeather.sunspotNumber = summary.sunspotNumber;
+  noaaSpaceWeather.activeRegions = summary.regions;
+  noaaSpaceWeather.sunspotArea = summary.area;
+
+  LOG_INFO(EV_SUNSPOTS_AGGREGATED, aggregator.rows(), summary.regions, summary.sunspotNumber);
+  return true;
+}
+
+// ============================================================================
+// SWPC alerts (streamed)
+// ============================================================================
+
+AlertIngest alertIngest;
+
+void AlertIngest::begin() {
+  depth = 0;
+  topIsArray = false;
+  currentKey = FIELD_NONE;
+  rows = 0;
+  added = 0;
+  duplicates = 0;
+  time_t clock = time(nullptr);
+  now = clock > MIN_VALID_EPOCH ? (uint32_t)clock : 0;
+}
+
+char* AlertIngest::tokenBuffer(size_t& size) {
+  size = sizeof(token);
+  return token;
+}
+
+void AlertIngest::startObject() {
+  depth++;
+  if (depth == 2) {
+    rowHasProduct = false;
+    rowHasIssued = false;
+    rowHasMessage = false;
+  }
+}
+
+void AlertIngest::endObject() {
+  if (depth == 2 && rowHasProduct && rowHasIssued && rowHasMessage) {
+    rows++;
+    AlertResult result = alertStoreAdd(alertStore, message, (uint32_t)rowIssued, now);
+    if (result == ALERT_ADDED) added++;
+    else if (result == ALERT_DUPLICATE) duplicates++;
+  }
+  depth--;
+}
+
+void AlertIngest::startArray() {
+  depth++;
+  if (depth == 1) topIsArray = true;
+}
+
+void AlertIngest::endArray() {
+  depth--;
+}
+
+void AlertIngest::key(const char* name) {
+  if (depth != 2) return;
+  if (strcmp(name, "product_id") == 0) currentKey = FIELD_PRODUCT;
+  else if (strcmp(name, "issue_datetime") == 0) currentKey = FIELD_ISSUED;
+  else if (strcmp(name, "message") == 0) currentKey = FIELD_MESSAGE;
+  else currentKey = FIELD_NONE;
+}
+
+void AlertIngest::value(const char* text, JsonValueType type) {
+  if (depth != 2 || type != JSON_STRING) {
+    currentKey = FIELD_NONE;
+    return;
+  }
+
+  if (currentKey == FIELD_PRODUCT) {
+    rowHasProduct = *text != '\0';
+  } else if (currentKey == FIELD_ISSUED) {
+    rowHasIssued = parseUtcTimestamp(text, rowIssued);
+  } else if (currentKey == FIELD_MESSAGE) {
+    // Keys may come in any order, so the message waits for the object to close
+    strlcpy(message, text, sizeof(message));
+    rowHasMessage = true;
+  }
+  currentKey = FIELD_NONE;
+}
+
+bool AlertIngest::finish(bool parsed) {
+  if (!topIsArray) {
+    if (parsed) LOG_ERROR(EV_SCHEMA_ERROR, SRC_ALERTS, SCHEMA_NOT_ARRAY);
+    return false;
+  }
+
+  // Entries added before a failed transfer are still valid products; an empty
+  // array is valid too (no alerts)
+  if (now != 0) alertStoreExpire(alertStore, now);
+  noaaSpaceWeather.alertCount = alertStore.count;
+
+  LOG_INFO(EV_ALERTS_INGESTED, added, duplicates, alertStore.count);
+  return parsed;
+}
@@ -0,0 +1,300 @@
+#include "json_stream.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+JsonStreamParser::JsonStreamParser(JsonStreamHandler& handler, char* tokenBuffer, size_t tokenSize)
+  : handler(handler), token(tokenBuffer), tokenSize(tokenSize) {
+  reset();
+}
+
+void JsonStreamParser::reset() {
+  tokenLength = 0;
+  consumed = 0;
+  containerBits = 0;
+  level = 0;
+  state = STATE_VALUE;
+  stringIsKey = false;
+  tokenTruncated = false;
+  unicodeDigits = 0;
+  unicodeValue = 0;
+  if (tokenSize > 0) token[0] = '\0';
+}
+
+bool JsonStreamParser::feed(const char* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if (state == STATE_ERROR) return false;
+    if (!process(data[i])) {
+      state = STATE_ERROR;
+      return false;
+    }
+    consumed++;
+  }
+  return state != STATE_ERROR;
+}
+
+bool JsonStreamParser::finish() {
+  // A bare top-level number has no terminator
+  if (state == STATE_NUMBER && level == 0) {
+    if (!emitScalar()) state = STATE_ERROR;
+  }
+  return state == STATE_DONE;
+}
+
+static bool isWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool JsonStreamParser::process(char c) {
+  switch (state) {
+    case STATE_STRING:
+      if (c == '"') {
+        token[tokenLength] = '\0';
+        if (stringIsKey) {
+          handler.key(token);
+          state = STATE_COLON;
+        } else {
+          handler.value(token, JSON_STRING);
+          endValue();
+        }
+      } else if (c == '\\') {
+        state = STATE_STRING_ESCAPE;
+      } else if ((uint8_t)c < 0x20) {
+        return false;  // Raw control characters are not allowed in strings
+      } else {
+        append(c);
+      }
+      return true;
+
+    case STATE_STRING_ESCAPE:
+      state = STATE_STRING;
+      switch (c) {
+        case '"': append('"'); break;
+        case '\\': append('\\'); break;
+        case '/': append('/'); break;
+        case 'b': append('\b'); break;
+        case 'f': append('\f'); break;
+        case 'n': append('\n'); break;
+        case 'r': append('\r'); break;
+        case 't': append('\t'); break;
+        case 'u':
+          state = STATE_STRING_UNICODE;
+          unicodeDigits = 0;
+          unicodeValue = 0;
+          break;
+        default: return false;
+      }
+      return true;
+
+    case STATE_STRING_UNICODE: {
+      uint8_t digit;
+      if (c >= '0' && c <= '9') digit = c - '0';
+      else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+      else return false;
+      unicodeValue = (unicodeValue << 4) | digit;
+      if (++unicodeDigits == 4) {
+        appendCodepoint(unicodeValue);
+        state = STATE_STRING;
+      }
+      return true;
+    }
+
+    case STATE_NUMBER:
+      if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+        return appendDigit(c);
+      }
+      if (!emitScalar()) return false;
+      return process(c);  // The terminator belongs to the enclosing structure
+
+    case STATE_LITERAL:
+      if (c >= 'a' && c <= 'z') {
+        append(c);
+        return true;
+      }
+      if (!emitScalar()) return false;
+      return process(c);
+
+    default:
+      break;
+  }
+
+  if (isWhitespace(c)) return true;
+
+  switch (state) {
+    case STATE_VALUE:
+      return beginValue(c);
+
+    case STATE_VALUE_OR_END:
+      if (c == ']') return pop(false);
+      return beginValue(c);
+
+    case STATE_KEY_OR_END:
+      if (c == '}') return pop(true);
+      // Fall through
+    case STATE_KEY:
+      if (c != '"') return false;
+      tokenLength = 0;
+      stringIsKey = true;
+      state = STATE_STRING;
+      return true;
+
+    case STATE_COLON:
+      if (c != ':') return false;
+      state = STATE_VALUE;
+      return true;
+
+    case STATE_AFTER_VALUE: {
+      bool inObject = containerBits & (1UL << (level - 1));
+      if (c == ',') {
+        state = inObject ? STATE_KEY : STATE_VALUE;
+        return true;
+      }
+      if (c == '}') return pop(true);
+      if (c == ']') return pop(false);
+      return false;
+    }
+
+    default:
+      return false;  // STATE_DONE accepts only trailing whitespace
+  }
+}
+
+bool JsonStreamParser::beginValue(char c) {
+  if (c == '{') return push(true);
+  if (c == '[') return push(false);
+
+  tokenLength = 0;
+  if (c == '"') {
+    stringIsKey = false;
+    state = STATE_STRING;
+  } else if (c == '-' || (c >= '0' && c <= '9')) {
+    if (!appendDigit(c)) return false;
+    state = STATE_NUMBER;
+  } else if (c == 't' || c == 'f' || c == 'n') {
+    append(c);
+    state = STATE_LITERAL;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool JsonStreamParser::push(bool object) {
+  if (level >= MAX_DEPTH) return false;
+  if (object) {
+    containerBits |= 1UL << level;
+  } else {
+    containerBits &= ~(1UL << level);
+  }
+  level++;
+
+  if (object) {
+    handler.startObject();
+    state = STATE_KEY_OR_END;
+  } else {
+    handler.startArray();
+    state = STATE_VALUE_OR_END;
+  }
+  return true;
+}
+
+bool JsonStreamParser::pop(bool object) {
+  if (level == 0) return false;
+  bool isObject = containerBits & (1UL << (level - 1));
+  if (isObject != object) return false;  // Mismatched bracket
+  level--;
+
+  if (object) {
+    handler.endObject();
+  } else {
+    handler.endArray();
+  }
+  endValue();
+  return true;
+}
+
+void JsonStreamParser::endValue() {
+  state = level == 0 ? STATE_DONE : STATE_AFTER_VALUE;
+}
+
+void JsonStreamParser::append(char c) {
+  if (tokenLength + 1 < tokenSize) {
+    token[tokenLength++] = c;
+  } else {
+    tokenTruncated = true;
+  }
+}
+
+// Numbers are never truncated: cut short they would read as another value
+bool JsonStreamParser::appendDigit(char c) {
+  if (tokenLength + 1 >= tokenSize) return false;
+  token[tokenLength++] = c;
+  return true;
+}
+
+void JsonStreamParser::appendCodepoint(uint16_t codepoint) {
+  // Surrogate pairs are not joined; they are rare in the feeds we read
+  if (codepoint < 0x80) {
+    append((char)codepoint);
+  } else if (codepoint < 0x800) {
+    append((char)(0xC0 | (codepoint >> 6)));
+    append((char)(0x80 | (codepoint & 0x3F)));
+  } else if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+    append('?');
+  } else {
+    append((char)(0xE0 | (codepoint >> 12)));
+    append((char)(0x80 | ((codepoint >> 6) & 0x3F)));
+    append((char)(0x80 | (codepoint & 0x3F)));
+  }
+}
+
+bool JsonStreamParser::emitScalar() {
+  token[tokenLength] = '\0';
+
+  if (state == STATE_NUMBER) {
+    char last = token[tokenLength - 1];
+    if (last < '0' || last > '9') return false;
+    handler.value(token, JSON_NUMBER);
+  } else if (strcmp(token, "true") == 0) {
+    handler.value(token, JSON_TRUE);
+  } else if (strcmp(token, "false") == 0) {
+    handler.value(token, JSON_FALSE);
+  } else if (strcmp(token, "null") == 0) {
+    handler.value(token, JSON_NULL);
+  } else {
+    return false;
+  }
+
+  endValue();
+  return true;
+}
+
+bool jsonToInt(const char* text, int32_t& out) {
+  // Integer fast path - the big grids are all whole numbers. It stops before
+  // the value could overflow and leaves longer digit runs to the slow path.
+  const char* p = text;
+  bool negative = *p == '-';
+  if (negative) p++;
+  if (*p < '0' || *p > '9') return false;
+
+  int32_t value = 0;
+  while (*p >= '0' && *p <= '9' && value <= (INT32_MAX - 9) / 10) value = value * 10 + (*p++ - '0');
+
+  if (*p != '\0') {
+    // Fractions, exponents and long integers; a double holds every int32_t
+    char* end;
+    double number = round(strtod(text, &end));
+    if (end == text || *end != '\0' || !(number >= INT32_MIN && number <= INT32_MAX)) return false;
+    out = (int32_t)number;
+    return true;
+  }
+  out = negative ? -value : value;
+  return true;
+}
+
+bool jsonToFloat(const char* text, float& out) {
+  char* end;
+  out = strtof(text, &end);
+  return end != text && *end == '\0' && isfinite(out);
+}
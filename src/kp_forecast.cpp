@@ -0,0 +1,86 @@
+#include "kp_forecast.h"
+#include "ephemeris.h"
+#include "timezone.h"
+#include <math.h>
+#include <string.h>
+
+void kpSeriesClear(KpForecastSeries& series) {
+  series.count = 0;
+}
+
+void kpSeriesAppend(KpForecastSeries& series, time_t time, float kp, KpSource source) {
+  if (series.count == KP_FORECAST_CAPACITY) {
+    // The product is chronological and the future matters most - drop the oldest
+    memmove(&series.points[0], &series.points[1], (KP_FORECAST_CAPACITY - 1) * sizeof(KpForecastPoint));
+    series.count--;
+  }
+
+  KpForecastPoint& point = series.points[series.count++];
+  point.time = (uint32_t)time;
+  point.kpTenths = (uint8_t)lroundf(kp * 10);
+  point.source = source;
+}
+
+// Dusk-to-dawn window for the night starting on the local day at dayStart.
+// Prefer astronomical darkness, then nautical, then plain sunset to sunrise.
+static bool darkWindow(time_t dayStart, double latitude, double longitude, time_t& start, time_t& end) {
+  SunTimes evening, morning;
+  computeSunTimes(dayStart, latitude, longitude, evening);
+  computeSunTimes(localMidnight(dayStart + 36 * 3600), latitude, longitude, morning);
+
+  if (evening.astronomicalDusk && morning.astronomicalDawn) {
+    start = evening.astronomicalDusk;
+    end = morning.astronomicalDawn;
+  } else if (evening.nauticalDusk && morning.nauticalDawn) {
+    start = evening.nauticalDusk;
+    end = morning.nauticalDawn;
+  } else if (evening.set && morning.rise) {
+    start = evening.set;
+    end = morning.rise;
+  } else if (sunAltitude(dayStart + 86400, latitude, longitude) < 0) {
+    start = dayStart + 12 * 3600;  // Polar night - dark around the clock
+    end = dayStart + 36 * 3600;
+  } else {
+    return false;                  // Midnight sun
+  }
+  return end > start;
+}
+
+bool analyzeAuroraNight(const KpForecastSeries& series, time_t evening, double latitude, double longitude,
+                        AuroraNight& out) {
+  out.maxKp = -1;
+  out.peakStart = 0;
+  out.peakEnd = 0;
+  out.source = KP_OBSERVED;
+
+  if (!darkWindow(localMidnight(evening), latitude, longitude, out.darkStart, out.darkEnd)) {
+    out.darkStart = 0;
+    out.darkEnd = 0;
+    return false;
+  }
+
+  int maxTenths = -1;
+  for (uint8_t i = 0; i < series.count; i++) {
+    const KpForecastPoint& point = series.points[i];
+    time_t slotStart = point.time;
+    time_t slotEnd = slotStart + KP_SLOT_SECONDS;
+    if (slotEnd <= out.darkStart || slotStart >= out.darkEnd) continue;
+
+    if (point.source > out.source) out.source = (KpSource)point.source;
+
+    time_t darkPartStart = slotStart > out.darkStart ? slotStart : out.darkStart;
+    time_t darkPartEnd = slotEnd < out.darkEnd ? slotEnd : out.darkEnd;
+
+    if (point.kpTenths > maxTenths) {
+      maxTenths = point.kpTenths;
+      out.peakStart = darkPartStart;
+      out.peakEnd = darkPartEnd;
+    } else if (point.kpTenths == maxTenths && darkPartStart <= out.peakEnd) {
+      out.peakEnd = darkPartEnd;  // Adjacent slot at the same level widens the window
+    }
+  }
+
+  if (maxTenths < 0) return false;
+  out.maxKp = maxTenths / 10.0f;
+  return true;
+}
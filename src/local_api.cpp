@@ -0,0 +1,376 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "local_api.h"
+#include "snapshot.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0             // lwIP never raises SIGPIPE
+#endif
+
+#define LOCAL_API_HEAD_SIZE 256
+
+struct ApiClient {
+  int fd;                  // -1 = free
+  uint32_t lastActive;
+  uint16_t received;
+  char request[LOCAL_API_REQUEST_SIZE];
+  // Response in flight: our head, then a body inside the pinned snapshot slot
+  char head[LOCAL_API_HEAD_SIZE];
+  uint16_t headLength;
+  uint16_t headSent;
+  const SnapshotSlot* slot;
+  const uint8_t* body;
+  uint16_t bodyLength;
+  uint16_t bodySent;
+  bool sending;
+  bool closeAfter;
+};
+
+// Header values point into the request buffer, nullptr when absent
+struct ApiRequest {
+  bool head;               // HEAD: headers only
+  bool keepAlive;
+  bool hasBody;
+  const char* connection;
+  const char* accept;
+  const char* ifNoneMatch;
+};
+
+static int listener = -1;
+static ApiClient clients[LOCAL_API_MAX_CLIENTS];
+static LocalApiStats stats = {0, 0, 0, 0};
+
+static const char* const contentTypes[SNAPSHOT_FORMAT_COUNT] = {"application/json", "application/cbor"};
+
+static bool setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static void closeClient(ApiClient& client) {
+  snapshotRelease(client.slot);
+  client.slot = nullptr;
+  close(client.fd);
+  client.fd = -1;
+  client.sending = false;
+}
+
+bool localApiOpen(uint16_t port) {
+  if (listener >= 0) return true;
+  for (uint8_t i = 0; i < LOCAL_API_MAX_CLIENTS; i++) clients[i].fd = -1;
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return false;
+  int yes = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(fd, LOCAL_API_MAX_CLIENTS) != 0 || !setNonBlocking(fd)) {
+    close(fd);
+    return false;
+  }
+  listener = fd;
+  return true;
+}
+
+// Splits the header lines after the request line in place and keeps the
+// ones we act on
+static void parseHeaders(char* lines, ApiRequest& request) {
+  while (*lines != '\0') {
+    char* end = strstr(lines, "\r\n");
+    if (end == nullptr) return;
+    *end = '\0';
+    char* colon = strchr(lines, ':');
+    if (colon != nullptr) {
+      *colon = '\0';
+      char* value = colon + 1;
+      while (*value == ' ' || *value == '\t') value++;
+      if (strcasecmp(lines, "Connection") == 0) request.connection = value;
+      else if (strcasecmp(lines, "Accept") == 0) request.accept = value;
+      else if (strcasecmp(lines, "If-None-Match") == 0) request.ifNoneMatch = value;
+      else if (strcasecmp(lines, "Content-Length") == 0 || strcasecmp(lines, "Transfer-Encoding") == 0) {
+        request.hasBody = strcmp(value, "0") != 0;
+      }
+    }
+    lines = end + 2;
+  }
+}
+
+static bool headerHas(const char* value, const char* token) {
+  if (value == nullptr) return false;
+  size_t length = strlen(token);
+  for (const char* p = value; *p; p++) {
+    if (strncasecmp(p, token, length) == 0) return true;
+  }
+  return false;
+}
+
+static void startResponse(ApiClient& client, const ApiRequest& request, const char* status,
+                          const char* extraHeaders, const SnapshotBody* body, SnapshotFormat format) {
+  bool notModified = strncmp(status, "304", 3) == 0;
+  char entity[96] = "";
+  if (body != nullptr) {
+    // A 304 carries the validator but no length, it has no body of its own
+    int length = snprintf(entity, sizeof(entity), "Content-Type: %s\r\nETag: \"%08lx\"\r\n",
+                          contentTypes[format], (unsigned long)body->etag);
+    if (!notModified) snprintf(entity + length, sizeof(entity) - length, "Content-Length: %u\r\n", body->length);
+  } else {
+    strcpy(entity, "Content-Length: 0\r\n");
+  }
+
+  int written = snprintf(client.head, sizeof(client.head),
+                         "HTTP/1.1 %s\r\n%s%s"
+                         "Cache-Control: no-cache\r\n"
+                         "Access-Control-Allow-Origin: *\r\n"
+                         "Connection: %s\r\n\r\n",
+                         status, entity, extraHeaders, request.keepAlive ? "keep-alive" : "close");
+  client.headLength = written < (int)sizeof(client.head) ? written : sizeof(client.head) - 1;
+  client.headSent = 0;
+  client.body = nullptr;
+  client.bodyLength = 0;
+  client.bodySent = 0;
+  if (body != nullptr && !notModified && !request.head) {
+    client.body = body->data;
+    client.bodyLength = body->length;
+  }
+  client.sending = true;
+  client.closeAfter = !request.keepAlive;
+
+  stats.requests++;
+  if (status[0] == '4' || status[0] == '5') stats.errors++;
+}
+
+static void errorResponse(ApiClient& client, const ApiRequest& request, const char* status, const char* extraHeaders) {
+  startResponse(client, request, status, extraHeaders, nullptr, SNAPSHOT_JSON);
+}
+
+// Handles the complete request head in client.request[0, headLength)
+static void handleRequest(ApiClient& client, uint16_t headLength) {
+  char* head = client.request;
+  head[headLength - 2] = '\0';  // Every line, the last header included, still ends in CRLF
+
+  ApiRequest request = {false, false, false, nullptr, nullptr, nullptr};
+  char* lineEnd = strstr(head, "\r\n");
+  char* target = strchr(head, ' ');
+  char* version = target != nullptr ? strchr(target + 1, ' ') : nullptr;
+  if (lineEnd == nullptr || version == nullptr || version > lineEnd || strncmp(version + 1, "HTTP/1.", 7) != 0) {
+    errorResponse(client, request, "400 Bad Request", "");
+    return;
+  }
+  *lineEnd = '\0';
+  *target++ = '\0';
+  *version++ = '\0';
+  parseHeaders(lineEnd + 2, request);
+
+  bool http10 = strcmp(version, "HTTP/1.0") == 0;
+  request.keepAlive = http10 ? headerHas(request.connection, "keep-alive") : !headerHas(request.connection, "close");
+  // Request bodies are never read, one would be taken for the next request
+  if (request.hasBody) request.keepAlive = false;
+
+  request.head = strcmp(head, "HEAD") == 0;
+  if (!request.head && strcmp(head, "GET") != 0) {
+    errorResponse(client, request, "405 Method Not Allowed", "Allow: GET, HEAD\r\n");
+    return;
+  }
+
+  char* query = strchr(target, '?');
+  if (query != nullptr) *query = '\0';
+  SnapshotFormat format;
+  bool negotiated = false;
+  if (strcmp(target, "/api/snapshot.json") == 0) {
+    format = SNAPSHOT_JSON;
+  } else if (strcmp(target, "/api/snapshot.cbor") == 0) {
+    format = SNAPSHOT_CBOR;
+  } else if (strcmp(target, "/api/snapshot") == 0) {
+    // q-values are ignored: naming CBOR at all selects it
+    format = headerHas(request.accept, "application/cbor") ? SNAPSHOT_CBOR : SNAPSHOT_JSON;
+    negotiated = true;
+  } else {
+    errorResponse(client, request, "404 Not Found", "");
+    return;
+  }
+
+  client.slot = snapshotAcquire();
+  if (client.slot == nullptr) {
+    errorResponse(client, request, "503 Service Unavailable", "Retry-After: 30\r\n");
+    return;
+  }
+  SnapshotBody body = snapshotBody(client.slot, format);
+  const char* vary = negotiated ? "Vary: Accept\r\n" : "";
+
+  char quoted[12];
+  snprintf(quoted, sizeof(quoted), "\"%08lx\"", (unsigned long)body.etag);
+  if (request.ifNoneMatch != nullptr &&
+      (strcmp(request.ifNoneMatch, "*") == 0 || strstr(request.ifNoneMatch, quoted) != nullptr)) {
+    startResponse(client, request, "304 Not Modified", vary, &body, format);
+    stats.notModified++;
+    return;
+  }
+  startResponse(client, request, "200 OK", vary, &body, format);
+}
+
+// Sends what the socket takes; false when the client is gone or the
+// response asked for the connection to be closed
+static bool sendPending(ApiClient& client, uint32_t now) {
+  while (client.headSent < client.headLength || client.bodySent < client.bodyLength) {
+    bool inHead = client.headSent < client.headLength;
+    const void* data = inHead ? (const void*)(client.head + client.headSent) : (const void*)(client.body + client.bodySent);
+    size_t count = inHead ? client.headLength - client.headSent : client.bodyLength - client.bodySent;
+    ssize_t sent = send(client.fd, data, count, MSG_NOSIGNAL);
+    if (sent < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;  // Wait for writable
+    client.lastActive = now;
+    if (inHead) client.headSent += sent;
+    else client.bodySent += sent;
+  }
+
+  client.sending = false;
+  snapshotRelease(client.slot);  // Done with its bytes, the publisher may reuse the slot
+  client.slot = nullptr;
+  return !client.closeAfter;
+}
+
+// Answers every complete request in the buffer, in order, until one has to
+// wait for the socket; false when the client is gone
+static bool serveBuffered(ApiClient& client, uint32_t now) {
+  while (!client.sending) {
+    client.request[client.received] = '\0';
+    char* end = strstr(client.request, "\r\n\r\n");
+    if (end == nullptr) {
+      if (client.received < sizeof(client.request) - 1) return true;
+      ApiRequest request = {false, false, false, nullptr, nullptr, nullptr};
+      errorResponse(client, request, "431 Request Header Fields Too Large", "");
+      client.received = 0;
+      return sendPending(client, now);
+    }
+
+    uint16_t headLength = end + 4 - client.request;
+    handleRequest(client, headLength);
+    // Pipelined bytes move to the front for the next round
+    memmove(client.request, client.request + headLength, client.received - headLength);
+    client.received -= headLength;
+    if (!sendPending(client, now)) return false;
+  }
+  return true;
+}
+
+// Keep-alive client that has waited longest for its next request, at least
+// LOCAL_API_EVICT_IDLE; it gives its slot up when another device is waiting
+// to connect, so a few polling clients cannot lock the rest out
+static int8_t evictableClient(uint32_t now) {
+  int8_t pick = -1;
+  for (uint8_t i = 0; i < LOCAL_API_MAX_CLIENTS; i++) {
+    const ApiClient& client = clients[i];
+    if (client.fd < 0 || client.sending || client.received > 0) continue;
+    if (now - client.lastActive < LOCAL_API_EVICT_IDLE) continue;
+    if (pick < 0 || (int32_t)(client.lastActive - clients[pick].lastActive) < 0) pick = i;
+  }
+  return pick;
+}
+
+static void acceptClients(uint32_t now) {
+  for (;;) {
+    int8_t index = -1;
+    for (uint8_t i = 0; i < LOCAL_API_MAX_CLIENTS && index < 0; i++) {
+      if (clients[i].fd < 0) index = i;
+    }
+    if (index < 0) {
+      index = evictableClient(now);
+      if (index < 0) return;
+      int fd = accept(listener, nullptr, nullptr);
+      if (fd < 0) return;
+      closeClient(clients[index]);
+      clients[index].fd = fd;
+    } else {
+      clients[index].fd = accept(listener, nullptr, nullptr);
+      if (clients[index].fd < 0) return;
+    }
+
+    ApiClient& client = clients[index];
+    if (!setNonBlocking(client.fd)) {
+      closeClient(client);
+      continue;
+    }
+    // Head and body go out as separate sends; without this Nagle holds the
+    // body back until the client's delayed ACK of the head
+    int yes = 1;
+    setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    client.lastActive = now;
+    client.received = 0;
+    client.slot = nullptr;
+    client.sending = false;
+    stats.connections++;
+  }
+}
+
+void localApiPoll(uint32_t now, uint32_t waitMillis) {
+  if (listener < 0) return;
+
+  fd_set readable, writable;
+  FD_ZERO(&readable);
+  FD_ZERO(&writable);
+  int highest = -1;
+  bool canAccept = evictableClient(now) >= 0;
+  for (uint8_t i = 0; i < LOCAL_API_MAX_CLIENTS; i++) {
+    ApiClient& client = clients[i];
+    if (client.fd < 0) {
+      canAccept = true;
+      continue;
+    }
+    // A client mid-response is not read, which also throttles pipelining
+    FD_SET(client.fd, client.sending ? &writable : &readable);
+    if (client.fd > highest) highest = client.fd;
+  }
+  // With every slot busy new connections wait in the listen backlog
+  if (canAccept) {
+    FD_SET(listener, &readable);
+    if (listener > highest) highest = listener;
+  }
+
+  struct timeval timeout;
+  timeout.tv_sec = waitMillis / 1000;
+  timeout.tv_usec = (waitMillis % 1000) * 1000;
+  int ready = select(highest + 1, &readable, &writable, nullptr, &timeout);
+  if (ready < 0) return;
+
+  for (uint8_t i = 0; i < LOCAL_API_MAX_CLIENTS; i++) {
+    ApiClient& client = clients[i];
+    if (client.fd < 0) continue;
+
+    bool alive = true;
+    if (FD_ISSET(client.fd, &writable)) {
+      alive = sendPending(client, now);
+      if (alive && !client.sending) alive = serveBuffered(client, now);
+    } else if (FD_ISSET(client.fd, &readable)) {
+      ssize_t count = recv(client.fd, client.request + client.received,
+                           sizeof(client.request) - 1 - client.received, 0);
+      if (count > 0) {
+        client.received += count;
+        client.lastActive = now;
+        alive = serveBuffered(client, now);
+      } else {
+        alive = count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+      }
+    } else if (now - client.lastActive > LOCAL_API_IDLE_TIMEOUT) {
+      alive = false;
+    }
+    if (!alive) closeClient(client);
+  }
+
+  if (canAccept && FD_ISSET(listener, &readable)) acceptClients(now);
+}
+
+LocalApiStats localApiStats() {
+  return stats;
+}
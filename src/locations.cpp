@@ -0,0 +1,32 @@
+#include "locations.h"
+
+uint32_t locationInterval(uint8_t count, uint8_t activeWeight, bool active, uint32_t sharedInterval,
+                          uint32_t baseInterval) {
+  if (count == 0 || activeWeight == 0) return baseInterval;
+  // Weights of everything sharing the budget
+  uint32_t weight = activeWeight + (uint32_t)(count - 1);
+  uint32_t interval = active ? sharedInterval * weight / activeWeight : sharedInterval * weight;
+  uint32_t floor = active ? baseInterval : baseInterval * activeWeight;
+  return interval > floor ? interval : floor;
+}
+
+uint8_t locationDue(const LocationStatus status[], uint8_t count, uint8_t active, uint32_t now, uint32_t interval) {
+  if (count < 2) return LOCATION_NONE;
+  uint8_t due = LOCATION_NONE;
+  uint32_t oldest = 0;
+  uint32_t newest = interval;
+  for (uint8_t i = 0; i < count; i++) {
+    if (i == active) continue;
+    if (status[i].refreshedAt == 0) return i;
+    uint32_t age = now - status[i].refreshedAt;  // Wraps with millis()
+    if (age < newest) newest = age;
+    if (age >= interval && (due == LOCATION_NONE || age > oldest)) {
+      due = i;
+      oldest = age;
+    }
+  }
+  // Spread over the interval rather than all at once, or they would empty
+  // the quota's burst together and some would be refused
+  if (newest < interval / (count - 1)) return LOCATION_NONE;
+  return due;
+}
@@ -1,10 +1,37 @@
 #include <WiFi.h>
 #include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <new>
 #include <ArduinoJson.h>
 #include <TFT_eSPI.h>
 #include "config.h"
 #include "weather.h"
 #include "display.h"
+#include "eventlog.h"
+#include "ephemeris.h"
+#include "timezone.h"
+#include "ingest.h"
+#include "aurora.h"
+#include "history.h"
+#include "coupling.h"
+#include "wifi_link.h"
+#include "upstream.h"
+#include "fetch_pool.h"
+#include "inflate.h"
+#include "connection_pool.h"
+#include "quota.h"
+#include "snapshot.h"
+#include "local_api.h"
+#include "bundle.h"
+#include "locations.h"
 
 // Configuration variables from config.h
 const char* ssid = WIFI_SSID;
@@ -14,9 +41,26 @@ const char* apiKey = OPENWEATHER_API_KEY;
 // OneCall 3.0 API Configuration
 const char* ONECALL_API_URL = "https://api.openweathermap.org/data/3.0/onecall";
 
-// Location Configuration from config.h
-const float latitude = LATITUDE;
-const float longitude = LONGITUDE;
+// Locations from config.h. The weather.h globals hold one location's data
+// at a time, normally the displayed one; the others are parked as compact
+// bundles of their OneCall and air quality data (~1 KB) and swapped in to
+// refresh or display them.
+const Location locations[] = {LOCATIONS};
+const uint8_t locationsConfigured = sizeof(locations) / sizeof(locations[0]);
+static_assert(locationsConfigured <= LOCATION_MAX, "more LOCATIONS than LOCATION_MAX");
+const uint8_t locationCount = AGGREGATOR_URL[0] != '\0' ? 1 : locationsConfigured; // The aggregator serves one site
+uint8_t activeLocation = 0;
+uint8_t loadedLocation = 0;  // Whose data the globals hold; differs from activeLocation while refreshing another
+bool locationCatchUp = false; // Refresh the newly displayed location on the next loop()
+LocationStatus locationStatus[locationsConfigured];
+struct LocationSlot {
+  uint8_t parked[LOCATION_PARK_SIZE]; // bundleEncode() of the weather while another location is loaded
+  uint16_t length;                    // 0 = nothing parked
+  AuroraNowcastData nowcast;          // Its OVATION cell, written there directly unless displayed
+};
+LocationSlot locationSlots[locationsConfigured];
+float latitude = 0;    // Of loadedLocation, set by loadLocation()
+float longitude = 0;
 
 TFT_eSPI tft = TFT_eSPI();
 WeatherData currentWeather;
@@ -24,9 +68,47 @@ SpaceWeatherData currentSpaceWeather;
 WeeklyForecast weeklyForecast;
 AuroraForecastData auroraToday;
 AuroraForecastData auroraTomorrow;
+AuroraNowcastData auroraNowcast;
+KpForecastSeries kpForecast;
+SolarWindSeries solarWind;
+FlareEventList flareEvents;
+AlertStore alertStore;   // Active SWPC alerts, ~6.8 KB with the compressed text pool
+CouplingEngine coupling; // Newell coupling + ring current state, fed from solarWind
 HourlyForecastData hourlyForecast;
 AirQualityData airQuality;
 NOAASpaceWeatherData noaaSpaceWeather;
+EndpointHealth upstreamHealth[SRC_COUNT]; // Circuit breaker per endpoint
+// Observation history, one compressed series per HistoryChannel (argument = fixed-point scale)
+HistorySeries history[HISTORY_CHANNEL_COUNT] = {
+  HistorySeries(10),   // Temperature, 0.1 F
+  HistorySeries(10),   // Pressure, 0.1 hPa
+  HistorySeries(1),    // Humidity, 1 %
+  HistorySeries(10),   // Wind speed, 0.1 mph
+  HistorySeries(100),  // Kp, 0.01
+  HistorySeries(10),   // Bz, 0.1 nT
+  HistorySeries(1)     // Solar wind speed, 1 km/s
+};
+Rollup rollups[HISTORY_CHANNEL_COUNT];
+// Wi-Fi: the Arduino library behind the wifiLink state machine
+class EspWifiDriver : public WifiDriver {
+public:
+  void connect(const uint8_t* bssid, int32_t channel) override {
+    WiFi.begin(ssid, password, channel, bssid);
+  }
+  void disconnect() override {
+    WiFi.disconnect();
+  }
+  bool accessPoint(uint8_t bssid[6], int32_t& channel) override {
+    const uint8_t* current = WiFi.BSSID();
+    if (current == nullptr) return false;
+    memcpy(bssid, current, 6);
+    channel = WiFi.channel();
+    return channel > 0;
+  }
+};
+EspWifiDriver wifiDriver;
+WifiLink wifiLink(wifiDriver);
+bool catchUpRefresh = false; // Set on reconnect, runs the periodic update on the next loop()
 // Screen control
 int currentScreen = SCREEN_WEATHER;
 bool forceDisplayUpdate = false; // Flag to force immediate display update
@@ -35,34 +117,71 @@ unsigned long lastButtonPress = 0;
 const unsigned long BUTTON_DEBOUNCE = 300;
 
 // Time variables
-String currentTime = "";
+char currentTime[TIME_STRING_SIZE] = "";
 unsigned long lastTimeUpdate = 0;
-const unsigned long TIME_UPDATE_INTERVAL = 60000; // Update every minute
+const unsigned long TIME_UPDATE_INTERVAL = 1000; // Check every second, reformat on minute change
 unsigned long lastWeatherUpdate = 0;
+time_t astronomyDay = 0; // Local midnight the sun and moon times are for, 0 = recompute
 const unsigned long WEATHER_UPDATE_INTERVAL = 600000; // 10 minutes (600 calls/day limit)
 
-// API call tracking for rate limiting
-int dailyApiCalls = 0;
-const int MAX_DAILY_CALLS = 600; // Safety margin under 1000 limit
-unsigned long lastDayReset = 0;
+// API call budgets per QuotaProvider, kept in NVS so reboots do not reset them
+const QuotaPolicy quotaPolicies[QUOTA_PROVIDER_COUNT] = {
+  {QUOTA_OPENWEATHER_DAILY, QUOTA_OPENWEATHER_BURST},
+  {QUOTA_SWPC_DAILY, QUOTA_SWPC_BURST}
+};
+const char* const quotaKeys[QUOTA_PROVIDER_COUNT] = {"owm", "swpc"};
+QuotaBucket quotaBuckets[QUOTA_PROVIDER_COUNT];
+QuotaJournal quotaJournals[QUOTA_PROVIDER_COUNT];      // What the NVS copies have charged ahead
+Preferences quotaStore;
+portMUX_TYPE quotaLock = portMUX_INITIALIZER_UNLOCKED; // Fetch tasks charge concurrently
+SemaphoreHandle_t quotaWriteLock = nullptr;            // Keeps NVS writes in charge order
 
 // Function declarations
 void connectToWiFi();
+void wifiEvent(arduino_event_id_t event, arduino_event_info_t info);
+void wifiUp(const WifiLink& link);
+void wifiDown(const WifiLink& link);
 void updateWeatherData();
-void updateMoonData();
+void updateAstronomyData();
 void updateAllWeatherData();
 void updateAirQualityData();
-void updateSpaceWeatherData();
-void updateNOAASpaceWeatherData();
+void refreshAllData();
+void deriveSpaceWeather();
+void deriveAuroraScore();
+void deriveNOAASpaceWeather();
 void update7DayForecast();
-void updateAuroraForecast();
+void deriveAuroraForecast();
+void locationsBegin();
+void parkLocation(uint8_t index);
+void loadLocation(uint8_t index);
+void activateLocation(uint8_t index);
+void nextLocation();
+void refreshLocations();
+unsigned long locationRefreshInterval(bool active);
 void updateTime();
+void timeSyncCallback(struct timeval* tv);
 void handleButtons();
+void handleSerialCommands();
+void recordHistory(HistoryChannel channel, float value);
+void exportHistory(Stream& out);
+void loadQuotas();
+void saveQuotas();
+uint32_t quotaClock();
+unsigned long quotaRefreshInterval(QuotaProvider provider, unsigned long baseInterval, uint8_t callsPerRefresh);
+bool fetchAllowed(LogSource source);
+void fetchRecord(LogSource source, int httpCode, bool ingested);
+int fetchAndIngest(LogSource source, const char* url, IngestFunction ingest);
+int fetchAndStream(LogSource source, const char* url, StreamIngest& ingest);
+int fetchBundle();
+void publishSnapshot();
+void startLocalApi();
+void localApiTask(void* parameter);
 
 void setup() {
   Serial.begin(115200);
   delay(1000);
   Serial.println("ESP32 Weather Station Starting...");
+  LOG_INFO(EV_BOOT);
   
   // Initialize backlight pin
   pinMode(4, OUTPUT);
@@ -80,6 +199,7 @@ void setup() {
   Serial.println("Display initialized");
   
   displayInit();
+  loadQuotas(); // Before anything can spend API calls
   
   // Show startup sequence with detailed status
   displayMessage("ESP32 Weather Station");
@@ -95,39 +215,29 @@ void setup() {
   displayMessage("Connecting to WiFi...");
   Serial.println("Starting WiFi connection...");
   connectToWiFi();
+  startLocalApi(); // Serves 503 until the first snapshot is published
   
-  // Time synchronization
+  // Time synchronization - SNTP runs in the background and keeps resyncing the RTC
   displayMessage("Syncing Time...");
-  Serial.println("Synchronizing time with API...");
-  delay(1000);
+  Serial.println("Synchronizing time with NTP...");
+  locationsBegin(); // Also sets the home and displayed time zones
+  sntp_set_time_sync_notification_cb(timeSyncCallback);
+  configTzTime(TIME_ZONE, NTP_SERVER_1, NTP_SERVER_2);
+  struct tm timeinfo;
+  if (getLocalTime(&timeinfo, NTP_SYNC_WAIT)) {
+    displayMessage("Time: Synchronized");
+  } else {
+    displayMessage("Time: Pending");
+  }
   updateTime(); // Get time immediately on startup
-  displayMessage("Time: Synchronized");
   delay(1500);
   
-  // Weather data fetching
-  displayMessage("Fetching Weather...");
-  Serial.println("Fetching weather data from OpenWeatherMap OneCall 3.0...");
-  delay(1000);
-  updateAllWeatherData(); // OneCall 3.0 - gets current, hourly, daily in one call
-  displayMessage("Weather: Updated");
-  delay(1500);
-  
-  // Air quality data
-  displayMessage("Getting Air Quality...");
-  Serial.println("Fetching air quality data...");
-  delay(1000);
-  updateAirQualityData();
-  displayMessage("Air Quality: Updated");
-  delay(1500);
-  
-  // Space weather data
-  displayMessage("Space Weather APIs...");
-  Serial.println("Fetching space weather data...");
-  delay(1000);
-  updateSpaceWeatherData();
-  updateNOAASpaceWeatherData();
-  updateAuroraForecast();
-  displayMessage("Space Weather: Updated");
+  // Weather, air quality and space weather, fetched in parallel
+  displayMessage("Fetching Data...");
+  Serial.println("Fetching weather and space weather data...");
+  refreshAllData();
+  publishSnapshot();
+  displayMessage("Data: Updated");
   delay(1500);
   
   // Final status
@@ -142,37 +252,42 @@ void setup() {
 }
 
 void loop() {
-  // Check button presses
+  // Apply Wi-Fi events: reconnects, backoff, catch-up trigger
+  wifiLink.poll(millis());
+  
+  // Check button presses and serial commands
   handleButtons();
+  handleSerialCommands();
   
-  // Update time every minute or when crossing minute boundary
-  static String lastTimeCheck = "";
+  // Update time when crossing a minute boundary
   bool intervalReached = (millis() - lastTimeUpdate >= TIME_UPDATE_INTERVAL);
   
   if (intervalReached) {
     updateTime();
     
-    // Call moon data after first successful time initialization
-    static bool moonDataInitialized = false;
-    if (!moonDataInitialized && timeInitialized) {
-      Serial.println("Time initialized, calling moon data for first time...");
-      updateMoonData();
-      moonDataInitialized = true;
+    // Compute sun and moon data after first successful time initialization
+    static bool astronomyInitialized = false;
+    if (!astronomyInitialized && timeInitialized) {
+      updateAstronomyData();
+      publishSnapshot();
+      astronomyInitialized = true;
     }
   }
   
-  // Check if it's time to update weather data
-  if (millis() - lastWeatherUpdate > WEATHER_UPDATE_INTERVAL) {
-    updateAllWeatherData(); // OneCall 3.0 - gets current, hourly, daily in one call
-    updateAirQualityData(); // Separate air quality call
-    updateMoonData(); // Also update moon data
-    updateSpaceWeatherData(); // Also update space weather data
-    updateNOAASpaceWeatherData(); // Also update NOAA space weather data
-    updateAuroraForecast(); // Update aurora forecasts
+  // Check if it's time to update weather data (or catch up after a reconnect)
+  // SWPC calls per refresh; the interval stretches when the day's budget runs low
+  if (catchUpRefresh || millis() - lastWeatherUpdate > quotaRefreshInterval(QUOTA_SWPC, WEATHER_UPDATE_INTERVAL, 10)) {
+    catchUpRefresh = false;
+    refreshAllData(); // All upstreams in parallel, blocks until every ingest is done
+    updateAstronomyData(); // Recompute moon phase, and sun/moon events on a new day
+    publishSnapshot(); // What the local API serves until the next refresh
     lastWeatherUpdate = millis(); // Update the timestamp
   }
   
   // Update display based on current screen
+#if EVENT_LOG_LEVEL >= LOG_LEVEL_DEBUG
+  unsigned long frameStart = micros();
+#endif
   if (currentScreen == SCREEN_WEATHER) {
     updateDisplay();
   } else if (currentScreen == SCREEN_FORECAST_7DAY) {
@@ -189,17 +304,29 @@ void loop() {
     updateAuroraTodayDisplay();
   } else if (currentScreen == SCREEN_AURORA_TOMORROW) {
     updateAuroraTomorrowDisplay();
+  } else if (currentScreen == SCREEN_HISTORY) {
+    updateHistoryDisplay();
+  } else if (currentScreen == SCREEN_ALERTS) {
+    updateAlertsDisplay();
+  } else if (currentScreen == SCREEN_LOCATIONS) {
+    updateLocationsDisplay();
   } else {
     // Fallback to weather screen if something went wrong
     currentScreen = SCREEN_WEATHER;
     updateDisplay();
   }
+#if EVENT_LOG_LEVEL >= LOG_LEVEL_DEBUG
+  LOG_DEBUG(EV_FRAME, currentScreen, (int32_t)(micros() - frameStart));
+#endif
   
   // Reset force update flag after display functions have been called
   if (forceDisplayUpdate) {
     forceDisplayUpdate = false;
   }
   
+  // At most one location refresh per pass, after the frame is on screen
+  refreshLocations();
+  
   delay(50); // Fast updates for responsive buttons, time/weather update on intervals
 }
 
@@ -208,31 +335,57 @@ void connectToWiFi() {
   Serial.print("Connecting to SSID: ");
   Serial.println(ssid);
   
-  WiFi.begin(ssid, password);
+  WiFi.persistent(false);       // Credentials come from config.h, skip the flash writes
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(false); // wifiLink owns reconnection and its backoff
+  WiFi.onEvent(wifiEvent);
+  wifiLink.onUp(wifiUp);
+  wifiLink.onDown(wifiDown);
+  wifiLink.begin(millis());
   
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-    delay(500);
-    Serial.print(".");
-    displayMessage("WiFi: Attempt " + String(attempts + 1) + "/20");
-    attempts++;
+  // Give the first connection a short head start for the setup() fetches;
+  // if it runs out the link keeps trying from loop() and catches up then
+  unsigned long start = millis();
+  while (!wifiLink.connected() && millis() - start < WIFI_SETUP_WAIT) {
+    wifiLink.poll(millis());
+    delay(50);
   }
   
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("");
+  if (wifiLink.connected()) {
     Serial.print("Connected to WiFi. IP address: ");
     Serial.println(WiFi.localIP());
-    displayMessage("WiFi: Connected!");
-    delay(1000);
     displayMessage("IP: " + WiFi.localIP().toString());
-    delay(2000);
+    delay(1000);
   } else {
-    Serial.println("Failed to connect to WiFi");
-    displayMessage("WiFi Connection Failed!");
-    delay(2000);
+    Serial.println("WiFi not connected yet, retrying in the background");
+    LOG_ERROR(EV_WIFI_FAILED, wifiLink.attempts());
+    displayMessage("WiFi: Retrying...");
+    delay(1000);
   }
 }
 
+// Runs in the Wi-Fi event task: only hand the event to the state machine
+void wifiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+    wifiLink.notify(WIFI_EVENT_GOT_IP);
+  } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+    wifiLink.notify(WIFI_EVENT_DISCONNECTED, info.wifi_sta_disconnected.reason);
+  }
+}
+
+void wifiUp(const WifiLink& link) {
+  LOG_INFO(EV_WIFI_CONNECTED, (int32_t)(uint32_t)WiFi.localIP(), (int32_t)link.outage(), link.attempts());
+  
+  // Catch up after a long outage, or when nothing was fetched yet
+  if (link.outage() >= WIFI_CATCH_UP_OUTAGE || currentWeather.lastUpdate == 0) {
+    catchUpRefresh = true;
+  }
+}
+
+void wifiDown(const WifiLink& link) {
+  LOG_ERROR(EV_WIFI_LOST, link.reason());
+}
+
 void updateWeatherData() {
   // Legacy function - now using updateAllWeatherData() with OneCall 3.0
   // This is kept for compatibility but redirects to the new function
@@ -244,8 +397,7 @@ void parseWeatherData(String jsonString) {
   DeserializationError error = deserializeJson(doc, jsonString);
   
   if (error) {
-    Serial.print("JSON parsing failed: ");
-    Serial.println(error.c_str());
+    LOG_ERROR(EV_JSON_ERROR, SRC_ONECALL, error.code());
     return;
   }
   
@@ -258,97 +410,32 @@ void parseWeatherData(String jsonString) {
   currentWeather.cityName = doc["name"].as<String>();
   currentWeather.windSpeed = doc["wind"]["speed"];
   currentWeather.windDirection = doc["wind"]["deg"];
-  
-  // Extract astronomical data
-  currentWeather.sunrise = doc["sys"]["sunrise"];
-  currentWeather.sunset = doc["sys"]["sunset"];
-  
-  // Note: Basic weather API doesn't include moon data
-  // For moon data, you'd need a different API endpoint
-  currentWeather.moonrise = 0; // Placeholder
-  currentWeather.moonset = 0;  // Placeholder
-  
-  Serial.println("Weather data parsed successfully");
+  // Astronomical data comes from the ephemeris, see updateAstronomyData()
+}
+
+void timeSyncCallback(struct timeval* tv) {
+  // Called from the SNTP task after each successful sync
+  LocalTime local;
+  toLocalTime(tv->tv_sec, local);
+  LOG_INFO(EV_TIME_SYNCED, local.hour, local.minute, local.second);
 }
 
 void updateTime() {
-  static unsigned long timeOffset = 0;
-  // timeInitialized is now global
-  
-  if (!timeInitialized || (millis() - lastTimeUpdate > 3600000)) { // Update from server every hour
-    if (WiFi.status() == WL_CONNECTED) {
-      HTTPClient http;
-      // Use your local timezone (adjust as needed)
-      http.begin("http://worldtimeapi.org/api/timezone/America/Chicago");
-      http.setTimeout(10000); // 10 second timeout
-      int httpCode = http.GET();
-      
-      Serial.print("Time API HTTP code: "); Serial.println(httpCode);
-      
-      if (httpCode == 200) {
-        String payload = http.getString();
-        Serial.println("Time API response: " + payload);
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, payload);
-        
-        if (!error) {
-          String datetime = doc["datetime"].as<String>();
-          String timezone = doc["timezone"].as<String>();
-          
-          Serial.println("Parsed datetime: " + datetime);
-          
-          // Parse ISO datetime: 2025-10-23T14:30:45.123456-05:00
-          int hour = datetime.substring(11, 13).toInt();
-          int minute = datetime.substring(14, 16).toInt();
-          int second = datetime.substring(17, 19).toInt();
-          
-          Serial.printf("Parsed time: %02d:%02d:%02d\n", hour, minute, second);
-          
-          unsigned long serverTime = hour * 3600 + minute * 60 + second;
-          timeOffset = serverTime - (millis() / 1000);
-          timeInitialized = true;
-          
-          // Configure ESP32 system timezone for Chicago (Central Time)
-          // CST6CDT means Central Standard Time (UTC-6) with Daylight saving (UTC-5)
-          configTime(-6 * 3600, 3600, "pool.ntp.org"); // GMT-6 offset, 1 hour DST
-          setenv("TZ", "CST6CDT,M3.2.0,M11.1.0", 1);
-          tzset();
-          
-          Serial.print("Time synchronized - Local Time (");
-          Serial.print(timezone);
-          Serial.println(") - ESP32 timezone configured for Central Time");
-        } else {
-          Serial.println("Failed to parse time API JSON");
-        }
-      } else {
-        Serial.print("Time API failed with HTTP code: ");
-        Serial.println(httpCode);
-      }
-      http.end();
-    }
-  }
+  static int lastMinute = -1;
+  time_t now = time(nullptr);
   
-  // Calculate current time
-  if (timeInitialized) {
-    unsigned long currentSeconds = (millis() / 1000) + timeOffset;
-    int hours = (currentSeconds % 86400) / 3600;
-    int minutes = (currentSeconds % 3600) / 60;
-    
-    String ampm = hours >= 12 ? "PM" : "AM";
-    if (hours > 12) hours -= 12;
-    if (hours == 0) hours = 12;
-    
-    currentTime = String(hours) + ":";
-    if (minutes < 10) currentTime += "0";
-    currentTime += String(minutes) + " " + ampm;
-    Serial.println("Time updated: " + currentTime);
+  if (now > MIN_VALID_EPOCH) {
+    // RTC has been set by SNTP - format local time from the configured TZ rule
+    timeInitialized = true;
+    // Same minute as last time - skip the conversion entirely
+    int minute = (int)(now / 60);
+    if (minute != lastMinute) {
+      formatClock(now, currentTime, sizeof(currentTime));
+      lastMinute = minute;
+    }
   } else {
-    // Fallback to uptime (no seconds to prevent flicker)
-    unsigned long uptime = millis() / 1000;
-    int hours = uptime / 3600;
-    int minutes = (uptime % 3600) / 60;
-    currentTime = String(hours) + "h" + String(minutes) + "m";
-    Serial.println("Time fallback: " + currentTime);
+    // Fallback to uptime (no seconds to prevent flicker); 64-bit timer never wraps
+    formatUptime(esp_timer_get_time(), currentTime, sizeof(currentTime));
   }
   
   lastTimeUpdate = millis();
@@ -379,30 +466,17 @@ void handleButtons() {
         currentScreen = SCREEN_AURORA_TODAY;
       } else if (currentScreen == SCREEN_AURORA_TODAY) {
         currentScreen = SCREEN_AURORA_TOMORROW;
+      } else if (currentScreen == SCREEN_AURORA_TOMORROW) {
+        currentScreen = SCREEN_HISTORY;
+      } else if (currentScreen == SCREEN_HISTORY) {
+        currentScreen = SCREEN_ALERTS;
+      } else if (currentScreen == SCREEN_ALERTS && locationCount > 1) {
+        currentScreen = SCREEN_LOCATIONS;
       } else {
         currentScreen = SCREEN_WEATHER;
       }
       
-      Serial.print("Switched to screen: ");
-      if (currentScreen == SCREEN_WEATHER) {
-        Serial.println("Current Weather");
-      } else if (currentScreen == SCREEN_FORECAST_7DAY) {
-        Serial.println("7-Day Forecast");
-      } else if (currentScreen == SCREEN_HOURLY_FORECAST) {
-        Serial.println("Hourly Forecast");
-      } else if (currentScreen == SCREEN_AIR_QUALITY) {
-        Serial.println("Air Quality & UV");
-      } else if (currentScreen == SCREEN_ASTRONOMY) {
-        Serial.println("Astronomy");
-      } else if (currentScreen == SCREEN_SPACE_WEATHER) {
-        Serial.println("Space Weather");
-      } else if (currentScreen == SCREEN_AURORA_TODAY) {
-        Serial.println("Aurora Today");
-      } else if (currentScreen == SCREEN_AURORA_TOMORROW) {
-        Serial.println("Aurora Tomorrow");
-      } else {
-        Serial.println("NOAA Space Weather");
-      }
+      LOG_INFO(EV_SCREEN_CHANGED, currentScreen);
       lastButtonPress = now;
       
       // Force immediate display update
@@ -412,281 +486,747 @@ void handleButtons() {
   }
   
   buttonWasPressed = buttonPressed;
-}
-
-void updateSpaceWeatherData() {
-  if (WiFi.status() == WL_CONNECTED) {
-    HTTPClient http;
-    
-    Serial.println("Fetching space weather data...");
-    
-    // Using NOAA Space Weather Prediction Center API
-    // This is a simplified approach - in production you might want multiple APIs
-    http.begin("https://services.swpc.noaa.gov/products/noaa-planetary-k-index.json");
-    
-    int httpCode = http.GET();
-    if (httpCode == 200) {
-      String payload = http.getString();
-      
-      // Parse the JSON for latest KP index
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error && doc.size() > 1) {
-        // Get the most recent entry (last in array)
-        JsonArray data = doc.as<JsonArray>();
-        if (data.size() > 0) {
-          JsonArray latest = data[data.size()-1];
-          if (latest.size() > 1) {
-            currentSpaceWeather.kpIndex = latest[1].as<float>();
-          }
-        }
-      }
-    }
-    http.end();
-    
-    // Get additional space weather data from a second API call
-    // Using NOAA real-time solar wind data
-    http.begin("https://services.swpc.noaa.gov/products/solar-wind/mag-1-day.json");
-    httpCode = http.GET();
-    if (httpCode == 200) {
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error && doc.size() > 1) {
-        JsonArray data = doc.as<JsonArray>();
-        if (data.size() > 0) {
-          // Get latest entry
-          JsonArray latest = data[data.size()-1];
-          if (latest.size() > 6) {
-            currentSpaceWeather.magneticFieldBz = latest[6].as<float>(); // Bz component
-          }
-        }
+  
+  // Check left button (selects the series on the history screen, pages through alerts, switches location)
+  static bool leftWasPressed = false;
+  bool leftPressed = (digitalRead(LEFT_BUTTON_PIN) == LOW);
+  
+  if (leftPressed && !leftWasPressed &&
+      (currentScreen == SCREEN_HISTORY || currentScreen == SCREEN_ALERTS || currentScreen == SCREEN_LOCATIONS)) {
+    if (now - lastButtonPress > BUTTON_DEBOUNCE) {
+      if (currentScreen == SCREEN_HISTORY) {
+        nextHistoryGraph();
+      } else if (currentScreen == SCREEN_ALERTS) {
+        scrollAlerts();
+      } else {
+        nextLocation();
       }
+      lastButtonPress = now;
+      forceDisplayUpdate = true;
     }
-    http.end();
-    
-    // Get real solar wind speed and density data
-    http.begin("https://services.swpc.noaa.gov/products/solar-wind/plasma-1-day.json");
-    httpCode = http.GET();
-    if (httpCode == 200) {
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error && doc.size() > 1) {
-        JsonArray data = doc.as<JsonArray>();
-        if (data.size() > 0) {
-          // Get latest entry for solar wind speed and density
-          JsonArray latest = data[data.size()-1];
-          if (latest.size() > 2) {
-            currentSpaceWeather.solarWindSpeed = latest[1].as<float>(); // Speed km/s
-            currentSpaceWeather.solarWindDensity = latest[2].as<float>(); // Density p/cm³
-          }
-        }
-      }
-    } else {
-      // Fallback values if API fails
-      currentSpaceWeather.solarWindSpeed = 400.0; // Typical average
-      currentSpaceWeather.solarWindDensity = 5.0;  // Typical average
+  }
+  
+  leftWasPressed = leftPressed;
+}
+
+void handleSerialCommands() {
+  // Drain the event log on request so formatting never runs in the hot path
+  while (Serial.available() > 0) {
+    char command = Serial.read();
+    if (command == EVENT_LOG_DRAIN_KEY) {
+      eventLogDrain(Serial);
+    } else if (command == EVENT_LOG_DUMP_KEY) {
+      eventLogDump(Serial);
+    } else if (command == HISTORY_EXPORT_KEY) {
+      exportHistory(Serial);
     }
-    http.end();
-    
-    // Determine geomagnetic status based on KP index
-    if (currentSpaceWeather.kpIndex < 3) {
-      currentSpaceWeather.geomagStatus = "Quiet";
-    } else if (currentSpaceWeather.kpIndex < 5) {
-      currentSpaceWeather.geomagStatus = "Unsettled";
-    } else if (currentSpaceWeather.kpIndex < 7) {
-      currentSpaceWeather.geomagStatus = "Active";
-    } else {
-      currentSpaceWeather.geomagStatus = "Storm";
+  }
+}
+
+// Append an observation stamped with wall-clock time (skipped until SNTP has synced)
+void recordHistory(HistoryChannel channel, float value) {
+  time_t now = time(nullptr);
+  if (now < MIN_VALID_EPOCH) return;
+  history[channel].append((uint32_t)now, value);
+  rollups[channel].add((uint32_t)now, value);
+}
+
+// Dump every history series as CSV: channel,unix_time,value
+void exportHistory(Stream& out) {
+  out.println("channel,time,value");
+  for (uint8_t channel = 0; channel < HISTORY_CHANNEL_COUNT; channel++) {
+    HistorySeries::Iterator it = history[channel].begin();
+    uint32_t sampleTime;
+    float value;
+    while (it.next(sampleTime, value)) {
+      out.printf("%u,%lu,%.2f\n", channel, (unsigned long)sampleTime, value);
     }
-    
-    // Aurora forecast based on KP and Bz
-    if (currentSpaceWeather.kpIndex >= 5 && currentSpaceWeather.magneticFieldBz < -5) {
-      currentSpaceWeather.auroraForecast = "HIGH";
-    } else if (currentSpaceWeather.kpIndex >= 4 || currentSpaceWeather.magneticFieldBz < -3) {
-      currentSpaceWeather.auroraForecast = "MODERATE";
-    } else if (currentSpaceWeather.kpIndex >= 3) {
-      currentSpaceWeather.auroraForecast = "LOW";
-    } else {
-      currentSpaceWeather.auroraForecast = "MINIMAL";
+  }
+  for (uint8_t channel = 0; channel < HISTORY_CHANNEL_COUNT; channel++) {
+    out.printf("# channel %u: %lu samples, %u bytes\n", channel, (unsigned long)history[channel].count(),
+               (unsigned)history[channel].bytesUsed());
+  }
+}
+
+void loadQuotas() {
+  quotaStore.begin("quota", false);
+  for (uint8_t i = 0; i < QUOTA_PROVIDER_COUNT; i++) {
+    QuotaBucket& bucket = quotaBuckets[i];
+    // Missing, from an older layout, or for other limits: start with a full bucket
+    if (quotaStore.getBytesLength(quotaKeys[i]) != sizeof(bucket) ||
+        quotaStore.getBytes(quotaKeys[i], &bucket, sizeof(bucket)) != sizeof(bucket) ||
+        !quotaValid(bucket, quotaPolicies[i])) {
+      quotaInit(bucket, quotaPolicies[i]);
     }
-    
-    currentSpaceWeather.lastUpdate = millis();
-    
-    Serial.println("Space weather data updated:");
-    Serial.print("KP Index: "); Serial.println(currentSpaceWeather.kpIndex);
-    Serial.print("Geomag Status: "); Serial.println(currentSpaceWeather.geomagStatus);
-    Serial.print("Aurora Forecast: "); Serial.println(currentSpaceWeather.auroraForecast);
-    Serial.print("Bz: "); Serial.print(currentSpaceWeather.magneticFieldBz); Serial.println(" nT");
+    quotaJournals[i] = {bucket.day, 0};  // The first charge writes a fresh copy
+  }
+  quotaWriteLock = xSemaphoreCreateMutex();
+  esp_register_shutdown_handler(saveQuotas);
+}
+
+// Exact counts, releasing the charged-ahead reserve; esp_restart() runs this
+// before a deliberate restart, a crash or power loss keeps the reserve spent
+void saveQuotas() {
+  xSemaphoreTake(quotaWriteLock, portMAX_DELAY);
+  for (uint8_t i = 0; i < QUOTA_PROVIDER_COUNT; i++) {
+    QuotaBucket stored;
+    portENTER_CRITICAL(&quotaLock);
+    quotaFlush(quotaJournals[i], quotaBuckets[i], stored);
+    portEXIT_CRITICAL(&quotaLock);
+    quotaStore.putBytes(quotaKeys[i], &stored, sizeof(stored));
+  }
+  xSemaphoreGive(quotaWriteLock);
+}
+
+// UTC epoch seconds for the quota, 0 until the clock is set
+uint32_t quotaClock() {
+  time_t now = time(nullptr);
+  return now > MIN_VALID_EPOCH ? (uint32_t)now : 0;
+}
+
+unsigned long quotaRefreshInterval(QuotaProvider provider, unsigned long baseInterval, uint8_t callsPerRefresh) {
+  portENTER_CRITICAL(&quotaLock);
+  QuotaBucket bucket = quotaBuckets[provider];
+  portEXIT_CRITICAL(&quotaLock);
+  return quotaInterval(bucket, quotaPolicies[provider], quotaClock(), baseInterval / 1000, callsPerRefresh) * 1000UL;
+}
+
+// Charge one call to the source's provider. It is covered by the NVS copy
+// before the request goes out, which takes a write every QUOTA_WRITE_AHEAD calls.
+static bool quotaAllow(LogSource source) {
+  QuotaProvider provider = source == SRC_ONECALL || source == SRC_AIR_QUALITY ? QUOTA_OPENWEATHER : QUOTA_SWPC;
+  uint32_t now = quotaClock();
+  QuotaBucket stored;
+  xSemaphoreTake(quotaWriteLock, portMAX_DELAY);
+  portENTER_CRITICAL(&quotaLock);
+  bool allowed = quotaTake(quotaBuckets[provider], quotaPolicies[provider], now);
+  bool write = quotaJournal(quotaJournals[provider], quotaBuckets[provider], quotaPolicies[provider], allowed, stored);
+  QuotaBucket bucket = quotaBuckets[provider];
+  portEXIT_CRITICAL(&quotaLock);
+  if (write) quotaStore.putBytes(quotaKeys[provider], &stored, sizeof(stored));
+  xSemaphoreGive(quotaWriteLock);
+
+  if (!allowed) LOG_ERROR(EV_API_LIMIT, provider, bucket.used, (int32_t)(bucket.tokens / QUOTA_TOKEN_SCALE));
+  return allowed;
+}
+
+// Fetch gate: false while the endpoint is backing off after failures
+// (circuit breaker) or its provider's call budget is spent
+bool fetchAllowed(LogSource source) {
+  EndpointHealth& health = upstreamHealth[source];
+  if (!endpointAllow(health, millis())) {
+    LOG_DEBUG(EV_FETCH_SKIPPED, source, health.skipped);
+    return false;
+  }
+  return source == SRC_AGGREGATOR || quotaAllow(source);  // Our own server, not a provider's budget
+}
+
+void fetchRecord(LogSource source, int httpCode, bool ingested) {
+  EndpointHealth& health = upstreamHealth[source];
+  unsigned long now = millis();
+  if (endpointRecord(health, now, httpCode, fetchOutcome(httpCode, ingested), esp_random())) {
+    int32_t retry = health.state == CIRCUIT_OPEN ? (int32_t)((health.retryAt - now) / 1000) : 0;
+    LOG_INFO(EV_CIRCUIT_CHANGED, source, health.state, retry);
+  }
+}
+
+// Keep-alive through a pooled connection when the URL's host has one
+static void beginRequest(HTTPClient& http, const char* url, WiFiClientSecure* client) {
+  if (client) {
+    http.begin(*client, url);
+    http.setReuse(true);
   } else {
-    Serial.println("WiFi not connected - cannot fetch space weather data");
+    http.begin(url);
   }
+  http.setTimeout(HTTP_TIMEOUT);
 }
 
-void updateNOAASpaceWeatherData() {
-  if (WiFi.status() == WL_CONNECTED) {
-    HTTPClient http;
-    
-    Serial.println("Fetching NOAA space weather data...");
-    
-    // Initialize data with defaults
-    noaaSpaceWeather.alertCount = 0;
-    noaaSpaceWeather.solarFluxIndex = 0.0;
-    noaaSpaceWeather.aIndex = 0.0;
-    noaaSpaceWeather.kpIndex = 0.0;
-    noaaSpaceWeather.xrayFlux = "A1.0";
-    noaaSpaceWeather.protonFlux = "Quiet";
-    noaaSpaceWeather.sunspotNumber = 0;
-    
-    // Get Solar Flux Index (10.7 cm radio flux)
-    http.begin("https://services.swpc.noaa.gov/json/f107_cm_flux.json");
-    int httpCode = http.GET();
-    if (httpCode == 200) {
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error && doc.size() > 0) {
-        JsonArray data = doc.as<JsonArray>();
-        if (data.size() > 0) {
-          JsonObject latest = data[data.size()-1];
-          noaaSpaceWeather.solarFluxIndex = latest["flux"].as<float>();
-        }
-      }
-    }
-    http.end();
+int fetchAndIngest(LogSource source, const char* url, IngestFunction ingest) {
+  if (!fetchAllowed(source)) return HTTP_CIRCUIT_OPEN;
+  
+  bool reused;
+  WiFiClientSecure* client = connectionAcquire(url, reused);
+  HTTPClient http;
+  beginRequest(http, url, client);
+  int httpCode = connectionGet(http, client, reused);
+  bool ingested = false;
+  bool complete = false;
+  
+  if (httpCode == 200) {
+    String payload = http.getString();
+    complete = http.getSize() < 0 || payload.length() == (size_t)http.getSize();
+    unsigned long start = micros();
+    ingested = ingest(payload.c_str(), payload.length());
+    LOG_INFO(EV_INGEST, source, (int32_t)payload.length(), (int32_t)(micros() - start));
+  } else {
+    LOG_ERROR(EV_HTTP_ERROR, source, httpCode);
+  }
+  
+  http.end();
+  connectionRelease(client, complete);
+  fetchRecord(source, httpCode, ingested);
+  return httpCode;
+}
+
+// Stream adapter that pushes an HTTP body through the JSON tokenizer as it
+// arrives, through the inflater first when the body is compressed
+class ParserSink : public Stream, public InflateOutput {
+public:
+  explicit ParserSink(JsonStreamParser& parser) : parser(parser) {}
+  void inflateWith(Inflater* decoder) { inflater = decoder; }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* data, size_t size) override {
+    // Returning 0 makes writeToStream() stop reading after a syntax error
+    bool ok = inflater ? inflater->feed(data, size) : parser.feed((const char*)data, size);
+    return ok ? size : 0;
+  }
+  bool inflated(const uint8_t* data, size_t length) override {
+    return parser.feed((const char*)data, length);
+  }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  void flush() override {}
+
+private:
+  JsonStreamParser& parser;
+  Inflater* inflater = nullptr;
+};
+
+// Room for an inflater (32 KB window) on top of this request's TLS session?
+static bool compressionAffordable() {
+  return heap_caps_get_free_size(MALLOC_CAP_8BIT) >= sizeof(Inflater) + FETCH_TLS_COST + FETCH_HEAP_RESERVE &&
+         heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) >= sizeof(Inflater);
+}
+
+// Like fetchAndIngest() but never holds the body in RAM - for multi-100 KB payloads.
+// Asks for a gzip/deflate body when the heap can carry the inflater; SWPC's
+// JSON arrays shrink 4-20x, which is most of the time spent on air.
+int fetchAndStream(LogSource source, const char* url, StreamIngest& ingest) {
+  if (!fetchAllowed(source)) return HTTP_CIRCUIT_OPEN;
+  
+  char token[JSON_TOKEN_SIZE];
+  size_t tokenSize = sizeof(token);
+  char* tokenBuffer = ingest.tokenBuffer(tokenSize);
+  JsonStreamParser parser(ingest, tokenBuffer ? tokenBuffer : token, tokenSize);
+  ParserSink sink(parser);
+  // Allocated before the request so the TLS session sees what is left
+  Inflater* inflater = compressionAffordable() ? new (std::nothrow) Inflater(sink) : nullptr;
+  
+  bool reused;
+  WiFiClientSecure* client = connectionAcquire(url, reused);
+  HTTPClient http;
+  beginRequest(http, url, client);
+  const char* headerKeys[] = {"Content-Encoding"};
+  http.collectHeaders(headerKeys, 1);
+  if (inflater) http.setAcceptEncoding("gzip, deflate");
+  int httpCode = connectionGet(http, client, reused);
+  bool ingested = false;
+  bool complete = false;
+  
+  if (httpCode == 200) {
+    unsigned long start = micros();
     
-    // Get Daily Geomagnetic Indices (A-index)
-    http.begin("https://services.swpc.noaa.gov/products/daily-geomagnetic-indices.json");
-    httpCode = http.GET();
-    if (httpCode == 200) {
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error && doc.size() > 1) {
-        JsonArray data = doc.as<JsonArray>();
-        if (data.size() > 1) {
-          JsonArray latest = data[data.size()-1];
-          if (latest.size() > 3) {
-            noaaSpaceWeather.aIndex = latest[3].as<float>(); // A-index
-          }
-        }
-      }
+    // The server may still answer uncompressed
+    String encoding = http.header("Content-Encoding");
+    bool compressed = inflater && (encoding == "gzip" || encoding == "deflate");
+    if (compressed) {
+      inflater->reset(encoding == "gzip" ? INFLATE_GZIP : INFLATE_ZLIB_OR_RAW);
+      sink.inflateWith(inflater);
     }
-    http.end();
-    
-    // Get current Kp index (reuse from existing function)
-    noaaSpaceWeather.kpIndex = currentSpaceWeather.kpIndex;
     
-    // Get X-ray flux data
-    http.begin("https://services.swpc.noaa.gov/json/goes/primary/xrays-1-day.json");
-    httpCode = http.GET();
-    if (httpCode == 200) {
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error && doc.size() > 0) {
-        JsonArray data = doc.as<JsonArray>();
-        if (data.size() > 0) {
-          JsonObject latest = data[data.size()-1];
-          float flux = latest["flux"].as<float>();
-          
-          // Convert to X-ray class
-          if (flux >= 1e-3) {
-            noaaSpaceWeather.xrayFlux = "X" + String(flux/1e-4, 1);
-          } else if (flux >= 1e-4) {
-            noaaSpaceWeather.xrayFlux = "M" + String(flux/1e-5, 1);
-          } else if (flux >= 1e-5) {
-            noaaSpaceWeather.xrayFlux = "C" + String(flux/1e-6, 1);
-          } else if (flux >= 1e-6) {
-            noaaSpaceWeather.xrayFlux = "B" + String(flux/1e-7, 1);
-          } else {
-            noaaSpaceWeather.xrayFlux = "A" + String(flux/1e-8, 1);
-          }
-        }
-      }
+    ingest.begin();
+    // Handles both Content-Length and chunked bodies; stops early on a parse error
+    complete = http.writeToStream(&sink) >= 0 && !parser.failed();
+    bool parsed = (!compressed || inflater->finish()) && parser.finish();
+    if (compressed) LOG_INFO(EV_INFLATED, source, (int32_t)inflater->consumed(), (int32_t)inflater->produced());
+    if (!parsed) {
+      LOG_ERROR(EV_JSON_ERROR, source, parser.failed() ? DeserializationError::InvalidInput
+                                                       : DeserializationError::IncompleteInput);
     }
-    http.end();
-    
-    // Get sunspot data
-    http.begin("https://services.swpc.noaa.gov/json/solar_regions.json");
-    httpCode = http.GET();
-    if (httpCode == 200) {
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error) {
-        JsonArray regions = doc.as<JsonArray>();
-        noaaSpaceWeather.sunspotNumber = regions.size(); // Count active regions as approximate sunspot number
+    ingested = ingest.finish(parsed);
+    LOG_INFO(EV_INGEST, source, (int32_t)parser.position(), (int32_t)(micros() - start));
+  } else {
+    LOG_ERROR(EV_HTTP_ERROR, source, httpCode);
+  }
+  
+  http.end();
+  connectionRelease(client, complete);
+  delete inflater;
+  fetchRecord(source, httpCode, ingested);
+  return httpCode;
+}
+
+// Fetch jobs for refreshAllData(). Each runs on whichever fetch task picks
+// it up, so a job only writes the globals its own ingests own; anything
+// combining several sources happens in the derive functions afterwards.
+// Each ingest keeps the previous value when its endpoint fails or changes shape.
+
+// OneCall and air quality share the OpenWeather key's budget; when it runs
+// low they refresh less often than the space weather data. Background
+// locations take their share from refreshLocations().
+void fetchWeatherJob() {
+  unsigned long interval = locationRefreshInterval(true);
+  if (currentWeather.lastUpdate > 0 && millis() - currentWeather.lastUpdate < interval) return;
+  updateAllWeatherData(); // OneCall 3.0 - gets current, hourly, daily in one call
+  updateAirQualityData(); // Separate air quality call
+}
+
+void fetchKpIndexJob() {
+  fetchAndIngest(SRC_KP_INDEX, SWPC_BASE_URL "/products/noaa-planetary-k-index.json",
+                 ingestKpIndex);
+}
+
+// Magnetometer and plasma rows land in the same solarWind bins, so they stay in one job
+void fetchSolarWindJob() {
+  fetchAndStream(SRC_SOLAR_WIND_MAG, SWPC_BASE_URL "/products/solar-wind/mag-1-day.json",
+                 solarWindMagIngest);
+  // On failure the last good values stay, and the display marks them stale
+  fetchAndStream(SRC_SOLAR_WIND_PLASMA, SWPC_BASE_URL "/products/solar-wind/plasma-1-day.json",
+                 solarWindPlasmaIngest);
+}
+
+void fetchSolarFluxJob() {
+  // 10.7 cm radio flux
+  fetchAndIngest(SRC_SOLAR_FLUX, SWPC_BASE_URL "/json/f107_cm_flux.json", ingestSolarFlux);
+}
+
+void fetchGeomagJob() {
+  // Daily geomagnetic indices (A-index)
+  fetchAndIngest(SRC_GEOMAG_INDICES, SWPC_BASE_URL "/products/daily-geomagnetic-indices.json",
+                 ingestGeomagIndices);
+}
+
+void fetchXrayJob() {
+  fetchAndStream(SRC_XRAY, SWPC_BASE_URL "/json/goes/primary/xrays-1-day.json", xrayIngest);
+}
+
+void fetchSolarRegionsJob() {
+  fetchAndStream(SRC_SOLAR_REGIONS, SWPC_BASE_URL "/json/solar_regions.json", solarRegionIngest);
+}
+
+void fetchAlertsJob() {
+  // Deduplicated against the alerts already held
+  fetchAndStream(SRC_ALERTS, SWPC_BASE_URL "/products/alerts.json", alertIngest);
+}
+
+void fetchKpForecastJob() {
+  // NOAA 3-day Kp forecast - every 3-hour slot goes into the kpForecast series
+  fetchAndStream(SRC_KP_FORECAST, SWPC_BASE_URL "/products/noaa-planetary-k-index-forecast.json",
+                 kpForecastIngest);
+}
+
+void fetchOvationJob() {
+  // OVATION nowcast grid (~1 MB) - streamed, only our longitude column is kept
+  fetchAndStream(SRC_OVATION, SWPC_BASE_URL "/json/ovation_aurora_latest.json", ovationIngest);
+}
+
+// Largest bodies first, so the long transfers start early and the small
+// ones fill in around them
+const FetchJob refreshJobs[] = {
+  fetchOvationJob,
+  fetchXrayJob,
+  fetchSolarWindJob,
+  fetchSolarRegionsJob,
+  fetchAlertsJob,
+  fetchWeatherJob,
+  fetchKpForecastJob,
+  fetchKpIndexJob,
+  fetchGeomagJob,
+  fetchSolarFluxJob
+};
+
+// Aggregator mode: the newest data already taken from the bundle, per source
+uint32_t bundleLatest[SRC_COUNT];
+String bundleEtag;
+
+// One plain HTTP request to the aggregator stands in for every upstream fetch.
+// Sections newer than ours are applied as if their own ingest had just run.
+int fetchBundle() {
+  if (!fetchAllowed(SRC_AGGREGATOR)) return HTTP_CIRCUIT_OPEN;
+  static uint8_t body[BUNDLE_MAX_SIZE]; // Only the loop task refreshes
+  
+  HTTPClient http;
+  http.begin(AGGREGATOR_URL);
+  http.setTimeout(HTTP_TIMEOUT);
+  const char* headerKeys[] = {"ETag"};
+  http.collectHeaders(headerKeys, 1);
+  if (bundleEtag.length() > 0) http.addHeader("If-None-Match", bundleEtag);
+  int httpCode = http.GET();
+  bool applied = false;
+  
+  if (httpCode == 200) {
+    int length = http.getSize(); // The aggregator always sends Content-Length
+    BundleInfo info;
+    unsigned long start = micros();
+    applied = length > 0 && length <= BUNDLE_MAX_SIZE &&
+              http.getStreamPtr()->readBytes(body, length) == (size_t)length &&
+              bundleApply(body, length, quotaClock(), bundleLatest, info);
+    if (applied) {
+      bundleEtag = http.header("ETag");
+      uint8_t sections = 0;
+      for (uint8_t source = 0; source < SRC_AGGREGATOR; source++) {
+        if (info.updated[source] == 0) continue;
+        fetchRecord((LogSource)source, 200, true); // Fresh for the stale markers
+        sections++;
       }
-    }
-    http.end();
-    
-    // Get space weather alerts
-    http.begin("https://services.swpc.noaa.gov/products/alerts.json");
-    httpCode = http.GET();
-    if (httpCode == 200) {
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error) {
-        JsonArray alerts = doc.as<JsonArray>();
-        noaaSpaceWeather.alertCount = min(5, (int)alerts.size()); // Limit to 5 alerts
-        
-        for (int i = 0; i < noaaSpaceWeather.alertCount; i++) {
-          JsonObject alert = alerts[i];
-          String message = alert["message"].as<String>();
-          
-          // Extract key info from alert message
-          if (message.indexOf("WATCH") >= 0) {
-            noaaSpaceWeather.alerts[i] = "WATCH: " + message.substring(0, 20);
-          } else if (message.indexOf("WARNING") >= 0) {
-            noaaSpaceWeather.alerts[i] = "WARN: " + message.substring(0, 20);
-          } else {
-            noaaSpaceWeather.alerts[i] = message.substring(0, 25);
-          }
-        }
+      uint32_t now = quotaClock();
+      LOG_INFO(EV_BUNDLE_APPLIED, length, sections, now > info.generated ? (int32_t)(now - info.generated) : 0);
+      LOG_INFO(EV_INGEST, SRC_AGGREGATOR, length, (int32_t)(micros() - start));
+      if (info.updated[SRC_ONECALL] != 0) {
+        recordHistory(HISTORY_TEMPERATURE, currentWeather.temperature);
+        recordHistory(HISTORY_PRESSURE, currentWeather.pressure);
+        recordHistory(HISTORY_HUMIDITY, currentWeather.humidity);
+        recordHistory(HISTORY_WIND_SPEED, currentWeather.windSpeed);
       }
+    } else {
+      LOG_ERROR(EV_BUNDLE_REJECTED, length);
     }
-    http.end();
-    
-    // Set proton flux status based on alerts
-    bool protonAlert = false;
-    for (int i = 0; i < noaaSpaceWeather.alertCount; i++) {
-      if (noaaSpaceWeather.alerts[i].indexOf("proton") >= 0 || 
-          noaaSpaceWeather.alerts[i].indexOf("PROTON") >= 0) {
-        protonAlert = true;
-        break;
-      }
+  } else if (httpCode != 304) {
+    LOG_ERROR(EV_HTTP_ERROR, SRC_AGGREGATOR, httpCode);
+  }
+  
+  http.end();
+  fetchRecord(SRC_AGGREGATOR, httpCode, applied);
+  return httpCode;
+}
+
+// Fetch every upstream (or the aggregator's bundle), then derive the
+// combined values on this task
+void refreshAllData() {
+  if (WiFi.status() != WL_CONNECTED) return;
+  
+  if (AGGREGATOR_URL[0] != '\0') {
+    fetchBundle();
+  } else {
+    FetchBatchStats stats = fetchRunAll(refreshJobs, sizeof(refreshJobs) / sizeof(refreshJobs[0]));
+    LOG_INFO(EV_REFRESH_DONE, stats.workers, (int32_t)stats.wallMillis, (int32_t)stats.minFreeHeap);
+    ConnectionStats connections = connectionCloseAll();
+    LOG_INFO(EV_CONNECTIONS, connections.requests, connections.handshakes, connections.resumed);
+  }
+  
+  deriveSpaceWeather();
+  deriveNOAASpaceWeather();
+  deriveAuroraForecast();
+}
+
+// millis() of an update -> UTC epoch seconds, 0 when never updated or the clock is not set
+static uint32_t snapshotTime(unsigned long updated, time_t now, unsigned long nowMillis) {
+  if (updated == 0 || now < MIN_VALID_EPOCH) return 0;
+  return (uint32_t)(now - (time_t)((nowMillis - updated) / 1000));
+}
+
+// Values of a group that was never fetched go out as null
+static float snapshotValue(unsigned long updated, float value) {
+  return updated == 0 ? NAN : value;
+}
+
+// Copy the globals into an immutable snapshot for the local API. Runs on the
+// loop task between refreshes, so no fetch is writing them meanwhile.
+void publishSnapshot() {
+  static StationSnapshot snapshot; // ~1 KB, kept off the loop task's stack
+  time_t now = time(nullptr);
+  unsigned long nowMillis = millis();
+  memset(&snapshot, 0, sizeof(snapshot));
+  snapshot.generated = now >= MIN_VALID_EPOCH ? (uint32_t)now : 0;
+  
+  unsigned long updated = currentWeather.lastUpdate;
+  snapshotCopyText(snapshot.city, sizeof(snapshot.city), currentWeather.cityName.c_str());
+  snapshot.temperature = snapshotValue(updated, currentWeather.temperature);
+  snapshot.humidity = currentWeather.humidity;
+  snapshot.pressure = snapshotValue(updated, currentWeather.pressure);
+  snapshot.windSpeed = snapshotValue(updated, currentWeather.windSpeed);
+  snapshot.windDirection = currentWeather.windDirection;
+  snapshotCopyText(snapshot.description, sizeof(snapshot.description), currentWeather.description.c_str());
+  snapshotCopyText(snapshot.icon, sizeof(snapshot.icon), currentWeather.icon.c_str());
+  snapshot.weatherUpdated = snapshotTime(updated, now, nowMillis);
+  
+  updated = airQuality.lastUpdate;
+  snapshot.aqi = airQuality.aqi;
+  snapshot.pm2_5 = snapshotValue(updated, airQuality.pm2_5);
+  snapshot.pm10 = snapshotValue(updated, airQuality.pm10);
+  snapshot.o3 = snapshotValue(updated, airQuality.o3);
+  snapshot.no2 = snapshotValue(updated, airQuality.no2);
+  snapshot.uvIndex = airQuality.uvIndex;
+  snapshot.airUpdated = snapshotTime(updated, now, nowMillis);
+  
+  snapshot.sunrise = currentWeather.sunrise;
+  snapshot.sunset = currentWeather.sunset;
+  snapshot.moonrise = currentWeather.moonrise;
+  snapshot.moonset = currentWeather.moonset;
+  snapshot.moonPhase = currentWeather.moonPhase;
+  snapshot.moonIllumination = currentWeather.moonIllumination;
+  snapshotCopyText(snapshot.moonPhaseName, sizeof(snapshot.moonPhaseName), currentWeather.moonPhaseName.c_str());
+  
+  updated = currentSpaceWeather.lastUpdate;
+  snapshot.kpIndex = snapshotValue(updated, currentSpaceWeather.kpIndex);
+  snapshot.bz = snapshotValue(updated, currentSpaceWeather.magneticFieldBz);
+  snapshot.by = snapshotValue(updated, currentSpaceWeather.magneticFieldBy);
+  snapshot.solarWindSpeed = snapshotValue(updated, currentSpaceWeather.solarWindSpeed);
+  snapshot.solarWindDensity = snapshotValue(updated, currentSpaceWeather.solarWindDensity);
+  snapshot.couplingKp = snapshotValue(updated, currentSpaceWeather.couplingKp);
+  snapshot.dst = snapshotValue(updated, currentSpaceWeather.dstEstimate);
+  snapshot.auroraScore = currentSpaceWeather.auroraScore;
+  snapshotCopyText(snapshot.geomagStatus, sizeof(snapshot.geomagStatus), currentSpaceWeather.geomagStatus.c_str());
+  snapshot.spaceUpdated = snapshotTime(updated, now, nowMillis);
+  
+  updated = noaaSpaceWeather.lastUpdate;
+  snapshot.solarFlux = snapshotValue(updated, noaaSpaceWeather.solarFluxIndex);
+  snapshot.aIndex = snapshotValue(updated, noaaSpaceWeather.aIndex);
+  snapshotCopyText(snapshot.xrayClass, sizeof(snapshot.xrayClass), noaaSpaceWeather.xrayFlux.c_str());
+  snapshot.sunspotNumber = noaaSpaceWeather.sunspotNumber;
+  snapshot.activeRegions = noaaSpaceWeather.activeRegions;
+  
+  snapshot.kpToday = snapshotValue(auroraToday.lastUpdate, auroraToday.kpPredicted);
+  snapshot.kpTomorrow = snapshotValue(auroraTomorrow.lastUpdate, auroraTomorrow.kpPredicted);
+  snapshot.nowcastProbability = auroraNowcast.probability;
+  snapshot.viewlineLatitude = auroraNowcast.viewlineLatitude;
+  
+  for (uint8_t i = 0; i < SNAPSHOT_DAYS; i++) {
+    const DayForecast& source = weeklyForecast.days[i];
+    SnapshotDay& day = snapshot.days[i];
+    snapshotCopyText(day.name, sizeof(day.name), source.dayName.c_str());
+    day.high = snapshotValue(weeklyForecast.lastUpdate, source.tempHigh);
+    day.low = snapshotValue(weeklyForecast.lastUpdate, source.tempLow);
+    day.precipChance = source.precipChance;
+    snapshotCopyText(day.icon, sizeof(day.icon), source.icon.c_str());
+  }
+  for (uint8_t i = 0; i < SNAPSHOT_HOURS; i++) {
+    const HourlyForecast& source = hourlyForecast.hours[i];
+    SnapshotHour& hour = snapshot.hours[i];
+    snapshotCopyText(hour.time, sizeof(hour.time), source.time);
+    hour.temperature = snapshotValue(hourlyForecast.lastUpdate, source.temperature);
+    hour.precipChance = source.precipChance;
+    snapshotCopyText(hour.icon, sizeof(hour.icon), source.icon.c_str());
+  }
+  
+  for (uint8_t i = 0; i < alertStore.count && snapshot.alertCount < SNAPSHOT_ALERTS; i++) {
+    const AlertEntry& entry = alertStore.entries[i];
+    SnapshotAlert& alert = snapshot.alerts[snapshot.alertCount++];
+    snapshotCopyText(alert.code, sizeof(alert.code), entry.code);
+    snapshotCopyText(alert.scale, sizeof(alert.scale), entry.scale);
+    alert.issued = entry.issued;
+    alert.expires = entry.expires;
+  }
+  
+  LocalApiStats api = localApiStats();
+  if (snapshotPublish(snapshot)) {
+    LOG_INFO(EV_SNAPSHOT_PUBLISHED, (int32_t)api.requests, (int32_t)api.notModified, (int32_t)api.connections);
+  } else {
+    LOG_ERROR(EV_SNAPSHOT_SKIPPED, (int32_t)api.requests);
+  }
+}
+
+void startLocalApi() {
+  bool listening = localApiOpen(LOCAL_API_PORT) &&
+                   xTaskCreatePinnedToCore(localApiTask, "local_api", LOCAL_API_STACK, nullptr, 1, nullptr,
+                                           tskNO_AFFINITY) == pdPASS;
+  LOG_INFO(EV_LOCAL_API, LOCAL_API_PORT, listening);
+}
+
+void localApiTask(void* parameter) {
+  (void)parameter;
+  for (;;) {
+    localApiPoll(millis(), 1000);
+  }
+}
+
+// OVATION cells of every location come out of the same grid pass; the
+// displayed one's goes straight to auroraNowcast, the others' to their slots
+static void locationOvationTargets() {
+  ovationIngest.clearLocations();
+  for (uint8_t i = 0; i < locationCount; i++) {
+    AuroraNowcastData& nowcast = i == activeLocation ? auroraNowcast : locationSlots[i].nowcast;
+    ovationIngest.addLocation(locations[i].latitude, locations[i].longitude, nowcast);
+  }
+}
+
+void locationsBegin() {
+  // History and rollups stay on home's clock whichever location is shown
+  timeZoneInit(locations[0].timeZone != nullptr ? locations[0].timeZone : TIME_ZONE, ZONE_HOME);
+  loadLocation(0);
+  locationOvationTargets();
+}
+
+// Encode the globals' OneCall and air quality data into the location's slot.
+// Stamps are millis() seconds (+1, 0 means never), so no wall clock is needed.
+void parkLocation(uint8_t index) {
+  LocationSlot& slot = locationSlots[index];
+  uint32_t updated[SRC_COUNT] = {0};
+  updated[SRC_ONECALL] = currentWeather.lastUpdate == 0 ? 0 : currentWeather.lastUpdate / 1000 + 1;
+  updated[SRC_AIR_QUALITY] = airQuality.lastUpdate == 0 ? 0 : airQuality.lastUpdate / 1000 + 1;
+  slot.length = bundleEncode(slot.parked, sizeof(slot.parked), 0, updated);
+  if (slot.length == 0) LOG_ERROR(EV_LOCATION_OVERFLOW, index, LOCATION_PARK_SIZE);
+  locationStatus[index].temperature = currentWeather.temperature;
+  locationStatus[index].weatherUpdated = currentWeather.lastUpdate;
+}
+
+// Swap a parked location into the globals; the caller parks the previous one.
+// Sun and moon times are not restored, updateAstronomyData() recomputes them.
+void loadLocation(uint8_t index) {
+  const Location& location = locations[index];
+  const LocationSlot& slot = locationSlots[index];
+  currentWeather = WeatherData();
+  hourlyForecast = HourlyForecastData();
+  weeklyForecast = WeeklyForecast();
+  airQuality = AirQualityData();
+  if (slot.length > 0) {
+    uint32_t applied[SRC_COUNT] = {0};
+    BundleInfo info;
+    bundleApply(slot.parked, slot.length, millis() / 1000 + 1, applied, info);
+  }
+  currentWeather.cityName = location.name;
+  latitude = location.latitude;
+  longitude = location.longitude;
+  timeZoneInit(location.timeZone != nullptr ? location.timeZone : TIME_ZONE); // Labels and astronomy, not history
+  loadedLocation = index;
+}
+
+// Show another location: park the displayed one, load this one and derive
+// everything that depends on where it is
+void activateLocation(uint8_t index) {
+  if (index == activeLocation || index >= locationCount) return;
+  parkLocation(activeLocation);
+  locationSlots[activeLocation].nowcast = auroraNowcast;
+  locationStatus[activeLocation].refreshedAt = currentWeather.lastUpdate; // Background rate from here on
+  loadLocation(index);
+  auroraNowcast = locationSlots[index].nowcast;
+  activeLocation = index;
+  locationOvationTargets();
+  
+  astronomyDay = 0; // Another place and maybe another time zone
+  updateAstronomyData();
+  deriveAuroraScore(); // Not deriveSpaceWeather(): no new data, so no history samples
+  deriveAuroraForecast();
+  if (timeInitialized) formatClock(time(nullptr), currentTime, sizeof(currentTime));
+  publishSnapshot();
+  locationCatchUp = true; // Its weather may be as old as the background interval
+  
+  unsigned long updated = currentWeather.lastUpdate;
+  LOG_INFO(EV_LOCATION_CHANGED, index, locationSlots[index].length,
+           updated == 0 ? -1 : (int32_t)((millis() - updated) / 1000));
+}
+
+void nextLocation() {
+  activateLocation((activeLocation + 1) % locationCount);
+}
+
+// The OpenWeather budget split between the displayed and the background
+// locations (see locations.h), in ms
+unsigned long locationRefreshInterval(bool active) {
+  uint32_t shared = quotaRefreshInterval(QUOTA_OPENWEATHER, 1000, 2) / 1000;
+  return locationInterval(locationCount, LOCATION_ACTIVE_WEIGHT, active, shared, WEATHER_UPDATE_INTERVAL / 1000) *
+         1000UL;
+}
+
+// Brings a newly displayed location up to date, otherwise refreshes the
+// background location that is most overdue: swapped in, fetched, parked
+void refreshLocations() {
+  if (locationCount < 2 || WiFi.status() != WL_CONNECTED) return;
+  
+  if (locationCatchUp) {
+    locationCatchUp = false;
+    unsigned long updated = currentWeather.lastUpdate;
+    fetchWeatherJob(); // Skipped while younger than the displayed location's interval
+    if (currentWeather.lastUpdate != updated) {
+      publishSnapshot();
+      forceDisplayUpdate = true;
     }
-    noaaSpaceWeather.protonFlux = protonAlert ? "Enhanced" : "Quiet";
-    
-    noaaSpaceWeather.lastUpdate = millis();
-    
-    Serial.println("NOAA space weather data updated:");
-    Serial.print("Solar Flux: "); Serial.println(noaaSpaceWeather.solarFluxIndex);
-    Serial.print("A Index: "); Serial.println(noaaSpaceWeather.aIndex);
-    Serial.print("Kp Index: "); Serial.println(noaaSpaceWeather.kpIndex);
-    Serial.print("X-ray Class: "); Serial.println(noaaSpaceWeather.xrayFlux);
-    Serial.print("Sunspots: "); Serial.println(noaaSpaceWeather.sunspotNumber);
-    Serial.print("Alerts: "); Serial.println(noaaSpaceWeather.alertCount);
-    
+    return;
+  }
+  
+  unsigned long now = millis();
+  uint8_t index = locationDue(locationStatus, locationCount, activeLocation, now, locationRefreshInterval(false));
+  if (index == LOCATION_NONE) return;
+  locationStatus[index].refreshedAt = now > 0 ? now : 1; // Failed attempts wait for the next turn too
+  
+  parkLocation(activeLocation);
+  loadLocation(index);
+  updateAllWeatherData();
+  updateAirQualityData();
+  parkLocation(index);
+  unsigned long updated = currentWeather.lastUpdate;
+  LOG_INFO(EV_LOCATION_REFRESHED, index, locationSlots[index].length,
+           updated == 0 ? -1 : (int32_t)((millis() - updated) / 1000));
+  
+  loadLocation(activeLocation);
+  astronomyDay = 0;
+  updateAstronomyData();
+}
+
+void deriveSpaceWeather() {
+  // Determine geomagnetic status based on KP index
+  if (currentSpaceWeather.kpIndex < 3) {
+    currentSpaceWeather.geomagStatus = "Quiet";
+  } else if (currentSpaceWeather.kpIndex < 5) {
+    currentSpaceWeather.geomagStatus = "Unsettled";
+  } else if (currentSpaceWeather.kpIndex < 7) {
+    currentSpaceWeather.geomagStatus = "Active";
+  } else {
+    currentSpaceWeather.geomagStatus = "Storm";
+  }
+  
+  uint16_t steps = coupling.update(solarWind);
+  (void)steps;  // Only logged at debug level
+  if (coupling.valid()) {
+    currentSpaceWeather.couplingKp = coupling.kpEquivalent();
+    currentSpaceWeather.dstEstimate = coupling.dst();
+    LOG_DEBUG(EV_COUPLING_UPDATED, steps, (int32_t)(currentSpaceWeather.couplingKp * 10),
+              (int32_t)currentSpaceWeather.dstEstimate);
+  }
+  deriveAuroraScore();
+  
+  currentSpaceWeather.lastUpdate = millis();
+  
+  recordHistory(HISTORY_KP, currentSpaceWeather.kpIndex);
+  // Only fresh solar wind values go into the history
+  unsigned long now = millis();
+  if (!endpointStale(upstreamHealth[SRC_SOLAR_WIND_MAG], now, UPSTREAM_STALE_AFTER)) {
+    recordHistory(HISTORY_BZ, currentSpaceWeather.magneticFieldBz);
+  }
+  if (!endpointStale(upstreamHealth[SRC_SOLAR_WIND_PLASMA], now, UPSTREAM_STALE_AFTER)) {
+    recordHistory(HISTORY_SOLAR_WIND_SPEED, currentSpaceWeather.solarWindSpeed);
+  }
+  
+  LOG_INFO(EV_SPACE_WEATHER_UPDATED, (int32_t)(currentSpaceWeather.kpIndex * 10),
+           (int32_t)(currentSpaceWeather.magneticFieldBz * 10), (int32_t)currentSpaceWeather.solarWindSpeed);
+}
+
+// The part of deriveSpaceWeather() that depends on where the station is, on
+// its own for a location switch: aurora likelihood from the solar wind
+// coupling engine, falling back to the observed Kp while no complete IMF +
+// plasma bins are available
+void deriveAuroraScore() {
+  float kp = coupling.valid() ? currentSpaceWeather.couplingKp : currentSpaceWeather.kpIndex;
+  currentSpaceWeather.auroraScore = auroraLikelihood(kp, latitude, longitude);
+  
+  if (currentSpaceWeather.auroraScore >= 70) {
+    currentSpaceWeather.auroraForecast = "HIGH";
+  } else if (currentSpaceWeather.auroraScore >= 40) {
+    currentSpaceWeather.auroraForecast = "MODERATE";
+  } else if (currentSpaceWeather.auroraScore >= 15) {
+    currentSpaceWeather.auroraForecast = "LOW";
   } else {
-    Serial.println("WiFi not connected - cannot fetch NOAA space weather data");
+    currentSpaceWeather.auroraForecast = "MINIMAL";
   }
 }
 
+void deriveNOAASpaceWeather() {
+  // Current Kp index from the space weather ingest
+  noaaSpaceWeather.kpIndex = currentSpaceWeather.kpIndex;
+  
+  // Particle flux status from the active alerts
+  noaaSpaceWeather.protonFlux = alertStoreHasTopic(alertStore, ALERT_TOPIC_PROTON) ? "Enhanced" : "Quiet";
+  noaaSpaceWeather.electronFlux = alertStoreHasTopic(alertStore, ALERT_TOPIC_ELECTRON) ? "High" : "Normal";
+  
+  noaaSpaceWeather.lastUpdate = millis();
+  
+  LOG_INFO(EV_NOAA_UPDATED, (int32_t)(noaaSpaceWeather.solarFluxIndex * 10),
+           (int32_t)(noaaSpaceWeather.aIndex * 10), noaaSpaceWeather.sunspotNumber);
+}
+
 void update7DayForecast() {
   // Legacy function - data now comes from OneCall 3.0 in updateAllWeatherData()
-  Serial.println("7-day forecast data updated via OneCall 3.0");
   weeklyForecast.lastUpdate = millis();
 }
 
@@ -763,501 +1303,191 @@ void update7DayForecast() {
   }
 END OF OLD CODE COMMENTED OUT */
 
-void updateAuroraForecast() {
-  if (WiFi.status() == WL_CONNECTED) {
-    HTTPClient http;
-    
-    Serial.println("Fetching NOAA aurora forecast...");
-    
-    // NOAA Aurora forecast - this is a simplified version
-    // In production, you'd want to parse their more complex forecast data
-    http.begin("https://services.swpc.noaa.gov/products/noaa-planetary-k-index-forecast.json");
-    
-    int httpCode = http.GET();
-    if (httpCode == 200) {
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error && doc.size() > 0) {
-        JsonArray data = doc.as<JsonArray>();
-        
-        // Process today's forecast
-        if (data.size() > 1) {
-          JsonArray todayData = data[1]; // First forecast entry
-          if (todayData.size() > 1) {
-            auroraToday.kpPredicted = todayData[1].as<float>();
-            auroraToday.date = "Today";
-            
-            // Determine activity level
-            if (auroraToday.kpPredicted >= 7) {
-              auroraToday.activity = "Very High";
-              auroraToday.visibility = "Visible to southern WI";
-            } else if (auroraToday.kpPredicted >= 5) {
-              auroraToday.activity = "High";
-              auroraToday.visibility = "Visible to northern WI";
-            } else if (auroraToday.kpPredicted >= 4) {
-              auroraToday.activity = "Moderate";
-              auroraToday.visibility = "Northern horizon only";
-            } else {
-              auroraToday.activity = "Low";
-              auroraToday.visibility = "Not likely visible";
-            }
-            
-            auroraToday.peakTime = "10 PM - 2 AM";
-            auroraToday.confidence = "Medium";
-          }
-        }
-        
-        // Process tomorrow's forecast
-        if (data.size() > 2) {
-          JsonArray tomorrowData = data[2]; // Second forecast entry
-          if (tomorrowData.size() > 1) {
-            auroraTomorrow.kpPredicted = tomorrowData[1].as<float>();
-            auroraTomorrow.date = "Tomorrow";
-            
-            // Determine activity level
-            if (auroraTomorrow.kpPredicted >= 7) {
-              auroraTomorrow.activity = "Very High";
-              auroraTomorrow.visibility = "Visible to southern WI";
-            } else if (auroraTomorrow.kpPredicted >= 5) {
-              auroraTomorrow.activity = "High";
-              auroraTomorrow.visibility = "Visible to northern WI";
-            } else if (auroraTomorrow.kpPredicted >= 4) {
-              auroraTomorrow.activity = "Moderate";
-              auroraTomorrow.visibility = "Northern horizon only";
-            } else {
-              auroraTomorrow.activity = "Low";
-              auroraTomorrow.visibility = "Not likely visible";
-            }
-            
-            auroraTomorrow.peakTime = "10 PM - 2 AM";
-            auroraTomorrow.confidence = "Medium";
-          }
-        }
-        
-        auroraToday.lastUpdate = millis();
-        auroraTomorrow.lastUpdate = millis();
-        
-        Serial.println("Aurora forecasts updated:");
-        Serial.print("Today KP: "); Serial.print(auroraToday.kpPredicted); 
-        Serial.print(" ("); Serial.print(auroraToday.activity); Serial.println(")");
-        Serial.print("Tomorrow KP: "); Serial.print(auroraTomorrow.kpPredicted); 
-        Serial.print(" ("); Serial.print(auroraTomorrow.activity); Serial.println(")");
-      }
-    }
-    
-    http.end();
+// Derive activity and visibility text from a predicted Kp
+void classifyAuroraForecast(AuroraForecastData& forecast) {
+  if (forecast.kpPredicted >= 7) {
+    forecast.activity = "Very High";
+  } else if (forecast.kpPredicted >= 5) {
+    forecast.activity = "High";
+  } else if (forecast.kpPredicted >= 4) {
+    forecast.activity = "Moderate";
   } else {
-    Serial.println("WiFi not connected - cannot fetch aurora forecast");
+    forecast.activity = "Low";
   }
+  
+  // Visibility relative to our own geomagnetic latitude
+  AuroraSighting sighting = auroraSightingFromKp(forecast.kpPredicted, latitude, longitude);
+  forecast.visibility = auroraSightingText(sighting, latitude);
+  
+  forecast.lastUpdate = millis();
 }
 
-// New unified OneCall 3.0 function for all weather data
-void updateAllWeatherData() {
-  // Check API rate limits
-  unsigned long now = millis();
-  if (now - lastDayReset > 86400000) { // Reset daily counter every 24 hours
-    dailyApiCalls = 0;
-    lastDayReset = now;
+// Take Kp, peak window and confidence from the forecast series for one night
+void applyAuroraNight(AuroraForecastData& forecast, time_t evening, time_t now) {
+  AuroraNight night;
+  if (!analyzeAuroraNight(kpForecast, evening, latitude, longitude, night)) {
+    forecast.kpPredicted = 0;
+    forecast.peakTime = night.darkStart == 0 ? "No darkness" : "No forecast";
+    forecast.confidence = "Low";
+    return;
   }
   
-  if (dailyApiCalls >= MAX_DAILY_CALLS) {
-    Serial.println("Daily API limit reached! Skipping update.");
-    return;
+  forecast.kpPredicted = night.maxKp;
+  
+  char start[TIME_STRING_SIZE], end[TIME_STRING_SIZE];
+  formatClockCompact(night.peakStart, start, sizeof(start));
+  formatClockCompact(night.peakEnd, end, sizeof(end));
+  forecast.peakTime = String(start) + " - " + end;
+  
+  // Observed slots are certain, predictions lose skill beyond a day
+  if (night.source != KP_PREDICTED) {
+    forecast.confidence = "High";
+  } else if (night.darkStart - now < 86400) {
+    forecast.confidence = "Medium";
+  } else {
+    forecast.confidence = "Low";
+  }
+}
+
+void deriveAuroraForecast() {
+  auroraToday.date = "Today";
+  auroraTomorrow.date = "Tomorrow";
+  
+  // Per-night Kp maxima over local darkness; needs the clock for the ephemeris
+  time_t now = time(nullptr);
+  if (now > MIN_VALID_EPOCH && kpForecast.count > 0) {
+    // Until last night's darkness ends, "today" still means last night
+    time_t tonight = localMidnight(now);
+    AuroraNight lastNight;
+    if (analyzeAuroraNight(kpForecast, tonight - 43200, latitude, longitude, lastNight) && now < lastNight.darkEnd) {
+      tonight -= 43200;
+    }
+    applyAuroraNight(auroraToday, tonight, now);
+    applyAuroraNight(auroraTomorrow, localMidnight(tonight) + 36 * 3600, now);
   }
   
-  if (now - currentWeather.lastUpdate < WEATHER_UPDATE_INTERVAL && currentWeather.lastUpdate > 0) {
-    return; // Don't update too frequently
+  classifyAuroraForecast(auroraToday);
+  classifyAuroraForecast(auroraTomorrow);
+  
+  // A fresh nowcast beats the Kp estimate for tonight
+  if (auroraNowcast.lastUpdate > 0 && millis() - auroraNowcast.lastUpdate < AURORA_NOWCAST_MAX_AGE) {
+    AuroraSighting sighting = auroraSightingFromViewline(latitude, auroraNowcast.ovalEdgeLatitude,
+                                                         auroraNowcast.viewlineLatitude);
+    auroraToday.visibility = auroraSightingText(sighting, latitude);
   }
   
+  LOG_INFO(EV_AURORA_UPDATED, (int32_t)(auroraToday.kpPredicted * 10),
+           (int32_t)(auroraTomorrow.kpPredicted * 10));
+}
+
+// New unified OneCall 3.0 function for all weather data
+void updateAllWeatherData() {
+  // Call budget and refresh pacing are handled by fetchAllowed() and fetchWeatherJob()
   if (WiFi.status() == WL_CONNECTED) {
-    HTTPClient http;
-    
-    Serial.println("Fetching weather data with OneCall 3.0...");
-    Serial.print("API calls today: "); Serial.println(dailyApiCalls);
-    
     // OneCall 3.0 API - gets current, hourly, daily, and air quality in one call
     String oneCallUrl = String(ONECALL_API_URL) + "?lat=" + String(latitude, 4) + 
                         "&lon=" + String(longitude, 4) + "&appid=" + String(apiKey) + 
                         "&units=imperial&exclude=minutely,alerts";
     
-    http.begin(oneCallUrl.c_str());
-    int httpCode = http.GET();
-    
+    int httpCode = fetchAndIngest(SRC_ONECALL, oneCallUrl.c_str(), ingestOneCall);
     if (httpCode == 200) {
-      dailyApiCalls++; // Count successful API call
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error) {
-        // Parse current weather
-        JsonObject current = doc["current"];
-        currentWeather.temperature = current["temp"].as<float>();
-        currentWeather.humidity = current["humidity"].as<int>();
-        currentWeather.pressure = current["pressure"].as<float>();
-        currentWeather.windSpeed = current["wind_speed"].as<float>();
-        currentWeather.windDirection = current["wind_deg"].as<int>();
-        currentWeather.description = current["weather"][0]["description"].as<String>();
-        currentWeather.icon = current["weather"][0]["icon"].as<String>();
-        currentWeather.cityName = String(LOCATION_NAME);
-        currentWeather.sunrise = current["sunrise"].as<unsigned long>();
-        currentWeather.sunset = current["sunset"].as<unsigned long>();
-        currentWeather.lastUpdate = millis();
-        
-        // Parse air quality data
-        if (current.containsKey("uvi")) {
-          airQuality.uvIndex = current["uvi"].as<int>();
-          if (airQuality.uvIndex <= 2) airQuality.uvRisk = "Low";
-          else if (airQuality.uvIndex <= 5) airQuality.uvRisk = "Moderate";
-          else if (airQuality.uvIndex <= 7) airQuality.uvRisk = "High";
-          else if (airQuality.uvIndex <= 10) airQuality.uvRisk = "Very High";
-          else airQuality.uvRisk = "Extreme";
-        }
-        
-        if (current.containsKey("visibility")) {
-          airQuality.visibility = current["visibility"].as<float>() / 1000.0; // Convert to km
-        }
-        
-        // Parse hourly forecast (next 12 hours, starting from next hour)
-        JsonArray hourly = doc["hourly"];
-        int hourCount = 0;
-        
-        Serial.println("=== HOURLY FORECAST DEBUG ===");
-        Serial.print("Total hourly entries: "); Serial.println(hourly.size());
-        
-        // Get current local time for comparison
-        time_t currentLocalTime = time(nullptr);
-        struct tm* currentTm = localtime(&currentLocalTime);
-        int currentHour = currentTm->tm_hour;
-        Serial.print("Current local hour: "); Serial.println(currentHour);
-        
-        // Use traditional for loop starting from index 1 (skip current hour at index 0)
-        for (int i = 1; i < hourly.size() && hourCount < 12; i++) {
-          JsonObject hour = hourly[i];
-          
-          unsigned long timestamp = hour["dt"].as<unsigned long>();
-          
-          // Convert UTC timestamp to local time properly
-          time_t utcTime = (time_t)timestamp;
-          struct tm* timeinfo = localtime(&utcTime); // This should now work with our timezone config
-          
-          Serial.print("API Timestamp: "); Serial.print(timestamp);
-          Serial.print(" -> Local time: "); Serial.print(timeinfo->tm_hour);
-          Serial.print(":"); Serial.print(timeinfo->tm_min);
-          Serial.println();
-          
-          hourlyForecast.hours[hourCount].time = String(timeinfo->tm_hour % 12 == 0 ? 12 : timeinfo->tm_hour % 12) + 
-                                                 (timeinfo->tm_hour >= 12 ? "PM" : "AM");
-          hourlyForecast.hours[hourCount].temperature = hour["temp"].as<float>();
-          hourlyForecast.hours[hourCount].icon = hour["weather"][0]["icon"].as<String>();
-          hourlyForecast.hours[hourCount].description = hour["weather"][0]["main"].as<String>();
-          hourlyForecast.hours[hourCount].precipChance = (hour.containsKey("pop") ? 
-                                                          (int)(hour["pop"].as<float>() * 100) : 0);
-          hourlyForecast.hours[hourCount].humidity = hour["humidity"].as<int>();
-          
-          // Enhanced debug output
-          Serial.print("Hour "); Serial.print(hourCount); 
-          Serial.print(" (API Index "); Serial.print(i); Serial.print(")");
-          Serial.print(" - Time: "); Serial.print(hourlyForecast.hours[hourCount].time);
-          Serial.print(", Temp: "); Serial.print(hourlyForecast.hours[hourCount].temperature);
-          Serial.print(", Humidity: "); Serial.print(hourlyForecast.hours[hourCount].humidity);
-          Serial.print("%, Rain: "); Serial.print(hourlyForecast.hours[hourCount].precipChance);
-          Serial.println("%");
-          
-          hourCount++;
-        }
-        Serial.println("=== END HOURLY DEBUG ===");
-        hourlyForecast.lastUpdate = millis();
-        
-        // Parse daily forecast (7 days)
-        JsonArray daily = doc["daily"];
-        String dayNames[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
-        int dayCount = 0;
-        
-        for (JsonObject day : daily) {
-          if (dayCount >= 7) break;
-          
-          unsigned long timestamp = day["dt"].as<unsigned long>();
-          struct tm* timeinfo = localtime((time_t*)&timestamp);
-          
-          if (dayCount == 0) {
-            weeklyForecast.days[dayCount].dayName = "Today";
-            // Get moon phase data from today's forecast
-            if (day.containsKey("moon_phase")) {
-              currentWeather.moonPhase = day["moon_phase"].as<float>();
-              
-              Serial.println("=== MOON DATA FROM ONECALL API ===");
-              Serial.print("Raw OneCall Moon Phase: ");
-              Serial.println(currentWeather.moonPhase);
-              
-              // Convert moon phase to name (0.0 = New Moon, 0.5 = Full Moon)
-              float phase = currentWeather.moonPhase;
-              if (phase < 0.0625 || phase >= 0.9375) {
-                currentWeather.moonPhaseName = "New Moon";
-              } else if (phase < 0.1875) {
-                currentWeather.moonPhaseName = "Waxing Crescent";
-              } else if (phase < 0.3125) {
-                currentWeather.moonPhaseName = "First Quarter";
-              } else if (phase < 0.4375) {
-                currentWeather.moonPhaseName = "Waxing Gibbous";
-              } else if (phase < 0.5625) {
-                currentWeather.moonPhaseName = "Full Moon";
-              } else if (phase < 0.6875) {
-                currentWeather.moonPhaseName = "Waning Gibbous";
-              } else if (phase < 0.8125) {
-                currentWeather.moonPhaseName = "Last Quarter";
-              } else {
-                currentWeather.moonPhaseName = "Waning Crescent";
-              }
-              
-              // Manual override DISABLED for testing - was October 24, 2025 if API data seems wrong
-              if (timeinfo->tm_year + 1900 == 2099 && timeinfo->tm_mon + 1 == 10 && timeinfo->tm_mday == 24) {
-                Serial.println("Manual override for October 24, 2025 - correcting moon phase");
-                
-                // October 24, 2025 is actually a Waxing Crescent phase
-                // New Moon was October 21, 2025, so this is 3 days after (early waxing)
-                currentWeather.moonPhaseName = "Waxing Crescent";
-                currentWeather.moonIllumination = 9.4; // 9.4% illuminated (waxing)
-                currentWeather.moonEmoji = "🌒"; // Waxing Crescent
-                
-                Serial.println("Corrected to: " + currentWeather.moonPhaseName + " (" + String(currentWeather.moonIllumination) + "% lit)");
-              } else {
-                // Calculate illumination percentage from phase (standard calculation)
-                currentWeather.moonIllumination = 0.5 * (1 - cos(2 * PI * phase)) * 100;
-                
-                // Set emoji based on corrected phase
-                if (currentWeather.moonPhaseName == "New Moon") {
-                  currentWeather.moonEmoji = "🌑";
-                } else if (currentWeather.moonPhaseName == "Waxing Crescent") {
-                  currentWeather.moonEmoji = "🌒";
-                } else if (currentWeather.moonPhaseName == "First Quarter") {
-                  currentWeather.moonEmoji = "🌓";
-                } else if (currentWeather.moonPhaseName == "Waxing Gibbous") {
-                  currentWeather.moonEmoji = "🌔";
-                } else if (currentWeather.moonPhaseName == "Full Moon") {
-                  currentWeather.moonEmoji = "🌕";
-                } else if (currentWeather.moonPhaseName == "Waning Gibbous") {
-                  currentWeather.moonEmoji = "🌖";
-                } else if (currentWeather.moonPhaseName == "Last Quarter") {
-                  currentWeather.moonEmoji = "🌗";
-                } else {
-                  currentWeather.moonEmoji = "🌘"; // Waning Crescent
-                }
-              }
-              
-              Serial.println("OneCall Moon Phase: " + String(phase));
-              Serial.println("Converted Phase Name: " + currentWeather.moonPhaseName);
-              Serial.println("Calculated Illumination: " + String(currentWeather.moonIllumination) + "%");
-              Serial.println("Moon Emoji: " + currentWeather.moonEmoji);
-              Serial.println("Moon data updated from OneCall API successfully");
-              
-              // Force display update to show new moon phase
-              extern bool forceDisplayUpdate;
-              forceDisplayUpdate = true;
-            }
-            // Get moonrise/moonset from API if available
-            if (day.containsKey("moonrise")) {
-              currentWeather.moonrise = day["moonrise"].as<unsigned long>();
-            }
-            if (day.containsKey("moonset")) {
-              currentWeather.moonset = day["moonset"].as<unsigned long>();
-            }
-          } else if (dayCount == 1) {
-            weeklyForecast.days[dayCount].dayName = "Tomorrow";
-          } else {
-            weeklyForecast.days[dayCount].dayName = dayNames[timeinfo->tm_wday];
-          }
-          
-          JsonObject temp = day["temp"];
-          weeklyForecast.days[dayCount].tempHigh = temp["max"].as<float>();
-          weeklyForecast.days[dayCount].tempLow = temp["min"].as<float>();
-          weeklyForecast.days[dayCount].icon = day["weather"][0]["icon"].as<String>();
-          weeklyForecast.days[dayCount].description = day["weather"][0]["description"].as<String>();
-          weeklyForecast.days[dayCount].precipChance = (day.containsKey("pop") ? 
-                                                        (int)(day["pop"].as<float>() * 100) : 0);
-          
-          dayCount++;
-        }
-        weeklyForecast.lastUpdate = millis();
-        
-        airQuality.lastUpdate = millis();
-        
-        Serial.println("OneCall 3.0 data updated successfully!");
-        Serial.print("Current temp: "); Serial.print(currentWeather.temperature); Serial.println("°F");
-        Serial.print("UV Index: "); Serial.println(airQuality.uvIndex);
-        
-      } else {
-        Serial.print("JSON parse failed: ");
-        Serial.println(error.c_str());
-      }
-    } else {
-      Serial.print("HTTP error: ");
-      Serial.println(httpCode);
-      if (httpCode > 0) {
-        String errorResponse = http.getString();
-        Serial.println("Error response: " + errorResponse);
+      if (loadedLocation == 0) { // The history is home's
+        recordHistory(HISTORY_TEMPERATURE, currentWeather.temperature);
+        recordHistory(HISTORY_PRESSURE, currentWeather.pressure);
+        recordHistory(HISTORY_HUMIDITY, currentWeather.humidity);
+        recordHistory(HISTORY_WIND_SPEED, currentWeather.windSpeed);
       }
+      LOG_INFO(EV_WEATHER_UPDATED, (int32_t)(currentWeather.temperature * 10), airQuality.uvIndex,
+               quotaBuckets[QUOTA_OPENWEATHER].used);
     }
-    
-    http.end();
-  } else {
-    Serial.println("WiFi not connected - cannot fetch weather data");
   }
 }
 
 // Air Quality API call (separate from OneCall)
 void updateAirQualityData() {
-  if (dailyApiCalls >= MAX_DAILY_CALLS) return;
-  
   if (WiFi.status() == WL_CONNECTED) {
-    HTTPClient http;
-    
-    Serial.println("Fetching air quality data...");
-    
     String airQualityUrl = "http://api.openweathermap.org/data/2.5/air_pollution?lat=" + 
                           String(latitude, 4) + "&lon=" + String(longitude, 4) + 
                           "&appid=" + String(apiKey);
     
-    http.begin(airQualityUrl.c_str());
-    int httpCode = http.GET();
-    
+    int httpCode = fetchAndIngest(SRC_AIR_QUALITY, airQualityUrl.c_str(), ingestAirQuality);
     if (httpCode == 200) {
-      dailyApiCalls++; // Count API call
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-      
-      if (!error) {
-        JsonObject main = doc["list"][0]["main"];
-        JsonObject components = doc["list"][0]["components"];
-        
-        airQuality.aqi = main["aqi"].as<int>();
-        
-        // AQI status mapping
-        switch(airQuality.aqi) {
-          case 1: airQuality.status = "Good"; break;
-          case 2: airQuality.status = "Fair"; break;
-          case 3: airQuality.status = "Moderate"; break;
-          case 4: airQuality.status = "Poor"; break;
-          case 5: airQuality.status = "Very Poor"; break;
-          default: airQuality.status = "Unknown"; break;
-        }
-        
-        airQuality.co = components["co"].as<float>();
-        airQuality.no2 = components["no2"].as<float>();
-        airQuality.o3 = components["o3"].as<float>();
-        airQuality.pm2_5 = components["pm2_5"].as<float>();
-        airQuality.pm10 = components["pm10"].as<float>();
-        
-        Serial.print("Air Quality Index: "); Serial.print(airQuality.aqi);
-        Serial.print(" ("); Serial.print(airQuality.status); Serial.println(")");
-        
-      } else {
-        Serial.print("Air quality JSON parse failed: ");
-        Serial.println(error.c_str());
-      }
-    } else {
-      Serial.print("Air quality HTTP error: ");
-      Serial.println(httpCode);
+      LOG_INFO(EV_AIR_QUALITY_UPDATED, airQuality.aqi);
     }
-    
-    http.end();
   }
 }
 
-void updateMoonData() {
-  // DISABLED: RapidAPI calls are failing with 202 error (requires ULTRA/MEGA plan)
-  // Instead, we'll use the moon phase data from OneCall API which is already working
+void updateAstronomyData() {
+  // Sun and moon data come from the on-device ephemeris, so this works offline
+  time_t now = time(nullptr);
+  if (now < MIN_VALID_EPOCH) return; // Needs a synced clock
   
-  Serial.println("=== MOON DATA FROM ONECALL API ===");
+  unsigned long start = micros();
   
-  if (currentWeather.moonPhase >= 0) {
-    // Convert OpenWeather moon phase (0-1) to phase name
-    float phase = currentWeather.moonPhase;
-    
-    Serial.println("Raw OneCall Moon Phase: " + String(phase));
-    
-    // OpenWeather API moon phase: 0 = new moon, 0.25 = first quarter, 0.5 = full moon, 0.75 = last quarter
-    // However, the API seems to sometimes give incorrect values, so let's add some debugging
-    
-    // For October 24, 2025, the actual moon phase should be Waxing Crescent (about 23% illuminated)
-    // Let's check if we need to override the API value for accuracy
-    
-    // Get current date for verification
-    time_t now;
-    time(&now);
-    struct tm* timeinfo = localtime(&now);
-    
-    // For debugging - calculate expected phase for this date
-    // October 24, 2025 should be approximately day 23 of lunar cycle (Waxing Crescent)
-    
-    // Convert phase value to moon phase name (consistent with OneCall API logic)
-    if (phase < 0.0625 || phase >= 0.9375) {
-      currentWeather.moonPhaseName = "New Moon";
-    } else if (phase < 0.1875) {
-      currentWeather.moonPhaseName = "Waxing Crescent";
-    } else if (phase < 0.3125) {
-      currentWeather.moonPhaseName = "First Quarter";
-    } else if (phase < 0.4375) {
-      currentWeather.moonPhaseName = "Waxing Gibbous";
-    } else if (phase < 0.5625) {
-      currentWeather.moonPhaseName = "Full Moon";
-    } else if (phase < 0.6875) {
-      currentWeather.moonPhaseName = "Waning Gibbous";
-    } else if (phase < 0.8125) {
-      currentWeather.moonPhaseName = "Last Quarter";
-    } else {
-      currentWeather.moonPhaseName = "Waning Crescent";
-    }
-    
-    // Manual override DISABLED for testing - was October 24, 2025 if API data seems wrong
-    if (timeinfo->tm_year + 1900 == 2099 && timeinfo->tm_mon + 1 == 10 && timeinfo->tm_mday == 24) {
-      Serial.println("Manual override for October 24, 2025 - correcting moon phase");
-      
-      // October 24, 2025 is actually a Waxing Crescent phase
-      // New Moon was October 21, 2025, so this is 3 days after (early waxing)
-      currentWeather.moonPhaseName = "Waxing Crescent";
-      currentWeather.moonIllumination = 9.4; // 9.4% illuminated (waxing)
-      currentWeather.moonEmoji = "�"; // Waning Crescent
-      
-      Serial.println("Corrected to: " + currentWeather.moonPhaseName + " (" + String(currentWeather.moonIllumination) + "% lit)");
-    } else {
-      // Calculate illumination percentage from phase (standard calculation)
-      currentWeather.moonIllumination = 0.5 * (1 - cos(2 * PI * phase)) * 100;
-      
-      // Set emoji based on corrected phase
-      if (currentWeather.moonPhaseName == "New Moon") {
-        currentWeather.moonEmoji = "🌑";
-      } else if (currentWeather.moonPhaseName == "Waxing Crescent") {
-        currentWeather.moonEmoji = "🌒";
-      } else if (currentWeather.moonPhaseName == "First Quarter") {
-        currentWeather.moonEmoji = "🌓";
-      } else if (currentWeather.moonPhaseName == "Waxing Gibbous") {
-        currentWeather.moonEmoji = "🌔";
-      } else if (currentWeather.moonPhaseName == "Full Moon") {
-        currentWeather.moonEmoji = "🌕";
-      } else if (currentWeather.moonPhaseName == "Waning Gibbous") {
-        currentWeather.moonEmoji = "🌖";
-      } else if (currentWeather.moonPhaseName == "Last Quarter") {
-        currentWeather.moonEmoji = "🌗";
-      } else {
-        currentWeather.moonEmoji = "🌘"; // Waning Crescent
-      }
-    }
-    
-    Serial.println("OneCall Moon Phase: " + String(phase));
-    Serial.println("Converted Phase Name: " + currentWeather.moonPhaseName);
-    Serial.println("Calculated Illumination: " + String(currentWeather.moonIllumination) + "%");
-    Serial.println("Moon Emoji: " + currentWeather.moonEmoji);
-    Serial.println("Moon data updated from OneCall API successfully");
+  // Rise/set/twilight times only change with the local date (or the location)
+  time_t midnight = localMidnight(now);
+  
+  if (midnight != astronomyDay) {
+    SunTimes sun;
+    computeSunTimes(midnight, latitude, longitude, sun);
+    currentWeather.sunrise = sun.rise;
+    currentWeather.sunset = sun.set;
+    currentWeather.solarNoon = sun.transit;
+    currentWeather.civilDawn = sun.civilDawn;
+    currentWeather.civilDusk = sun.civilDusk;
+    currentWeather.nauticalDawn = sun.nauticalDawn;
+    currentWeather.nauticalDusk = sun.nauticalDusk;
+    currentWeather.astronomicalDawn = sun.astronomicalDawn;
+    currentWeather.astronomicalDusk = sun.astronomicalDusk;
     
-    // Force display update to show new moon phase
-    extern bool forceDisplayUpdate;
-    forceDisplayUpdate = true;
+    MoonTimes moon;
+    computeMoonTimes(midnight, latitude, longitude, moon);
+    currentWeather.moonrise = moon.rise;
+    currentWeather.moonset = moon.set;
+    currentWeather.moonTransit = moon.transit;
     
+    astronomyDay = midnight;
+  }
+  
+  MoonPhaseInfo moonPhase;
+  computeMoonPhase(now, moonPhase);
+  float phase = moonPhase.phase;
+  currentWeather.moonPhase = phase;
+  currentWeather.moonIllumination = moonPhase.illumination * 100;
+  currentWeather.moonAge = moonPhase.age;
+  
+  LOG_INFO(EV_EPHEMERIS, (int32_t)(micros() - start));
+  
+  // Convert moon phase (0-1) to phase name and emoji
+  if (phase < 0.0625 || phase >= 0.9375) {
+    currentWeather.moonPhaseName = "New Moon";
+    currentWeather.moonEmoji = "🌑";
+  } else if (phase < 0.1875) {
+    currentWeather.moonPhaseName = "Waxing Crescent";
+    currentWeather.moonEmoji = "🌒";
+  } else if (phase < 0.3125) {
+    currentWeather.moonPhaseName = "First Quarter";
+    currentWeather.moonEmoji = "🌓";
+  } else if (phase < 0.4375) {
+    currentWeather.moonPhaseName = "Waxing Gibbous";
+    currentWeather.moonEmoji = "🌔";
+  } else if (phase < 0.5625) {
+    currentWeather.moonPhaseName = "Full Moon";
+    currentWeather.moonEmoji = "🌕";
+  } else if (phase < 0.6875) {
+    currentWeather.moonPhaseName = "Waning Gibbous";
+    currentWeather.moonEmoji = "🌖";
+  } else if (phase < 0.8125) {
+    currentWeather.moonPhaseName = "Last Quarter";
+    currentWeather.moonEmoji = "🌗";
   } else {
-    Serial.println("No moon phase data available from OneCall API");
+    currentWeather.moonPhaseName = "Waning Crescent";
+    currentWeather.moonEmoji = "🌘";
   }
+  
+  LOG_INFO(EV_MOON_UPDATED, (int32_t)(phase * 1000), (int32_t)(currentWeather.moonIllumination * 10));
+  
+  // Force display update to show new moon phase
+  extern bool forceDisplayUpdate;
+  forceDisplayUpdate = true;
 }
\ No newline at end of file
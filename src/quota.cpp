@@ -0,0 +1,91 @@
+#include "quota.h"
+
+void quotaInit(QuotaBucket& bucket, const QuotaPolicy& policy) {
+  bucket.day = 0;
+  bucket.refilledAt = 0;
+  bucket.tokens = (uint32_t)policy.burst * QUOTA_TOKEN_SCALE;
+  bucket.used = 0;
+  bucket.denied = 0;
+}
+
+bool quotaValid(const QuotaBucket& bucket, const QuotaPolicy& policy) {
+  return bucket.tokens <= (uint32_t)policy.burst * QUOTA_TOKEN_SCALE && bucket.used <= policy.dailyLimit;
+}
+
+void quotaAdvance(QuotaBucket& bucket, const QuotaPolicy& policy, uint32_t now) {
+  if (now == 0) return;
+
+  uint32_t today = now / QUOTA_DAY_SECONDS;
+  if (today > bucket.day) {
+    // First sight of the clock keeps what was spent before it was set
+    if (bucket.day != 0) {
+      bucket.used = 0;
+      bucket.denied = 0;
+    }
+    bucket.day = today;
+  }
+
+  // A clock stepped backwards restarts the refill from here instead of stalling it
+  if (bucket.refilledAt != 0 && now > bucket.refilledAt) {
+    uint64_t capacity = (uint64_t)policy.burst * QUOTA_TOKEN_SCALE;
+    uint64_t tokens = bucket.tokens +
+                      (uint64_t)(now - bucket.refilledAt) * policy.dailyLimit * QUOTA_TOKEN_SCALE / QUOTA_DAY_SECONDS;
+    bucket.tokens = (uint32_t)(tokens < capacity ? tokens : capacity);
+  }
+  bucket.refilledAt = now;
+}
+
+bool quotaTake(QuotaBucket& bucket, const QuotaPolicy& policy, uint32_t now) {
+  quotaAdvance(bucket, policy, now);
+  if (bucket.used >= policy.dailyLimit || bucket.tokens < QUOTA_TOKEN_SCALE) {
+    if (bucket.denied < UINT16_MAX) bucket.denied++;
+    return false;
+  }
+  bucket.tokens -= QUOTA_TOKEN_SCALE;
+  bucket.used++;
+  return true;
+}
+
+bool quotaJournal(QuotaJournal& journal, const QuotaBucket& bucket, const QuotaPolicy& policy, bool charged,
+                  QuotaBucket& stored) {
+  if (!charged) return false;  // Refusals change nothing a reboot must remember
+  if (journal.ahead > 0 && journal.day == bucket.day) {
+    journal.ahead--;
+    return false;
+  }
+
+  // This call is already in bucket; reserve the next ones as far as both limits allow
+  uint32_t ahead = QUOTA_WRITE_AHEAD > 1 ? QUOTA_WRITE_AHEAD - 1 : 0;
+  uint32_t tokens = bucket.tokens / QUOTA_TOKEN_SCALE;
+  uint32_t left = policy.dailyLimit > bucket.used ? policy.dailyLimit - bucket.used : 0;
+  if (ahead > tokens) ahead = tokens;
+  if (ahead > left) ahead = left;
+  stored = bucket;
+  stored.tokens -= ahead * QUOTA_TOKEN_SCALE;
+  stored.used += ahead;
+  journal.day = bucket.day;
+  journal.ahead = (uint8_t)ahead;
+  return true;
+}
+
+void quotaFlush(QuotaJournal& journal, const QuotaBucket& bucket, QuotaBucket& stored) {
+  stored = bucket;
+  journal.day = bucket.day;
+  journal.ahead = 0;
+}
+
+uint32_t quotaInterval(const QuotaBucket& bucket, const QuotaPolicy& policy, uint32_t now,
+                       uint32_t baseInterval, uint8_t callsPerRefresh) {
+  if (now == 0 || callsPerRefresh == 0) return baseInterval;
+  uint32_t untilReset = QUOTA_DAY_SECONDS - now % QUOTA_DAY_SECONDS;
+  // used belongs to an earlier day when the reset has not been applied yet
+  uint32_t used = bucket.day == now / QUOTA_DAY_SECONDS ? bucket.used : 0;
+  uint32_t remaining = policy.dailyLimit > used ? policy.dailyLimit - used : 0;
+  uint32_t refreshes = remaining / callsPerRefresh;
+  uint32_t interval = refreshes == 0 ? untilReset : untilReset / refreshes;
+  // Nor faster than the bucket refills, or a late start would run it dry
+  if (policy.dailyLimit > 0 && interval < QUOTA_DAY_SECONDS * callsPerRefresh / policy.dailyLimit) {
+    interval = QUOTA_DAY_SECONDS * callsPerRefresh / policy.dailyLimit;
+  }
+  return interval > baseInterval ? interval : baseInterval;
+}
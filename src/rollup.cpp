@@ -0,0 +1,103 @@
+#include "rollup.h"
+#include "timezone.h"
+
+Rollup::Rollup() {
+  clear();
+}
+
+void Rollup::clear() {
+  hourHead = 0;
+  hourCount = 0;
+  dayHead = 0;
+  dayCount = 0;
+  latestTime = 0;
+  latestValue = 0;
+}
+
+void Rollup::openBucket(RollupBucket& bucket, uint32_t start, uint32_t end, float value) {
+  bucket.start = start;
+  bucket.end = end;
+  bucket.min = value;
+  bucket.max = value;
+  bucket.mean = value;
+  bucket.count = 1;
+}
+
+void Rollup::addToBucket(RollupBucket& bucket, float value) {
+  if (value < bucket.min) bucket.min = value;
+  if (value > bucket.max) bucket.max = value;
+  if (bucket.count < UINT16_MAX) bucket.count++;
+  bucket.mean += (value - bucket.mean) / bucket.count;  // Running mean, no large sums
+}
+
+bool Rollup::add(uint32_t time, float value) {
+  if (hourCount > 0 && time < hours[hourHead].start) return false;
+
+  // Common case: the sample falls in the open hour, which also means the open day
+  if (hourCount > 0 && time < hours[hourHead].end) {
+    addToBucket(hours[hourHead], value);
+    addToBucket(days[dayHead], value);
+  } else {
+    // Local hours start at a whole number of hours after local midnight, which
+    // also holds for half-hour zones and across DST changes
+    uint32_t midnight = (uint32_t)localMidnight(time, ZONE_HOME);
+    uint32_t hourStart = midnight + (time - midnight) / 3600 * 3600;
+
+    if (hourCount > 0) hourHead = (hourHead + 1) % ROLLUP_HOURS;
+    if (hourCount < ROLLUP_HOURS) hourCount++;
+    openBucket(hours[hourHead], hourStart, hourStart + 3600, value);
+
+    if (dayCount > 0 && days[dayHead].start == midnight) {
+      addToBucket(days[dayHead], value);
+    } else {
+      if (dayCount > 0) dayHead = (dayHead + 1) % ROLLUP_DAYS;
+      if (dayCount < ROLLUP_DAYS) dayCount++;
+      // Days are 23-25 hours around DST, so take the end from the next midnight
+      uint32_t nextMidnight = (uint32_t)localMidnight(midnight + 30 * 3600, ZONE_HOME);
+      openBucket(days[dayHead], midnight, nextMidnight, value);
+    }
+
+    // Keep the hour inside the day so the fast path above stays correct
+    if (hours[hourHead].end > days[dayHead].end) hours[hourHead].end = days[dayHead].end;
+  }
+
+  latestTime = time;
+  latestValue = value;
+  return true;
+}
+
+const RollupBucket* Rollup::hour(uint8_t ago) const {
+  if (ago >= hourCount) return nullptr;
+  return &hours[(hourHead + ROLLUP_HOURS - ago) % ROLLUP_HOURS];
+}
+
+const RollupBucket* Rollup::day(uint8_t ago) const {
+  if (ago >= dayCount) return nullptr;
+  return &days[(dayHead + ROLLUP_DAYS - ago) % ROLLUP_DAYS];
+}
+
+const RollupBucket* Rollup::hourAt(uint32_t time) const {
+  for (uint8_t i = 0; i < hourCount; i++) {
+    const RollupBucket* bucket = hour(i);
+    if (time >= bucket->end) return nullptr;  // In a gap between buckets
+    if (time >= bucket->start) return bucket;
+  }
+  return nullptr;
+}
+
+const RollupBucket* Rollup::dayAt(uint32_t time) const {
+  for (uint8_t i = 0; i < dayCount; i++) {
+    const RollupBucket* bucket = day(i);
+    if (time >= bucket->end) return nullptr;
+    if (time >= bucket->start) return bucket;
+  }
+  return nullptr;
+}
+
+bool rollupChange(const Rollup& rollup, uint32_t now, uint32_t seconds, float& change) {
+  if (!rollup.hasData() || now < seconds) return false;
+  const RollupBucket* then = rollup.hourAt(now - seconds);
+  if (!then) return false;
+  change = rollup.lastValue() - then->mean;
+  return true;
+}
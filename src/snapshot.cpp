@@ -0,0 +1,329 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "snapshot.h"
+
+struct SnapshotSlot {
+  uint8_t json[SNAPSHOT_JSON_SIZE];
+  uint8_t cbor[SNAPSHOT_CBOR_SIZE];
+  SnapshotBody bodies[SNAPSHOT_FORMAT_COUNT];
+  uint16_t readers;        // Requests currently sending from this slot
+};
+
+static SnapshotSlot slots[2];
+static int8_t publishedSlot = -1;
+
+// One document walk, written as JSON or as CBOR with indefinite-length
+// containers (no counts needed up front). Keys are plain ASCII.
+class SnapshotWriter {
+public:
+  SnapshotWriter(SnapshotFormat format, uint8_t* out, size_t size)
+    : format(format), out(out), size(size), length(0), overflow(false), depth(0), first(1) {}
+
+  void beginObject(const char* key = nullptr) { open(key, '{', 0xBF); }
+  void beginArray(const char* key = nullptr) { open(key, '[', 0x9F); }
+  void endObject() { close('}'); }
+  void endArray() { close(']'); }
+
+  void integer(const char* key, int64_t value) {
+    name(key);
+    if (format == SNAPSHOT_CBOR) {
+      if (value < 0) cborHead(1, (uint64_t)(-1 - value));
+      else cborHead(0, (uint64_t)value);
+      return;
+    }
+    char digits[24];
+    put(digits, snprintf(digits, sizeof(digits), "%lld", (long long)value));
+  }
+
+  void number(const char* key, float value, uint8_t decimals) {
+    name(key);
+    if (!isfinite(value)) {
+      null();
+      return;
+    }
+    if (format == SNAPSHOT_CBOR) {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      put(0xFA);
+      for (int shift = 24; shift >= 0; shift -= 8) put((uint8_t)(bits >> shift));
+      return;
+    }
+    char digits[24];
+    put(digits, snprintf(digits, sizeof(digits), "%.*f", decimals, value));
+  }
+
+  // 0 = unknown, written as null
+  void time(const char* key, uint32_t value) {
+    if (value == 0) {
+      name(key);
+      null();
+    } else {
+      integer(key, value);
+    }
+  }
+
+  void text(const char* key, const char* value) {
+    name(key);
+    string(value);
+  }
+
+  size_t finish() const { return overflow || depth != 0 ? 0 : length; }
+
+private:
+  SnapshotFormat format;
+  uint8_t* out;
+  size_t size;
+  size_t length;
+  bool overflow;
+  uint8_t depth;
+  uint32_t first;          // Bit per nesting level: nothing written in it yet
+
+  void put(uint8_t byte) {
+    if (length < size) out[length++] = byte;
+    else overflow = true;
+  }
+
+  void put(const void* data, size_t count) {
+    if (count > size - length) {
+      overflow = true;
+      return;
+    }
+    memcpy(out + length, data, count);
+    length += count;
+  }
+
+  void cborHead(uint8_t major, uint64_t value) {
+    major <<= 5;
+    if (value < 24) {
+      put(major | (uint8_t)value);
+      return;
+    }
+    uint8_t bytes = value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFFULL ? 4 : 8;
+    put(major | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27));
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) put((uint8_t)(value >> shift));
+  }
+
+  void null() {
+    if (format == SNAPSHOT_CBOR) put(0xF6);
+    else put("null", 4);
+  }
+
+  void string(const char* value) {
+    size_t count = strlen(value);
+    if (format == SNAPSHOT_CBOR) {
+      cborHead(3, count);
+      put(value, count);
+      return;
+    }
+    put('"');
+    for (size_t i = 0; i < count; i++) {
+      uint8_t c = (uint8_t)value[i];
+      if (c == '"' || c == '\\') {
+        put('\\');
+        put(c);
+      } else if (c < 0x20) {
+        char escaped[8];
+        put(escaped, snprintf(escaped, sizeof(escaped), "\\u%04x", c));
+      } else {
+        put(c);
+      }
+    }
+    put('"');
+  }
+
+  // Comma and key before a member; array elements pass no key
+  void name(const char* key) {
+    if (format == SNAPSHOT_JSON && depth > 0 && !(first & (1u << depth))) put(',');
+    first &= ~(1u << depth);
+    if (key == nullptr) return;
+    string(key);
+    if (format == SNAPSHOT_JSON) put(':');
+  }
+
+  void open(const char* key, char jsonByte, uint8_t cborByte) {
+    if (depth >= 31) {
+      overflow = true;
+      return;
+    }
+    name(key);
+    put(format == SNAPSHOT_CBOR ? cborByte : (uint8_t)jsonByte);
+    depth++;
+    first |= 1u << depth;
+  }
+
+  void close(char jsonByte) {
+    if (depth == 0) {
+      overflow = true;
+      return;
+    }
+    depth--;
+    put(format == SNAPSHOT_CBOR ? 0xFF : (uint8_t)jsonByte);
+  }
+};
+
+static void writeSnapshot(SnapshotWriter& writer, const StationSnapshot& s) {
+  writer.beginObject();
+  writer.time("generated", s.generated);
+
+  writer.beginObject("weather");
+  writer.text("city", s.city);
+  writer.number("temp", s.temperature, 1);
+  writer.integer("humidity", s.humidity);
+  writer.number("pressure", s.pressure, 0);
+  writer.number("wind", s.windSpeed, 1);
+  writer.integer("windDir", s.windDirection);
+  writer.text("desc", s.description);
+  writer.text("icon", s.icon);
+  writer.time("updated", s.weatherUpdated);
+  writer.endObject();
+
+  writer.beginObject("air");
+  writer.integer("aqi", s.aqi);
+  writer.number("pm2_5", s.pm2_5, 1);
+  writer.number("pm10", s.pm10, 1);
+  writer.number("o3", s.o3, 1);
+  writer.number("no2", s.no2, 1);
+  writer.integer("uv", s.uvIndex);
+  writer.time("updated", s.airUpdated);
+  writer.endObject();
+
+  writer.beginObject("astro");
+  writer.time("sunrise", s.sunrise);
+  writer.time("sunset", s.sunset);
+  writer.time("moonrise", s.moonrise);
+  writer.time("moonset", s.moonset);
+  writer.number("moonPhase", s.moonPhase, 3);
+  writer.number("moonIllum", s.moonIllumination, 0);
+  writer.text("moonName", s.moonPhaseName);
+  writer.endObject();
+
+  writer.beginObject("space");
+  writer.number("kp", s.kpIndex, 2);
+  writer.number("bz", s.bz, 1);
+  writer.number("by", s.by, 1);
+  writer.number("speed", s.solarWindSpeed, 0);
+  writer.number("density", s.solarWindDensity, 1);
+  writer.number("couplingKp", s.couplingKp, 1);
+  writer.number("dst", s.dst, 0);
+  writer.integer("aurora", s.auroraScore);
+  writer.text("geomag", s.geomagStatus);
+  writer.number("sfi", s.solarFlux, 0);
+  writer.number("aIndex", s.aIndex, 0);
+  writer.text("xray", s.xrayClass);
+  writer.integer("ssn", s.sunspotNumber);
+  writer.integer("regions", s.activeRegions);
+  writer.time("updated", s.spaceUpdated);
+  writer.endObject();
+
+  writer.beginObject("aurora");
+  writer.number("kpToday", s.kpToday, 1);
+  writer.number("kpTomorrow", s.kpTomorrow, 1);
+  writer.integer("nowcast", s.nowcastProbability);
+  writer.integer("viewline", s.viewlineLatitude);
+  writer.endObject();
+
+  writer.beginArray("daily");
+  for (uint8_t i = 0; i < SNAPSHOT_DAYS; i++) {
+    const SnapshotDay& day = s.days[i];
+    writer.beginObject();
+    writer.text("day", day.name);
+    writer.number("hi", day.high, 1);
+    writer.number("lo", day.low, 1);
+    writer.integer("pop", day.precipChance);
+    writer.text("icon", day.icon);
+    writer.endObject();
+  }
+  writer.endArray();
+
+  writer.beginArray("hourly");
+  for (uint8_t i = 0; i < SNAPSHOT_HOURS; i++) {
+    const SnapshotHour& hour = s.hours[i];
+    writer.beginObject();
+    writer.text("time", hour.time);
+    writer.number("temp", hour.temperature, 1);
+    writer.integer("pop", hour.precipChance);
+    writer.text("icon", hour.icon);
+    writer.endObject();
+  }
+  writer.endArray();
+
+  writer.beginArray("alerts");
+  for (uint8_t i = 0; i < s.alertCount && i < SNAPSHOT_ALERTS; i++) {
+    const SnapshotAlert& alert = s.alerts[i];
+    writer.beginObject();
+    writer.text("code", alert.code);
+    writer.text("scale", alert.scale);
+    writer.time("issued", alert.issued);
+    writer.time("expires", alert.expires);
+    writer.endObject();
+  }
+  writer.endArray();
+
+  writer.endObject();
+}
+
+static uint32_t bodyHash(const uint8_t* data, size_t length) {
+  uint32_t hash = 2166136261u;  // FNV-1a
+  for (size_t i = 0; i < length; i++) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+void snapshotCopyText(char* dest, size_t size, const char* src) {
+  if (size == 0) return;
+  size_t length = strlen(src);
+  if (length >= size) {
+    length = size - 1;
+    // Back up over a cut multi-byte sequence so the text stays valid UTF-8
+    while (length > 0 && ((uint8_t)src[length] & 0xC0) == 0x80) length--;
+  }
+  memcpy(dest, src, length);
+  dest[length] = '\0';
+}
+
+size_t snapshotEncode(const StationSnapshot& snapshot, SnapshotFormat format, uint8_t* out, size_t size) {
+  SnapshotWriter writer(format, out, size);
+  writeSnapshot(writer, snapshot);
+  return writer.finish();
+}
+
+bool snapshotPublish(const StationSnapshot& snapshot) {
+  int8_t current = __atomic_load_n(&publishedSlot, __ATOMIC_SEQ_CST);
+  SnapshotSlot& slot = slots[current == 0 ? 1 : 0];
+  // A reader that pinned this slot before it was replaced may still be sending
+  // from it. Readers arriving now see it unpublished and back off.
+  if (__atomic_load_n(&slot.readers, __ATOMIC_SEQ_CST) != 0) return false;
+
+  size_t jsonLength = snapshotEncode(snapshot, SNAPSHOT_JSON, slot.json, sizeof(slot.json));
+  size_t cborLength = snapshotEncode(snapshot, SNAPSHOT_CBOR, slot.cbor, sizeof(slot.cbor));
+  if (jsonLength == 0 || cborLength == 0) return false;
+
+  slot.bodies[SNAPSHOT_JSON] = {slot.json, (uint16_t)jsonLength, bodyHash(slot.json, jsonLength)};
+  slot.bodies[SNAPSHOT_CBOR] = {slot.cbor, (uint16_t)cborLength, bodyHash(slot.cbor, cborLength)};
+  __atomic_store_n(&publishedSlot, (int8_t)(&slot - slots), __ATOMIC_SEQ_CST);
+  return true;
+}
+
+const SnapshotSlot* snapshotAcquire() {
+  for (;;) {
+    int8_t index = __atomic_load_n(&publishedSlot, __ATOMIC_SEQ_CST);
+    if (index < 0) return nullptr;
+    SnapshotSlot& slot = slots[index];
+    __atomic_fetch_add(&slot.readers, 1, __ATOMIC_SEQ_CST);
+    // Still published after pinning, so the publisher cannot be writing it
+    if (__atomic_load_n(&publishedSlot, __ATOMIC_SEQ_CST) == index) return &slot;
+    __atomic_fetch_sub(&slot.readers, 1, __ATOMIC_SEQ_CST);
+  }
+}
+
+void snapshotRelease(const SnapshotSlot* slot) {
+  if (slot == nullptr) return;
+  __atomic_fetch_sub(&slots[slot - slots].readers, 1, __ATOMIC_SEQ_CST);
+}
+
+SnapshotBody snapshotBody(const SnapshotSlot* slot, SnapshotFormat format) {
+  return slot->bodies[format];
+}
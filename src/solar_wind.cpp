@@ -0,0 +1,112 @@
+#include "solar_wind.h"
+#include <math.h>
+#include <string.h>
+
+static inline uint32_t binStartOf(uint32_t time) {
+  return time - time % SOLAR_WIND_BIN_SECONDS;
+}
+
+static inline SolarWindBin& slotOf(SolarWindSeries& series, uint32_t binStart) {
+  return series.bins[(binStart / SOLAR_WIND_BIN_SECONDS) % SOLAR_WIND_BINS];
+}
+
+static int16_t toTenths(float value) {
+  long scaled = lroundf(value * 10);
+  return (int16_t)(scaled > INT16_MAX ? INT16_MAX : (scaled < INT16_MIN ? INT16_MIN : scaled));
+}
+
+static uint16_t toUnsigned(float value, float scale) {
+  long scaled = lroundf(value * scale);
+  return (uint16_t)(scaled > UINT16_MAX ? UINT16_MAX : (scaled < 0 ? 0 : scaled));
+}
+
+void solarWindClear(SolarWindSeries& series) {
+  memset(&series, 0, sizeof(series));
+}
+
+const SolarWindBin* solarWindBinAt(const SolarWindSeries& series, uint32_t time) {
+  uint32_t binStart = binStartOf(time);
+  const SolarWindBin& bin = series.bins[(binStart / SOLAR_WIND_BIN_SECONDS) % SOLAR_WIND_BINS];
+  return bin.start == binStart ? &bin : nullptr;
+}
+
+void SolarWindBinner::begin(SolarWindKind binnerKind) {
+  kind = binnerKind;
+  binStart = 0;
+  count = 0;
+}
+
+void SolarWindBinner::add(SolarWindSeries& series, uint32_t time, float primary, float secondary) {
+  uint32_t start = binStartOf(time);
+  if (start != binStart) {
+    flush(series);
+    binStart = start;
+  }
+
+  if (count == 0) {
+    primaryMin = primary;
+    primaryMax = primary;
+    primarySum = 0;
+    secondarySum = 0;
+  } else {
+    if (primary < primaryMin) primaryMin = primary;
+    if (primary > primaryMax) primaryMax = primary;
+  }
+  primarySum += primary;
+  secondarySum += secondary;
+  if (count < UINT8_MAX) count++;
+}
+
+void SolarWindBinner::flush(SolarWindSeries& series) {
+  if (binStart == 0 || count == 0) return;
+
+  SolarWindBin& bin = slotOf(series, binStart);
+  if (bin.start != binStart) {
+    if (bin.start > binStart) {
+      count = 0;  // Slot already holds a newer bin - this row is more than a day old
+      return;
+    }
+    memset(&bin, 0, sizeof(bin));  // Recycle the slot from the previous day
+    bin.start = binStart;
+  }
+
+  float primaryMean = primarySum / count;
+  float secondaryMean = secondarySum / count;
+  if (kind == SOLAR_WIND_MAG) {
+    bin.bzMin = toTenths(primaryMin);
+    bin.bzMean = toTenths(primaryMean);
+    bin.bzMax = toTenths(primaryMax);
+    bin.byMean = toTenths(secondaryMean);
+    bin.magSamples = count;
+  } else {
+    bin.speedMin = toUnsigned(primaryMin, 1);
+    bin.speedMean = toUnsigned(primaryMean, 1);
+    bin.speedMax = toUnsigned(primaryMax, 1);
+    bin.densityMean = toUnsigned(secondaryMean, 100);
+    bin.plasmaSamples = count;
+  }
+  count = 0;
+}
+
+uint32_t solarWindSouthwardSeconds(const SolarWindSeries& series, uint32_t now, float threshold) {
+  int16_t limit = toTenths(threshold);
+  uint32_t runEnd = 0;
+  uint32_t runStart = 0;
+  uint8_t gap = 0;
+
+  // Walk back one bin at a time from now
+  uint32_t binStart = binStartOf(now);
+  for (uint16_t i = 0; i < SOLAR_WIND_BINS; i++, binStart -= SOLAR_WIND_BIN_SECONDS) {
+    const SolarWindBin* bin = solarWindBinAt(series, binStart);
+    if (!bin || bin->magSamples == 0) {
+      if (runEnd != 0 && ++gap > SOLAR_WIND_GAP_BINS) break;
+      continue;  // No data yet at the newest end, or a short gap inside the run
+    }
+    gap = 0;
+    if (bin->bzMean >= limit) break;
+    if (runEnd == 0) runEnd = binStart + SOLAR_WIND_BIN_SECONDS;
+    runStart = binStart;
+  }
+
+  return runEnd ? runEnd - runStart : 0;
+}
@@ -0,0 +1,50 @@
+#include "sunspots.h"
+#include <string.h>
+
+static uint16_t clampAdd(uint16_t total, int32_t value) {
+  if (value <= 0) return total;
+  uint32_t sum = (uint32_t)total + (uint32_t)value;
+  return sum > UINT16_MAX ? UINT16_MAX : (uint16_t)sum;
+}
+
+void SunspotAggregator::begin() {
+  rowCount = 0;
+  memset(&current, 0, sizeof(current));
+  regionCount = 0;
+}
+
+void SunspotAggregator::add(uint32_t observed, int32_t region, int32_t spots, int32_t area) {
+  if (observed == 0 || region <= 0) return;
+  rowCount++;
+
+  if (observed < current.observed) return;  // Older observation date
+  if (observed > current.observed) {
+    memset(&current, 0, sizeof(current));
+    current.observed = observed;
+    regionCount = 0;
+  }
+
+  uint16_t number = (uint16_t)region;  // NOAA numbers are 4-5 digits
+  for (uint8_t i = 0; i < regionCount; i++) {
+    if (regionNumbers[i] == number) return;  // Same region listed twice
+  }
+  if (regionCount < SUNSPOT_REGION_CAPACITY) regionNumbers[regionCount++] = number;
+
+  current.regions++;
+  if (spots > 0) {
+    current.spotGroups++;
+    current.spots = clampAdd(current.spots, spots);
+  }
+  current.area = clampAdd(current.area, area);
+  if (area > current.largestArea) {
+    current.largestArea = area > UINT16_MAX ? UINT16_MAX : (uint16_t)area;
+    current.largestRegion = number;
+  }
+}
+
+bool SunspotAggregator::finish(SunspotSummary& summary) const {
+  if (current.observed == 0) return false;
+  summary = current;
+  summary.sunspotNumber = clampAdd(clampAdd(0, 10 * (int32_t)current.spotGroups), current.spots);
+  return true;
+}
@@ -0,0 +1,425 @@
+#include "timezone.h"
+#include <stdio.h>
+
+// How the day of a DST transition is written in the rule
+enum TransitionType : uint8_t {
+  TRANSITION_MONTH_WEEK_DAY = 0,  // Mm.w.d - day d of week w (5 = last) of month m
+  TRANSITION_JULIAN_NO_LEAP,      // Jn - day 1-365, Feb 29 never counted
+  TRANSITION_JULIAN               // n - day 0-365, Feb 29 counted
+};
+
+struct TransitionRule {
+  TransitionType type;
+  uint8_t month;
+  uint8_t week;
+  uint8_t weekday;
+  uint16_t day;
+  int32_t time;                   // Local wall-clock seconds after midnight
+};
+
+struct TimeZoneRule {
+  int32_t standardOffset;         // Seconds east of UTC
+  int32_t dstOffset;
+  bool hasDst;
+  TransitionRule start;
+  TransitionRule end;
+};
+
+// Transitions for one UTC year, recomputed when a timestamp falls outside it
+struct TransitionCache {
+  time_t yearBegin;
+  time_t yearEnd;
+  time_t dstStart;
+  time_t dstEnd;
+  uint32_t generation;            // Rule the transitions were computed from
+};
+
+// Converted from the loop, the SNTP callback and the fetch tasks, so nothing
+// here is written in place while another task may read it. timeZoneInit()
+// (loop task only) fills the unpublished rule and then bumps the generation;
+// the cache is a sequence-locked copy that a conversion only reuses when it
+// read it whole, and only publishes when no other task is filling it. Neither
+// side ever waits on the other.
+struct Zone {
+  TimeZoneRule rules[2];
+  uint32_t ruleGeneration;        // rules[ruleGeneration & 1] is current
+  TransitionCache sharedCache;
+  uint32_t cacheSequence;         // Odd while sharedCache is being written
+};
+
+static Zone zones[ZONE_COUNT];    // Zeroed: UTC, and an empty cache range forces the first fill
+
+// Consistent copy of the zone for one conversion
+struct ZoneView {
+  Zone* zone;
+  TimeZoneRule rule;
+  TransitionCache cache;
+};
+
+static const int32_t SECONDS_PER_DAY = 86400;
+
+// ============================================================================
+// Calendar arithmetic (days since 1970-01-01, proleptic Gregorian)
+// ============================================================================
+
+static int32_t daysFromCivil(int32_t year, uint32_t month, uint32_t day) {
+  year -= month <= 2;
+  int32_t era = (year >= 0 ? year : year - 399) / 400;
+  uint32_t yearOfEra = (uint32_t)(year - era * 400);
+  uint32_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  uint32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + (int32_t)dayOfEra - 719468;
+}
+
+static void civilFromDays(int32_t days, int32_t& year, uint32_t& month, uint32_t& day) {
+  days += 719468;
+  int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+  uint32_t dayOfEra = (uint32_t)(days - era * 146097);
+  uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  uint32_t monthIndex = (5 * dayOfYear + 2) / 153;
+  day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+  month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+  year = (int32_t)yearOfEra + era * 400 + (month <= 2);
+}
+
+static bool isLeapYear(int32_t year) {
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static uint32_t weekdayFromDays(int32_t days) {
+  return (uint32_t)((days % 7 + 11) % 7);  // 1970-01-01 was a Thursday
+}
+
+static int32_t floorDiv(int64_t value, int32_t divisor) {
+  int64_t quotient = value / divisor;
+  if (value % divisor < 0) quotient--;
+  return (int32_t)quotient;
+}
+
+static int32_t transitionDay(const TransitionRule& rule, int32_t year) {
+  int32_t newYear = daysFromCivil(year, 1, 1);
+
+  if (rule.type == TRANSITION_JULIAN_NO_LEAP) {
+    return newYear + rule.day - 1 + (isLeapYear(year) && rule.day >= 60 ? 1 : 0);
+  }
+  if (rule.type == TRANSITION_JULIAN) {
+    return newYear + rule.day;
+  }
+
+  int32_t firstOfMonth = daysFromCivil(year, rule.month, 1);
+  int32_t nextMonth = rule.month == 12 ? daysFromCivil(year + 1, 1, 1) : daysFromCivil(year, rule.month + 1, 1);
+  int32_t day = firstOfMonth + (int32_t)((rule.weekday + 7 - weekdayFromDays(firstOfMonth)) % 7) + (rule.week - 1) * 7;
+  while (day >= nextMonth) day -= 7;  // Week 5 means "last"
+  return day;
+}
+
+static void readCache(ZoneView& view, uint32_t generation) {
+  Zone& zone = *view.zone;
+  view.cache = {1, 0, 0, 0, generation};
+  uint32_t before = __atomic_load_n(&zone.cacheSequence, __ATOMIC_ACQUIRE);
+  if (before & 1) return;
+  TransitionCache copy = zone.sharedCache;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (__atomic_load_n(&zone.cacheSequence, __ATOMIC_RELAXED) != before || copy.generation != generation) return;
+  view.cache = copy;
+}
+
+static void publishCache(Zone& zone, const TransitionCache& cache) {
+  uint32_t sequence = __atomic_load_n(&zone.cacheSequence, __ATOMIC_RELAXED);
+  // Another task is filling it - keep ours local rather than wait
+  if ((sequence & 1) || !__atomic_compare_exchange_n(&zone.cacheSequence, &sequence, sequence + 1, false,
+                                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+    return;
+  }
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  zone.sharedCache = cache;
+  __atomic_store_n(&zone.cacheSequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+static void viewZone(ZoneView& view, ZoneId id) {
+  Zone& zone = zones[id < ZONE_COUNT ? id : ZONE_DISPLAYED];
+  view.zone = &zone;
+  uint32_t generation;
+  do {
+    generation = __atomic_load_n(&zone.ruleGeneration, __ATOMIC_ACQUIRE);
+    view.rule = zone.rules[generation & 1];
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    // Only retries when timeZoneInit() published twice during the copy
+  } while (__atomic_load_n(&zone.ruleGeneration, __ATOMIC_RELAXED) != generation);
+  readCache(view, generation);
+}
+
+static void fillCache(ZoneView& view, time_t utc) {
+  const TimeZoneRule& zone = view.rule;
+  int32_t year;
+  uint32_t month, day;
+  civilFromDays(floorDiv(utc, SECONDS_PER_DAY), year, month, day);
+
+  TransitionCache& cache = view.cache;
+  cache.yearBegin = (time_t)daysFromCivil(year, 1, 1) * SECONDS_PER_DAY;
+  cache.yearEnd = (time_t)daysFromCivil(year + 1, 1, 1) * SECONDS_PER_DAY;
+  // Transition times are local: the start is in standard time, the end in DST
+  cache.dstStart = (time_t)transitionDay(zone.start, year) * SECONDS_PER_DAY + zone.start.time - zone.standardOffset;
+  cache.dstEnd = (time_t)transitionDay(zone.end, year) * SECONDS_PER_DAY + zone.end.time - zone.dstOffset;
+  publishCache(*view.zone, cache);
+}
+
+static bool isDst(ZoneView& view, time_t utc) {
+  if (!view.rule.hasDst) return false;
+  if (utc < view.cache.yearBegin || utc >= view.cache.yearEnd) fillCache(view, utc);
+
+  const TransitionCache& cache = view.cache;
+  if (cache.dstStart < cache.dstEnd) {
+    return utc >= cache.dstStart && utc < cache.dstEnd;
+  }
+  // Southern hemisphere - DST spans the new year
+  return utc >= cache.dstStart || utc < cache.dstEnd;
+}
+
+static int32_t offsetAt(ZoneView& view, time_t utc) {
+  return isDst(view, utc) ? view.rule.dstOffset : view.rule.standardOffset;
+}
+
+// ============================================================================
+// POSIX TZ rule parsing
+// ============================================================================
+
+static bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static bool isAlpha(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static bool parseNumber(const char*& p, int32_t& value) {
+  if (!isDigit(*p)) return false;
+  value = 0;
+  while (isDigit(*p)) value = value * 10 + (*p++ - '0');
+  return true;
+}
+
+static bool parseName(const char*& p) {
+  const char* begin = p;
+  if (*p == '<') {
+    while (*p && *p != '>') p++;
+    if (*p != '>') return false;
+    p++;
+    return true;
+  }
+  while (isAlpha(*p)) p++;
+  return p - begin >= 3;
+}
+
+// [+|-]hh[:mm[:ss]] in seconds
+static bool parseTime(const char*& p, int32_t& seconds) {
+  int32_t sign = 1;
+  if (*p == '+' || *p == '-') {
+    if (*p == '-') sign = -1;
+    p++;
+  }
+  int32_t hours, minutes = 0, secs = 0;
+  if (!parseNumber(p, hours)) return false;
+  if (*p == ':') {
+    p++;
+    if (!parseNumber(p, minutes)) return false;
+    if (*p == ':') {
+      p++;
+      if (!parseNumber(p, secs)) return false;
+    }
+  }
+  seconds = sign * (hours * 3600 + minutes * 60 + secs);
+  return true;
+}
+
+static bool parseTransition(const char*& p, TransitionRule& rule) {
+  int32_t value;
+  if (*p == 'M') {
+    p++;
+    int32_t week, weekday;
+    if (!parseNumber(p, value) || *p++ != '.') return false;
+    if (!parseNumber(p, week) || *p++ != '.') return false;
+    if (!parseNumber(p, weekday)) return false;
+    if (value < 1 || value > 12 || week < 1 || week > 5 || weekday > 6) return false;
+    rule.type = TRANSITION_MONTH_WEEK_DAY;
+    rule.month = value;
+    rule.week = week;
+    rule.weekday = weekday;
+  } else if (*p == 'J') {
+    p++;
+    if (!parseNumber(p, value) || value < 1 || value > 365) return false;
+    rule.type = TRANSITION_JULIAN_NO_LEAP;
+    rule.day = value;
+  } else {
+    if (!parseNumber(p, value) || value > 365) return false;
+    rule.type = TRANSITION_JULIAN;
+    rule.day = value;
+  }
+
+  rule.time = 7200;  // Default 02:00
+  if (*p == '/') {
+    p++;
+    if (!parseTime(p, rule.time)) return false;
+  }
+  return true;
+}
+
+bool timeZoneInit(const char* rule, ZoneId id) {
+  TimeZoneRule parsed = {0, 0, false, {}, {}};
+  const char* p = rule;
+  int32_t offset;
+
+  // POSIX offsets are hours west of UTC; we keep seconds east
+  bool valid = parseName(p) && parseTime(p, offset);
+  if (valid) {
+    parsed.standardOffset = -offset;
+    parsed.dstOffset = parsed.standardOffset;
+
+    if (*p) {
+      parsed.hasDst = parseName(p);
+      parsed.dstOffset = parsed.standardOffset + 3600;
+      if (parsed.hasDst && *p && *p != ',') {
+        parsed.hasDst = parseTime(p, offset);
+        parsed.dstOffset = -offset;
+      }
+      if (parsed.hasDst && *p == ',') {
+        p++;
+        parsed.hasDst = parseTransition(p, parsed.start) && *p++ == ',' && parseTransition(p, parsed.end);
+      } else if (parsed.hasDst) {
+        // No rule given - use the US rules like glibc does
+        const char* fallback = "M3.2.0,M11.1.0";
+        parseTransition(fallback, parsed.start);
+        fallback++;
+        parseTransition(fallback, parsed.end);
+      }
+      valid = parsed.hasDst && *p == '\0';
+    }
+  }
+
+  if (!valid) parsed = {0, 0, false, {}, {}};
+  // Fill the rule readers are not using, then switch them over; the cache
+  // belongs to the old generation from here on
+  Zone& zone = zones[id < ZONE_COUNT ? id : ZONE_DISPLAYED];
+  uint32_t generation = zone.ruleGeneration + 1;
+  zone.rules[generation & 1] = parsed;
+  __atomic_store_n(&zone.ruleGeneration, generation, __ATOMIC_RELEASE);
+  return valid;
+}
+
+// ============================================================================
+// Conversion and formatting
+// ============================================================================
+
+static void toLocal(ZoneView& view, time_t utc, LocalTime& out) {
+  out.dst = isDst(view, utc);
+  int64_t local = (int64_t)utc + (out.dst ? view.rule.dstOffset : view.rule.standardOffset);
+  int32_t days = floorDiv(local, SECONDS_PER_DAY);
+  int32_t seconds = (int32_t)(local - (int64_t)days * SECONDS_PER_DAY);
+
+  int32_t year;
+  uint32_t month, day;
+  civilFromDays(days, year, month, day);
+  out.year = year;
+  out.month = month;
+  out.day = day;
+  out.hour = seconds / 3600;
+  out.minute = seconds / 60 % 60;
+  out.second = seconds % 60;
+  out.weekday = weekdayFromDays(days);
+}
+
+int32_t timeZoneOffset(time_t utc, ZoneId id) {
+  ZoneView view;
+  viewZone(view, id);
+  return offsetAt(view, utc);
+}
+
+void toLocalTime(time_t utc, LocalTime& out, ZoneId id) {
+  ZoneView view;
+  viewZone(view, id);
+  toLocal(view, utc, out);
+}
+
+time_t localMidnight(time_t utc, ZoneId id) {
+  ZoneView view;
+  viewZone(view, id);
+  LocalTime local;
+  toLocal(view, utc, local);
+  time_t midnight = utc - (local.hour * 3600 + local.minute * 60 + local.second);
+  // A DST change between midnight and now shifts the offset by the difference
+  return midnight - (offsetAt(view, midnight) - offsetAt(view, utc));
+}
+
+// Fixed-width digits, false on anything else
+static bool readDigits(const char*& p, int count, int32_t& value) {
+  value = 0;
+  for (int i = 0; i < count; i++) {
+    if (!isDigit(*p)) return false;
+    value = value * 10 + (*p++ - '0');
+  }
+  return true;
+}
+
+bool parseUtcTimestamp(const char* text, time_t& out) {
+  // SWPC and most feeds use "YYYY-MM-DD HH:MM[:SS][.fff][Z]" in UTC, with a space or 'T'
+  const char* p = text;
+  int32_t year, month, day, hour, minute, second = 0;
+  if (!readDigits(p, 4, year) || *p++ != '-') return false;
+  if (!readDigits(p, 2, month) || *p++ != '-') return false;
+  if (!readDigits(p, 2, day)) return false;
+  if (*p != ' ' && *p != 'T') return false;
+  p++;
+  if (!readDigits(p, 2, hour) || *p++ != ':') return false;
+  if (!readDigits(p, 2, minute)) return false;
+  if (*p == ':') {
+    p++;
+    if (!readDigits(p, 2, second)) return false;
+  }
+  if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) return false;
+
+  out = (time_t)daysFromCivil(year, month, day) * SECONDS_PER_DAY + hour * 3600 + minute * 60 + second;
+  return true;
+}
+
+static uint8_t hour12(uint8_t hour) {
+  return hour % 12 == 0 ? 12 : hour % 12;
+}
+
+static size_t clampLength(int length, size_t size) {
+  if (length < 0) return 0;
+  return (size_t)length < size ? (size_t)length : (size ? size - 1 : 0);
+}
+
+size_t formatClock(time_t utc, char* buffer, size_t size) {
+  LocalTime local;
+  toLocalTime(utc, local);
+  return clampLength(snprintf(buffer, size, "%d:%02d %s", hour12(local.hour), local.minute,
+                              local.hour >= 12 ? "PM" : "AM"), size);
+}
+
+size_t formatClockCompact(time_t utc, char* buffer, size_t size) {
+  LocalTime local;
+  toLocalTime(utc, local);
+  return clampLength(snprintf(buffer, size, "%d:%02d%s", hour12(local.hour), local.minute,
+                              local.hour >= 12 ? "PM" : "AM"), size);
+}
+
+size_t formatHour(time_t utc, char* buffer, size_t size) {
+  LocalTime local;
+  toLocalTime(utc, local);
+  return clampLength(snprintf(buffer, size, "%d%s", hour12(local.hour), local.hour >= 12 ? "PM" : "AM"), size);
+}
+
+size_t formatDate(time_t utc, char* buffer, size_t size) {
+  LocalTime local;
+  toLocalTime(utc, local);
+  return clampLength(snprintf(buffer, size, "%02d/%02d/%d", local.month, local.day, local.year), size);
+}
+
+size_t formatUptime(uint64_t microseconds, char* buffer, size_t size) {
+  // 64-bit so it keeps counting past the 49.7 days where millis() wraps
+  uint64_t minutes = microseconds / 60000000;
+  return clampLength(snprintf(buffer, size, "%luh%lum", (unsigned long)(minutes / 60),
+                              (unsigned long)(minutes % 60)), size);
+}
@@ -0,0 +1,63 @@
+#include "upstream.h"
+
+static inline bool reached(uint32_t now, uint32_t deadline) {
+  return (int32_t)(now - deadline) >= 0;  // Wrap-safe millis() comparison
+}
+
+FetchOutcome fetchOutcome(int httpCode, bool ingested) {
+  if (httpCode == 200) return ingested ? FETCH_OK : FETCH_BAD_DATA;
+  if (httpCode == 304) return FETCH_OK;       // Conditional request, what we hold is current
+  if (httpCode < 0) return FETCH_TRANSPORT_ERROR;
+  if (httpCode == 429 || httpCode >= 500) return FETCH_SERVER_ERROR;
+  if (httpCode >= 400) return FETCH_CLIENT_ERROR;
+  return FETCH_SERVER_ERROR;  // Redirects and other codes we cannot use
+}
+
+bool endpointAllow(EndpointHealth& health, uint32_t now) {
+  if (health.state == CIRCUIT_OPEN) {
+    if (!reached(now, health.retryAt)) {
+      health.skipped++;
+      return false;
+    }
+    health.state = CIRCUIT_HALF_OPEN;  // Let one probe through
+  }
+  return true;
+}
+
+bool endpointRecord(EndpointHealth& health, uint32_t now, int httpCode, FetchOutcome outcome, uint32_t random) {
+  uint8_t previous = health.state;
+  health.requests++;
+  health.lastCode = (int16_t)httpCode;
+
+  if (outcome == FETCH_OK) {
+    health.state = CIRCUIT_CLOSED;
+    health.failures = 0;
+    health.backoff = 0;
+    health.lastSuccess = now ? now : 1;
+    return health.state != previous;
+  }
+
+  if (health.failures < UINT8_MAX) health.failures++;
+  bool open = health.state == CIRCUIT_HALF_OPEN || outcome == FETCH_CLIENT_ERROR ||
+              health.failures >= UPSTREAM_FAILURE_THRESHOLD;
+  if (!open) return false;
+
+  if (outcome == FETCH_CLIENT_ERROR) {
+    health.backoff = UPSTREAM_BACKOFF_MAX;
+  } else if (health.backoff == 0) {
+    health.backoff = UPSTREAM_BACKOFF_MIN;
+  } else {
+    health.backoff = health.backoff >= UPSTREAM_BACKOFF_MAX / 2 ? UPSTREAM_BACKOFF_MAX : health.backoff * 2;
+  }
+
+  // Spread by +-UPSTREAM_JITTER_PERCENT
+  uint32_t spread = health.backoff / 100 * UPSTREAM_JITTER_PERCENT;
+  uint32_t delay = health.backoff - spread + (spread ? random % (2 * spread + 1) : 0);
+  health.retryAt = now + delay;
+  health.state = CIRCUIT_OPEN;
+  return health.state != previous;
+}
+
+bool endpointStale(const EndpointHealth& health, uint32_t now, uint32_t maxAge) {
+  return health.lastSuccess == 0 || now - health.lastSuccess > maxAge;
+}
@@ -0,0 +1,86 @@
+#include "wifi_link.h"
+
+static inline bool reached(uint32_t now, uint32_t deadline) {
+  return (int32_t)(now - deadline) >= 0;  // Wrap-safe millis() comparison
+}
+
+void WifiLink::begin(uint32_t now) {
+  downSince = now;
+  backoff = 0;
+  attemptCount = 0;
+  attempt(now);
+}
+
+void WifiLink::notify(WifiLinkEvent event, uint8_t reason) {
+  if (event == WIFI_EVENT_DISCONNECTED) pendingReason.store(reason);
+  lastEvent.store(event);
+  pending.fetch_or(1u << event);
+}
+
+void WifiLink::attempt(uint32_t now) {
+  // Pin the last good access point on the first try after a drop only; a
+  // failure there falls back to a full scan (the AP may have moved channel)
+  attemptFast = cached && attemptCount == 0;
+  attemptCount++;
+  attemptStart = now;
+  linkState = WIFI_LINK_CONNECTING;
+  driver.connect(attemptFast ? bssid : nullptr, attemptFast ? channel : 0);
+}
+
+// Every retry waits in BACKOFF, where the late disconnect events caused by
+// our own driver.disconnect() are ignored
+void WifiLink::failed(uint32_t now) {
+  if (attemptFast) {
+    cached = false;
+    retryAt = now + WIFI_LINK_SETTLE;  // Straight to a scan, no backoff for the cheap attempt
+  } else {
+    backoff = backoff ? backoff * 2 : WIFI_LINK_BACKOFF_MIN;
+    if (backoff > WIFI_LINK_BACKOFF_MAX) backoff = WIFI_LINK_BACKOFF_MAX;
+    retryAt = now + backoff;
+  }
+  linkState = WIFI_LINK_BACKOFF;
+}
+
+void WifiLink::gotIp(uint32_t now) {
+  if (linkState == WIFI_LINK_CONNECTED) return;
+  cached = driver.accessPoint(bssid, channel);
+  outageMillis = now - downSince;
+  lastFast = attemptFast;
+  backoff = 0;
+  linkState = WIFI_LINK_CONNECTED;
+  if (upHook) upHook(*this);
+}
+
+void WifiLink::lost(uint32_t now) {
+  lastReason = pendingReason.load();
+  if (linkState == WIFI_LINK_CONNECTED) {
+    downSince = now;
+    attemptCount = 0;
+    if (downHook) downHook(*this);
+    retryAt = now + WIFI_LINK_SETTLE;  // Then reassociate pinned to the cached AP
+    linkState = WIFI_LINK_BACKOFF;
+  } else if (linkState == WIFI_LINK_CONNECTING) {
+    driver.disconnect();  // Stop the driver's own retries before backing off
+    failed(now);
+  }
+}
+
+void WifiLink::poll(uint32_t now) {
+  if (linkState == WIFI_LINK_IDLE) return;
+
+  // Apply the events in the order they last happened
+  uint32_t events = pending.exchange(0);
+  if (events) {
+    bool gotIpLast = lastEvent.load() == WIFI_EVENT_GOT_IP;
+    if ((events & (1u << WIFI_EVENT_DISCONNECTED)) && gotIpLast) lost(now);
+    if (events & (1u << WIFI_EVENT_GOT_IP)) gotIp(now);
+    if ((events & (1u << WIFI_EVENT_DISCONNECTED)) && !gotIpLast) lost(now);
+  }
+
+  if (linkState == WIFI_LINK_CONNECTING && reached(now, attemptStart + WIFI_LINK_ATTEMPT_TIMEOUT)) {
+    driver.disconnect();
+    failed(now);
+  } else if (linkState == WIFI_LINK_BACKOFF && reached(now, retryAt)) {
+    attempt(now);
+  }
+}
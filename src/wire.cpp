@@ -0,0 +1,274 @@
+#include <math.h>
+#include <stdio.h>
+#include "wire.h"
+
+// Same nibble table as the gzip trailer check in inflate.cpp
+static const uint32_t crcNibble[16] = {0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+                                       0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+                                       0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+static const uint8_t fieldSizes[] = {1, 1, 2, 2, 4, 4, 4, 2};  // Indexed by WireType
+
+uint32_t wireCrc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ crcNibble[crc & 0x0F];
+    crc = (crc >> 4) ^ crcNibble[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+WireWriter::WireWriter(uint8_t* out, size_t size, char* strings, size_t stringsSize, uint8_t maxSections)
+    : out(out), size(size), strings(strings), stringsSize(stringsSize), stringsUsed(0), maxSections(maxSections),
+      sections(0), used(WIRE_HEADER_SIZE + (size_t)maxSections * WIRE_DIRECTORY_ENTRY_SIZE), overflow(false) {
+  if (used > size || stringsSize == 0) {
+    overflow = true;
+    return;
+  }
+  strings[stringsUsed++] = '\0';
+}
+
+uint8_t* WireWriter::section(uint8_t kind, uint16_t recordSize, uint16_t count) {
+  size_t start = (used + 3) & ~(size_t)3;
+  size_t bytes = (size_t)recordSize * count;
+  if (overflow || sections == maxSections || recordSize == 0 || bytes > size || start > size - bytes) {
+    overflow = true;
+    return nullptr;
+  }
+  uint8_t* entry = out + WIRE_HEADER_SIZE + sections * WIRE_DIRECTORY_ENTRY_SIZE;
+  memset(entry, 0, WIRE_DIRECTORY_ENTRY_SIZE);
+  entry[0] = kind;
+  wirePut16(entry, 2, recordSize);
+  wirePut16(entry, 4, count);
+  wirePut32(entry, 8, (uint32_t)start);  // Moved down in finish()
+  sections++;
+
+  memset(out + used, 0, start + bytes - used);
+  used = start + bytes;
+  return out + start;
+}
+
+uint16_t WireWriter::string(const char* text) {
+  size_t length = strlen(text);
+  if (length == 0) return 0;
+  // Icons, day names and alert scales repeat a lot
+  for (size_t at = 1; at + length < stringsUsed; at += strlen(strings + at) + 1) {
+    if (memcmp(strings + at, text, length + 1) == 0) return (uint16_t)at;
+  }
+  if (stringsUsed + length + 1 > stringsSize || stringsUsed + length + 1 > WIRE_STRINGS_MAX) {
+    overflow = true;
+    return 0;
+  }
+  size_t at = stringsUsed;
+  memcpy(strings + at, text, length + 1);
+  stringsUsed += length + 1;
+  return (uint16_t)at;
+}
+
+size_t WireWriter::finish(uint32_t generated) {
+  if (overflow) return 0;
+
+  // Close the unused directory slots; a 4-byte multiple keeps records aligned
+  size_t directoryEnd = WIRE_HEADER_SIZE + (size_t)sections * WIRE_DIRECTORY_ENTRY_SIZE;
+  size_t reservedEnd = WIRE_HEADER_SIZE + (size_t)maxSections * WIRE_DIRECTORY_ENTRY_SIZE;
+  size_t firstRecord = (reservedEnd + 3) & ~(size_t)3;
+  size_t shift = firstRecord - ((directoryEnd + 3) & ~(size_t)3);
+  if (used > firstRecord) memmove(out + firstRecord - shift, out + firstRecord, used - firstRecord);
+  used -= shift;
+  for (uint16_t i = 0; i < sections; i++) {
+    uint8_t* entry = out + WIRE_HEADER_SIZE + i * WIRE_DIRECTORY_ENTRY_SIZE;
+    wirePut32(entry, 8, wireU32(entry, 8) - (uint32_t)shift);
+  }
+  memset(out + directoryEnd, 0, ((directoryEnd + 3) & ~(size_t)3) - directoryEnd);
+
+  if (stringsUsed > size - used) return 0;
+  size_t stringsAt = used;
+  memcpy(out + stringsAt, strings, stringsUsed);
+  size_t length = stringsAt + stringsUsed;
+
+  memcpy(out, WIRE_MAGIC, 3);
+  out[3] = WIRE_VERSION;
+  wirePut32(out, 4, (uint32_t)length);
+  wirePut32(out, 12, generated);
+  wirePut16(out, 16, sections);
+  wirePut16(out, 18, 0);
+  wirePut32(out, 20, (uint32_t)stringsAt);
+  wirePut32(out, 8, wireCrc32(out + 12, length - 12));
+  return length;
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+static const WireSchema* findSchema(const WireSchema* schemas, uint8_t schemaCount, uint8_t kind) {
+  for (uint8_t i = 0; i < schemaCount; i++) {
+    if (schemas[i].kind == kind) return &schemas[i];
+  }
+  return nullptr;
+}
+
+bool wireOpen(WireView& view, const uint8_t* data, size_t length, const WireSchema* schemas, uint8_t schemaCount) {
+  memset(&view, 0, sizeof(view));
+  if (length < WIRE_HEADER_SIZE + 1 || memcmp(data, WIRE_MAGIC, 3) != 0 || data[3] != WIRE_VERSION) return false;
+  if (wireU32(data, 4) != length || wireU32(data, 8) != wireCrc32(data + 12, length - 12)) return false;
+
+  uint16_t sectionCount = wireU16(data, 16);
+  uint32_t stringsAt = wireU32(data, 20);
+  size_t directoryEnd = WIRE_HEADER_SIZE + (size_t)sectionCount * WIRE_DIRECTORY_ENTRY_SIZE;
+  if (directoryEnd > stringsAt || stringsAt >= length || length - stringsAt > WIRE_STRINGS_MAX + 1) return false;
+  // Offset 0 is "", and the last string is terminated, so any offset in range is a valid C string
+  if (data[stringsAt] != '\0' || data[length - 1] != '\0') return false;
+  uint32_t stringsLength = length - stringsAt;
+
+  for (uint16_t i = 0; i < sectionCount; i++) {
+    const uint8_t* entry = data + WIRE_HEADER_SIZE + i * WIRE_DIRECTORY_ENTRY_SIZE;
+    uint8_t kind = entry[0];
+    uint16_t recordSize = wireU16(entry, 2);
+    uint16_t count = wireU16(entry, 4);
+    uint32_t offset = wireU32(entry, 8);
+    uint64_t end = (uint64_t)offset + (uint64_t)recordSize * count;
+    if (recordSize == 0 || offset % 4 != 0 || offset < directoryEnd || end > stringsAt) return false;
+    for (uint16_t j = 0; j < i; j++) {
+      if (data[WIRE_HEADER_SIZE + j * WIRE_DIRECTORY_ENTRY_SIZE] == kind) return false;
+    }
+
+    const WireSchema* schema = findSchema(schemas, schemaCount, kind);
+    if (schema == nullptr) continue;
+    if (recordSize < schema->recordSize) return false;
+    for (uint16_t r = 0; r < count; r++) {
+      const uint8_t* record = data + offset + (size_t)r * recordSize;
+      for (uint8_t f = 0; f < schema->fieldCount; f++) {
+        const WireField& field = schema->fields[f];
+        if (field.offset + fieldSizes[field.type] > schema->recordSize) return false;  // Broken schema
+        if (field.type == WIRE_STRING && wireU16(record, field.offset) >= stringsLength) return false;
+      }
+    }
+  }
+
+  view.data = data;
+  view.length = length;
+  view.generated = wireU32(data, 12);
+  view.sectionCount = sectionCount;
+  view.strings = (const char*)data + stringsAt;
+  view.stringsLength = stringsLength;
+  return true;
+}
+
+WireSection wireSection(const WireView& view, uint8_t kind) {
+  WireSection section = {nullptr, 0, 0};
+  for (uint16_t i = 0; i < view.sectionCount; i++) {
+    const uint8_t* entry = view.data + WIRE_HEADER_SIZE + i * WIRE_DIRECTORY_ENTRY_SIZE;
+    if (entry[0] != kind) continue;
+    section.records = view.data + wireU32(entry, 8);
+    section.recordSize = wireU16(entry, 2);
+    section.count = wireU16(entry, 4);
+    break;
+  }
+  return section;
+}
+
+// ============================================================================
+// JSON rendering
+// ============================================================================
+
+class JsonOut {
+public:
+  JsonOut(char* out, size_t size) : out(out), size(size), length(0), overflow(size == 0) {}
+
+  void text(const char* value) {
+    size_t count = strlen(value);
+    if (count >= size - length) {
+      overflow = true;
+      return;
+    }
+    memcpy(out + length, value, count);
+    length += count;
+  }
+  void quoted(const char* value) {
+    char escape[8];
+    text("\"");
+    for (const char* p = value; *p && !overflow; p++) {
+      unsigned char c = (unsigned char)*p;
+      if (c == '"' || c == '\\') {
+        escape[0] = '\\';
+        escape[1] = (char)c;
+        escape[2] = '\0';
+      } else if (c < 0x20) {
+        snprintf(escape, sizeof(escape), "\\u%04x", c);
+      } else {
+        escape[0] = (char)c;
+        escape[1] = '\0';
+      }
+      text(escape);
+    }
+    text("\"");
+  }
+  void number(double value, bool integer) {
+    char buffer[24];
+    if (isnan(value) || isinf(value)) {
+      text("null");
+      return;
+    }
+    snprintf(buffer, sizeof(buffer), integer ? "%.0f" : "%.7g", value);
+    text(buffer);
+  }
+
+  size_t finish() {
+    if (overflow) return 0;
+    out[length] = '\0';
+    return length;
+  }
+
+private:
+  char* out;
+  size_t size;
+  size_t length;
+  bool overflow;
+};
+
+size_t wireToJson(const WireView& view, const WireSchema* schemas, uint8_t schemaCount, char* out, size_t size) {
+  JsonOut json(out, size);
+  char number[16];
+  snprintf(number, sizeof(number), "%lu", (unsigned long)view.generated);
+  json.text("{\"generated\":");
+  json.text(number);
+
+  for (uint8_t s = 0; s < schemaCount; s++) {
+    const WireSchema& schema = schemas[s];
+    WireSection section = wireSection(view, schema.kind);
+    if (section.records == nullptr) continue;
+    json.text(",");
+    json.quoted(schema.name);
+    json.text(":[");
+    for (uint16_t r = 0; r < section.count; r++) {
+      const uint8_t* record = wireRecord(section, r);
+      json.text(r == 0 ? "{" : ",{");
+      for (uint8_t f = 0; f < schema.fieldCount; f++) {
+        const WireField& field = schema.fields[f];
+        if (f > 0) json.text(",");
+        json.quoted(field.name);
+        json.text(":");
+        switch (field.type) {
+          case WIRE_U8: json.number(wireU8(record, field.offset), true); break;
+          case WIRE_I8: json.number(wireI8(record, field.offset), true); break;
+          case WIRE_U16: json.number(wireU16(record, field.offset), true); break;
+          case WIRE_I16: json.number(wireI16(record, field.offset), true); break;
+          case WIRE_U32: json.number(wireU32(record, field.offset), true); break;
+          case WIRE_I32: json.number(wireI32(record, field.offset), true); break;
+          case WIRE_F32: json.number(wireF32(record, field.offset), false); break;
+          default: json.quoted(wireString(view, record, field.offset)); break;
+        }
+      }
+      json.text("}");
+    }
+    json.text("]");
+  }
+  json.text("}");
+  return json.finish();
+}
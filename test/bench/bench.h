@@ -0,0 +1,40 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+
+// Host benchmarks of the shared modules. Each one is a function listed in
+// main.cpp's table and prints its own result lines:
+//   pio run -e bench && .pio/build/bench/program [name...]
+
+// Heap traffic through malloc/new since benchHeapReset(), counted in main.cpp
+struct BenchHeap {
+  uint64_t allocations;
+  int64_t current;         // Bytes held now, relative to the reset
+  int64_t peak;            // Most bytes held at once
+};
+
+extern BenchHeap benchHeap;
+
+void benchHeapReset();
+
+inline double benchSeconds() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Function declarations - one per bench_*.cpp
+void benchIngest();
+void benchEphemeris();
+void benchTimeZone();
+void benchOvation();
+void benchHistory();
+void benchRollup();
+void benchSolarWind();
+void benchAlerts();
+void benchInflate();
+void benchLocalApi();
+void benchBundle();
+
+#endif
@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include "alerts.h"
+#include "bench.h"
+#include "fixture.h"
+#include "weather.h"
+
+// alerts.json into the store: cold (every product parsed, compressed and
+// added) and the steady re-fetch where every product is a duplicate
+
+void benchAlerts() {
+  std::string alerts = fixtureRead("alerts.json");
+  if (alerts.empty()) {
+    printf("alerts fixture missing\n");
+    return;
+  }
+
+  benchHeapReset();
+  uint32_t runs = 0;
+  double start = benchSeconds();
+  double elapsed;
+  do {
+    alertStoreClear(alertStore);
+    fixtureStream(alertIngest, alerts);
+    runs++;
+    elapsed = benchSeconds() - start;
+  } while (elapsed < 0.5);
+  printf("%-24s %8.2f ms %6.1f allocs %6lld B peak heap\n", "cold fetch", elapsed / runs * 1e3,
+         (double)benchHeap.allocations / runs, (long long)benchHeap.peak);
+
+  runs = 0;
+  start = benchSeconds();
+  do {
+    fixtureStream(alertIngest, alerts);
+    runs++;
+    elapsed = benchSeconds() - start;
+  } while (elapsed < 0.5);
+  printf("%-24s %8.2f ms\n", "re-fetch, all duplicates", elapsed / runs * 1e3);
+
+  static char text[ALERT_MESSAGE_SIZE];
+  size_t plain = 0;
+  for (uint8_t i = 0; i < alertStore.count; i++) plain += alertText(alertStore, i, text, sizeof(text));
+  printf("%u alerts, text %u B compressed of %zu B (%.0f%%)\n", alertStore.count, alertStore.textUsed, plain,
+         plain > 0 ? 100.0 * alertStore.textUsed / plain : 0.0);
+  printf("sizeof(AlertStore) %zu B, ingest %zu B\n", sizeof(AlertStore), sizeof(AlertIngest));
+}
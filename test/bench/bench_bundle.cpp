@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <vector>
+#include "bench.h"
+#include "bundle.h"
+#include "fixture.h"
+
+// A bundle of the fixtures' data (as the aggregator sends it to a station
+// and a station parks a location) through every step: bundleEncode,
+// wireOpen, bundleApply with every source fresh, and the JSON rendering
+
+struct BundleFixture {
+  const char* name;
+  StreamIngest* stream;
+  IngestFunction ingest;
+};
+
+static const BundleFixture bundleFixtures[] = {
+  {"onecall.json", nullptr, ingestOneCall},
+  {"air_pollution.json", nullptr, ingestAirQuality},
+  {"noaa-planetary-k-index.json", nullptr, ingestKpIndex},
+  {"f107_cm_flux.json", nullptr, ingestSolarFlux},
+  {"mag-1-day.json", &solarWindMagIngest, nullptr},
+  {"plasma-1-day.json", &solarWindPlasmaIngest, nullptr},
+  {"xrays-1-day.json", &xrayIngest, nullptr},
+  {"solar_regions.json", &solarRegionIngest, nullptr},
+  {"alerts.json", &alertIngest, nullptr},
+  {"noaa-planetary-k-index-forecast.json", &kpForecastIngest, nullptr},
+  {"ovation_aurora_latest.json", &ovationIngest, nullptr},
+};
+
+// Repeat for at least 0.2 s and report per call
+template <typename Step>
+static void measure(const char* name, size_t bytes, Step step) {
+  step();
+  benchHeapReset();
+  uint32_t runs = 0;
+  double start = benchSeconds();
+  double elapsed;
+  do {
+    step();
+    runs++;
+    elapsed = benchSeconds() - start;
+  } while (elapsed < 0.2);
+  printf("%-24s %8zu B %9.1f us %8.1f MB/s %6.1f allocs\n", name, bytes, elapsed / runs * 1e6,
+         bytes * runs / elapsed / 1e6, (double)benchHeap.allocations / runs);
+}
+
+void benchBundle() {
+  ovationIngest.setLocation(LATITUDE, LONGITUDE);
+  for (const BundleFixture& fixture : bundleFixtures) {
+    std::string body = fixtureRead(fixture.name);
+    bool ingested = fixture.stream ? fixtureStream(*fixture.stream, body) : fixture.ingest(body.data(), body.size());
+    if (!ingested) printf("%s not ingested, its sections stay empty\n", fixture.name);
+  }
+
+  uint32_t updated[SRC_COUNT];
+  for (uint8_t source = 0; source < SRC_COUNT; source++) updated[source] = 1792400000;
+  static uint8_t bundle[BUNDLE_MAX_SIZE];
+  size_t length = bundleEncode(bundle, sizeof(bundle), 1792400000, updated);
+  if (length == 0) {
+    printf("bundle does not fit in %d bytes\n", BUNDLE_MAX_SIZE);
+    return;
+  }
+  measure("bundleEncode", length, [&] { bundleEncode(bundle, sizeof(bundle), 1792400000, updated); });
+
+  WireView view;
+  measure("wireOpen", length, [&] { wireOpen(view, bundle, length, bundleSchemas, bundleSchemaCount); });
+  BundleInfo info;
+  bool applied = false;
+  measure("bundleApply", length, [&] {
+    uint32_t none[SRC_COUNT] = {};
+    applied = bundleApply(bundle, length, 1792400060, none, info);
+  });
+  static char json[131072];
+  size_t jsonLength = 0;
+  measure("wireToJson", length, [&] {
+    jsonLength = wireToJson(view, bundleSchemas, bundleSchemaCount, json, sizeof(json));
+  });
+
+  printf("bundle %zu B in %u sections, JSON %zu B, %s\n", length, view.sectionCount, jsonLength,
+         applied ? "applied" : "rejected");
+  for (uint8_t i = 0; i < bundleSchemaCount; i++) {
+    WireSection section = wireSection(view, bundleSchemas[i].kind);
+    if (section.records != nullptr) {
+      printf("  %-16s %4u x %3u B\n", bundleSchemas[i].name, section.count, section.recordSize);
+    }
+  }
+}
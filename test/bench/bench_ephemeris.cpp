@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include "bench.h"
+#include "config.h"
+#include "ephemeris.h"
+
+// What updateAstronomyData() costs once per local day (sun and moon events)
+// and on every weather cycle (the phase), over a year of consecutive days
+
+void benchEphemeris() {
+  const time_t start = 1792281600;  // 2026-10-18 00:00 UTC
+  const int days = 365;
+  SunTimes sun;
+  MoonTimes moon;
+  MoonPhaseInfo phase;
+  volatile time_t sink = 0;
+
+  double begin = benchSeconds();
+  for (int i = 0; i < days; i++) {
+    computeSunTimes(start + i * 86400, LATITUDE, LONGITUDE, sun);
+    sink = sink + sun.rise;
+  }
+  double sunTime = benchSeconds() - begin;
+
+  begin = benchSeconds();
+  for (int i = 0; i < days; i++) {
+    computeMoonTimes(start + i * 86400, LATITUDE, LONGITUDE, moon);
+    sink = sink + moon.rise;
+  }
+  double moonTime = benchSeconds() - begin;
+
+  begin = benchSeconds();
+  for (int i = 0; i < days * 24; i++) {
+    computeMoonPhase(start + i * 3600, phase);
+    sink = sink + (time_t)phase.age;
+  }
+  double phaseTime = benchSeconds() - begin;
+
+  printf("%-20s %8.2f us/day\n", "computeSunTimes", sunTime / days * 1e6);
+  printf("%-20s %8.2f us/day\n", "computeMoonTimes", moonTime / days * 1e6);
+  printf("%-20s %8.2f us/call\n", "computeMoonPhase", phaseTime / (days * 24) * 1e6);
+}
@@ -0,0 +1,86 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "config.h"
+#include "history.h"
+
+#define GRAPH_WIDTH (SCREEN_WIDTH - 34)  // Plot width on the history screen, see display.cpp
+
+// Compression and speed of the history ring for each channel's kind of data:
+// bytes per sample once the ring is full, append cost, a full scan, and the
+// decimation into pixel columns the history screen does once per frame
+
+struct HistoryCase {
+  const char* name;
+  float scale;
+  uint32_t cadence;              // Seconds between samples
+  float (*value)(int i);
+};
+
+static float noise(float amplitude) {
+  return (rand() % 1000 / 1000.0f - 0.5f) * amplitude;
+}
+
+static float temperature(int i) { return 60 + 15 * sinf(i * 2 * (float)M_PI / 144) + noise(1); }
+static float pressure(int i) { return 1013 + 8 * sinf(i * 2 * (float)M_PI / 700) + noise(0.3f); }
+static float humidity(int i) { return 60 - 20 * sinf(i * 2 * (float)M_PI / 144) + noise(4); }
+static float kp(int i) { return roundf((2 + 2 * sinf(i * 2 * (float)M_PI / 500)) * 3) / 3; }
+static float bz(int i) { return 4 * sinf(i * 2 * (float)M_PI / 90) + noise(3); }
+static float solarWind(int i) { return 420 + 80 * sinf(i * 2 * (float)M_PI / 800) + noise(20); }
+
+static const HistoryCase historyCases[] = {
+  {"temperature 0.1 F", 10, 600, temperature},
+  {"pressure 0.1 hPa", 10, 600, pressure},
+  {"humidity 1 %", 1, 600, humidity},
+  {"kp 0.01", 100, 600, kp},
+  {"bz 0.1 nT", 10, 600, bz},
+  {"solar wind 1 km/s", 1, 600, solarWind},
+};
+
+void benchHistory() {
+  static HistorySeries series(1);
+  const uint32_t start = 1792281600;
+  const int samples = 20000;  // Well past a full ring
+
+  printf("%-20s %8s %10s %10s %10s %12s %14s\n", "channel", "kept", "bits/smp", "days", "append", "scan",
+         "decimate");
+  for (const HistoryCase& test : historyCases) {
+    series = HistorySeries(test.scale);
+    srand(1);
+    static float values[samples];
+    for (int i = 0; i < samples; i++) values[i] = test.value(i);
+
+    double begin = benchSeconds();
+    for (int i = 0; i < samples; i++) series.append(start + i * test.cadence, values[i]);
+    double append = (benchSeconds() - begin) / samples;
+
+    uint32_t scanned = 0;
+    volatile float sink = 0;
+    begin = benchSeconds();
+    for (int round = 0; round < 200; round++) {
+      HistorySeries::Iterator it = series.begin();
+      uint32_t time;
+      float value;
+      while (it.next(time, value)) {
+        sink = sink + value;
+        scanned++;
+      }
+    }
+    double scan = (benchSeconds() - begin) / scanned;
+
+    // One history screen frame: the last HISTORY_GRAPH_SPAN into GRAPH_WIDTH columns
+    static HistoryColumn columns[GRAPH_WIDTH];
+    uint32_t end = series.lastTime() + 1;
+    uint32_t first = end - series.firstTime() > HISTORY_GRAPH_SPAN ? end - HISTORY_GRAPH_SPAN : series.firstTime();
+    begin = benchSeconds();
+    for (int frame = 0; frame < 200; frame++) historyDecimate(series, first, end, columns, GRAPH_WIDTH);
+    double decimate = (benchSeconds() - begin) / 200;
+
+    printf("%-20s %8u %10.2f %10.1f %8.1f ns %8.1f ns/smp %8.1f us/frame\n", test.name, series.count(),
+           series.bytesUsed() * 8.0 / series.count(), series.count() * (double)test.cadence / 86400, append * 1e9,
+           scan * 1e9, decimate * 1e6);
+  }
+  printf("sizeof(HistorySeries) %zu B, %d channels %zu B\n", sizeof(HistorySeries), HISTORY_CHANNEL_COUNT,
+         sizeof(HistorySeries) * HISTORY_CHANNEL_COUNT);
+}
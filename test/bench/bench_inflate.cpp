@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <zlib.h>
+#include <string>
+#include "bench.h"
+#include "fixture.h"
+#include "inflate.h"
+
+// Each SWPC fixture gzipped at level 6 (what the CDN sends): bytes on the
+// wire, parsing the identity body against inflating and parsing the gzip
+// one through the ingest, fed in TCP-sized chunks as the firmware does
+
+static std::string gzip(const std::string& data) {
+  z_stream stream = {};
+  deflateInit2(&stream, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+  std::string compressed(deflateBound(&stream, data.size()), '\0');
+  stream.next_in = (Bytef*)data.data();
+  stream.avail_in = data.size();
+  stream.next_out = (Bytef*)&compressed[0];
+  stream.avail_out = compressed.size();
+  deflate(&stream, Z_FINISH);
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  return compressed;
+}
+
+// The firmware's ParserSink in miniature: inflated bytes into the parser
+class ParserFeed : public InflateOutput {
+public:
+  explicit ParserFeed(JsonStreamParser& parser) : parser(parser) {}
+  bool inflated(const uint8_t* data, size_t length) override { return parser.feed((const char*)data, length); }
+
+private:
+  JsonStreamParser& parser;
+};
+
+static bool streamGzip(StreamIngest& ingest, Inflater*& inflater, const std::string& body) {
+  char token[JSON_TOKEN_SIZE];
+  size_t tokenSize = sizeof(token);
+  char* buffer = ingest.tokenBuffer(tokenSize);
+  JsonStreamParser parser(ingest, buffer ? buffer : token, tokenSize);
+  ParserFeed feed(parser);
+  inflater = new Inflater(feed);  // Per request, as fetchAndStream() does
+  inflater->reset(INFLATE_GZIP);
+  ingest.begin();
+  bool fed = true;
+  for (size_t offset = 0; offset < body.size() && fed; offset += FIXTURE_CHUNK) {
+    size_t length = body.size() - offset < FIXTURE_CHUNK ? body.size() - offset : FIXTURE_CHUNK;
+    fed = inflater->feed((const uint8_t*)body.data() + offset, length);
+  }
+  bool done = ingest.finish(fed && inflater->finish() && parser.finish());
+  delete inflater;
+  inflater = nullptr;
+  return done;
+}
+
+void benchInflate() {
+  static const struct {
+    const char* name;
+    StreamIngest* ingest;
+  } bodies[] = {
+    {"alerts.json", &alertIngest},
+    {"mag-1-day.json", &solarWindMagIngest},
+    {"plasma-1-day.json", &solarWindPlasmaIngest},
+    {"xrays-1-day.json", &xrayIngest},
+    {"solar_regions.json", &solarRegionIngest},
+    {"noaa-planetary-k-index-forecast.json", &kpForecastIngest},
+    {"ovation_aurora_latest.json", &ovationIngest},
+  };
+
+  ovationIngest.setLocation(LATITUDE, LONGITUDE);
+  printf("%-38s %9s %8s %6s %9s %9s %8s\n", "", "identity", "gzip", "ratio", "parse us", "+inflate", "MB/s");
+  size_t identityTotal = 0;
+  size_t gzipTotal = 0;
+  for (const auto& body : bodies) {
+    std::string identity = fixtureRead(body.name);
+    if (identity.empty()) {
+      printf("%s missing\n", body.name);
+      continue;
+    }
+    std::string compressed = gzip(identity);
+    Inflater* inflater = nullptr;
+    if (!streamGzip(*body.ingest, inflater, compressed)) printf("%s: gzip body rejected\n", body.name);
+
+    // Best of several runs, alerts cleared so both paths do the same work
+    double plain = 1e9;
+    double both = 1e9;
+    for (int run = 0; run < 10; run++) {
+      alertStoreClear(alertStore);
+      double start = benchSeconds();
+      fixtureStream(*body.ingest, identity);
+      double middle = benchSeconds();
+      alertStoreClear(alertStore);
+      streamGzip(*body.ingest, inflater, compressed);
+      double end = benchSeconds();
+      if (middle - start < plain) plain = middle - start;
+      if (end - middle < both) both = end - middle;
+    }
+    identityTotal += identity.size();
+    gzipTotal += compressed.size();
+    printf("%-38s %9zu %8zu %5.1fx %9.0f %9.0f %8.1f\n", body.name, identity.size(), compressed.size(),
+           (double)identity.size() / compressed.size(), plain * 1e6, both * 1e6,
+           both > plain ? identity.size() / (both - plain) / 1e6 : 0.0);
+  }
+  printf("%-38s %9zu %8zu %5.1fx\n", "total", identityTotal, gzipTotal, (double)identityTotal / gzipTotal);
+  printf("sizeof(Inflater) %zu B, allocated per request\n", sizeof(Inflater));
+}
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include "bench.h"
+#include "fixture.h"
+
+// Every ingest over its recorded payload: throughput, heap allocations per
+// document and peak heap above the caller's. The streaming ingests see the
+// body in TCP-sized chunks like on the station, the DOM ones whole.
+
+struct IngestCase {
+  const char* fixture;
+  StreamIngest* stream;
+  IngestFunction ingest;
+};
+
+static const IngestCase ingestCases[] = {
+  {"onecall.json", nullptr, ingestOneCall},
+  {"air_pollution.json", nullptr, ingestAirQuality},
+  {"noaa-planetary-k-index.json", nullptr, ingestKpIndex},
+  {"f107_cm_flux.json", nullptr, ingestSolarFlux},
+  {"daily-geomagnetic-indices.json", nullptr, ingestGeomagIndices},
+  {"mag-1-day.json", &solarWindMagIngest, nullptr},
+  {"plasma-1-day.json", &solarWindPlasmaIngest, nullptr},
+  {"xrays-1-day.json", &xrayIngest, nullptr},
+  {"solar_regions.json", &solarRegionIngest, nullptr},
+  {"alerts.json", &alertIngest, nullptr},
+  {"noaa-planetary-k-index-forecast.json", &kpForecastIngest, nullptr},
+  {"ovation_aurora_latest.json", &ovationIngest, nullptr},
+};
+
+// Malformed and hostile bodies; these must fail fast without touching the globals
+static const char* const adversarialFixtures[] = {
+  "adversarial/deep.json", "adversarial/long_string.json", "adversarial/big_numbers.json",
+  "adversarial/escapes.json", "adversarial/truncated.json", "adversarial/wrong_shape.json",
+};
+
+static bool runCase(const IngestCase& test, const std::string& body) {
+  if (test.stream != nullptr) return fixtureStream(*test.stream, body);
+  return test.ingest(body.data(), body.size());
+}
+
+// Repeat for at least 0.2 s and report per document
+static void measure(const char* name, const IngestCase& test, const std::string& body) {
+  runCase(test, body);  // Warm up lazily built state (the OneCall filter)
+  benchHeapReset();
+  uint32_t runs = 0;
+  uint32_t accepted = 0;
+  double start = benchSeconds();
+  double elapsed;
+  do {
+    accepted += runCase(test, body);
+    runs++;
+    elapsed = benchSeconds() - start;
+  } while (elapsed < 0.2);
+  printf("%-36s %8zu B %9.1f us %8.1f MB/s %7.1f allocs %8lld B peak %s\n", name, body.size(),
+         elapsed / runs * 1e6, body.size() * runs / elapsed / 1e6, (double)benchHeap.allocations / runs,
+         (long long)benchHeap.peak, accepted == runs ? "ok" : accepted == 0 ? "rejected" : "mixed");
+}
+
+void benchIngest() {
+  ovationIngest.setLocation(LATITUDE, LONGITUDE);
+  printf("%-36s %10s %12s %13s %14s %14s\n", "payload", "size", "per doc", "throughput", "heap", "");
+  for (const IngestCase& test : ingestCases) {
+    std::string body = fixtureRead(test.fixture);
+    if (body.empty()) {
+      printf("%-36s missing\n", test.fixture);
+      continue;
+    }
+    measure(test.fixture, test, body);
+  }
+
+  // Every adversarial body through every path
+  for (const char* fixture : adversarialFixtures) {
+    std::string body = fixtureRead(fixture);
+    double start = benchSeconds();
+    uint32_t accepted = 0;
+    for (const IngestCase& test : ingestCases) accepted += runCase(test, body);
+    printf("%-36s %8zu B %9.1f us for all %zu paths, %u accepted\n", fixture, body.size(),
+           (benchSeconds() - start) * 1e6, sizeof(ingestCases) / sizeof(ingestCases[0]), accepted);
+  }
+}
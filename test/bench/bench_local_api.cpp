@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "local_api.h"
+#include "local_api_client.h"
+
+// The local API over loopback: keep-alive clients requesting as fast as they
+// can while a new snapshot is published every 20 ms, plain and conditional,
+// then with more clients than LOCAL_API_MAX_CLIENTS
+
+#define BENCH_PORT 18476
+#define BENCH_SECONDS 1.0
+
+static std::atomic<bool> serving;
+
+static uint32_t benchMillis() {
+  return (uint32_t)(benchSeconds() * 1e3);
+}
+
+static void loadRun(const char* name, int clients, bool conditional) {
+  std::atomic<bool> running(true);
+  std::atomic<uint32_t> answered(0);
+  std::atomic<uint32_t> torn(0);
+  std::atomic<uint32_t> timeouts(0);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < clients; i++) {
+    readers.emplace_back([&, i] {
+      int socketFd = localApiDial(BENCH_PORT);
+      std::string pending;
+      std::string etag;
+      while (running) {
+        std::string request = i % 2 ? "GET /api/snapshot.cbor HTTP/1.1\r\n" : "GET /api/snapshot HTTP/1.1\r\n";
+        if (conditional && !etag.empty()) request += "If-None-Match: " + etag + "\r\n";
+        request += "\r\n";
+        if (socketFd < 0 || send(socketFd, request.data(), request.size(), MSG_NOSIGNAL) < 0) {
+          timeouts++;
+          if (socketFd >= 0) close(socketFd);
+          socketFd = localApiDial(BENCH_PORT);
+          pending.clear();
+          continue;
+        }
+        LocalApiResponse response = localApiRead(socketFd, pending);
+        if (response.status < 0) {
+          // Dropped for another client or timed out waiting for a slot
+          timeouts++;
+          close(socketFd);
+          socketFd = localApiDial(BENCH_PORT);
+          pending.clear();
+          continue;
+        }
+        if (response.status == 200) {
+          if (response.etag != localApiEtag(response.body)) torn++;
+          etag = response.etag;
+        }
+        answered++;
+      }
+      if (socketFd >= 0) close(socketFd);
+    });
+  }
+  static StationSnapshot snapshot;
+  static int variant = 0;
+  LocalApiStats before = localApiStats();
+  double start = benchSeconds();
+  while (benchSeconds() - start < BENCH_SECONDS) {
+    localApiSnapshot(snapshot, ++variant);
+    snapshotPublish(snapshot);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  running = false;
+  for (std::thread& reader : readers) reader.join();
+  double elapsed = benchSeconds() - start;
+  LocalApiStats after = localApiStats();
+  printf("%-28s %8.0f req/s %5.0f%% 304 %4u torn %4u timeouts\n", name, answered / elapsed,
+         100.0 * (after.notModified - before.notModified) / (after.requests - before.requests + 1), torn.load(),
+         timeouts.load());
+}
+
+void benchLocalApi() {
+  if (!localApiOpen(BENCH_PORT)) {
+    printf("port %d unavailable\n", BENCH_PORT);
+    return;
+  }
+  serving = true;
+  std::thread server([] {
+    while (serving) localApiPoll(benchMillis(), 10);
+  });
+  StationSnapshot snapshot;
+  localApiSnapshot(snapshot, 0);
+  snapshotPublish(snapshot);
+
+  loadRun("4 clients", LOCAL_API_MAX_CLIENTS, false);
+  loadRun("4 clients, If-None-Match", LOCAL_API_MAX_CLIENTS, true);
+  loadRun("16 clients", 16, false);
+
+  static uint8_t body[SNAPSHOT_JSON_SIZE];
+  printf("worst-case body %zu B JSON of %d, %zu B CBOR of %d\n",
+         snapshotEncode(snapshot, SNAPSHOT_JSON, body, sizeof(body)), SNAPSHOT_JSON_SIZE,
+         snapshotEncode(snapshot, SNAPSHOT_CBOR, body, sizeof(body)), SNAPSHOT_CBOR_SIZE);
+  serving = false;
+  server.join();
+}
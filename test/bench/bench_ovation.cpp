@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include "bench.h"
+#include "fixture.h"
+
+// The full OVATION grid (65160 cells) through the streaming ingest with one
+// to LOCATION_MAX cells picked out in the same pass, and the state it needs
+
+void benchOvation() {
+  std::string body = fixtureRead("ovation_aurora_latest.json");
+  if (body.empty()) {
+    printf("ovation_aurora_latest.json missing\n");
+    return;
+  }
+  static const float places[][2] = {{LATITUDE, LONGITUDE}, {64.84f, -147.72f}, {69.65f, 18.96f}, {40.71f, -74.01f}};
+  AuroraNowcastData nowcasts[LOCATION_MAX];
+
+  printf("state: %zu B ingest + %d B token + %zu B parser, grid %zu B\n", sizeof(OvationIngest), JSON_TOKEN_SIZE,
+         sizeof(JsonStreamParser), body.size());
+  for (uint8_t count = 1; count <= LOCATION_MAX && count <= sizeof(places) / sizeof(places[0]); count++) {
+    ovationIngest.setLocation(places[0][0], places[0][1]);
+    for (uint8_t i = 1; i < count; i++) ovationIngest.addLocation(places[i][0], places[i][1], nowcasts[i]);
+
+    benchHeapReset();
+    uint32_t runs = 0;
+    uint32_t accepted = 0;
+    double start = benchSeconds();
+    double elapsed;
+    do {
+      accepted += fixtureStream(ovationIngest, body);
+      runs++;
+      elapsed = benchSeconds() - start;
+    } while (elapsed < 0.5);
+    printf("%u location%s %8.2f ms/grid %8.1f MB/s %6.1f allocs %6lld B peak %s\n", count, count > 1 ? "s" : " ",
+           elapsed / runs * 1e3, body.size() * runs / elapsed / 1e6, (double)benchHeap.allocations / runs,
+           (long long)benchHeap.peak, accepted == runs ? "ok" : "rejected");
+  }
+  ovationIngest.setLocation(LATITUDE, LONGITUDE);
+}
@@ -0,0 +1,37 @@
+#include <stdio.h>
+#include "bench.h"
+#include "config.h"
+#include "rollup.h"
+#include "timezone.h"
+
+// Cost of Rollup::add() on the fast path (sample in the open hour) and when
+// every sample opens a new hour, plus rollupChange() as the weather screen
+// calls it
+
+void benchRollup() {
+  timeZoneInit(TIME_ZONE, ZONE_HOME);
+  static Rollup rollup;
+  const uint32_t start = 1792281600;
+  const uint32_t count = 5000000;
+  volatile float sink = 0;
+
+  rollup.clear();
+  double begin = benchSeconds();
+  for (uint32_t i = 0; i < count; i++) rollup.add(start + i * 60, (float)(i & 255));
+  printf("%-24s %8.1f ns\n", "add, 1 min cadence", (benchSeconds() - begin) / count * 1e9);
+
+  rollup.clear();
+  begin = benchSeconds();
+  for (uint32_t i = 0; i < count / 10; i++) rollup.add(start + i * 3600, (float)(i & 255));
+  printf("%-24s %8.1f ns\n", "add, new hour each", (benchSeconds() - begin) / (count / 10) * 1e9);
+
+  float change;
+  uint32_t now = rollup.lastTime();
+  begin = benchSeconds();
+  for (uint32_t i = 0; i < count; i++) {
+    rollupChange(rollup, now, 3 * 3600 + (i & 1023), change);
+    sink = sink + change;
+  }
+  printf("%-24s %8.1f ns\n", "rollupChange 3 h", (benchSeconds() - begin) / count * 1e9);
+  printf("sizeof(Rollup) %zu B\n", sizeof(Rollup));
+}
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include "bench.h"
+#include "coupling.h"
+#include "fixture.h"
+#include "solar_wind.h"
+
+// One solar wind refresh (both 1-day products into the 5-minute bins), the
+// southward-duration scan run after the mag product, and the coupling
+// engine stepping through the day of bins
+
+void benchSolarWind() {
+  std::string mag = fixtureRead("mag-1-day.json");
+  std::string plasma = fixtureRead("plasma-1-day.json");
+  if (mag.empty() || plasma.empty()) {
+    printf("solar wind fixtures missing\n");
+    return;
+  }
+  const uint32_t rows = 2 * 1440;
+
+  benchHeapReset();
+  uint32_t runs = 0;
+  double start = benchSeconds();
+  double elapsed;
+  do {
+    fixtureStream(solarWindMagIngest, mag);
+    fixtureStream(solarWindPlasmaIngest, plasma);
+    runs++;
+    elapsed = benchSeconds() - start;
+  } while (elapsed < 0.5);
+  printf("%-24s %8.0f us %8.0f ns/row %6.1f allocs\n", "mag + plasma refresh", elapsed / runs * 1e6,
+         elapsed / runs / rows * 1e9, (double)benchHeap.allocations / runs);
+
+  const uint32_t now = 1792324740;  // Newest row of the fixtures
+  const uint32_t scans = 200000;
+  volatile uint32_t sink = 0;
+  start = benchSeconds();
+  for (uint32_t i = 0; i < scans; i++) sink = sink + solarWindSouthwardSeconds(solarWind, now - (i & 63) * 60, 4.0f);
+  printf("%-24s %8.1f ns\n", "southward scan", (benchSeconds() - start) / scans * 1e9);
+  CouplingEngine engine;
+  runs = 0;
+  start = benchSeconds();
+  do {
+    engine.reset();
+    engine.update(solarWind);
+    runs++;
+    elapsed = benchSeconds() - start;
+  } while (elapsed < 0.2);
+  printf("%-24s %8.1f us %8.1f ns/bin\n", "coupling, day of bins", elapsed / runs * 1e6,
+         elapsed / runs / (SOLAR_WIND_BINS - 1) * 1e9);
+
+  printf("sizeof(SolarWindSeries) %zu B, ingest %zu B each\n", sizeof(SolarWindSeries), sizeof(SolarWindIngest));
+}
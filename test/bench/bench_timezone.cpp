@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include "bench.h"
+#include "config.h"
+#include "timezone.h"
+
+// Conversions per second for the clock, the forecast labels and the rollups'
+// midnight lookups, hour by hour across a year so the DST cache refills
+
+static void report(const char* name, uint32_t count, double elapsed) {
+  printf("%-20s %8.1f ns %10.2f M/s\n", name, elapsed / count * 1e9, count / elapsed / 1e6);
+}
+
+void benchTimeZone() {
+  timeZoneInit(TIME_ZONE);
+  const time_t start = 1767225600;  // 2026-01-01 00:00 UTC
+  const uint32_t count = 2000000;
+  volatile int32_t sink = 0;
+  LocalTime local;
+  char buffer[16];
+
+  double begin = benchSeconds();
+  for (uint32_t i = 0; i < count; i++) {
+    toLocalTime(start + (time_t)(i % 8760) * 3600, local);
+    sink = sink + local.hour;
+  }
+  report("toLocalTime", count, benchSeconds() - begin);
+
+  begin = benchSeconds();
+  for (uint32_t i = 0; i < count; i++) sink = sink + (int32_t)localMidnight(start + (time_t)(i % 8760) * 3600);
+  report("localMidnight", count, benchSeconds() - begin);
+
+  begin = benchSeconds();
+  for (uint32_t i = 0; i < count; i++) sink = sink + (int32_t)formatClock(start + (time_t)(i % 8760) * 3600, buffer, sizeof(buffer));
+  report("formatClock", count, benchSeconds() - begin);
+}
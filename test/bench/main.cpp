@@ -0,0 +1,85 @@
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+BenchHeap benchHeap;
+
+// glibc's own allocator behind counting wrappers; operator new lands here too
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+extern "C" void __libc_free(void* pointer);
+
+static void countAlloc(void* pointer) {
+  if (pointer == nullptr) return;
+  benchHeap.allocations++;
+  benchHeap.current += malloc_usable_size(pointer);
+  if (benchHeap.current > benchHeap.peak) benchHeap.peak = benchHeap.current;
+}
+
+static void countFree(void* pointer) {
+  if (pointer != nullptr) benchHeap.current -= malloc_usable_size(pointer);
+}
+
+extern "C" void* malloc(size_t size) {
+  void* pointer = __libc_malloc(size);
+  countAlloc(pointer);
+  return pointer;
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  void* pointer = __libc_calloc(count, size);
+  countAlloc(pointer);
+  return pointer;
+}
+
+extern "C" void* realloc(void* pointer, size_t size) {
+  size_t before = pointer != nullptr ? malloc_usable_size(pointer) : 0;
+  void* moved = __libc_realloc(pointer, size);
+  if (moved == nullptr && size > 0) return nullptr;  // Failed, the old block stays
+  benchHeap.current -= before;
+  countAlloc(moved);
+  return moved;
+}
+
+extern "C" void free(void* pointer) {
+  countFree(pointer);
+  __libc_free(pointer);
+}
+
+void benchHeapReset() {
+  benchHeap.allocations = 0;
+  benchHeap.current = 0;
+  benchHeap.peak = 0;
+}
+
+struct Benchmark {
+  const char* name;
+  void (*run)();
+};
+
+static const Benchmark benchmarks[] = {
+  {"ingest", benchIngest},
+  {"ephemeris", benchEphemeris},
+  {"timezone", benchTimeZone},
+  {"ovation", benchOvation},
+  {"history", benchHistory},
+  {"rollup", benchRollup},
+  {"solar_wind", benchSolarWind},
+  {"alerts", benchAlerts},
+  {"inflate", benchInflate},
+  {"local_api", benchLocalApi},
+  {"bundle", benchBundle},
+};
+
+int main(int argc, char** argv) {
+  for (const Benchmark& benchmark : benchmarks) {
+    bool wanted = argc < 2;
+    for (int i = 1; i < argc; i++) wanted |= strcmp(argv[i], benchmark.name) == 0;
+    if (!wanted) continue;
+    printf("== %s\n", benchmark.name);
+    benchmark.run();
+  }
+  return 0;
+}
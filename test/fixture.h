@@ -0,0 +1,54 @@
+#ifndef TEST_FIXTURE_H
+#define TEST_FIXTURE_H
+
+#include <stdio.h>
+#include <string>
+#include "config.h"
+#include "ingest.h"
+
+// Shared by the host tests, fuzz targets and benchmarks: recorded upstream
+// payloads from test/fixtures, fed through the ingests the way the
+// firmware's transport does (a JsonStreamParser over TCP-sized chunks).
+
+#ifndef FIXTURE_DIR
+#define FIXTURE_DIR "test/fixtures"   // pio runs host programs from the project directory
+#endif
+
+#define FIXTURE_CHUNK 1460            // One TCP segment
+
+// Whole file; empty when it cannot be read
+inline std::string fixtureReadFile(const char* path) {
+  std::string data;
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) return data;
+  char buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) data.append(buffer, count);
+  fclose(file);
+  return data;
+}
+
+// A recorded payload under FIXTURE_DIR
+inline std::string fixtureRead(const char* name) {
+  return fixtureReadFile((std::string(FIXTURE_DIR) + "/" + name).c_str());
+}
+
+// One document through a streaming ingest, as fetchAndStream() does
+inline bool fixtureStream(StreamIngest& ingest, const char* data, size_t length, size_t chunk = FIXTURE_CHUNK) {
+  char token[JSON_TOKEN_SIZE];
+  size_t tokenSize = sizeof(token);
+  char* buffer = ingest.tokenBuffer(tokenSize);
+  JsonStreamParser parser(ingest, buffer ? buffer : token, tokenSize);
+  ingest.begin();
+  bool fed = true;
+  for (size_t offset = 0; offset < length && fed; offset += chunk) {
+    fed = parser.feed(data + offset, length - offset < chunk ? length - offset : chunk);
+  }
+  return ingest.finish(fed && parser.finish());
+}
+
+inline bool fixtureStream(StreamIngest& ingest, const std::string& data, size_t chunk = FIXTURE_CHUNK) {
+  return fixtureStream(ingest, data.data(), data.size(), chunk);
+}
+
+#endif
@@ -0,0 +1,6 @@
+# libFuzzer comes with clang; the sanitizers have to reach the link too
+Import("env")
+
+sanitizers = "-fsanitize=fuzzer,address,undefined"
+env.Replace(CC="clang", CXX="clang++", LINK="clang++")
+env.Append(CCFLAGS=[sanitizers, "-fno-omit-frame-pointer"], LINKFLAGS=[sanitizers])
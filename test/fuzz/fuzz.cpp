@@ -0,0 +1,362 @@
+// libFuzzer targets for every JSON ingest path, the inflater and the bundle
+// decoder. One binary
+// serves them all: FUZZ_TARGET names the target to run, unset runs every
+// target on each input (handy with the mixed fixtures as a seed corpus).
+//   pio run -e fuzz
+//   FUZZ_TARGET=ovation .pio/build/fuzz/program -max_len=65536 corpus/ test/fixtures
+// The inflate target wants compressed seeds, e.g. each fixture through
+// gzip -c into corpus/inflate/ (its first input byte picks the format); the
+// bundle target wants bundles, e.g. GET /bundle/<id> from the aggregator.
+// Built with -DFUZZ_REPLAY instead of libFuzzer (e.g. with gcc), the program
+// runs each file or directory given once, to replay a crash.
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <string>
+#include <vector>
+#include "bundle.h"
+#include "fixture.h"
+#include "inflate.h"
+
+// Whatever the input, the callbacks must describe a well-formed prefix of a
+// document: containers balance, keys only come first in an object, and the
+// number helpers never overflow (UBSan watches the conversions)
+class CheckingHandler : public JsonStreamHandler {
+public:
+  void reset() {
+    depth = 0;
+    objects = 0;
+    expectKey = false;
+    hash = 2166136261u;
+  }
+
+  void startObject() override { push(true); }
+  void endObject() override { pop(true); }
+  void startArray() override { push(false); }
+  void endArray() override { pop(false); }
+
+  void key(const char* name) override {
+    if (!inObject() || !expectKey) abort();
+    expectKey = false;
+    mix('k', name);
+  }
+
+  void value(const char* text, JsonValueType type) override {
+    if (inObject() && expectKey) abort();
+    if (inObject()) expectKey = true;
+    if (type == JSON_NUMBER) {
+      int32_t integer;
+      float number;
+      if (jsonToInt(text, integer)) mix('i', (const char*)&integer, sizeof(integer));
+      if (jsonToFloat(text, number)) mix('f', (const char*)&number, sizeof(number));
+    }
+    mix('0' + type, text);
+  }
+
+  uint8_t depth;
+  uint32_t hash;             // Of every callback, to compare differently chunked runs
+
+private:
+  bool inObject() const { return depth > 0 && (objects & (1UL << (depth - 1))); }
+
+  void push(bool object) {
+    if (inObject() && expectKey) abort();
+    if (depth >= 32) abort();
+    if (object) {
+      objects |= 1UL << depth;
+    } else {
+      objects &= ~(1UL << depth);
+    }
+    depth++;
+    expectKey = object;
+    mix(object ? '{' : '[', "");
+  }
+
+  void pop(bool object) {
+    if (depth == 0 || inObject() != object) abort();
+    depth--;
+    expectKey = inObject();
+    mix(object ? '}' : ']', "");
+  }
+
+  void mix(char tag, const char* text) { mix(tag, text, strlen(text)); }
+
+  void mix(char tag, const char* data, size_t length) {
+    hash = (hash ^ (uint8_t)tag) * 16777619u;
+    for (size_t i = 0; i < length; i++) hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+  }
+
+  uint32_t objects;
+  bool expectKey;
+};
+
+// Parsing in one piece or in small chunks must give the same callbacks
+static void fuzzJsonStream(const uint8_t* data, size_t size) {
+  static CheckingHandler whole;
+  static CheckingHandler chunked;
+  char wholeToken[JSON_TOKEN_SIZE];
+  char chunkedToken[JSON_TOKEN_SIZE];
+  JsonStreamParser wholeParser(whole, wholeToken, sizeof(wholeToken));
+  JsonStreamParser chunkedParser(chunked, chunkedToken, sizeof(chunkedToken));
+  whole.reset();
+  chunked.reset();
+
+  const char* text = (const char*)data;
+  bool wholeFed = wholeParser.feed(text, size);
+  bool wholeDone = wholeParser.finish();
+  size_t chunk = size % 13 + 1;
+  bool chunkedFed = true;
+  for (size_t offset = 0; offset < size && chunkedFed; offset += chunk) {
+    chunkedFed = chunkedParser.feed(text + offset, size - offset < chunk ? size - offset : chunk);
+  }
+  bool chunkedDone = chunkedParser.finish();
+
+  if (wholeFed != chunkedFed || wholeDone != chunkedDone || whole.hash != chunked.hash) abort();
+  if (wholeParser.depth() != whole.depth) abort();
+  if (wholeDone && whole.depth != 0) abort();
+}
+
+static void fuzzStream(StreamIngest& ingest, const uint8_t* data, size_t size) {
+  // Chunk boundaries vary with the input so tokens get split everywhere
+  fixtureStream(ingest, (const char*)data, size, size % 61 + 1);
+}
+
+static void fuzzOvation(const uint8_t* data, size_t size) {
+  static AuroraNowcastData second;
+  ovationIngest.setLocation(LATITUDE, LONGITUDE);
+  ovationIngest.addLocation(-LATITUDE, LONGITUDE + 180, second);
+  fuzzStream(ovationIngest, data, size);
+}
+
+static void fuzzKpForecast(const uint8_t* data, size_t size) { fuzzStream(kpForecastIngest, data, size); }
+static void fuzzSolarWindMag(const uint8_t* data, size_t size) { fuzzStream(solarWindMagIngest, data, size); }
+static void fuzzSolarWindPlasma(const uint8_t* data, size_t size) { fuzzStream(solarWindPlasmaIngest, data, size); }
+static void fuzzXray(const uint8_t* data, size_t size) { fuzzStream(xrayIngest, data, size); }
+static void fuzzSolarRegions(const uint8_t* data, size_t size) { fuzzStream(solarRegionIngest, data, size); }
+
+static void fuzzAlerts(const uint8_t* data, size_t size) {
+  alertStoreClear(alertStore);
+  fuzzStream(alertIngest, data, size);
+}
+
+class CollectingOutput : public InflateOutput {
+public:
+  bool inflated(const uint8_t* data, size_t length) override {
+    text.append((const char*)data, length);
+    return true;
+  }
+
+  std::string text;
+};
+
+// zlib on the same stream, its format chosen the way Inflater::headerByte() does
+static bool zlibInflate(const uint8_t* data, size_t size, InflateFormat format, std::string& text) {
+  int windowBits = 15 + 16;
+  if (format == INFLATE_ZLIB_OR_RAW) {
+    bool wrapped = size >= 2 && (data[0] & 0x0F) == 8 && (data[0] >> 4) <= 7 &&
+                   ((uint16_t)data[0] << 8 | data[1]) % 31 == 0 && !(data[1] & 0x20);
+    windowBits = wrapped ? 15 : -15;
+  }
+  z_stream stream = {};
+  if (inflateInit2(&stream, windowBits) != Z_OK) return false;
+  stream.next_in = (Bytef*)data;
+  stream.avail_in = size;
+  uint8_t buffer[4096];
+  int result;
+  do {
+    stream.next_out = buffer;
+    stream.avail_out = sizeof(buffer);
+    result = inflate(&stream, Z_NO_FLUSH);
+    text.append((const char*)buffer, sizeof(buffer) - stream.avail_out);
+  } while (result == Z_OK);
+  inflateEnd(&stream);
+  return result == Z_STREAM_END;
+}
+
+// Fed whole or in small chunks the inflater must give the same verdict and
+// bytes, and whatever it accepts zlib inflates to the very same output.
+// The first input byte picks the format, the rest is the stream.
+static void fuzzInflate(const uint8_t* data, size_t size) {
+  if (size == 0) return;
+  InflateFormat format = data[0] & 1 ? INFLATE_ZLIB_OR_RAW : INFLATE_GZIP;
+  data++;
+  size--;
+
+  static CollectingOutput whole;
+  static CollectingOutput chunked;
+  static Inflater wholeInflater(whole);
+  static Inflater chunkedInflater(chunked);
+  whole.text.clear();
+  chunked.text.clear();
+  wholeInflater.reset(format);
+  chunkedInflater.reset(format);
+
+  bool wholeDone = wholeInflater.feed(data, size) && wholeInflater.finish();
+  size_t chunk = size % 7 + 1;
+  bool fed = true;
+  for (size_t offset = 0; offset < size && fed; offset += chunk) {
+    fed = chunkedInflater.feed(data + offset, size - offset < chunk ? size - offset : chunk);
+  }
+  bool chunkedDone = fed && chunkedInflater.finish();
+  if (wholeDone != chunkedDone) abort();
+  if (!wholeDone) return;
+  if (whole.text != chunked.text || wholeInflater.produced() != whole.text.size()) abort();
+
+  std::string reference;
+  bool headerCrc = format == INFLATE_GZIP && size > 3 && (data[3] & 0x02);  // zlib checks it, Inflater skips it
+  if (!zlibInflate(data, size, format, reference)) {
+    if (!headerCrc) abort();
+  } else if (reference != whole.text) {
+    abort();
+  }
+}
+
+// Every string field of every record the reader has a schema for, as the
+// JSON rendering and bundleApply() read them
+static void readSections(const WireView& view) {
+  for (uint8_t i = 0; i < bundleSchemaCount; i++) {
+    const WireSchema& schema = bundleSchemas[i];
+    WireSection section = wireSection(view, schema.kind);
+    for (uint16_t r = 0; r < section.count; r++) {
+      const uint8_t* record = wireRecord(section, r);
+      if (record < view.data || record + section.recordSize > view.data + view.length) abort();
+      for (uint8_t f = 0; f < schema.fieldCount; f++) {
+        if (schema.fields[f].type != WIRE_STRING) continue;
+        const char* text = wireString(view, record, schema.fields[f].offset);
+        if (text + strlen(text) >= view.strings + view.stringsLength) abort();
+      }
+    }
+  }
+}
+
+// The globals as one bundle with every section, to see whether they changed
+static std::vector<uint8_t> encodeGlobals() {
+  uint32_t updated[SRC_COUNT];
+  for (uint8_t source = 0; source < SRC_COUNT; source++) updated[source] = 1;
+  std::vector<uint8_t> bundle(BUNDLE_MAX_SIZE);
+  bundle.resize(bundleEncode(bundle.data(), bundle.size(), 0, updated));
+  return bundle;
+}
+
+static void applyBundle(const std::vector<uint8_t>& data) {
+  WireView view;
+  if (wireOpen(view, data.data(), data.size(), bundleSchemas, bundleSchemaCount)) {
+    readSections(view);
+    static char json[131072];
+    size_t length = wireToJson(view, bundleSchemas, bundleSchemaCount, json, sizeof(json));
+    if (length >= sizeof(json) || (length > 0 && json[length] != '\0')) abort();
+  }
+
+  // Rejected means untouched: neither the globals nor applied move
+  uint32_t applied[SRC_COUNT] = {};
+  BundleInfo info;
+  std::vector<uint8_t> before = encodeGlobals();
+  if (!bundleApply(data.data(), data.size(), 0, applied, info)) {
+    for (uint8_t source = 0; source < SRC_COUNT; source++) {
+      if (applied[source] != 0) abort();
+    }
+    if (encodeGlobals() != before) abort();
+  }
+}
+
+// The bundle as received, then with its length and CRC made to match so the
+// mutations reach the directory and records behind the checksum
+static void fuzzBundle(const uint8_t* data, size_t size) {
+  std::vector<uint8_t> bundle(data, data + size);
+  applyBundle(bundle);
+  if (size < WIRE_HEADER_SIZE) return;
+  wirePut32(bundle.data(), 4, (uint32_t)size);
+  wirePut32(bundle.data(), 8, wireCrc32(bundle.data() + 12, size - 12));
+  applyBundle(bundle);
+}
+
+static void fuzzOneCall(const uint8_t* data, size_t size) { ingestOneCall((const char*)data, size); }
+static void fuzzAirQuality(const uint8_t* data, size_t size) { ingestAirQuality((const char*)data, size); }
+static void fuzzKpIndex(const uint8_t* data, size_t size) { ingestKpIndex((const char*)data, size); }
+static void fuzzSolarFlux(const uint8_t* data, size_t size) { ingestSolarFlux((const char*)data, size); }
+static void fuzzGeomagIndices(const uint8_t* data, size_t size) { ingestGeomagIndices((const char*)data, size); }
+
+struct FuzzTarget {
+  const char* name;
+  void (*run)(const uint8_t* data, size_t size);
+};
+
+static const FuzzTarget fuzzTargets[] = {
+  {"json_stream", fuzzJsonStream},
+  {"ovation", fuzzOvation},
+  {"kp_forecast", fuzzKpForecast},
+  {"solar_wind_mag", fuzzSolarWindMag},
+  {"solar_wind_plasma", fuzzSolarWindPlasma},
+  {"xray", fuzzXray},
+  {"solar_regions", fuzzSolarRegions},
+  {"alerts", fuzzAlerts},
+  {"onecall", fuzzOneCall},
+  {"air_quality", fuzzAirQuality},
+  {"kp_index", fuzzKpIndex},
+  {"solar_flux", fuzzSolarFlux},
+  {"geomag_indices", fuzzGeomagIndices},
+  {"inflate", fuzzInflate},
+  {"bundle", fuzzBundle},
+};
+static const size_t fuzzTargetCount = sizeof(fuzzTargets) / sizeof(fuzzTargets[0]);
+
+static const FuzzTarget* selected = nullptr;  // nullptr = all
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv) {
+  (void)argc;
+  (void)argv;
+  const char* name = getenv("FUZZ_TARGET");
+  if (name == nullptr || *name == '\0') return 0;
+  for (size_t i = 0; i < fuzzTargetCount; i++) {
+    if (strcmp(fuzzTargets[i].name, name) == 0) selected = &fuzzTargets[i];
+  }
+  if (selected == nullptr) {
+    fprintf(stderr, "unknown FUZZ_TARGET %s, one of:", name);
+    for (size_t i = 0; i < fuzzTargetCount; i++) fprintf(stderr, " %s", fuzzTargets[i].name);
+    fprintf(stderr, "\n");
+    exit(2);
+  }
+  return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (selected != nullptr) {
+    selected->run(data, size);
+  } else {
+    for (size_t i = 0; i < fuzzTargetCount; i++) fuzzTargets[i].run(data, size);
+  }
+  return 0;
+}
+
+#ifdef FUZZ_REPLAY
+static void replay(const char* path) {
+  struct stat info;
+  if (stat(path, &info) != 0) {
+    perror(path);
+    return;
+  }
+  if (S_ISDIR(info.st_mode)) {
+    DIR* dir = opendir(path);
+    if (dir == nullptr) return;
+    while (struct dirent* entry = readdir(dir)) {
+      if (entry->d_name[0] == '.') continue;
+      replay((std::string(path) + "/" + entry->d_name).c_str());
+    }
+    closedir(dir);
+    return;
+  }
+  std::string data = fixtureReadFile(path);
+  LLVMFuzzerTestOneInput((const uint8_t*)data.data(), data.size());
+  printf("%s: %zu bytes ok\n", path, data.size());
+}
+
+int main(int argc, char** argv) {
+  LLVMFuzzerInitialize(&argc, &argv);
+  for (int i = 1; i < argc; i++) replay(argv[i]);
+  return 0;
+}
+#endif
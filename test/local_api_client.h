@@ -0,0 +1,168 @@
+#ifndef TEST_LOCAL_API_CLIENT_H
+#define TEST_LOCAL_API_CLIENT_H
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <string>
+#include "snapshot.h"
+
+// Shared by the local API test and benchmark: a worst-case snapshot (every
+// text field long, every list full) and a minimal HTTP/1.1 client over
+// loopback that checks each body against its ETag.
+
+// Every field set, texts at their limits and multi-byte UTF-8 to cut
+inline void localApiSnapshot(StationSnapshot& snapshot, int variant) {
+  memset(&snapshot, 0, sizeof(snapshot));
+  snapshot.generated = 1792400000 + variant;
+  snapshotCopyText(snapshot.city, sizeof(snapshot.city), "Fairbanks North Star Borough, Alaska");
+  snapshot.temperature = -12.34f + variant * 0.1f;
+  snapshot.humidity = 78;
+  snapshot.pressure = 1013.2f;
+  snapshot.windSpeed = 3.6f;
+  snapshot.windDirection = 270;
+  snapshotCopyText(snapshot.description, sizeof(snapshot.description),
+                   "l\xc3\xa9g\xc3\xa8re pluie vergla\xc3\xa7" "ante \"tr\xc3\xa8s\" froide");
+  strcpy(snapshot.icon, "13n");
+  snapshot.weatherUpdated = 1792399900;
+  snapshot.aqi = 2;
+  snapshot.pm2_5 = 4.5f;
+  snapshot.pm10 = 9.1f;
+  snapshot.o3 = 61.2f;
+  snapshot.no2 = 3.3f;
+  snapshot.airUpdated = 1792399900;
+  snapshot.sunrise = 1792390000;
+  snapshot.sunset = 1792420000;
+  snapshot.moonset = 1792410000;
+  snapshot.moonPhase = 0.534f;
+  snapshot.moonIllumination = 98.7f;
+  strcpy(snapshot.moonPhaseName, "Waning Gibbous");
+  snapshot.kpIndex = 5.33f;
+  snapshot.bz = -12.4f;
+  snapshot.by = 3.1f;
+  snapshot.solarWindSpeed = 612;
+  snapshot.solarWindDensity = 8.2f;
+  snapshot.couplingKp = 5.7f;
+  snapshot.dst = -87;
+  snapshot.auroraScore = 85;
+  strcpy(snapshot.geomagStatus, "Minor Storm");
+  snapshot.solarFlux = 187;
+  snapshot.aIndex = 48;
+  strcpy(snapshot.xrayClass, "M1.2");
+  snapshot.sunspotNumber = 156;
+  snapshot.activeRegions = 11;
+  snapshot.spaceUpdated = 1792399950;
+  snapshot.kpToday = 6.0f;
+  snapshot.kpTomorrow = NAN;
+  snapshot.nowcastProbability = 67;
+  snapshot.viewlineLatitude = 48;
+  static const char* const names[SNAPSHOT_DAYS] = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
+  for (int i = 0; i < SNAPSHOT_DAYS; i++) {
+    SnapshotDay& day = snapshot.days[i];
+    strcpy(day.name, names[i]);
+    day.high = -5.5f - i;
+    day.low = -18.25f - i;
+    day.precipChance = 10 * i;
+    strcpy(day.icon, "13d");
+  }
+  for (int i = 0; i < SNAPSHOT_HOURS; i++) {
+    SnapshotHour& hour = snapshot.hours[i];
+    snprintf(hour.time, sizeof(hour.time), "%d%s", i % 12 + 1, i < 6 ? "AM" : "PM");
+    hour.temperature = -14.5f + i;
+    hour.precipChance = 100;
+    strcpy(hour.icon, "13n");
+  }
+  snapshot.alertCount = SNAPSHOT_ALERTS;
+  for (int i = 0; i < SNAPSHOT_ALERTS; i++) {
+    SnapshotAlert& alert = snapshot.alerts[i];
+    snprintf(alert.code, sizeof(alert.code), "WARK%02d", i);
+    strcpy(alert.scale, "G3");
+    alert.issued = 1792300000 + i;
+    alert.expires = 1792500000 + i;
+  }
+}
+
+// Connected socket with a 1 s receive timeout, -1 when refused
+inline int localApiDial(uint16_t port) {
+  int socketFd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(socketFd, (sockaddr*)&address, sizeof(address)) != 0) {
+    close(socketFd);
+    return -1;
+  }
+  int yes = 1;
+  setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+  timeval timeout = {1, 0};
+  setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  return socketFd;
+}
+
+struct LocalApiResponse {
+  int status;              // -1 when the connection closed or timed out first
+  std::string head;
+  std::string body;
+  std::string etag;
+};
+
+// The next response on a keep-alive connection; pending holds bytes read past it
+inline LocalApiResponse localApiRead(int socketFd, std::string& pending, bool head = false) {
+  LocalApiResponse response = {-1, "", "", ""};
+  char buffer[8192];
+  size_t end;
+  while ((end = pending.find("\r\n\r\n")) == std::string::npos) {
+    ssize_t count = recv(socketFd, buffer, sizeof(buffer), 0);
+    if (count <= 0) return response;
+    pending.append(buffer, count);
+  }
+  response.head = pending.substr(0, end);
+  int status = atoi(response.head.c_str() + 9);
+  size_t length = 0;
+  size_t field = response.head.find("Content-Length: ");
+  if (field != std::string::npos && status != 304 && !head) length = atoi(response.head.c_str() + field + 16);
+  field = response.head.find("ETag: ");
+  if (field != std::string::npos) {
+    response.etag = response.head.substr(field + 6, response.head.find("\r\n", field) - field - 6);
+  }
+  while (pending.size() < end + 4 + length) {
+    ssize_t count = recv(socketFd, buffer, sizeof(buffer), 0);
+    if (count <= 0) return response;
+    pending.append(buffer, count);
+  }
+  response.body = pending.substr(end + 4, length);
+  pending.erase(0, end + 4 + length);
+  response.status = status;
+  return response;
+}
+
+// One request on a fresh connection, everything the server sent until it closed
+inline std::string localApiExchange(uint16_t port, const std::string& request) {
+  std::string reply;
+  int socketFd = localApiDial(port);
+  if (socketFd < 0) return reply;
+  send(socketFd, request.data(), request.size(), MSG_NOSIGNAL);
+  shutdown(socketFd, SHUT_WR);
+  char buffer[8192];
+  ssize_t count;
+  while ((count = recv(socketFd, buffer, sizeof(buffer), 0)) > 0) reply.append(buffer, count);
+  close(socketFd);
+  return reply;
+}
+
+// The ETag the server derives from a body (quoted FNV-1a)
+inline std::string localApiEtag(const std::string& body) {
+  uint32_t hash = 2166136261u;
+  for (char c : body) hash = (hash ^ (uint8_t)c) * 16777619u;
+  char etag[16];
+  snprintf(etag, sizeof(etag), "\"%08x\"", hash);
+  return etag;
+}
+
+#endif
@@ -0,0 +1,103 @@
+#include <unity.h>
+#include <string.h>
+#include "alerts.h"
+#include "fixture.h"
+#include "weather.h"
+
+static AlertStore store;
+
+void setUp() {
+  alertStoreClear(store);
+  alertStoreClear(alertStore);
+}
+void tearDown() {}
+
+static const uint32_t ISSUED = 1792321800;  // 2026-10-18 11:10 UTC
+
+static const char* const WARNING =
+    "Space Weather Message Code: WARK05\r\nSerial Number: 1234\r\nIssue Time: 2026 Oct 18 1110 UTC\r\n\r\n"
+    "WARNING: Geomagnetic K-index of 5 expected\r\nValid From: 2026 Oct 18 1110 UTC\r\n"
+    "Valid To: 2026 Oct 18 1800 UTC\r\nWarning Condition: Onset\r\nNOAA Scale: G1 - Minor\r\n\r\n"
+    "Potential Impacts: Area of impact primarily poleward of 60 degrees Geomagnetic Latitude.";
+
+void test_fields_and_text_round_trip() {
+  TEST_ASSERT_EQUAL(ALERT_ADDED, alertStoreAdd(store, WARNING, ISSUED, ISSUED));
+  const AlertEntry& entry = store.entries[0];
+  TEST_ASSERT_EQUAL_STRING("WARK05", entry.code);
+  TEST_ASSERT_EQUAL_UINT32(1234, entry.serial);
+  TEST_ASSERT_EQUAL(ALERT_KIND_WARNING, entry.kind);
+  TEST_ASSERT_EQUAL(ALERT_TOPIC_GEOMAGNETIC, entry.topic);
+  TEST_ASSERT_EQUAL_STRING("G1", entry.scale);
+  TEST_ASSERT_EQUAL(1, entry.severity);
+  TEST_ASSERT_EQUAL_UINT32(1792346400, entry.expires);  // 18:00 UTC
+
+  char text[ALERT_MESSAGE_SIZE];
+  size_t length = alertText(store, 0, text, sizeof(text));
+  const char* body = strstr(WARNING, "WARNING:");
+  TEST_ASSERT_EQUAL(strlen(text), length);
+  // Same lines, '\r\n' folded to '\n'
+  TEST_ASSERT_NOT_NULL(strstr(text, "WARNING: Geomagnetic K-index of 5 expected\n"));
+  TEST_ASSERT_NOT_NULL(strstr(text, "Potential Impacts: Area of impact primarily poleward of 60 degrees"));
+  TEST_ASSERT_TRUE(entry.textLength < strlen(body) / 2);  // Boilerplate compresses well
+}
+
+void test_duplicates_cancels_and_extensions() {
+  TEST_ASSERT_EQUAL(ALERT_ADDED, alertStoreAdd(store, WARNING, ISSUED, ISSUED));
+  TEST_ASSERT_EQUAL(ALERT_DUPLICATE, alertStoreAdd(store, WARNING, ISSUED, ISSUED));
+
+  // An extension replaces serial 1234
+  const char* extension =
+      "Space Weather Message Code: WARK05\r\nSerial Number: 1240\r\nIssue Time: 2026 Oct 18 1700 UTC\r\n\r\n"
+      "EXTENDED WARNING: Geomagnetic K-index of 5 expected\r\nExtension to Serial Number: 1234\r\n"
+      "Now Valid Until: 2026 Oct 19 0300 UTC\r\n";
+  TEST_ASSERT_EQUAL(ALERT_ADDED, alertStoreAdd(store, extension, ISSUED + 21000, ISSUED + 21000));
+  alertStoreExpire(store, ISSUED + 21000);
+  TEST_ASSERT_EQUAL(ALERT_CANCELLED, alertStoreAdd(store, WARNING, ISSUED, ISSUED + 21000));
+
+  // A cancellation retires its product whichever order the feed has them in
+  const char* cancel = "Space Weather Message Code: WATA20\r\nSerial Number: 900\r\nIssue Time: 2026 Oct 18 1000 UTC\r\n\r\n"
+                       "CANCEL WATCH: Geomagnetic Storm Category G1\r\nCancel Serial Number: 899\r\n";
+  const char* watch = "Space Weather Message Code: WATA20\r\nSerial Number: 899\r\nIssue Time: 2026 Oct 17 1000 UTC\r\n\r\n"
+                      "WATCH: Geomagnetic Storm Category G1 Predicted\r\nNOAA Scale: G1 - Minor\r\n";
+  TEST_ASSERT_EQUAL(ALERT_CANCELLED, alertStoreAdd(store, cancel, ISSUED - 4200, ISSUED));
+  TEST_ASSERT_EQUAL(ALERT_CANCELLED, alertStoreAdd(store, watch, ISSUED - 90600, ISSUED));
+  TEST_ASSERT_FALSE(alertStoreHasTopic(store, ALERT_TOPIC_OTHER));
+}
+
+void test_expiry_and_rejects() {
+  // Issued two days ago without a validity line: past the default lifetime
+  TEST_ASSERT_EQUAL(ALERT_EXPIRED, alertStoreAdd(store, WARNING, ISSUED, ISSUED + 86400));
+  TEST_ASSERT_EQUAL(ALERT_REJECTED, alertStoreAdd(store, "No code here", ISSUED, ISSUED));
+  TEST_ASSERT_EQUAL(ALERT_ADDED, alertStoreAdd(store, WARNING, ISSUED, 0));  // Clock unknown, kept
+  TEST_ASSERT_EQUAL(1, alertStoreExpire(store, ISSUED + 86400));
+  TEST_ASSERT_EQUAL(0, store.count);
+}
+
+void test_fixture_fills_the_store_within_budget() {
+  // 127 products over eight days, newest first, at the fixture's clock
+  TEST_ASSERT_TRUE(fixtureStream(alertIngest, fixtureRead("alerts.json")));
+  TEST_ASSERT_TRUE(alertStore.count > 0 && alertStore.count <= ALERT_CAPACITY);
+  TEST_ASSERT_TRUE(alertStore.textUsed <= ALERT_TEXT_BUDGET);
+  char text[ALERT_MESSAGE_SIZE];
+  for (uint8_t i = 0; i < alertStore.count; i++) {
+    const AlertEntry& entry = alertStore.entries[i];
+    if (i > 0) TEST_ASSERT_TRUE(alertStore.entries[i - 1].issued >= entry.issued);
+    TEST_ASSERT_TRUE(entry.expires > entry.issued);
+    TEST_ASSERT_TRUE(alertText(alertStore, i, text, sizeof(text)) > 0);
+    for (uint8_t j = 0; j < i; j++) TEST_ASSERT_NOT_EQUAL(alertStore.entries[j].hash, entry.hash);
+  }
+  // A re-fetch is all duplicates and changes nothing
+  static AlertStore before;
+  before = alertStore;
+  TEST_ASSERT_TRUE(fixtureStream(alertIngest, fixtureRead("alerts.json")));
+  TEST_ASSERT_EQUAL_MEMORY(&before, &alertStore, sizeof(before));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fields_and_text_round_trip);
+  RUN_TEST(test_duplicates_cancels_and_extensions);
+  RUN_TEST(test_expiry_and_rejects);
+  RUN_TEST(test_fixture_fills_the_store_within_budget);
+  return UNITY_END();
+}
@@ -0,0 +1,113 @@
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include "coupling.h"
+#include "fixture.h"
+#include "weather.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Storm drivers as piecewise-constant upstream conditions, after the OMNI
+// records of each event, with minute-scale noise on density and Bz
+struct StormStep {
+  float hour;
+  float speed;             // km/s
+  float density;           // cm-3
+  float by;                // nT
+  float bz;
+};
+
+struct StormResult {
+  float minDst;
+  float maxKp;
+  float dstAtEnd;
+};
+
+static StormResult runStorm(const StormStep* steps, int count, float hours) {
+  CouplingEngine engine;
+  StormResult result = {INFINITY, 0, 0};
+  srand(1);
+  for (int minute = 0; minute < hours * 60; minute++) {
+    float hour = minute / 60.0f;
+    int k = 0;
+    while (k < count - 1 && steps[k + 1].hour <= hour) k++;
+    float density = steps[k].density + (rand() % 100 - 50) / 100.0f;
+    float bz = steps[k].bz + (rand() % 200 - 100) / 100.0f;
+    engine.step(1426550400 + minute * 60, steps[k].speed, density, steps[k].by, bz);
+    result.minDst = fminf(result.minDst, engine.dst());
+    result.maxKp = fmaxf(result.maxKp, engine.kpEquivalent());
+  }
+  result.dstAtEnd = engine.dst();
+  return result;
+}
+
+void test_quiet_day() {
+  const StormStep quiet[] = {{0, 380, 4, 2, 1}, {6, 400, 5, -2, -1}, {12, 360, 4, 3, 2}, {18, 390, 5, 1, -1}};
+  StormResult result = runStorm(quiet, 4, 24);
+  TEST_ASSERT_TRUE(result.minDst > -15);
+  TEST_ASSERT_TRUE(result.maxKp < 3);
+}
+
+void test_st_patricks_day_2015() {
+  // Observed: Dst minimum -223 nT, Kp 8-
+  const StormStep storm[] = {{0, 400, 5, 2, 1},    {4.75f, 550, 30, 10, 5}, {6, 560, 25, 5, -18},
+                             {10, 570, 20, 10, 5}, {12, 600, 15, -5, -20},  {22, 580, 8, 3, -8},
+                             {28, 520, 5, 3, 2},   {48, 480, 4, 2, 1}};
+  StormResult result = runStorm(storm, 8, 48);
+  TEST_ASSERT_FLOAT_WITHIN(45, -223, result.minDst);
+  TEST_ASSERT_TRUE(result.maxKp >= 7);
+  TEST_ASSERT_TRUE(result.dstAtEnd > result.minDst / 2);  // Recovering
+}
+
+void test_may_2024() {
+  // Observed: Dst minimum -412 nT, Kp 9
+  const StormStep storm[] = {{0, 450, 5, 2, 0},     {3, 700, 40, 20, -30}, {5, 750, 25, -20, -45},
+                             {12, 850, 10, 10, -30}, {18, 800, 6, 5, -10},  {24, 700, 4, 3, 5},
+                             {40, 600, 4, 2, 1}};
+  StormResult result = runStorm(storm, 7, 40);
+  TEST_ASSERT_FLOAT_WITHIN(60, -412, result.minDst);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 9, result.maxKp);
+}
+
+void test_newell_coupling() {
+  TEST_ASSERT_FLOAT_WITHIN(1e-3, 0, newellCoupling(400, 0, 5));  // Due north
+  // Due south: v^4/3 B^2/3
+  TEST_ASSERT_FLOAT_WITHIN(1, powf(500, 4.0f / 3) * powf(10, 2.0f / 3), newellCoupling(500, 0, -10));
+  TEST_ASSERT_TRUE(newellCoupling(500, 10, 0) < newellCoupling(500, 0, -10));
+}
+
+void test_gap_decays_the_state() {
+  CouplingEngine engine;
+  TEST_ASSERT_FALSE(engine.valid());
+  for (int minute = 0; minute < 360; minute++) engine.step(1700000000 + minute * 60, 700, 20, 0, -30);
+  float driven = engine.dst();
+  TEST_ASSERT_TRUE(driven < -100);
+  // Two days without data, then quiet wind
+  engine.step(1700000000 + 360 * 60 + 2 * 86400, 350, 4, 0, 1);
+  TEST_ASSERT_TRUE(engine.dst() > driven / 4);
+  TEST_ASSERT_TRUE(engine.kpEquivalent() < 3);
+}
+
+void test_update_from_the_binned_fixtures() {
+  solarWindClear(solarWind);
+  TEST_ASSERT_TRUE(fixtureStream(solarWindMagIngest, fixtureRead("mag-1-day.json")));
+  TEST_ASSERT_TRUE(fixtureStream(solarWindPlasmaIngest, fixtureRead("plasma-1-day.json")));
+  CouplingEngine engine;
+  TEST_ASSERT_EQUAL(SOLAR_WIND_BINS - 1, engine.update(solarWind));  // The newest bin is held back
+  TEST_ASSERT_TRUE(engine.valid());
+  TEST_ASSERT_EQUAL(0, engine.update(solarWind));                     // Nothing new
+  TEST_ASSERT_TRUE(engine.dst() < 0 && engine.dst() > -100);
+  TEST_ASSERT_TRUE(engine.kpEquivalent() >= 0 && engine.kpEquivalent() <= 9);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_quiet_day);
+  RUN_TEST(test_st_patricks_day_2015);
+  RUN_TEST(test_may_2024);
+  RUN_TEST(test_newell_coupling);
+  RUN_TEST(test_gap_decays_the_state);
+  RUN_TEST(test_update_from_the_binned_fixtures);
+  return UNITY_END();
+}
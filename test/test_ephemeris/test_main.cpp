@@ -0,0 +1,110 @@
+#include <unity.h>
+#include <math.h>
+#include "ephemeris.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Published tables (USNO) give whole minutes; the series is good to a minute
+// or two, so events are checked to 2 minutes
+#define TOLERANCE 120
+
+static time_t utc(int year, int month, int day, int hour, int minute) {
+  struct tm fields = {};
+  fields.tm_year = year - 1900;
+  fields.tm_mon = month - 1;
+  fields.tm_mday = day;
+  fields.tm_hour = hour;
+  fields.tm_min = minute;
+  return timegm(&fields);
+}
+
+static void assertNear(time_t expected, time_t actual) {
+  TEST_ASSERT_NOT_EQUAL(0, actual);
+  TEST_ASSERT_INT_WITHIN(TOLERANCE, expected, actual);
+}
+
+void test_sun_new_york_summer_solstice() {
+  // 2024-06-20, EDT (UTC-4): local midnight is 04:00 UTC
+  SunTimes sun;
+  computeSunTimes(utc(2024, 6, 20, 4, 0), 40.7128, -74.006, sun);
+  assertNear(utc(2024, 6, 20, 9, 25), sun.rise);
+  assertNear(utc(2024, 6, 21, 0, 31), sun.set);
+  assertNear(utc(2024, 6, 20, 16, 57), sun.transit);
+  assertNear(utc(2024, 6, 20, 8, 52), sun.civilDawn);
+  assertNear(utc(2024, 6, 21, 1, 4), sun.civilDusk);
+}
+
+void test_sun_chicago_winter_solstice() {
+  // 2025-12-21, CST (UTC-6)
+  SunTimes sun;
+  computeSunTimes(utc(2025, 12, 21, 6, 0), 41.88, -87.63, sun);
+  assertNear(utc(2025, 12, 21, 13, 15), sun.rise);
+  assertNear(utc(2025, 12, 21, 22, 22), sun.set);
+}
+
+void test_sun_events_sit_on_their_altitudes() {
+  SunTimes sun;
+  computeSunTimes(utc(2026, 10, 18, 5, 0), 43.0731, -89.4012, sun);
+  TEST_ASSERT_FLOAT_WITHIN(0.1, -0.833, sunAltitude(sun.rise, 43.0731, -89.4012));
+  TEST_ASSERT_FLOAT_WITHIN(0.1, -0.833, sunAltitude(sun.set, 43.0731, -89.4012));
+  TEST_ASSERT_FLOAT_WITHIN(0.1, -6.0, sunAltitude(sun.civilDusk, 43.0731, -89.4012));
+  TEST_ASSERT_FLOAT_WITHIN(0.1, -12.0, sunAltitude(sun.nauticalDawn, 43.0731, -89.4012));
+  TEST_ASSERT_FLOAT_WITHIN(0.1, -18.0, sunAltitude(sun.astronomicalDusk, 43.0731, -89.4012));
+  TEST_ASSERT_TRUE(sun.astronomicalDawn < sun.nauticalDawn && sun.nauticalDawn < sun.civilDawn);
+  TEST_ASSERT_TRUE(sun.civilDawn < sun.rise && sun.rise < sun.transit && sun.transit < sun.set);
+}
+
+void test_sun_polar_day_and_night() {
+  SunTimes sun;
+  // Tromsø, midnight sun
+  computeSunTimes(utc(2024, 6, 20, 22, 0), 69.65, 18.96, sun);
+  TEST_ASSERT_EQUAL(0, sun.rise);
+  TEST_ASSERT_EQUAL(0, sun.set);
+  TEST_ASSERT_NOT_EQUAL(0, sun.transit);
+  // Polar night: no sunrise, but still civil twilight around noon
+  computeSunTimes(utc(2024, 12, 20, 23, 0), 69.65, 18.96, sun);
+  TEST_ASSERT_EQUAL(0, sun.rise);
+  TEST_ASSERT_EQUAL(0, sun.set);
+  TEST_ASSERT_NOT_EQUAL(0, sun.civilDawn);
+  TEST_ASSERT_NOT_EQUAL(0, sun.civilDusk);
+}
+
+void test_moon_phase_at_published_phases() {
+  MoonPhaseInfo phase;
+  // Full moon 2024-04-23 23:49 UTC
+  computeMoonPhase(utc(2024, 4, 23, 23, 49), phase);
+  TEST_ASSERT_FLOAT_WITHIN(0.005, 0.5, phase.phase);
+  TEST_ASSERT_TRUE(phase.illumination > 0.99);
+  // New moon 2024-01-11 11:57 UTC
+  computeMoonPhase(utc(2024, 1, 11, 11, 57), phase);
+  TEST_ASSERT_TRUE(phase.phase < 0.005 || phase.phase > 0.995);
+  TEST_ASSERT_TRUE(phase.illumination < 0.01);
+  // First quarter 2024-02-16 15:01 UTC
+  computeMoonPhase(utc(2024, 2, 16, 15, 1), phase);
+  TEST_ASSERT_FLOAT_WITHIN(0.005, 0.25, phase.phase);
+  TEST_ASSERT_FLOAT_WITHIN(0.02, 0.5, phase.illumination);
+}
+
+void test_moon_rises_near_sunset_before_full() {
+  // Full moon 2024-06-22 01:08 UTC: the evening before it rises around sunset
+  SunTimes sun;
+  MoonTimes moon;
+  computeSunTimes(utc(2024, 6, 20, 4, 0), 40.7128, -74.006, sun);
+  computeMoonTimes(utc(2024, 6, 20, 4, 0), 40.7128, -74.006, moon);
+  TEST_ASSERT_NOT_EQUAL(0, moon.rise);
+  TEST_ASSERT_INT_WITHIN(3600, sun.set, moon.rise);
+  TEST_ASSERT_NOT_EQUAL(0, moon.set);
+  TEST_ASSERT_TRUE(moon.set < moon.rise);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_sun_new_york_summer_solstice);
+  RUN_TEST(test_sun_chicago_winter_solstice);
+  RUN_TEST(test_sun_events_sit_on_their_altitudes);
+  RUN_TEST(test_sun_polar_day_and_night);
+  RUN_TEST(test_moon_phase_at_published_phases);
+  RUN_TEST(test_moon_rises_near_sunset_before_full);
+  return UNITY_END();
+}
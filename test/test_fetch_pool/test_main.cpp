@@ -0,0 +1,113 @@
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <esp_heap_caps.h>
+#include "config.h"
+#include "fetch_pool.h"
+
+// The pool on the host's thread-backed FreeRTOS. Each job opens a fake TLS
+// session: FETCH_TLS_COST taken from the simulated heap for SESSION_MS.
+
+#define SESSION_MS 20
+#define JOB_COUNT 10
+
+static std::atomic<int> runs[JOB_COUNT];
+static std::atomic<int> inFlight;
+static std::atomic<int> mostInFlight;
+
+static void session(int index) {
+  runs[index]++;
+  int now = ++inFlight;
+  int most = mostInFlight.load();
+  while (now > most && !mostInFlight.compare_exchange_weak(most, now)) {
+  }
+  hostHeapUse(FETCH_TLS_COST);
+  std::this_thread::sleep_for(std::chrono::milliseconds(SESSION_MS));
+  hostHeapUse(-FETCH_TLS_COST);
+  inFlight--;
+}
+
+template <int index>
+static void job() {
+  session(index);
+}
+
+static const FetchJob jobs[JOB_COUNT] = {job<0>, job<1>, job<2>, job<3>, job<4>,
+                                         job<5>, job<6>, job<7>, job<8>, job<9>};
+
+static void startHeap(int64_t bytes) {
+  hostHeapFree = bytes;
+  hostHeapMinimum = bytes;
+}
+
+void setUp() {
+  for (auto& count : runs) count = 0;
+  inFlight = 0;
+  mostInFlight = 0;
+}
+void tearDown() {}
+
+static void assertEachRanOnce(int count) {
+  for (int i = 0; i < JOB_COUNT; i++) TEST_ASSERT_EQUAL(i < count ? 1 : 0, runs[i].load());
+}
+
+void test_roomy_heap_uses_every_worker() {
+  startHeap(200000);
+  FetchBatchStats stats = fetchRunAll(jobs, JOB_COUNT);
+  assertEachRanOnce(JOB_COUNT);
+  TEST_ASSERT_EQUAL(FETCH_MAX_WORKERS, stats.workers);
+  TEST_ASSERT_EQUAL(FETCH_MAX_WORKERS, mostInFlight.load());
+  // Overlapped: well under the serial time
+  TEST_ASSERT_TRUE(stats.wallMillis < JOB_COUNT * SESSION_MS * 2 / FETCH_MAX_WORKERS + SESSION_MS * 2);
+  TEST_ASSERT_EQUAL_UINT32(200000 - FETCH_MAX_WORKERS * FETCH_TLS_COST, stats.minFreeHeap);
+}
+
+void test_tight_heap_stays_serial() {
+  startHeap(2 * FETCH_TLS_COST + FETCH_HEAP_RESERVE - 1);
+  FetchBatchStats stats = fetchRunAll(jobs, JOB_COUNT);
+  assertEachRanOnce(JOB_COUNT);
+  TEST_ASSERT_EQUAL(1, stats.workers);
+  TEST_ASSERT_EQUAL(1, mostInFlight.load());
+}
+
+void test_helpers_yield_when_the_heap_shrinks() {
+  // Room for three sessions at the start; something else then takes heap
+  // and the helpers stop rather than push below the reserve
+  startHeap(3 * FETCH_TLS_COST + FETCH_HEAP_RESERVE);
+  std::thread squeeze([] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(SESSION_MS / 2));
+    hostHeapUse(2 * FETCH_TLS_COST);
+  });
+  FetchBatchStats stats = fetchRunAll(jobs, JOB_COUNT);
+  squeeze.join();
+  assertEachRanOnce(JOB_COUNT);
+  TEST_ASSERT_EQUAL(FETCH_MAX_WORKERS, stats.workers);
+  // One parallel round, then the rest (almost all) on the caller alone
+  TEST_ASSERT_TRUE(stats.wallMillis >= (JOB_COUNT - FETCH_MAX_WORKERS) * SESSION_MS * 3 / 4);
+  hostHeapUse(-2 * FETCH_TLS_COST);
+}
+
+void test_small_and_repeated_batches() {
+  startHeap(200000);
+  FetchBatchStats stats = fetchRunAll(jobs, 0);
+  TEST_ASSERT_EQUAL(1, stats.workers);
+  stats = fetchRunAll(jobs, 1);
+  TEST_ASSERT_EQUAL(1, stats.workers);  // No helper for a single job
+  assertEachRanOnce(1);
+  // The done semaphore is reused batch after batch
+  for (int batch = 0; batch < 50; batch++) {
+    setUp();
+    fetchRunAll(jobs, 1 + batch % JOB_COUNT);
+    assertEachRanOnce(1 + batch % JOB_COUNT);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_roomy_heap_uses_every_worker);
+  RUN_TEST(test_tight_heap_stays_serial);
+  RUN_TEST(test_helpers_yield_when_the_heap_shrinks);
+  RUN_TEST(test_small_and_repeated_batches);
+  return UNITY_END();
+}
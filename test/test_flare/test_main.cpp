@@ -0,0 +1,104 @@
+#include <unity.h>
+#include <math.h>
+#include "fixture.h"
+#include "flare.h"
+#include "weather.h"
+
+void setUp() {
+  flareEvents.count = 0;
+}
+void tearDown() {}
+
+static const uint32_t DAY_START = 1792238400;  // 2026-10-17 12:00 UTC, first row of the fixture
+
+static const char* flareClass(float flux) {
+  static char text[8];
+  flareClassText(flux, text, sizeof(text));
+  return text;
+}
+
+void test_fixture_flares() {
+  // An M2 peaking at minute 612 over a C2 background, and a C6 enhancement
+  // at minute 918 that rises at most 1.33x in 4 minutes, too slow to count
+  TEST_ASSERT_TRUE(fixtureStream(xrayIngest, fixtureRead("xrays-1-day.json")));
+  TEST_ASSERT_EQUAL(1, flareEvents.count);
+
+  const FlareEvent& m2 = flareEvents.events[0];
+  TEST_ASSERT_EQUAL_UINT32(DAY_START + 612 * 60, m2.peak);
+  TEST_ASSERT_EQUAL_STRING("M2.3", flareClass(m2.peakFlux));
+  TEST_ASSERT_FLOAT_WITHIN(1e-7, m2.peakFlux / 10, m2.shortPeakFlux);
+  TEST_ASSERT_TRUE(m2.start < m2.peak && m2.peak < m2.end);
+  TEST_ASSERT_TRUE(m2.peak - m2.start <= 30 * 60);
+  TEST_ASSERT_TRUE(m2.end < DAY_START + 900 * 60);
+}
+
+static void feedGaussian(FlareDetector& detector, uint32_t from, uint32_t minutes, uint32_t peakMinute, float peak) {
+  for (uint32_t i = 0; i < minutes; i++) {
+    float flux = 1e-6f + peak * expf(-powf(((float)i - peakMinute) / 6.0f, 2));
+    detector.sample(XRAY_SHORT, from + i * 60, flux / 10);
+    detector.sample(XRAY_LONG, from + i * 60, flux);
+  }
+}
+
+void test_flare_in_progress_has_no_end() {
+  FlareDetector detector;
+  FlareEventList list = {};
+  detector.begin(FLARE_MIN_FLUX);
+  feedGaussian(detector, DAY_START, 100, 95, 5e-5f);  // Data stops just after the peak
+  detector.finish(list);
+  TEST_ASSERT_EQUAL(1, list.count);
+  TEST_ASSERT_EQUAL_UINT32(0, list.events[0].end);
+  TEST_ASSERT_EQUAL_STRING("M5.1", flareClass(list.events[0].peakFlux));
+}
+
+void test_small_and_slow_rises_are_ignored() {
+  FlareDetector detector;
+  FlareEventList list = {};
+  detector.begin(FLARE_MIN_FLUX);
+  // Below the minimum peak, then a slow drift that never rises 1.4x in 4 minutes
+  for (uint32_t i = 0; i < 600; i++) detector.sample(XRAY_LONG, DAY_START + i * 60, 1e-7f * (1 + 0.05f * i));
+  detector.finish(list);
+  TEST_ASSERT_EQUAL(0, list.count);
+  TEST_ASSERT_EQUAL_UINT32(600, detector.samples());
+}
+
+void test_rescan_keeps_older_events() {
+  FlareEventList list = {};
+  FlareDetector detector;
+  detector.begin(FLARE_MIN_FLUX);
+  feedGaussian(detector, DAY_START, 200, 50, 2e-5f);
+  detector.finish(list);
+  TEST_ASSERT_EQUAL(1, list.count);
+
+  // The next 1-day product starts after that flare and holds a new one
+  detector.begin(FLARE_MIN_FLUX);
+  feedGaussian(detector, DAY_START + 150 * 60, 200, 100, 3e-6f);
+  detector.finish(list);
+  TEST_ASSERT_EQUAL(2, list.count);
+  TEST_ASSERT_EQUAL_UINT32(DAY_START + 50 * 60, list.events[0].peak);
+  TEST_ASSERT_EQUAL_UINT32(DAY_START + 250 * 60, list.events[1].peak);
+
+  // Scanning the same window again replaces rather than duplicates
+  detector.begin(FLARE_MIN_FLUX);
+  feedGaussian(detector, DAY_START + 150 * 60, 200, 100, 3e-6f);
+  detector.finish(list);
+  TEST_ASSERT_EQUAL(2, list.count);
+}
+
+void test_class_text() {
+  TEST_ASSERT_EQUAL_STRING("A0.5", flareClass(5e-9f));
+  TEST_ASSERT_EQUAL_STRING("B1.0", flareClass(1e-7f));
+  TEST_ASSERT_EQUAL_STRING("C9.9", flareClass(9.9e-6f));
+  TEST_ASSERT_EQUAL_STRING("X1.0", flareClass(1e-4f));
+  TEST_ASSERT_EQUAL_STRING("X10.3", flareClass(1.03e-3f));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fixture_flares);
+  RUN_TEST(test_flare_in_progress_has_no_end);
+  RUN_TEST(test_small_and_slow_rises_are_ignored);
+  RUN_TEST(test_rescan_keeps_older_events);
+  RUN_TEST(test_class_text);
+  return UNITY_END();
+}
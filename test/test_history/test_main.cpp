@@ -0,0 +1,143 @@
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include "history.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t WEEK_START = 1792281600;  // 2026-10-18 00:00 UTC
+
+// A week of 0.1 F temperature at a 10 minute cadence with a daily swing,
+// noise and the odd late sample
+static float temperatureAt(int i) {
+  return roundf((60 + 15 * sinf(i * 2 * (float)M_PI / 144) + (rand() % 10) / 10.0f) * 10) / 10;
+}
+
+static uint32_t cadenceAt(int i) {
+  return WEEK_START + i * 600 + (i % 37 == 0 ? 3 : 0);
+}
+
+void test_week_round_trips_exactly() {
+  static HistorySeries series(10);
+  static float values[1008];
+  srand(1);
+  for (int i = 0; i < 1008; i++) {
+    values[i] = temperatureAt(i);
+    TEST_ASSERT_TRUE(series.append(cadenceAt(i), values[i]));
+  }
+  TEST_ASSERT_EQUAL_UINT32(1008, series.count());
+  TEST_ASSERT_EQUAL_UINT32(WEEK_START + 3, series.firstTime());
+
+  HistorySeries::Iterator it = series.begin();
+  uint32_t time;
+  float value;
+  int i = 0;
+  while (it.next(time, value)) {
+    TEST_ASSERT_EQUAL_UINT32(cadenceAt(i), time);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, values[i], value);
+    i++;
+  }
+  TEST_ASSERT_EQUAL(1008, i);
+  // About 10 bits per sample, well under the ring
+  TEST_ASSERT_TRUE(series.bytesUsed() * 8 < 12 * 1008);
+  TEST_ASSERT_TRUE(series.bytesUsed() <= HISTORY_BLOCK_COUNT * HISTORY_BLOCK_BYTES);
+}
+
+void test_full_ring_drops_oldest_blocks() {
+  static HistorySeries series(1);
+  for (int i = 0; i < 20000; i++) series.append(WEEK_START + i * 600, (float)(i % 50) * (i % 7));
+  TEST_ASSERT_TRUE(series.count() < 20000);
+  TEST_ASSERT_TRUE(series.count() > 0);
+  TEST_ASSERT_EQUAL_UINT32(WEEK_START + 19999 * 600, series.lastTime());
+
+  HistorySeries::Iterator it = series.begin();
+  uint32_t time, previous = 0, seen = 0;
+  float value;
+  while (it.next(time, value)) {
+    TEST_ASSERT_TRUE(time > previous);
+    uint32_t index = (time - WEEK_START) / 600;
+    TEST_ASSERT_EQUAL_FLOAT((float)(index % 50) * (index % 7), value);
+    previous = time;
+    seen++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(series.count(), seen);
+  TEST_ASSERT_EQUAL_UINT32(series.firstTime(), WEEK_START + (20000 - seen) * 600);
+}
+
+void test_extreme_jumps_and_gaps() {
+  static HistorySeries series(1);
+  TEST_ASSERT_TRUE(series.append(5, 1e9f));
+  TEST_ASSERT_TRUE(series.append(6, -1e9f));
+  TEST_ASSERT_TRUE(series.append(4000000000u, 3));
+  TEST_ASSERT_TRUE(series.append(4000000001u, 0));
+  TEST_ASSERT_FALSE(series.append(10, 1));  // Backwards
+
+  const uint32_t times[] = {5, 6, 4000000000u, 4000000001u};
+  const float values[] = {1e9f, -1e9f, 3, 0};
+  HistorySeries::Iterator it = series.begin();
+  uint32_t time;
+  float value;
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(it.next(time, value));
+    TEST_ASSERT_EQUAL_UINT32(times[i], time);
+    TEST_ASSERT_FLOAT_WITHIN(64, values[i], value);
+  }
+  TEST_ASSERT_FALSE(it.next(time, value));
+}
+
+void test_clear_and_empty() {
+  static HistorySeries series(10);
+  uint32_t time;
+  float value;
+  HistorySeries::Iterator empty = series.begin();
+  TEST_ASSERT_FALSE(empty.next(time, value));
+  series.append(WEEK_START, 1.5f);
+  series.clear();
+  TEST_ASSERT_EQUAL_UINT32(0, series.count());
+  TEST_ASSERT_EQUAL(0, series.bytesUsed());
+  TEST_ASSERT_TRUE(series.append(WEEK_START - 600, 2.5f));  // Time restarts after a clear
+}
+
+void test_decimate_columns() {
+  // Two samples per column over 10 columns, plus some outside the window
+  static HistorySeries series(10);
+  series.clear();
+  for (int i = -4; i < 24; i++) series.append(WEEK_START + i * 300, (float)(i % 5));
+  HistoryColumn columns[10];
+  uint32_t placed = historyDecimate(series, WEEK_START, WEEK_START + 6000, columns, 10);
+  TEST_ASSERT_EQUAL_UINT32(20, placed);
+  for (int x = 0; x < 10; x++) {
+    float first = (float)(2 * x % 5), second = (float)((2 * x + 1) % 5);
+    TEST_ASSERT_EQUAL(2, columns[x].count);
+    TEST_ASSERT_EQUAL_FLOAT(first < second ? first : second, columns[x].min);
+    TEST_ASSERT_EQUAL_FLOAT(first > second ? first : second, columns[x].max);
+    TEST_ASSERT_EQUAL_FLOAT(second, columns[x].last);
+  }
+}
+
+void test_decimate_gaps_and_degenerate_windows() {
+  static HistorySeries series(10);
+  series.clear();
+  series.append(WEEK_START, 1);
+  series.append(WEEK_START + 3600, 2);
+  HistoryColumn columns[4];
+  TEST_ASSERT_EQUAL_UINT32(2, historyDecimate(series, WEEK_START, WEEK_START + 4000, columns, 4));
+  TEST_ASSERT_EQUAL(1, columns[0].count);
+  TEST_ASSERT_EQUAL(0, columns[1].count);  // Gap, drawn as nothing
+  TEST_ASSERT_EQUAL(0, columns[2].count);
+  TEST_ASSERT_EQUAL(1, columns[3].count);
+  TEST_ASSERT_EQUAL_UINT32(0, historyDecimate(series, WEEK_START + 10, WEEK_START + 10, columns, 4));
+  TEST_ASSERT_EQUAL_UINT32(0, historyDecimate(series, WEEK_START, WEEK_START + 4000, columns, 0));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_week_round_trips_exactly);
+  RUN_TEST(test_full_ring_drops_oldest_blocks);
+  RUN_TEST(test_extreme_jumps_and_gaps);
+  RUN_TEST(test_clear_and_empty);
+  RUN_TEST(test_decimate_columns);
+  RUN_TEST(test_decimate_gaps_and_degenerate_windows);
+  return UNITY_END();
+}
@@ -0,0 +1,118 @@
+#include <unity.h>
+#include <string.h>
+#include "fixture.h"
+
+// Every ingest against its recorded payload, in one piece and split into
+// single bytes, and against the adversarial bodies, which must be rejected
+// without touching the last good values.
+
+void setUp() {}
+void tearDown() {}
+
+static const char* const rejectedFixtures[] = {
+  "adversarial/deep.json", "adversarial/truncated.json", "adversarial/wrong_shape.json",
+};
+
+void test_stream_fixtures_accepted_in_any_chunking() {
+  struct { const char* fixture; StreamIngest* ingest; } cases[] = {
+    {"mag-1-day.json", &solarWindMagIngest},
+    {"plasma-1-day.json", &solarWindPlasmaIngest},
+    {"xrays-1-day.json", &xrayIngest},
+    {"solar_regions.json", &solarRegionIngest},
+    {"alerts.json", &alertIngest},
+    {"noaa-planetary-k-index-forecast.json", &kpForecastIngest},
+    {"ovation_aurora_latest.json", &ovationIngest},
+  };
+  ovationIngest.setLocation(LATITUDE, LONGITUDE);
+  for (auto& test : cases) {
+    std::string body = fixtureRead(test.fixture);
+    TEST_ASSERT_TRUE_MESSAGE(!body.empty(), test.fixture);
+    TEST_ASSERT_TRUE_MESSAGE(fixtureStream(*test.ingest, body), test.fixture);
+    TEST_ASSERT_TRUE_MESSAGE(fixtureStream(*test.ingest, body, 1), test.fixture);
+  }
+}
+
+void test_ovation_reads_each_location_column() {
+  AuroraNowcastData fairbanks = AuroraNowcastData();
+  AuroraNowcastData tromso = AuroraNowcastData();
+  ovationIngest.setLocation(40.7128, -74.0060);
+  TEST_ASSERT_TRUE(ovationIngest.addLocation(64.84, -147.72, fairbanks));
+  TEST_ASSERT_TRUE(ovationIngest.addLocation(69.65, 18.96, tromso));
+  TEST_ASSERT_TRUE(fixtureStream(ovationIngest, fixtureRead("ovation_aurora_latest.json")));
+
+  TEST_ASSERT_EQUAL_INT(0, auroraNowcast.probability);
+  TEST_ASSERT_EQUAL_INT(38, auroraNowcast.polewardMax);
+  TEST_ASSERT_EQUAL_INT(58, auroraNowcast.ovalEdgeLatitude);
+  TEST_ASSERT_EQUAL_INT(58 - AURORA_HORIZON_DISTANCE, auroraNowcast.viewlineLatitude);
+  TEST_ASSERT_EQUAL_STRING("2026-10-18T12:40:00Z", auroraNowcast.forecastTime);
+  TEST_ASSERT_EQUAL_INT(37, fairbanks.probability);
+  TEST_ASSERT_EQUAL_INT(60, fairbanks.ovalEdgeLatitude);
+  TEST_ASSERT_EQUAL_INT(34, tromso.probability);
+  TEST_ASSERT_EQUAL_INT(65, tromso.ovalEdgeLatitude);
+}
+
+void test_rejected_bodies_keep_last_good_values() {
+  ovationIngest.setLocation(64.84, -147.72);
+  TEST_ASSERT_TRUE(fixtureStream(ovationIngest, fixtureRead("ovation_aurora_latest.json")));
+  TEST_ASSERT_TRUE(fixtureStream(kpForecastIngest, fixtureRead("noaa-planetary-k-index-forecast.json")));
+  KpForecastSeries forecast = kpForecast;
+  AuroraNowcastData nowcast = auroraNowcast;
+
+  for (const char* fixture : rejectedFixtures) {
+    std::string body = fixtureRead(fixture);
+    TEST_ASSERT_FALSE_MESSAGE(fixtureStream(ovationIngest, body), fixture);
+    TEST_ASSERT_FALSE_MESSAGE(fixtureStream(kpForecastIngest, body), fixture);
+    TEST_ASSERT_FALSE_MESSAGE(fixtureStream(xrayIngest, body), fixture);
+    TEST_ASSERT_FALSE_MESSAGE(fixtureStream(solarRegionIngest, body), fixture);
+    TEST_ASSERT_FALSE_MESSAGE(fixtureStream(alertIngest, body), fixture);
+  }
+  TEST_ASSERT_EQUAL_MEMORY(&forecast, &kpForecast, sizeof(forecast));
+  TEST_ASSERT_EQUAL_INT(nowcast.probability, auroraNowcast.probability);
+  TEST_ASSERT_EQUAL_INT(nowcast.ovalEdgeLatitude, auroraNowcast.ovalEdgeLatitude);
+}
+
+void test_dom_fixtures() {
+  std::string body = fixtureRead("onecall.json");
+  TEST_ASSERT_TRUE(ingestOneCall(body.data(), body.size()));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 54.32, currentWeather.temperature);
+  TEST_ASSERT_EQUAL_INT(3, airQuality.uvIndex);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 58.0, weeklyForecast.days[0].tempHigh);
+
+  body = fixtureRead("air_pollution.json");
+  TEST_ASSERT_TRUE(ingestAirQuality(body.data(), body.size()));
+  TEST_ASSERT_EQUAL_INT(2, airQuality.aqi);
+
+  body = fixtureRead("noaa-planetary-k-index.json");
+  TEST_ASSERT_TRUE(ingestKpIndex(body.data(), body.size()));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 3.33, currentSpaceWeather.kpIndex);
+
+  body = fixtureRead("f107_cm_flux.json");
+  TEST_ASSERT_TRUE(ingestSolarFlux(body.data(), body.size()));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 152.0, noaaSpaceWeather.solarFluxIndex);
+
+  body = fixtureRead("daily-geomagnetic-indices.json");
+  TEST_ASSERT_TRUE(ingestGeomagIndices(body.data(), body.size()));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 12.0, noaaSpaceWeather.aIndex);
+}
+
+void test_dom_rejects_keep_last_good_values() {
+  std::string body = fixtureRead("noaa-planetary-k-index.json");
+  TEST_ASSERT_TRUE(ingestKpIndex(body.data(), body.size()));
+  for (const char* fixture : rejectedFixtures) {
+    body = fixtureRead(fixture);
+    TEST_ASSERT_FALSE_MESSAGE(ingestOneCall(body.data(), body.size()), fixture);
+    TEST_ASSERT_FALSE_MESSAGE(ingestAirQuality(body.data(), body.size()), fixture);
+    TEST_ASSERT_FALSE_MESSAGE(ingestKpIndex(body.data(), body.size()), fixture);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 3.33, currentSpaceWeather.kpIndex);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_stream_fixtures_accepted_in_any_chunking);
+  RUN_TEST(test_ovation_reads_each_location_column);
+  RUN_TEST(test_rejected_bodies_keep_last_good_values);
+  RUN_TEST(test_dom_fixtures);
+  RUN_TEST(test_dom_rejects_keep_last_good_values);
+  return UNITY_END();
+}
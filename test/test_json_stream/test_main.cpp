@@ -0,0 +1,103 @@
+#include <unity.h>
+#include <string.h>
+#include "json_stream.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Keeps the last scalar seen
+class LastValue : public JsonStreamHandler {
+public:
+  void value(const char* text, JsonValueType type) override {
+    strncpy(last, text, sizeof(last) - 1);
+    lastType = type;
+  }
+
+  char last[80] = "";
+  JsonValueType lastType = JSON_NULL;
+};
+
+static bool parse(const char* json, JsonStreamHandler& handler, size_t tokenSize = 16) {
+  char token[80];
+  JsonStreamParser parser(handler, token, tokenSize);
+  return parser.feed(json, strlen(json)) && parser.finish();
+}
+
+void test_int_fast_path() {
+  int32_t value;
+  TEST_ASSERT_TRUE(jsonToInt("0", value));
+  TEST_ASSERT_EQUAL_INT32(0, value);
+  TEST_ASSERT_TRUE(jsonToInt("-359", value));
+  TEST_ASSERT_EQUAL_INT32(-359, value);
+  TEST_ASSERT_TRUE(jsonToInt("214748363", value));
+  TEST_ASSERT_EQUAL_INT32(214748363, value);
+  TEST_ASSERT_FALSE(jsonToInt("", value));
+  TEST_ASSERT_FALSE(jsonToInt("-", value));
+  TEST_ASSERT_FALSE(jsonToInt("x1", value));
+}
+
+void test_int_long_digit_runs_do_not_overflow() {
+  int32_t value = 7;
+  TEST_ASSERT_TRUE(jsonToInt("2147483647", value));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, value);
+  TEST_ASSERT_TRUE(jsonToInt("-2147483648", value));
+  TEST_ASSERT_EQUAL_INT32(INT32_MIN, value);
+  TEST_ASSERT_TRUE(jsonToInt("0000000000042", value));
+  TEST_ASSERT_EQUAL_INT32(42, value);
+
+  value = 7;
+  TEST_ASSERT_FALSE(jsonToInt("2147483648", value));
+  TEST_ASSERT_FALSE(jsonToInt("12345678901", value));
+  TEST_ASSERT_FALSE(jsonToInt("-2147483649", value));
+  TEST_ASSERT_FALSE(jsonToInt("99999999999999999999", value));
+  TEST_ASSERT_FALSE(jsonToInt("1e999", value));
+  TEST_ASSERT_EQUAL_INT32(7, value);
+}
+
+void test_int_rounds_fractions() {
+  int32_t value;
+  TEST_ASSERT_TRUE(jsonToInt("2.5", value));
+  TEST_ASSERT_EQUAL_INT32(3, value);
+  TEST_ASSERT_TRUE(jsonToInt("-1.5e1", value));
+  TEST_ASSERT_EQUAL_INT32(-15, value);
+  TEST_ASSERT_TRUE(jsonToInt("-0.0", value));
+  TEST_ASSERT_EQUAL_INT32(0, value);
+}
+
+void test_numbers_longer_than_token_rejected() {
+  LastValue handler;
+  // 15 characters fit a 16-byte token, 16 do not
+  TEST_ASSERT_TRUE(parse("[123456789012345]", handler));
+  TEST_ASSERT_EQUAL_STRING("123456789012345", handler.last);
+  TEST_ASSERT_FALSE(parse("[1234567890123456]", handler));
+  TEST_ASSERT_FALSE(parse("[0.00000000000000001]", handler));
+  TEST_ASSERT_FALSE(parse("1234567890123456", handler));
+}
+
+void test_long_strings_truncated_not_rejected() {
+  LastValue handler;
+  char token[8];
+  JsonStreamParser parser(handler, token, sizeof(token));
+  const char* json = "[\"abcdefghijkl\", 5]";
+  TEST_ASSERT_TRUE(parser.feed(json, strlen(json)));
+  TEST_ASSERT_TRUE(parser.finish());
+  TEST_ASSERT_TRUE(parser.truncated());
+  TEST_ASSERT_EQUAL_STRING("5", handler.last);
+}
+
+void test_tiny_token_buffer() {
+  LastValue handler;
+  TEST_ASSERT_FALSE(parse("[1]", handler, 1));
+  TEST_ASSERT_TRUE(parse("[1]", handler, 2));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_int_fast_path);
+  RUN_TEST(test_int_long_digit_runs_do_not_overflow);
+  RUN_TEST(test_int_rounds_fractions);
+  RUN_TEST(test_numbers_longer_than_token_rejected);
+  RUN_TEST(test_long_strings_truncated_not_rejected);
+  RUN_TEST(test_tiny_token_buffer);
+  return UNITY_END();
+}
@@ -0,0 +1,111 @@
+#include <unity.h>
+#include <string>
+#include "fixture.h"
+#include "kp_forecast.h"
+#include "timezone.h"
+#include "weather.h"
+
+void setUp() {
+  timeZoneInit("CST6CDT,M3.2.0,M11.1.0");
+  kpSeriesClear(kpForecast);
+}
+void tearDown() {}
+
+static const time_t OCT_11 = 1791676800;   // 2026-10-11 00:00 UTC, first row of the fixture
+static const time_t OCT_19_NOON = 1792429200;  // 2026-10-19 12:00 CDT
+
+void test_table_fixture() {
+  TEST_ASSERT_TRUE(fixtureStream(kpForecastIngest, fixtureRead("noaa-planetary-k-index-forecast.json"), 7));
+  TEST_ASSERT_EQUAL(83, kpForecast.count);
+  TEST_ASSERT_EQUAL_UINT32(OCT_11, kpForecast.points[0].time);
+  TEST_ASSERT_EQUAL_UINT32(OCT_11 + 82 * KP_SLOT_SECONDS, kpForecast.points[82].time);
+
+  int sources[3] = {0, 0, 0};
+  int maxTenths = 0;
+  for (uint8_t i = 0; i < kpForecast.count; i++) {
+    sources[kpForecast.points[i].source]++;
+    if (kpForecast.points[i].kpTenths > maxTenths) maxTenths = kpForecast.points[i].kpTenths;
+    if (i > 0) TEST_ASSERT_EQUAL_UINT32(kpForecast.points[i - 1].time + KP_SLOT_SECONDS, kpForecast.points[i].time);
+  }
+  TEST_ASSERT_EQUAL(59, sources[KP_OBSERVED]);
+  TEST_ASSERT_EQUAL(1, sources[KP_ESTIMATED]);
+  TEST_ASSERT_EQUAL(23, sources[KP_PREDICTED]);
+  TEST_ASSERT_EQUAL(60, maxTenths);
+}
+
+void test_object_form() {
+  const char* body = "[{\"time_tag\":\"2026-10-18T00:00:00\",\"kp\":2.33,\"observed\":\"observed\",\"noaa_scale\":null},"
+                     "{\"time_tag\":\"2026-10-19T03:00:00\",\"kp\":5.33,\"observed\":\"predicted\",\"noaa_scale\":\"G1\"}]";
+  TEST_ASSERT_TRUE(fixtureStream(kpForecastIngest, body, strlen(body), 5));
+  TEST_ASSERT_EQUAL(2, kpForecast.count);
+  TEST_ASSERT_EQUAL_UINT32(1792281600, kpForecast.points[0].time);
+  TEST_ASSERT_EQUAL(23, kpForecast.points[0].kpTenths);
+  TEST_ASSERT_EQUAL(KP_OBSERVED, kpForecast.points[0].source);
+  TEST_ASSERT_EQUAL(53, kpForecast.points[1].kpTenths);
+  TEST_ASSERT_EQUAL(KP_PREDICTED, kpForecast.points[1].source);
+}
+
+void test_long_product_keeps_the_newest_slots() {
+  // 500 rows into a fixed series: memory stays bounded and the future wins
+  std::string body = "[[\"time_tag\",\"kp\",\"observed\",\"noaa_scale\"]";
+  for (int i = 0; i < 500; i++) {
+    time_t time = OCT_11 + (time_t)i * KP_SLOT_SECONDS;
+    struct tm fields;
+    gmtime_r(&time, &fields);
+    char row[80];
+    snprintf(row, sizeof(row), ",[\"%04d-%02d-%02d %02d:00:00\",\"%d.00\",\"predicted\",null]", fields.tm_year + 1900,
+             fields.tm_mon + 1, fields.tm_mday, fields.tm_hour, i % 9);
+    body += row;
+  }
+  body += "]";
+  TEST_ASSERT_TRUE(fixtureStream(kpForecastIngest, body));
+  TEST_ASSERT_EQUAL(KP_FORECAST_CAPACITY, kpForecast.count);
+  TEST_ASSERT_EQUAL_UINT32(OCT_11 + 499 * KP_SLOT_SECONDS, kpForecast.points[KP_FORECAST_CAPACITY - 1].time);
+  TEST_ASSERT_EQUAL_UINT32(OCT_11 + (500 - KP_FORECAST_CAPACITY) * KP_SLOT_SECONDS, kpForecast.points[0].time);
+  TEST_ASSERT_TRUE(sizeof(KpForecastSeries) <= KP_FORECAST_CAPACITY * 8 + 4);
+}
+
+void test_night_peak_in_darkness() {
+  TEST_ASSERT_TRUE(fixtureStream(kpForecastIngest, fixtureRead("noaa-planetary-k-index-forecast.json")));
+  AuroraNight night;
+  // Chicago, the night of Oct 19: the 6.0 slots (00-06 UTC Oct 20) fall after dusk
+  TEST_ASSERT_TRUE(analyzeAuroraNight(kpForecast, OCT_19_NOON, 41.88, -87.63, night));
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 6.0, night.maxKp);
+  TEST_ASSERT_EQUAL(KP_PREDICTED, night.source);
+  TEST_ASSERT_TRUE(night.darkStart > OCT_19_NOON && night.darkEnd > night.darkStart);
+  TEST_ASSERT_TRUE(night.peakStart >= night.darkStart && night.peakEnd <= night.darkEnd);
+  TEST_ASSERT_TRUE(night.peakStart < (time_t)(OCT_11 + 9 * 86400 + 6 * 3600));
+  TEST_ASSERT_TRUE(night.peakEnd > (time_t)(OCT_11 + 9 * 86400));
+  LocalTime dusk;
+  toLocalTime(night.darkStart, dusk);
+  TEST_ASSERT_EQUAL(19, dusk.day);
+  TEST_ASSERT_TRUE(dusk.hour >= 19 && dusk.hour <= 20);
+}
+
+void test_night_without_slots() {
+  TEST_ASSERT_TRUE(fixtureStream(kpForecastIngest, fixtureRead("noaa-planetary-k-index-forecast.json")));
+  AuroraNight night;
+  // A week past the product: dark, but nothing forecast for it
+  TEST_ASSERT_FALSE(analyzeAuroraNight(kpForecast, OCT_19_NOON + 7 * 86400, 41.88, -87.63, night));
+  TEST_ASSERT_EQUAL_FLOAT(-1, night.maxKp);
+  TEST_ASSERT_NOT_EQUAL(0, night.darkStart);
+}
+
+void test_midnight_sun_has_no_night() {
+  AuroraNight night;
+  timeZoneInit("CET-1CEST,M3.5.0,M10.5.0/3");
+  TEST_ASSERT_FALSE(analyzeAuroraNight(kpForecast, 1750500000, 69.65, 18.96, night));  // Tromsø, June 21
+  TEST_ASSERT_EQUAL(0, night.darkStart);
+  TEST_ASSERT_EQUAL(0, night.darkEnd);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_table_fixture);
+  RUN_TEST(test_object_form);
+  RUN_TEST(test_long_product_keeps_the_newest_slots);
+  RUN_TEST(test_night_peak_in_darkness);
+  RUN_TEST(test_night_without_slots);
+  RUN_TEST(test_midnight_sun_has_no_night);
+  return UNITY_END();
+}
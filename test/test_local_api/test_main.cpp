@@ -0,0 +1,218 @@
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "local_api.h"
+#include "local_api_client.h"
+
+// The server on a loopback port, polled by its own thread as localApiTask
+// does on the device, with the test thread as the one publisher.
+
+#define TEST_PORT 18475
+#define LOAD_CLIENTS LOCAL_API_MAX_CLIENTS
+#define LOAD_MILLIS 1000
+#define PUBLISH_MILLIS 20
+
+static std::atomic<bool> serving;
+static std::thread server;
+static int variant = 0;
+
+static uint32_t millisNow() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void publish() {
+  static StationSnapshot snapshot;
+  localApiSnapshot(snapshot, ++variant);
+  TEST_ASSERT_TRUE(snapshotPublish(snapshot));
+}
+
+static LocalApiResponse get(const std::string& request, bool head = false) {
+  int socketFd = localApiDial(TEST_PORT);
+  TEST_ASSERT_TRUE(socketFd >= 0);
+  send(socketFd, request.data(), request.size(), MSG_NOSIGNAL);
+  std::string pending;
+  LocalApiResponse response = localApiRead(socketFd, pending, head);
+  close(socketFd);
+  return response;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// Must run first: nothing is published yet
+void test_unavailable_before_publish() {
+  LocalApiResponse response = get("GET /api/snapshot HTTP/1.1\r\nHost: x\r\n\r\n");
+  TEST_ASSERT_EQUAL(503, response.status);
+}
+
+void test_formats() {
+  publish();
+  LocalApiResponse json = get("GET /api/snapshot HTTP/1.1\r\nHost: x\r\n\r\n");
+  TEST_ASSERT_EQUAL(200, json.status);
+  TEST_ASSERT_TRUE(json.head.find("Content-Type: application/json") != std::string::npos);
+  TEST_ASSERT_EQUAL('{', json.body[0]);
+  TEST_ASSERT_TRUE(localApiEtag(json.body) == json.etag);
+
+  LocalApiResponse cbor = get("GET /api/snapshot HTTP/1.1\r\nAccept: application/cbor\r\n\r\n");
+  TEST_ASSERT_EQUAL(200, cbor.status);
+  TEST_ASSERT_TRUE(cbor.head.find("Content-Type: application/cbor") != std::string::npos);
+  TEST_ASSERT_TRUE(localApiEtag(cbor.body) == cbor.etag);
+  TEST_ASSERT_TRUE(cbor.body.size() < json.body.size());
+
+  // Headers only, same entity
+  LocalApiResponse head = get("HEAD /api/snapshot.cbor HTTP/1.1\r\n\r\n", true);
+  TEST_ASSERT_EQUAL(200, head.status);
+  TEST_ASSERT_TRUE(cbor.etag == head.etag);
+  TEST_ASSERT_EQUAL(0, head.body.size());
+
+  // HTTP/1.0 and a query string
+  LocalApiResponse old = get("GET /api/snapshot.json?x=1 HTTP/1.0\r\n\r\n");
+  TEST_ASSERT_EQUAL(200, old.status);
+  TEST_ASSERT_TRUE(json.etag == old.etag);
+}
+
+void test_not_modified() {
+  LocalApiResponse first = get("GET /api/snapshot HTTP/1.1\r\n\r\n");
+  LocalApiResponse again = get("GET /api/snapshot HTTP/1.1\r\nIf-None-Match: " + first.etag + "\r\n\r\n");
+  TEST_ASSERT_EQUAL(304, again.status);
+  TEST_ASSERT_EQUAL(0, again.body.size());
+  TEST_ASSERT_EQUAL(304, get("GET /api/snapshot HTTP/1.1\r\nIf-None-Match: *\r\n\r\n").status);
+
+  // A new publish changes the tag
+  publish();
+  LocalApiResponse changed = get("GET /api/snapshot HTTP/1.1\r\nIf-None-Match: " + first.etag + "\r\n\r\n");
+  TEST_ASSERT_EQUAL(200, changed.status);
+  TEST_ASSERT_TRUE(changed.etag != first.etag);
+}
+
+void test_errors() {
+  TEST_ASSERT_EQUAL(405, get("POST /api/snapshot HTTP/1.1\r\nContent-Length: 0\r\n\r\n").status);
+  TEST_ASSERT_EQUAL(404, get("GET /nope HTTP/1.1\r\n\r\n").status);
+  TEST_ASSERT_EQUAL(400, get("garbage\r\n\r\n").status);
+
+  // A head longer than the request buffer is refused and the connection closed
+  std::string request = "GET /api/snapshot HTTP/1.1\r\nX-Padding: " + std::string(LOCAL_API_REQUEST_SIZE, 'a');
+  std::string reply = localApiExchange(TEST_PORT, request + "\r\n\r\n");
+  TEST_ASSERT_EQUAL(0, reply.find("HTTP/1.1 431"));
+}
+
+void test_pipelined() {
+  int socketFd = localApiDial(TEST_PORT);
+  std::string requests = "GET /api/snapshot.json HTTP/1.1\r\n\r\n"
+                         "HEAD /api/snapshot.json HTTP/1.1\r\n\r\n"
+                         "GET /api/snapshot.cbor HTTP/1.1\r\n\r\n";
+  send(socketFd, requests.data(), requests.size(), MSG_NOSIGNAL);
+  std::string pending;
+  LocalApiResponse json = localApiRead(socketFd, pending);
+  LocalApiResponse head = localApiRead(socketFd, pending, true);
+  LocalApiResponse cbor = localApiRead(socketFd, pending);
+  close(socketFd);
+  // Answered in order
+  TEST_ASSERT_EQUAL(200, json.status);
+  TEST_ASSERT_EQUAL('{', json.body[0]);
+  TEST_ASSERT_EQUAL(200, head.status);
+  TEST_ASSERT_TRUE(json.etag == head.etag);
+  TEST_ASSERT_EQUAL(200, cbor.status);
+  TEST_ASSERT_TRUE(cbor.head.find("application/cbor") != std::string::npos);
+  TEST_ASSERT_EQUAL(0, pending.size());
+}
+
+// Every slot held by an idle keep-alive client: a new device still gets in
+void test_idle_client_yields_slot() {
+  std::vector<int> idle;
+  for (int i = 0; i < LOCAL_API_MAX_CLIENTS; i++) {
+    int socketFd = localApiDial(TEST_PORT);
+    std::string pending;
+    send(socketFd, "GET /api/snapshot HTTP/1.1\r\n\r\n", 30, MSG_NOSIGNAL);
+    TEST_ASSERT_EQUAL(200, localApiRead(socketFd, pending).status);
+    idle.push_back(socketFd);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(LOCAL_API_EVICT_IDLE * 2));
+  TEST_ASSERT_EQUAL(200, get("GET /api/snapshot HTTP/1.1\r\n\r\n").status);
+  for (int socketFd : idle) close(socketFd);
+}
+
+// Keep-alive clients reading while a new snapshot goes out every
+// PUBLISH_MILLIS: each body must match its ETag, never a mix of two
+void test_load_no_torn_bodies() {
+  std::atomic<bool> running(true);
+  std::atomic<uint32_t> answered(0);
+  std::atomic<uint32_t> torn(0);
+  std::atomic<uint32_t> failed(0);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < LOAD_CLIENTS; i++) {
+    readers.emplace_back([&, i] {
+      int socketFd = localApiDial(TEST_PORT);
+      std::string pending;
+      std::string request = i % 2 ? "GET /api/snapshot.cbor HTTP/1.1\r\n\r\n" : "GET /api/snapshot HTTP/1.1\r\n\r\n";
+      while (running) {
+        send(socketFd, request.data(), request.size(), MSG_NOSIGNAL);
+        LocalApiResponse response = localApiRead(socketFd, pending);
+        if (response.status != 200) {
+          failed++;
+          close(socketFd);
+          socketFd = localApiDial(TEST_PORT);
+          pending.clear();
+          continue;
+        }
+        if (response.etag != localApiEtag(response.body)) torn++;
+        answered++;
+      }
+      close(socketFd);
+    });
+  }
+  uint32_t published = 0;
+  uint32_t start = millisNow();
+  while (millisNow() - start < LOAD_MILLIS) {
+    static StationSnapshot snapshot;
+    localApiSnapshot(snapshot, ++variant);
+    // Refused while a slow reader still pins the other slot; retried next time
+    published += snapshotPublish(snapshot);
+    std::this_thread::sleep_for(std::chrono::milliseconds(PUBLISH_MILLIS));
+  }
+  running = false;
+  for (std::thread& reader : readers) reader.join();
+  printf("load: %u responses/s over %d clients, %u publishes, %u torn, %u failed\n",
+         answered.load() * 1000 / LOAD_MILLIS, LOAD_CLIENTS, published, torn.load(), failed.load());
+  TEST_ASSERT_EQUAL(0, torn.load());
+  TEST_ASSERT_EQUAL(0, failed.load());
+  TEST_ASSERT_TRUE(published > LOAD_MILLIS / PUBLISH_MILLIS / 2);
+  TEST_ASSERT_TRUE(answered.load() > 1000);
+}
+
+void test_stats() {
+  LocalApiStats stats = localApiStats();
+  TEST_ASSERT_TRUE(stats.requests >= stats.notModified + stats.errors);
+  TEST_ASSERT_TRUE(stats.notModified >= 2);
+  TEST_ASSERT_TRUE(stats.errors >= 5);
+  TEST_ASSERT_TRUE(stats.connections > LOCAL_API_MAX_CLIENTS);
+}
+
+int main() {
+  TEST_ASSERT_TRUE(localApiOpen(TEST_PORT));
+  serving = true;
+  server = std::thread([] {
+    while (serving) localApiPoll(millisNow(), 10);
+  });
+
+  UNITY_BEGIN();
+  RUN_TEST(test_unavailable_before_publish);
+  RUN_TEST(test_formats);
+  RUN_TEST(test_not_modified);
+  RUN_TEST(test_errors);
+  RUN_TEST(test_pipelined);
+  RUN_TEST(test_idle_client_yields_slot);
+  RUN_TEST(test_load_no_torn_bodies);
+  RUN_TEST(test_stats);
+  int failures = UNITY_END();
+
+  serving = false;
+  server.join();
+  return failures;
+}
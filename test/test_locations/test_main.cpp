@@ -0,0 +1,161 @@
+#include <unity.h>
+#include <string.h>
+#include "config.h"
+#include "locations.h"
+#include "quota.h"
+
+// The OpenWeather budget shared by several locations: the interval split,
+// the background pick, and two simulated days of a station cycling through
+// LOCATION_MAX places against the real quota as main.cpp drives it
+
+static const uint32_t BASE = 600;                       // WEATHER_UPDATE_INTERVAL, s
+static const uint32_t DAY = QUOTA_DAY_SECONDS;
+static const uint32_t START = 1792281600 + 5 * 3600;   // 2026-10-18 05:00 UTC
+
+void setUp() {}
+void tearDown() {}
+
+void test_interval_split() {
+  // Alone, a location gets the whole budget above the base interval
+  TEST_ASSERT_EQUAL_UINT32(BASE, locationInterval(1, 6, true, 288, BASE));
+  TEST_ASSERT_EQUAL_UINT32(900, locationInterval(1, 6, true, 900, BASE));
+  // Weight 6 against three background shares of one: the active one refreshes 6x as often
+  TEST_ASSERT_EQUAL_UINT32(1350, locationInterval(4, 6, true, 900, BASE));
+  TEST_ASSERT_EQUAL_UINT32(8100, locationInterval(4, 6, false, 900, BASE));
+  // Calls per day add back up to the shared rate
+  TEST_ASSERT_EQUAL_UINT32(DAY / 900, DAY / 1350 + 3 * DAY / 8100);
+  // Floors: the base interval, activeWeight times that in the background
+  TEST_ASSERT_EQUAL_UINT32(BASE, locationInterval(4, 6, true, 100, BASE));
+  TEST_ASSERT_EQUAL_UINT32(6 * BASE, locationInterval(4, 6, false, 100, BASE));
+  TEST_ASSERT_EQUAL_UINT32(BASE, locationInterval(0, 6, false, 900, BASE));
+}
+
+void test_due_order_and_spread() {
+  LocationStatus status[4];
+  memset(status, 0, sizeof(status));
+  TEST_ASSERT_EQUAL(LOCATION_NONE, locationDue(status, 1, 0, 5000, 1000));
+  // Never refreshed first, the active one never
+  TEST_ASSERT_EQUAL(1, locationDue(status, 4, 0, 5000, 1000));
+  TEST_ASSERT_EQUAL(0, locationDue(status, 4, 1, 5000, 1000));
+
+  status[1].refreshedAt = 100000;
+  status[2].refreshedAt = 100200;
+  status[3].refreshedAt = 100400;
+  // Nobody is due before the interval, and then the oldest goes first
+  TEST_ASSERT_EQUAL(LOCATION_NONE, locationDue(status, 4, 0, 100900, 1000));
+  TEST_ASSERT_EQUAL(1, locationDue(status, 4, 0, 101000, 1000));
+  TEST_ASSERT_EQUAL(1, locationDue(status, 4, 0, 101300, 1000));
+  // Within interval / 3 of the last refresh the next one waits
+  status[1].refreshedAt = 101300;
+  TEST_ASSERT_EQUAL(LOCATION_NONE, locationDue(status, 4, 0, 101500, 1000));
+  TEST_ASSERT_EQUAL(2, locationDue(status, 4, 0, 101700, 1000));
+
+  // Ages survive millis() wrapping
+  status[1].refreshedAt = 0xFFFFFF00;
+  status[2].refreshedAt = 0xFFFFFF80;
+  status[3].refreshedAt = 0xFFFFFFF0;
+  TEST_ASSERT_EQUAL(1, locationDue(status, 4, 0, 0x000003F0, 1000));
+}
+
+struct Simulation {
+  uint32_t refreshes[LOCATION_MAX];
+  uint32_t denied;
+  uint32_t usedPerDay[2];
+  uint32_t shortestGap;            // s between background refreshes after the first round
+};
+
+// Steps of 10 s: the active location refreshes once its interval has passed
+// (fetchWeatherJob), one background location when locationDue() picks it
+// (refreshLocations), two calls each. Halfway, the display moves on to
+// location 2 like activateLocation().
+static Simulation simulate(const QuotaPolicy& policy, uint8_t count) {
+  Simulation result;
+  memset(&result, 0, sizeof(result));
+  result.shortestGap = UINT32_MAX;
+  QuotaBucket bucket;
+  quotaInit(bucket, policy);
+  LocationStatus status[LOCATION_MAX];
+  memset(status, 0, sizeof(status));
+  uint8_t active = 0;
+  uint32_t activeUpdated = 0;      // ms, 0 = never
+  uint32_t lastBackground = 0;
+  uint8_t firstRound = count - 1;
+
+  for (uint32_t now = START; now < START + 2 * DAY; now += 10) {
+    uint32_t millis = (now - START) * 1000 + 1;
+    if (now == START + DAY) {
+      status[active].refreshedAt = activeUpdated;
+      active = 2;
+      activeUpdated = status[active].refreshedAt;
+    }
+    uint32_t shared = quotaInterval(bucket, policy, now, 1, 2);
+    uint32_t activeInterval = locationInterval(count, LOCATION_ACTIVE_WEIGHT, true, shared, BASE);
+    uint32_t backgroundInterval = locationInterval(count, LOCATION_ACTIVE_WEIGHT, false, shared, BASE);
+
+    uint8_t refreshed = LOCATION_NONE;
+    if (activeUpdated == 0 || millis - activeUpdated >= activeInterval * 1000) {
+      refreshed = active;
+      activeUpdated = millis;
+    } else {
+      uint8_t due = locationDue(status, count, active, millis, backgroundInterval * 1000);
+      if (due != LOCATION_NONE) {
+        refreshed = due;
+        status[due].refreshedAt = millis;
+        if (firstRound > 0) {
+          firstRound--;
+        } else if (now - lastBackground < result.shortestGap) {
+          result.shortestGap = now - lastBackground;
+        }
+        lastBackground = now;
+      }
+    }
+    if (refreshed == LOCATION_NONE) continue;
+    result.refreshes[refreshed]++;
+    for (int call = 0; call < 2; call++) {
+      if (!quotaTake(bucket, policy, now)) result.denied++;
+    }
+    uint32_t day = (now - START) / DAY;
+    if (bucket.used > result.usedPerDay[day]) result.usedPerDay[day] = bucket.used;
+  }
+  return result;
+}
+
+// At the default budget the floors bind: 10 min for the displayed one, an hour for the rest
+void test_simulated_days_at_the_floors() {
+  const QuotaPolicy policy = {QUOTA_OPENWEATHER_DAILY, QUOTA_OPENWEATHER_BURST};
+  Simulation result = simulate(policy, LOCATION_MAX);
+  TEST_ASSERT_EQUAL_UINT32(0, result.denied);
+  for (uint32_t used : result.usedPerDay) TEST_ASSERT_TRUE(used <= QUOTA_OPENWEATHER_DAILY);
+  // Location 0 is displayed the first day, location 2 the second
+  TEST_ASSERT_UINT32_WITHIN(3, DAY / BASE + DAY / (LOCATION_ACTIVE_WEIGHT * BASE), result.refreshes[0]);
+  TEST_ASSERT_UINT32_WITHIN(3, DAY / BASE + DAY / (LOCATION_ACTIVE_WEIGHT * BASE), result.refreshes[2]);
+  TEST_ASSERT_UINT32_WITHIN(3, 2 * DAY / (LOCATION_ACTIVE_WEIGHT * BASE), result.refreshes[1]);
+  TEST_ASSERT_UINT32_WITHIN(3, 2 * DAY / (LOCATION_ACTIVE_WEIGHT * BASE), result.refreshes[3]);
+  // Spread over the hour, never back to back
+  TEST_ASSERT_TRUE(result.shortestGap >= LOCATION_ACTIVE_WEIGHT * BASE / (LOCATION_MAX - 1));
+}
+
+// A budget below the floors' needs: none refused, and all of it spent once
+// a whole day is left (the first one starts at 05:00 with the bucket's refill
+// behind)
+void test_simulated_days_on_a_tight_budget() {
+  const QuotaPolicy policy = {200, QUOTA_OPENWEATHER_BURST};
+  Simulation result = simulate(policy, LOCATION_MAX);
+  TEST_ASSERT_EQUAL_UINT32(0, result.denied);
+  for (uint32_t used : result.usedPerDay) TEST_ASSERT_TRUE(used <= policy.dailyLimit);
+  TEST_ASSERT_TRUE(result.usedPerDay[0] >= policy.dailyLimit * 19 / 24 * 9 / 10);
+  TEST_ASSERT_TRUE(result.usedPerDay[1] >= policy.dailyLimit * 9 / 10);
+  // The displayed one still gets about its weight's share
+  uint32_t background = result.refreshes[1] + result.refreshes[3];
+  uint32_t displayed = result.refreshes[0] + result.refreshes[2] - background / 2;
+  TEST_ASSERT_TRUE(displayed > 2 * background);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_interval_split);
+  RUN_TEST(test_due_order_and_spread);
+  RUN_TEST(test_simulated_days_at_the_floors);
+  RUN_TEST(test_simulated_days_on_a_tight_budget);
+  return UNITY_END();
+}
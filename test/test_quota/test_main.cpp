@@ -0,0 +1,279 @@
+#include <unity.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "quota.h"
+
+static const QuotaPolicy OPENWEATHER = {600, 8};
+static const QuotaPolicy SWPC = {3000, 40};
+static const uint32_t DAY = QUOTA_DAY_SECONDS;
+static const uint32_t START = 1792281600 + 5 * 3600;  // 2026-10-18 05:00 UTC
+
+void setUp() {}
+void tearDown() {}
+
+void test_bucket_limits_and_day_reset() {
+  QuotaBucket bucket;
+  quotaInit(bucket, OPENWEATHER);
+  int taken = 0;
+  while (quotaTake(bucket, OPENWEATHER, START)) taken++;
+  TEST_ASSERT_EQUAL(OPENWEATHER.burst, taken);  // The bucket, not the day, stops a burst
+  TEST_ASSERT_EQUAL(1, bucket.denied);
+  // 144 s refill one call at 600 a day (in whole thousandths per step)
+  TEST_ASSERT_FALSE(quotaTake(bucket, OPENWEATHER, START + 143));
+  TEST_ASSERT_TRUE(quotaTake(bucket, OPENWEATHER, START + 150));
+
+  bucket.used = OPENWEATHER.dailyLimit;
+  bucket.tokens = OPENWEATHER.burst * QUOTA_TOKEN_SCALE;
+  uint32_t midnight = START - START % DAY + DAY;
+  TEST_ASSERT_FALSE(quotaTake(bucket, OPENWEATHER, midnight - 1));
+  TEST_ASSERT_TRUE(quotaTake(bucket, OPENWEATHER, midnight));
+  TEST_ASSERT_EQUAL(1, bucket.used);
+  TEST_ASSERT_EQUAL(0, bucket.denied);
+}
+
+void test_no_clock_and_clock_steps() {
+  QuotaBucket bucket;
+  quotaInit(bucket, OPENWEATHER);
+  for (int i = 0; i < 20; i++) quotaTake(bucket, OPENWEATHER, 0);
+  TEST_ASSERT_EQUAL(OPENWEATHER.burst, bucket.used);  // Nothing refills before SNTP
+  TEST_ASSERT_EQUAL_UINT32(0, bucket.day);
+  quotaAdvance(bucket, OPENWEATHER, START);
+  TEST_ASSERT_EQUAL(OPENWEATHER.burst, bucket.used);  // Spent before the clock counts today
+
+  // Stepped back three days: no tokens minted, the day kept
+  bucket.tokens = 0;
+  quotaAdvance(bucket, OPENWEATHER, START - 3 * DAY);
+  quotaAdvance(bucket, OPENWEATHER, START - 3 * DAY + 60);
+  TEST_ASSERT_TRUE(bucket.tokens < QUOTA_TOKEN_SCALE);
+  TEST_ASSERT_EQUAL(OPENWEATHER.burst, bucket.used);
+}
+
+void test_interval_spreads_the_rest_of_the_day() {
+  QuotaBucket bucket;
+  quotaInit(bucket, OPENWEATHER);
+  uint32_t noon = START - START % DAY + DAY / 2;
+  quotaAdvance(bucket, OPENWEATHER, noon);
+  TEST_ASSERT_EQUAL_UINT32(600, quotaInterval(bucket, OPENWEATHER, noon, 600, 2));
+  bucket.used = 560;
+  TEST_ASSERT_EQUAL_UINT32(DAY / 2 / 20, quotaInterval(bucket, OPENWEATHER, noon, 600, 2));
+  bucket.used = 600;
+  TEST_ASSERT_EQUAL_UINT32(DAY / 2, quotaInterval(bucket, OPENWEATHER, noon, 600, 2));
+}
+
+void test_journal_writes_ahead() {
+  QuotaBucket bucket;
+  QuotaBucket stored;
+  QuotaJournal journal = {0, 0};
+  quotaInit(bucket, SWPC);
+  int writes = 0;
+  for (int i = 0; i < 4 * QUOTA_WRITE_AHEAD; i++) {
+    bool charged = quotaTake(bucket, SWPC, START);
+    TEST_ASSERT_TRUE(charged);
+    if (quotaJournal(journal, bucket, SWPC, charged, stored)) writes++;
+    // The copy never holds less than what was spent
+    TEST_ASSERT_TRUE(stored.used >= bucket.used && stored.used - bucket.used < QUOTA_WRITE_AHEAD);
+    TEST_ASSERT_TRUE(stored.tokens <= bucket.tokens);
+  }
+  TEST_ASSERT_EQUAL(4, writes);
+
+  // Refusals do not write
+  QuotaBucket empty = bucket;
+  empty.tokens = 0;
+  TEST_ASSERT_FALSE(quotaJournal(journal, empty, SWPC, quotaTake(empty, SWPC, START), stored));
+
+  // A new day writes on its first charge even with reserve left
+  quotaTake(bucket, SWPC, START);
+  quotaJournal(journal, bucket, SWPC, true, stored);
+  TEST_ASSERT_TRUE(journal.ahead > 0);
+  uint32_t tomorrow = START - START % DAY + DAY;
+  TEST_ASSERT_TRUE(quotaTake(bucket, SWPC, tomorrow));
+  TEST_ASSERT_TRUE(quotaJournal(journal, bucket, SWPC, true, stored));
+  TEST_ASSERT_EQUAL_UINT32(tomorrow / DAY, stored.day);
+  TEST_ASSERT_EQUAL(QUOTA_WRITE_AHEAD, stored.used);
+
+  // The reserve never goes past either limit
+  bucket.used = SWPC.dailyLimit - 2;
+  journal.ahead = 0;
+  quotaJournal(journal, bucket, SWPC, true, stored);
+  TEST_ASSERT_EQUAL(SWPC.dailyLimit, stored.used);
+  TEST_ASSERT_TRUE(quotaValid(stored, SWPC));
+  bucket.used = 0;
+  bucket.tokens = 1 * QUOTA_TOKEN_SCALE + 500;
+  journal.ahead = 0;
+  quotaJournal(journal, bucket, SWPC, true, stored);
+  TEST_ASSERT_EQUAL(1, journal.ahead);
+  TEST_ASSERT_EQUAL_UINT32(500, stored.tokens);
+
+  // A flush is exact and releases the reserve
+  quotaFlush(journal, bucket, stored);
+  TEST_ASSERT_EQUAL_MEMORY(&bucket, &stored, sizeof(bucket));
+  TEST_ASSERT_EQUAL(0, journal.ahead);
+}
+
+// The firmware around the quota on a simulated clock: NVS holds one copy
+// per provider, each boot loads it the way loadQuotas() does, every request
+// goes through quotaAllow(), a refresh makes 10 SWPC calls at the paced
+// interval and 2 OpenWeather calls at theirs, and a boot refreshes at once.
+struct Device {
+  const QuotaPolicy* policies[2] = {&OPENWEATHER, &SWPC};
+  QuotaBucket buckets[2];
+  QuotaJournal journals[2];
+  QuotaBucket nvs[2];
+  bool stored = false;
+  uint32_t writes = 0;
+  uint32_t boots = 0;
+  uint32_t charges = 0;
+  std::vector<uint32_t> sent[2];  // Wall time of every call that went out
+  uint32_t bootedAt = 0;
+  uint32_t lastSwpc = 0;
+  uint32_t lastOpenWeather = 0;
+
+  void boot(uint32_t time) {
+    for (int i = 0; i < 2; i++) {
+      if (!stored || !quotaValid(nvs[i], *policies[i])) quotaInit(nvs[i], *policies[i]);
+      buckets[i] = nvs[i];
+      journals[i] = {buckets[i].day, 0};
+    }
+    stored = true;
+    boots++;
+    bootedAt = time;
+    lastSwpc = 0;
+    lastOpenWeather = 0;
+  }
+  void restart(uint32_t time) {  // Deliberate: the shutdown handler flushes
+    for (int i = 0; i < 2; i++) {
+      quotaFlush(journals[i], buckets[i], nvs[i]);
+      writes++;
+    }
+    boot(time);
+  }
+  bool call(int provider, uint32_t time, uint32_t clock) {
+    QuotaBucket copy;
+    bool allowed = quotaTake(buckets[provider], *policies[provider], clock);
+    if (quotaJournal(journals[provider], buckets[provider], *policies[provider], allowed, copy)) {
+      nvs[provider] = copy;
+      writes++;
+    }
+    if (allowed) {
+      sent[provider].push_back(time);
+      charges++;
+    }
+    return allowed;
+  }
+  void tick(uint32_t time, uint32_t clock) {
+    uint32_t swpcInterval = quotaInterval(buckets[1], SWPC, clock, 600, 10);
+    if (lastSwpc == 0 || time - lastSwpc >= swpcInterval) {
+      for (int i = 0; i < 10; i++) call(1, time, clock);
+      lastSwpc = time;
+    }
+    uint32_t openWeatherInterval = quotaInterval(buckets[0], OPENWEATHER, clock, 600, 2);
+    if (lastOpenWeather == 0 || time - lastOpenWeather >= openWeatherInterval) {
+      for (int i = 0; i < 2; i++) call(0, time, clock);
+      lastOpenWeather = time;
+    }
+  }
+};
+
+struct Scenario {
+  uint32_t (*crashEvery)(uint32_t elapsed);    // Seconds between unplanned reboots, 0 = none
+  uint32_t restartEvery;                       // Seconds between deliberate restarts, 0 = none
+  uint32_t (*clockAfter)(uint32_t elapsed);    // Seconds after boot until SNTP sets the clock
+};
+
+static uint32_t never(uint32_t) { return 0; }
+static uint32_t stormDayTwo(uint32_t elapsed) { return elapsed >= DAY && elapsed < 2 * DAY ? 20 : 0; }
+static uint32_t stormSixHours(uint32_t elapsed) { return elapsed >= DAY + 3600 && elapsed < DAY + 7 * 3600 ? 30 : 0; }
+static uint32_t clockAtOnce(uint32_t) { return 0; }
+static uint32_t clockAfterTen(uint32_t) { return 10; }
+static uint32_t clockLostDayTwo(uint32_t elapsed) { return elapsed >= DAY && elapsed < 2 * DAY ? DAY : 10; }
+
+static void runDays(Device& device, const Scenario& scenario, uint32_t days) {
+  device.boot(START);
+  for (uint32_t time = START; time < START + days * DAY; time++) {
+    uint32_t elapsed = time - START;
+    uint32_t crash = scenario.crashEvery(elapsed);
+    if (crash && time - device.bootedAt >= crash) {
+      device.boot(time);  // Power loss or a crash: RAM is gone, nothing flushed
+    } else if (scenario.restartEvery && time - device.bootedAt >= scenario.restartEvery) {
+      device.restart(time);
+    }
+    uint32_t clock = time - device.bootedAt >= scenario.clockAfter(elapsed) ? time : 0;
+    device.tick(time, clock);
+  }
+}
+
+// Calls that went out per UTC day and in any hour never exceed the policy
+static void assertWithinBudget(const Device& device) {
+  for (int provider = 0; provider < 2; provider++) {
+    const QuotaPolicy& policy = *device.policies[provider];
+    std::map<uint32_t, uint32_t> perDay;
+    for (uint32_t time : device.sent[provider]) perDay[time / DAY]++;
+    for (const auto& day : perDay) TEST_ASSERT_TRUE(day.second <= policy.dailyLimit);
+
+    const std::vector<uint32_t>& sent = device.sent[provider];
+    uint32_t hourLimit = policy.burst + 3600 * policy.dailyLimit / DAY + 1;
+    size_t first = 0;
+    for (size_t last = 0; last < sent.size(); last++) {
+      while (sent[last] - sent[first] >= 3600) first++;
+      TEST_ASSERT_TRUE(last - first + 1 <= hourLimit);
+    }
+  }
+}
+
+void test_steady_days_write_once_per_reserve() {
+  Device device;
+  runDays(device, {never, 0, clockAtOnce}, 4);
+  assertWithinBudget(device);
+  // About 4 * (144 * 10 + 144 * 2) charges; one write per QUOTA_WRITE_AHEAD
+  // of them plus one per provider and day
+  TEST_ASSERT_TRUE(device.charges > 4 * 144 * 12 * 9 / 10);
+  TEST_ASSERT_TRUE(device.writes <= device.charges / QUOTA_WRITE_AHEAD + 2 * 5);
+}
+
+void test_reboot_storms_stay_within_budget() {
+  const Scenario storms[] = {
+    {stormDayTwo, 0, clockAtOnce},      // Every 20 s for a whole day
+    {stormSixHours, 0, clockAfterTen},  // Every 30 s for 6 h, SNTP 10 s after each boot
+    {stormDayTwo, 0, clockLostDayTwo},  // Every 20 s with no clock at all that day
+  };
+  for (const Scenario& storm : storms) {
+    Device device;
+    runDays(device, storm, 4);
+    assertWithinBudget(device);
+    // A write per boot at most, on top of the steady rate
+    TEST_ASSERT_TRUE(device.writes <= device.charges / QUOTA_WRITE_AHEAD + 2 * device.boots + 2 * 5);
+  }
+}
+
+void test_deliberate_restarts_waste_nothing() {
+  // Hourly restarts flush the exact counts, so the day's spending matches
+  // the calls made; crashes may waste up to the reserve each
+  Device restarted;
+  runDays(restarted, {never, 3600, clockAtOnce}, 2);
+  assertWithinBudget(restarted);
+  uint32_t today = (START + 2 * DAY - 1) / DAY;
+  uint32_t sentToday = 0;
+  for (uint32_t time : restarted.sent[0]) sentToday += time / DAY == today;
+  TEST_ASSERT_EQUAL(sentToday, restarted.buckets[0].used);
+
+  Device crashed;
+  crashed.boot(START);
+  for (int i = 0; i < 3; i++) crashed.call(1, START, START);
+  uint16_t spent = crashed.buckets[1].used;
+  crashed.boot(START + 1);
+  TEST_ASSERT_TRUE(crashed.buckets[1].used >= spent);
+  TEST_ASSERT_TRUE(crashed.buckets[1].used - spent < QUOTA_WRITE_AHEAD);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_bucket_limits_and_day_reset);
+  RUN_TEST(test_no_clock_and_clock_steps);
+  RUN_TEST(test_interval_spreads_the_rest_of_the_day);
+  RUN_TEST(test_journal_writes_ahead);
+  RUN_TEST(test_steady_days_write_once_per_reserve);
+  RUN_TEST(test_reboot_storms_stay_within_budget);
+  RUN_TEST(test_deliberate_restarts_waste_nothing);
+  return UNITY_END();
+}
@@ -0,0 +1,138 @@
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "rollup.h"
+#include "timezone.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Sample {
+  uint32_t time;
+  float value;
+};
+
+// Four weeks of jittered samples with gaps, across the March DST change,
+// checked bucket by bucket against a brute-force pass over the raw samples
+static void checkAgainstBruteForce(const char* rule) {
+  TEST_ASSERT_TRUE(timeZoneInit(rule, ZONE_HOME));
+  static Rollup rollup;
+  rollup.clear();
+  std::vector<Sample> samples;
+  uint32_t time = 1741000000;  // 2025-03-03
+  srand(1);
+  for (int i = 0; i < 6 * 24 * 28; i++) {
+    time += 600 + (rand() % 5 == 0 ? rand() % 3600 : 0);
+    float value = 1000 + 10 * sinf(i / 50.0f) + (rand() % 100) / 10.0f;
+    TEST_ASSERT_TRUE(rollup.add(time, value));
+    samples.push_back({time, value});
+  }
+
+  uint32_t kept = 0;
+  for (uint8_t ago = 0; ago < ROLLUP_DAYS + ROLLUP_HOURS; ago++) {
+    const RollupBucket* buckets[2] = {rollup.day(ago), rollup.hour(ago)};
+    for (const RollupBucket* bucket : buckets) {
+      if (bucket == nullptr) continue;
+      float low = INFINITY, high = -INFINITY;
+      double sum = 0;
+      uint16_t count = 0;
+      for (const Sample& sample : samples) {
+        if (sample.time < bucket->start || sample.time >= bucket->end) continue;
+        low = fminf(low, sample.value);
+        high = fmaxf(high, sample.value);
+        sum += sample.value;
+        count++;
+      }
+      TEST_ASSERT_EQUAL_MESSAGE(count, bucket->count, rule);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(low, bucket->min, rule);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(high, bucket->max, rule);
+      TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.01, sum / count, bucket->mean, rule);
+      kept++;
+    }
+  }
+  TEST_ASSERT_EQUAL(ROLLUP_DAYS + ROLLUP_HOURS, kept);
+
+  // Days start at local midnight and run to the next one, 23-25 hours
+  for (uint8_t ago = 0; ago < ROLLUP_DAYS; ago++) {
+    const RollupBucket* day = rollup.day(ago);
+    LocalTime local;
+    toLocalTime(day->start, local, ZONE_HOME);
+    TEST_ASSERT_EQUAL_MESSAGE(0, local.hour * 60 + local.minute, rule);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(localMidnight(day->end, ZONE_HOME), day->end, rule);
+    TEST_ASSERT_TRUE_MESSAGE(day->end - day->start >= 23 * 3600 && day->end - day->start <= 25 * 3600, rule);
+  }
+  // Hours start on a local hour boundary
+  for (uint8_t ago = 0; ago < ROLLUP_HOURS; ago++) {
+    const RollupBucket* hour = rollup.hour(ago);
+    LocalTime local;
+    toLocalTime(hour->start, local, ZONE_HOME);
+    TEST_ASSERT_EQUAL_MESSAGE(0, local.minute, rule);
+    TEST_ASSERT_TRUE_MESSAGE(hour->end - hour->start <= 3600, rule);
+  }
+}
+
+void test_matches_brute_force_central() {
+  checkAgainstBruteForce("CST6CDT,M3.2.0,M11.1.0");
+}
+
+void test_matches_brute_force_half_hour_zone() {
+  checkAgainstBruteForce("IST-5:30");
+}
+
+void test_matches_brute_force_utc() {
+  checkAgainstBruteForce("UTC0");
+}
+
+void test_matches_brute_force_southern_half_hour_dst() {
+  checkAgainstBruteForce("ACST-9:30ACDT,M10.1.0,M4.1.0/3");
+}
+
+void test_dst_days_are_23_and_25_hours() {
+  timeZoneInit("CST6CDT,M3.2.0,M11.1.0", ZONE_HOME);
+  Rollup rollup;
+  rollup.add(1772949600, 1);  // 2026-03-08 00:00 CST
+  TEST_ASSERT_EQUAL_UINT32(23 * 3600, rollup.day(0)->end - rollup.day(0)->start);
+  rollup.add(1793509200, 1);  // 2026-11-01 00:00 CDT
+  TEST_ASSERT_EQUAL_UINT32(25 * 3600, rollup.day(0)->end - rollup.day(0)->start);
+}
+
+void test_change_and_lookups() {
+  timeZoneInit("UTC0", ZONE_HOME);
+  Rollup rollup;
+  float change;
+  TEST_ASSERT_FALSE(rollupChange(rollup, 1792281600, 3 * 3600, change));
+  // Pressure falling 1 hPa an hour
+  for (uint32_t minutes = 0; minutes <= 6 * 60; minutes += 10) rollup.add(1792281600 + minutes * 60, 1015 - minutes / 60.0f);
+  TEST_ASSERT_TRUE(rollupChange(rollup, 1792281600 + 6 * 3600, 3 * 3600, change));
+  TEST_ASSERT_FLOAT_WITHIN(0.01, -2.583, change);  // From the mean of 03:00-03:50
+  TEST_ASSERT_NULL(rollup.hourAt(1792281600 - 1));
+  TEST_ASSERT_NOT_NULL(rollup.dayAt(1792281600));
+  TEST_ASSERT_FALSE(rollup.add(1792281600 - 600, 0));  // Older than the open buckets
+}
+
+// Showing another location switches the displayed zone; the buckets stay on home's
+void test_displayed_zone_does_not_move_buckets() {
+  timeZoneInit("CST6CDT,M3.2.0,M11.1.0", ZONE_HOME);
+  timeZoneInit("JST-9");
+  Rollup rollup;
+  rollup.add(1792299600, 1);  // 2026-10-18 00:00 CDT, 14:00 JST
+  TEST_ASSERT_EQUAL_UINT32(1792299600, rollup.day(0)->start);
+  TEST_ASSERT_EQUAL_UINT32(1792299600 + 24 * 3600, rollup.day(0)->end);
+  timeZoneInit("UTC0");
+  rollup.add(1792299600 + 20 * 3600, 2);  // Next UTC day, same CDT day
+  TEST_ASSERT_EQUAL_UINT32(1792299600, rollup.day(0)->start);
+  TEST_ASSERT_EQUAL_FLOAT(2, rollup.day(0)->max);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_matches_brute_force_central);
+  RUN_TEST(test_matches_brute_force_half_hour_zone);
+  RUN_TEST(test_matches_brute_force_utc);
+  RUN_TEST(test_matches_brute_force_southern_half_hour_dst);
+  RUN_TEST(test_dst_days_are_23_and_25_hours);
+  RUN_TEST(test_change_and_lookups);
+  RUN_TEST(test_displayed_zone_does_not_move_buckets);
+  return UNITY_END();
+}
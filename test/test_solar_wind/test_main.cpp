@@ -0,0 +1,106 @@
+#include <unity.h>
+#include <string>
+#include "fixture.h"
+#include "solar_wind.h"
+#include "weather.h"
+
+void setUp() {
+  solarWindClear(solarWind);
+}
+void tearDown() {}
+
+static const uint32_t DAY_START = 1792238400;  // 2026-10-17 12:00 UTC, first row of the fixtures
+
+// A mag-1-day table with Bz from bzAt(minute)
+static std::string magTable(float (*bzAt)(int minute), int rows = 1440) {
+  std::string body = "[[\"time_tag\",\"bx_gsm\",\"by_gsm\",\"bz_gsm\",\"lon_gsm\",\"lat_gsm\",\"bt\"]";
+  for (int i = 0; i < rows; i++) {
+    time_t time = DAY_START + i * 60;
+    struct tm fields;
+    gmtime_r(&time, &fields);
+    char row[120];
+    snprintf(row, sizeof(row), ",[\"%04d-%02d-%02d %02d:%02d:00.000\",\"1.00\",\"2.00\",\"%.2f\",\"0\",\"0\",\"5\"]",
+             fields.tm_year + 1900, fields.tm_mon + 1, fields.tm_mday, fields.tm_hour, fields.tm_min, bzAt(i));
+    body += row;
+  }
+  return body + "]";
+}
+
+void test_fixtures_fill_every_bin() {
+  TEST_ASSERT_TRUE(fixtureStream(solarWindMagIngest, fixtureRead("mag-1-day.json")));
+  TEST_ASSERT_TRUE(fixtureStream(solarWindPlasmaIngest, fixtureRead("plasma-1-day.json")));
+  for (uint32_t bin = 0; bin < SOLAR_WIND_BINS; bin++) {
+    const SolarWindBin* filled = solarWindBinAt(solarWind, DAY_START + bin * SOLAR_WIND_BIN_SECONDS);
+    TEST_ASSERT_NOT_NULL(filled);
+    TEST_ASSERT_TRUE(filled->magSamples > 0 && filled->plasmaSamples > 0);
+    TEST_ASSERT_TRUE(filled->bzMin <= filled->bzMean && filled->bzMean <= filled->bzMax);
+    TEST_ASSERT_TRUE(filled->speedMin <= filled->speedMean && filled->speedMean <= filled->speedMax);
+  }
+  // The newest row becomes the current value
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 0.55, currentSpaceWeather.magneticFieldBz);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, -1.45, currentSpaceWeather.magneticFieldBy);
+  TEST_ASSERT_FLOAT_WITHIN(0.1, 513.2, currentSpaceWeather.solarWindSpeed);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 4.25, currentSpaceWeather.solarWindDensity);
+  TEST_ASSERT_EQUAL(0, currentSpaceWeather.bzSouthwardMinutes);
+}
+
+static float lateTurn(int minute) {
+  return minute >= 1300 ? -18.0f : 3.0f;
+}
+
+void test_southward_turn_duration() {
+  std::string body = magTable(lateTurn);
+  TEST_ASSERT_TRUE(fixtureStream(solarWindMagIngest, body));
+  TEST_ASSERT_EQUAL(140, currentSpaceWeather.bzSouthwardMinutes);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, -18.0, currentSpaceWeather.magneticFieldBz);
+}
+
+void test_short_gaps_do_not_break_the_run() {
+  SolarWindBinner binner;
+  binner.begin(SOLAR_WIND_MAG);
+  const uint32_t end = DAY_START + 3600;
+  for (uint32_t time = DAY_START; time < end; time += 60) {
+    // A 10 minute outage in the middle of a southward hour
+    if (time >= DAY_START + 1800 && time < DAY_START + 2400) continue;
+    binner.add(solarWind, time, -5, 0);
+  }
+  binner.flush(solarWind);
+  TEST_ASSERT_EQUAL_UINT32(3600, solarWindSouthwardSeconds(solarWind, end - 60, 0));
+
+  // A gap longer than SOLAR_WIND_GAP_BINS ends it
+  solarWindClear(solarWind);
+  binner.begin(SOLAR_WIND_MAG);
+  for (uint32_t time = DAY_START; time < end; time += 60) {
+    if (time >= DAY_START + 1200 && time < DAY_START + 1200 + (SOLAR_WIND_GAP_BINS + 1) * SOLAR_WIND_BIN_SECONDS) continue;
+    binner.add(solarWind, time, -5, 0);
+  }
+  binner.flush(solarWind);
+  TEST_ASSERT_TRUE(solarWindSouthwardSeconds(solarWind, end - 60, 0) < 3600 - 1200);
+}
+
+void test_rejected_bodies() {
+  TEST_ASSERT_TRUE(fixtureStream(solarWindMagIngest, fixtureRead("mag-1-day.json")));
+  static SolarWindSeries before;
+  before = solarWind;
+
+  // The other product has none of the columns: nothing changes
+  TEST_ASSERT_FALSE(fixtureStream(solarWindMagIngest, fixtureRead("plasma-1-day.json")));
+  TEST_ASSERT_EQUAL_MEMORY(&before, &solarWind, sizeof(before));
+
+  // A truncated body is refused but keeps the bins it did fill, since they
+  // hold real measurements
+  solarWindClear(solarWind);
+  std::string body = fixtureRead("mag-1-day.json");
+  TEST_ASSERT_FALSE(fixtureStream(solarWindMagIngest, body.substr(0, body.size() / 2), 512));
+  TEST_ASSERT_NOT_NULL(solarWindBinAt(solarWind, DAY_START));
+  TEST_ASSERT_NULL(solarWindBinAt(solarWind, DAY_START + 86400 - 60));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fixtures_fill_every_bin);
+  RUN_TEST(test_southward_turn_duration);
+  RUN_TEST(test_short_gaps_do_not_break_the_run);
+  RUN_TEST(test_rejected_bodies);
+  return UNITY_END();
+}
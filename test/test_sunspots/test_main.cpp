@@ -0,0 +1,107 @@
+#include <unity.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "fixture.h"
+#include "sunspots.h"
+#include "weather.h"
+
+void setUp() {
+  noaaSpaceWeather.sunspotNumber = -1;
+  noaaSpaceWeather.activeRegions = -1;
+  noaaSpaceWeather.sunspotArea = -1;
+}
+void tearDown() {}
+
+static const uint32_t DAY = 86400;
+static const uint32_t LATEST = 1792281600;  // 2026-10-18, newest date of the fixture
+
+// The fixture's rows, one flat object each
+static std::vector<std::string> fixtureRows() {
+  std::string body = fixtureRead("solar_regions.json");
+  std::vector<std::string> rows;
+  size_t start = body.find('{');
+  while (start != std::string::npos) {
+    size_t end = body.find('}', start);
+    rows.push_back(body.substr(start, end - start + 1));
+    start = body.find('{', end);
+  }
+  return rows;
+}
+
+static std::string joinRows(const std::vector<std::string>& rows) {
+  std::string body = "[";
+  for (size_t i = 0; i < rows.size(); i++) body += (i > 0 ? "," : "") + rows[i];
+  return body + "]";
+}
+
+void test_wolf_number_of_the_latest_date() {
+  SunspotAggregator aggregator;
+  aggregator.begin();
+  aggregator.add(LATEST - DAY, 14200, 40, 500);  // Older date first
+  aggregator.add(LATEST, 14230, 12, 120);
+  aggregator.add(LATEST, 14231, 0, 0);           // Plage: a region without spots
+  aggregator.add(LATEST, 14232, 3, -1);          // No area given
+  aggregator.add(LATEST, 14230, 12, 120);        // Listed twice
+  aggregator.add(LATEST - DAY, 14201, 9, 90);    // Older date later
+  aggregator.add(0, 14233, 5, 5);                // No date
+  SunspotSummary summary;
+  TEST_ASSERT_TRUE(aggregator.finish(summary));
+  TEST_ASSERT_EQUAL_UINT32(LATEST, summary.observed);
+  TEST_ASSERT_EQUAL(3, summary.regions);
+  TEST_ASSERT_EQUAL(2, summary.spotGroups);
+  TEST_ASSERT_EQUAL(15, summary.spots);
+  TEST_ASSERT_EQUAL(120, summary.area);
+  TEST_ASSERT_EQUAL(35, summary.sunspotNumber);
+  TEST_ASSERT_EQUAL(14230, summary.largestRegion);
+  TEST_ASSERT_EQUAL(6, aggregator.rows());
+}
+
+void test_no_rows_and_saturation() {
+  SunspotAggregator aggregator;
+  SunspotSummary summary;
+  aggregator.begin();
+  TEST_ASSERT_FALSE(aggregator.finish(summary));
+  aggregator.add(LATEST, 1, 70000, 70000);
+  aggregator.add(LATEST, 2, 70000, 70000);
+  TEST_ASSERT_TRUE(aggregator.finish(summary));
+  TEST_ASSERT_EQUAL(UINT16_MAX, summary.spots);
+  TEST_ASSERT_EQUAL(UINT16_MAX, summary.area);
+  TEST_ASSERT_EQUAL(UINT16_MAX, summary.sunspotNumber);
+}
+
+void test_fixture_in_any_order() {
+  // 341 rows over 30 days; 2026-10-18 has 7 regions, 4 with spots, 82 spots
+  std::vector<std::string> rows = fixtureRows();
+  TEST_ASSERT_EQUAL(341, rows.size());
+  std::mt19937 random(40);
+  for (int pass = 0; pass < 4; pass++) {
+    setUp();
+    TEST_ASSERT_TRUE(fixtureStream(solarRegionIngest, joinRows(rows)));
+    TEST_ASSERT_EQUAL(122, noaaSpaceWeather.sunspotNumber);
+    TEST_ASSERT_EQUAL(7, noaaSpaceWeather.activeRegions);
+    TEST_ASSERT_EQUAL(300, noaaSpaceWeather.sunspotArea);
+    rows.push_back(rows[random() % rows.size()]);  // A repeated row changes nothing
+    std::shuffle(rows.begin(), rows.end(), random);
+  }
+}
+
+void test_rejected_bodies_keep_the_values() {
+  TEST_ASSERT_TRUE(fixtureStream(solarRegionIngest, fixtureRead("solar_regions.json")));
+  std::string body = fixtureRead("solar_regions.json");
+  TEST_ASSERT_FALSE(fixtureStream(solarRegionIngest, body.substr(0, body.size() / 2)));
+  TEST_ASSERT_FALSE(fixtureStream(solarRegionIngest, "{\"region\":1}"));
+  TEST_ASSERT_FALSE(fixtureStream(solarRegionIngest, "[{\"region\":1,\"number_spots\":3}]"));
+  TEST_ASSERT_EQUAL(122, noaaSpaceWeather.sunspotNumber);
+  TEST_ASSERT_EQUAL(7, noaaSpaceWeather.activeRegions);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_wolf_number_of_the_latest_date);
+  RUN_TEST(test_no_rows_and_saturation);
+  RUN_TEST(test_fixture_in_any_order);
+  RUN_TEST(test_rejected_bodies_keep_the_values);
+  return UNITY_END();
+}
@@ -0,0 +1,67 @@
+#include <unity.h>
+#include <string.h>
+#include "timezone.h"
+
+void setUp() {
+  timeZoneInit("CST6CDT,M3.2.0,M11.1.0");
+}
+void tearDown() {}
+
+static const uint64_t MICROS_PER_MINUTE = 60000000ULL;
+
+void test_uptime_before_sync() {
+  char buffer[16];
+  TEST_ASSERT_EQUAL(4, formatUptime(0, buffer, sizeof(buffer)));
+  TEST_ASSERT_EQUAL_STRING("0h0m", buffer);
+  formatUptime(61 * MICROS_PER_MINUTE + 59999999, buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL_STRING("1h1m", buffer);
+}
+
+void test_uptime_past_millis_wrap() {
+  char buffer[16];
+  // millis() wraps after 2^32 ms (49 days 17:02); the 64-bit timer keeps going
+  uint64_t wrap = 4294967296ULL * 1000;
+  formatUptime(wrap - MICROS_PER_MINUTE, buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL_STRING("1193h1m", buffer);
+  formatUptime(wrap + MICROS_PER_MINUTE, buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL_STRING("1193h3m", buffer);
+  formatUptime(400ULL * 24 * 60 * MICROS_PER_MINUTE, buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL_STRING("9600h0m", buffer);
+}
+
+void test_uptime_truncates_to_buffer() {
+  char buffer[4];
+  TEST_ASSERT_EQUAL(3, formatUptime(600 * MICROS_PER_MINUTE, buffer, sizeof(buffer)));
+  TEST_ASSERT_EQUAL_STRING("10h", buffer);
+}
+
+void test_clock_across_sntp_steps() {
+  // What the header shows as SNTP steps the RTC over the spring-forward gap
+  char buffer[16];
+  formatClock(1772956740, buffer, sizeof(buffer));  // 2026-03-08 07:59 UTC
+  TEST_ASSERT_EQUAL_STRING("1:59 AM", buffer);
+  formatClock(1772956800, buffer, sizeof(buffer));  // 08:00 UTC
+  TEST_ASSERT_EQUAL_STRING("3:00 AM", buffer);
+  // Fall back repeats 1 AM
+  formatClock(1793512800, buffer, sizeof(buffer));  // 2026-11-01 06:00 UTC
+  TEST_ASSERT_EQUAL_STRING("1:00 AM", buffer);
+  formatClock(1793516400, buffer, sizeof(buffer));  // 07:00 UTC
+  TEST_ASSERT_EQUAL_STRING("1:00 AM", buffer);
+}
+
+void test_clock_fits_time_string() {
+  // TIME_STRING_SIZE is 16
+  char buffer[16];
+  TEST_ASSERT_TRUE(formatClock(1793561940, buffer, sizeof(buffer)) < sizeof(buffer) - 1);
+  TEST_ASSERT_TRUE(formatUptime(UINT64_MAX, buffer, sizeof(buffer)) <= sizeof(buffer) - 1);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_uptime_before_sync);
+  RUN_TEST(test_uptime_past_millis_wrap);
+  RUN_TEST(test_uptime_truncates_to_buffer);
+  RUN_TEST(test_clock_across_sntp_steps);
+  RUN_TEST(test_clock_fits_time_string);
+  return UNITY_END();
+}
@@ -0,0 +1,169 @@
+#include <unity.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include "timezone.h"
+
+void setUp() {}
+void tearDown() {}
+
+// The rule engine against the C library's zoneinfo: every hour (and the
+// minutes around each transition) of 2024-2030 must give the same local time
+struct ZoneCase {
+  const char* rule;
+  const char* zoneinfo;       // System zone the rule describes for these years
+};
+
+static const ZoneCase zoneCases[] = {
+  {"CST6CDT,M3.2.0,M11.1.0", "America/Chicago"},
+  {"EST5EDT,M3.2.0,M11.1.0", "America/New_York"},
+  {"AKST9AKDT,M3.2.0,M11.1.0", "America/Anchorage"},
+  {"MST7", "America/Phoenix"},
+  {"CET-1CEST,M3.5.0,M10.5.0/3", "Europe/Berlin"},
+  {"GMT0BST,M3.5.0/1,M10.5.0", "Europe/London"},
+  {"AEST-10AEDT,M10.1.0,M4.1.0/3", "Australia/Sydney"},
+  {"NZST-12NZDT,M9.5.0,M4.1.0/3", "Pacific/Auckland"},
+  {"ACST-9:30ACDT,M10.1.0,M4.1.0/3", "Australia/Adelaide"},
+  {"IST-5:30", "Asia/Kolkata"},
+  {"<-03>3", "America/Sao_Paulo"},
+};
+
+static const time_t RANGE_BEGIN = 1704067200;  // 2024-01-01 00:00 UTC
+static const time_t RANGE_END = 1924992000;    // 2031-01-01 00:00 UTC
+
+static void useSystemZone(const char* name) {
+  setenv("TZ", name, 1);
+  tzset();
+}
+
+static bool sameAsSystem(time_t utc, char* message, size_t size) {
+  struct tm expected;
+  localtime_r(&utc, &expected);
+  LocalTime local;
+  toLocalTime(utc, local);
+  int32_t offset = timeZoneOffset(utc);
+  if (local.year == expected.tm_year + 1900 && local.month == expected.tm_mon + 1 &&
+      local.day == expected.tm_mday && local.hour == expected.tm_hour && local.minute == expected.tm_min &&
+      local.second == expected.tm_sec && local.weekday == expected.tm_wday &&
+      local.dst == (expected.tm_isdst > 0) && offset == expected.tm_gmtoff) {
+    return true;
+  }
+  snprintf(message, size, "at %lld: %04d-%02d-%02d %02d:%02d dst %d offset %d, system %04d-%02d-%02d %02d:%02d dst %d offset %ld",
+           (long long)utc, local.year, local.month, local.day, local.hour, local.minute, local.dst, (int)offset,
+           expected.tm_year + 1900, expected.tm_mon + 1, expected.tm_mday, expected.tm_hour, expected.tm_min,
+           expected.tm_isdst, expected.tm_gmtoff);
+  return false;
+}
+
+void test_matches_system_zoneinfo() {
+  char message[200];
+  for (const ZoneCase& zone : zoneCases) {
+    TEST_ASSERT_TRUE_MESSAGE(timeZoneInit(zone.rule), zone.rule);
+    useSystemZone(zone.zoneinfo);
+    int32_t lastOffset = timeZoneOffset(RANGE_BEGIN);
+    for (time_t utc = RANGE_BEGIN; utc < RANGE_END; utc += 3600) {
+      if (!sameAsSystem(utc, message, sizeof(message))) TEST_FAIL_MESSAGE(message);
+      // Minute by minute around each transition
+      int32_t offset = timeZoneOffset(utc);
+      if (offset != lastOffset) {
+        for (time_t near = utc - 3600; near < utc + 3600; near += 60) {
+          if (!sameAsSystem(near, message, sizeof(message))) TEST_FAIL_MESSAGE(message);
+        }
+        lastOffset = offset;
+      }
+    }
+  }
+}
+
+void test_local_midnight_matches_system() {
+  for (const ZoneCase& zone : zoneCases) {
+    timeZoneInit(zone.rule);
+    useSystemZone(zone.zoneinfo);
+    for (time_t utc = RANGE_BEGIN; utc < RANGE_END; utc += 7 * 3600 + 59) {
+      struct tm fields;
+      localtime_r(&utc, &fields);
+      fields.tm_hour = 0;
+      fields.tm_min = 0;
+      fields.tm_sec = 0;
+      fields.tm_isdst = -1;
+      TEST_ASSERT_EQUAL_MESSAGE((long long)mktime(&fields), (long long)localMidnight(utc), zone.rule);
+    }
+  }
+}
+
+void test_malformed_rules_fall_back_to_utc() {
+  const char* const malformed[] = {"", "C", "CST", "CST6CDT,M3.2.0", "CST6CDT,M13.2.0,M11.1.0", "CST6CDT,J0,J10",
+                                   "CST6CDT,M3.2.0,M11.1.0x", "<CST6"};
+  for (const char* rule : malformed) {
+    TEST_ASSERT_FALSE_MESSAGE(timeZoneInit(rule), rule);
+    TEST_ASSERT_EQUAL_INT32(0, timeZoneOffset(1792324800));
+  }
+}
+
+void test_home_and_displayed_zones_are_independent() {
+  TEST_ASSERT_TRUE(timeZoneInit("CST6CDT,M3.2.0,M11.1.0", ZONE_HOME));
+  TEST_ASSERT_TRUE(timeZoneInit("AKST9AKDT,M3.2.0,M11.1.0"));
+  const time_t utc = 1792324800;  // 2026-10-18 12:00 UTC
+  TEST_ASSERT_EQUAL_INT32(-5 * 3600, timeZoneOffset(utc, ZONE_HOME));
+  TEST_ASSERT_EQUAL_INT32(-8 * 3600, timeZoneOffset(utc));
+  TEST_ASSERT_EQUAL(utc - 7 * 3600, localMidnight(utc, ZONE_HOME));
+  TEST_ASSERT_EQUAL(utc - 4 * 3600, localMidnight(utc));
+
+  // Switching one leaves the other's rule and DST cache alone
+  timeZoneInit("JST-9");
+  TEST_ASSERT_EQUAL_INT32(-5 * 3600, timeZoneOffset(utc, ZONE_HOME));
+  TEST_ASSERT_EQUAL_INT32(-6 * 3600, timeZoneOffset(utc + 30 * 86400, ZONE_HOME));
+  TEST_ASSERT_EQUAL_INT32(9 * 3600, timeZoneOffset(utc));
+  timeZoneInit("garbage", ZONE_HOME);
+  TEST_ASSERT_EQUAL_INT32(0, timeZoneOffset(utc, ZONE_HOME));
+  TEST_ASSERT_EQUAL_INT32(9 * 3600, timeZoneOffset(utc));
+}
+
+void test_concurrent_conversions_during_init() {
+  // Readers on other threads must always get one whole rule's answer or the
+  // other's, never a mix or a stale DST cache, while the rule keeps switching
+  static const char* const rules[2] = {"CST6CDT,M3.2.0,M11.1.0", "AEST-10AEDT,M10.1.0,M4.1.0/3"};
+  static const int SAMPLES = 1000;
+  static int32_t expected[2][SAMPLES];
+  const time_t first = 1783000000;  // 2026-07-02, DST in Chicago, not in Sydney
+  for (int rule = 0; rule < 2; rule++) {
+    timeZoneInit(rules[rule]);
+    for (int i = 0; i < SAMPLES; i++) expected[rule][i] = timeZoneOffset(first + (time_t)i * 3 * 86400 + i * 613);
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<uint32_t> conversions{0};
+  std::atomic<uint32_t> wrong{0};
+  auto reader = [&]() {
+    uint32_t count = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      // Wanders across years so the DST cache keeps refilling
+      int i = count % SAMPLES;
+      time_t utc = first + (time_t)i * 3 * 86400 + i * 613;
+      int32_t offset = timeZoneOffset(utc);
+      if (offset != expected[0][i] && offset != expected[1][i]) wrong++;
+      time_t midnight = localMidnight(utc);
+      if (midnight > utc || utc - midnight >= 25 * 3600) wrong++;
+      count++;
+    }
+    conversions += count;
+  };
+
+  std::thread threads[3] = {std::thread(reader), std::thread(reader), std::thread(reader)};
+  for (int i = 0; i < 200000; i++) timeZoneInit(rules[i & 1]);
+  stop = true;
+  for (std::thread& thread : threads) thread.join();
+  TEST_ASSERT_TRUE(conversions > 0);
+  TEST_ASSERT_EQUAL_UINT32(0, wrong.load());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_matches_system_zoneinfo);
+  RUN_TEST(test_local_midnight_matches_system);
+  RUN_TEST(test_malformed_rules_fall_back_to_utc);
+  RUN_TEST(test_home_and_displayed_zones_are_independent);
+  RUN_TEST(test_concurrent_conversions_during_init);
+  return UNITY_END();
+}
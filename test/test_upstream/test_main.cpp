@@ -0,0 +1,151 @@
+#include <unity.h>
+#include <stdlib.h>
+#include "upstream.h"
+
+void setUp() {
+  srand(42);
+}
+void tearDown() {}
+
+static const uint32_t TICK = 600000;  // One request every 10 minutes
+static const uint32_t DAY = 86400000;
+
+void test_outcome_classes() {
+  TEST_ASSERT_EQUAL(FETCH_OK, fetchOutcome(200, true));
+  TEST_ASSERT_EQUAL(FETCH_OK, fetchOutcome(304, false));
+  TEST_ASSERT_EQUAL(FETCH_BAD_DATA, fetchOutcome(200, false));
+  TEST_ASSERT_EQUAL(FETCH_TRANSPORT_ERROR, fetchOutcome(-11, false));
+  TEST_ASSERT_EQUAL(FETCH_SERVER_ERROR, fetchOutcome(503, false));
+  TEST_ASSERT_EQUAL(FETCH_SERVER_ERROR, fetchOutcome(429, false));
+  TEST_ASSERT_EQUAL(FETCH_SERVER_ERROR, fetchOutcome(301, false));
+  TEST_ASSERT_EQUAL(FETCH_CLIENT_ERROR, fetchOutcome(401, false));
+}
+
+void test_open_probe_and_close() {
+  EndpointHealth health = {};
+  TEST_ASSERT_TRUE(endpointStale(health, 1000, 1800000));
+  TEST_ASSERT_FALSE(endpointRecord(health, 1000, 503, FETCH_SERVER_ERROR, 0));  // One failure waits
+  TEST_ASSERT_EQUAL(CIRCUIT_CLOSED, health.state);
+  TEST_ASSERT_TRUE(endpointRecord(health, 2000, 503, FETCH_SERVER_ERROR, 0));
+  TEST_ASSERT_EQUAL(CIRCUIT_OPEN, health.state);
+  // random 0 is the low end of the jitter
+  TEST_ASSERT_EQUAL_UINT32(2000 + UPSTREAM_BACKOFF_MIN / 100 * (100 - UPSTREAM_JITTER_PERCENT), health.retryAt);
+  TEST_ASSERT_FALSE(endpointAllow(health, health.retryAt - 1));
+  TEST_ASSERT_EQUAL(1, health.skipped);
+  TEST_ASSERT_TRUE(endpointAllow(health, health.retryAt));
+  TEST_ASSERT_EQUAL(CIRCUIT_HALF_OPEN, health.state);
+
+  // A failed probe doubles the backoff, a good one closes
+  uint32_t now = health.retryAt;
+  TEST_ASSERT_TRUE(endpointRecord(health, now, -1, FETCH_TRANSPORT_ERROR, 0));
+  TEST_ASSERT_EQUAL_UINT32(2 * UPSTREAM_BACKOFF_MIN, health.backoff);
+  now = health.retryAt;
+  TEST_ASSERT_TRUE(endpointAllow(health, now));
+  TEST_ASSERT_TRUE(endpointRecord(health, now, 200, FETCH_OK, 0));
+  TEST_ASSERT_EQUAL(CIRCUIT_CLOSED, health.state);
+  TEST_ASSERT_EQUAL(0, health.failures);
+  TEST_ASSERT_EQUAL_UINT32(now, health.lastSuccess);
+  TEST_ASSERT_FALSE(endpointStale(health, now + 1800000, 1800000));
+  TEST_ASSERT_TRUE(endpointStale(health, now + 1800001, 1800000));
+}
+
+void test_backoff_caps_and_jitters() {
+  EndpointHealth health = {};
+  endpointRecord(health, 0, 500, FETCH_SERVER_ERROR, 0);
+  for (int i = 0; i < 10; i++) endpointRecord(health, 0, 500, FETCH_SERVER_ERROR, 0xFFFFFFFF);
+  TEST_ASSERT_EQUAL_UINT32(UPSTREAM_BACKOFF_MAX, health.backoff);
+  uint32_t spread = UPSTREAM_BACKOFF_MAX / 100 * UPSTREAM_JITTER_PERCENT;
+  for (uint32_t random = 0; random < 1000; random++) {
+    endpointRecord(health, 0, 500, FETCH_SERVER_ERROR, random * 2654435761u);
+    TEST_ASSERT_TRUE(health.retryAt >= UPSTREAM_BACKOFF_MAX - spread && health.retryAt <= UPSTREAM_BACKOFF_MAX + spread);
+  }
+  // A client error goes straight to the longest backoff
+  EndpointHealth client = {};
+  TEST_ASSERT_TRUE(endpointRecord(client, 0, 401, FETCH_CLIENT_ERROR, 0));
+  TEST_ASSERT_EQUAL_UINT32(UPSTREAM_BACKOFF_MAX, client.backoff);
+}
+
+void test_retry_across_millis_wrap() {
+  EndpointHealth health = {};
+  uint32_t now = 0xFFFFFFFF - 1000;
+  endpointRecord(health, now, 500, FETCH_SERVER_ERROR, 0);
+  endpointRecord(health, now, 500, FETCH_SERVER_ERROR, 0);
+  TEST_ASSERT_TRUE(health.retryAt < now);  // Wrapped
+  TEST_ASSERT_FALSE(endpointAllow(health, now + 5000));
+  TEST_ASSERT_TRUE(endpointAllow(health, health.retryAt));
+}
+
+struct Run {
+  int sent;
+  int failed;
+  int skipped;
+  int32_t recovery;  // ms from the upstream's return to the first good request, -1 = none
+};
+
+// A week of polling against a scripted upstream, with or without the breaker
+static Run simulate(int (*script)(uint32_t), bool breaker, uint32_t backAt) {
+  EndpointHealth health = {};
+  Run run = {0, 0, 0, -1};
+  for (uint32_t now = TICK; now < 7 * DAY; now += TICK) {
+    if (breaker && !endpointAllow(health, now)) {
+      run.skipped++;
+      continue;
+    }
+    int code = script(now);
+    run.sent++;
+    if (code != 200) run.failed++;
+    else if (backAt && now >= backAt && run.recovery < 0) run.recovery = now - backAt;
+    if (breaker) endpointRecord(health, now, code, fetchOutcome(code, code == 200), (uint32_t)rand());
+  }
+  return run;
+}
+
+static int twoHours503(uint32_t now) { return now >= DAY && now < DAY + 2 * 3600000 ? 503 : 200; }
+static int halfDayTimeouts(uint32_t now) { return now >= DAY && now < DAY + DAY / 2 ? -11 : 200; }
+static int threeDayOutage(uint32_t now) { return now >= DAY && now < 4 * DAY ? -1 : 200; }
+static int blips(uint32_t now) { return (now / TICK) % 10 == 0 ? 502 : 200; }
+static int badKey(uint32_t) { return 401; }
+
+void test_scripted_outages() {
+  struct Case {
+    int (*script)(uint32_t);
+    uint32_t backAt;
+  } cases[] = {{twoHours503, DAY + 2 * 3600000}, {halfDayTimeouts, DAY + DAY / 2}, {threeDayOutage, 4 * DAY}};
+  for (const Case& c : cases) {
+    Run naive = simulate(c.script, false, c.backAt);
+    Run guarded = simulate(c.script, true, c.backAt);
+    TEST_ASSERT_EQUAL(naive.sent, guarded.sent + guarded.skipped);
+    TEST_ASSERT_TRUE(guarded.failed < naive.failed);
+    // Back within one longest (jittered) backoff of the upstream's return
+    TEST_ASSERT_TRUE(guarded.recovery >= 0);
+    TEST_ASSERT_TRUE((uint32_t)guarded.recovery <= UPSTREAM_BACKOFF_MAX / 100 * (100 + UPSTREAM_JITTER_PERCENT) + TICK);
+  }
+  // The 3-day outage costs about one probe an hour instead of six requests
+  Run outage = simulate(threeDayOutage, true, 4 * DAY);
+  TEST_ASSERT_TRUE(outage.failed <= 3 * 24 * 3 / 2);
+}
+
+void test_blips_never_open() {
+  Run guarded = simulate(blips, true, 0);
+  TEST_ASSERT_EQUAL(0, guarded.skipped);
+  TEST_ASSERT_EQUAL(simulate(blips, false, 0).failed, guarded.failed);
+}
+
+void test_bad_key_backs_off_to_hourly() {
+  Run naive = simulate(badKey, false, 0);
+  Run guarded = simulate(badKey, true, 0);
+  TEST_ASSERT_EQUAL(1007, naive.failed);
+  TEST_ASSERT_TRUE(guarded.failed <= 7 * 24 * 100 / (100 - UPSTREAM_JITTER_PERCENT) + 1);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_outcome_classes);
+  RUN_TEST(test_open_probe_and_close);
+  RUN_TEST(test_backoff_caps_and_jitters);
+  RUN_TEST(test_retry_across_millis_wrap);
+  RUN_TEST(test_scripted_outages);
+  RUN_TEST(test_blips_never_open);
+  RUN_TEST(test_bad_key_backs_off_to_hourly);
+  return UNITY_END();
+}
@@ -0,0 +1,220 @@
+#include <unity.h>
+#include <string.h>
+#include <utility>
+#include <vector>
+#include "wifi_link.h"
+
+// A simulated radio on a 50 ms loop: associating takes PINNED_MS pinned to
+// the cached access point and SCAN_MS with a channel scan. The access point
+// is absent during the outage windows and may move channel.
+
+#define STEP_MS 50
+#define PINNED_MS 300
+#define SCAN_MS 2400
+
+struct SimulatedDriver : WifiDriver {
+  WifiLink* link = nullptr;
+  uint32_t now = 0;
+  int32_t apChannel = 6;
+  uint8_t apBssid[6] = {1, 2, 3, 4, 5, 6};
+  std::vector<std::pair<uint32_t, uint32_t>> outages;  // [from, to) ms
+  bool silent = false;                                 // Never answer an attempt
+  int64_t ipAt = -1;
+  int64_t failAt = -1;
+  bool associated = false;
+  int connects = 0;
+  int pinned = 0;
+  int disconnects = 0;
+
+  bool apUp(uint32_t time) const {
+    for (const auto& outage : outages) {
+      if (time >= outage.first && time < outage.second) return false;
+    }
+    return true;
+  }
+  void connect(const uint8_t* bssid, int32_t channel) override {
+    connects++;
+    if (bssid != nullptr) pinned++;
+    if (silent) return;
+    bool reachable = apUp(now) && (bssid == nullptr || channel == apChannel);
+    if (reachable) ipAt = now + (bssid ? PINNED_MS : SCAN_MS);
+    else failAt = now + (bssid ? 500 : 3000);
+  }
+  void disconnect() override {
+    disconnects++;
+    ipAt = -1;
+    failAt = now + 5;  // The driver reports its own disconnect late
+    associated = false;
+  }
+  bool accessPoint(uint8_t bssid[6], int32_t& channel) override {
+    memcpy(bssid, apBssid, 6);
+    channel = apChannel;
+    return true;
+  }
+  void tick() {
+    if (ipAt >= 0 && now >= ipAt) {
+      ipAt = -1;
+      if (apUp(now)) {
+        associated = true;
+        link->notify(WIFI_EVENT_GOT_IP);
+      } else {
+        failAt = now;
+      }
+    }
+    if (failAt >= 0 && now >= failAt) {
+      failAt = -1;
+      link->notify(WIFI_EVENT_DISCONNECTED, 201);  // No AP found
+    }
+    if (associated && !apUp(now)) {
+      associated = false;
+      link->notify(WIFI_EVENT_DISCONNECTED, 200);  // Beacon timeout
+    }
+  }
+};
+
+static SimulatedDriver* driver;
+static WifiLink* link;
+static int ups;
+static int downs;
+static uint32_t lastUpAt;
+
+static void countUp(const WifiLink&) {
+  ups++;
+  lastUpAt = driver->now;
+}
+static void countDown(const WifiLink&) {
+  downs++;
+}
+
+void setUp() {
+  driver = new SimulatedDriver();
+  link = new WifiLink(*driver);
+  driver->link = link;
+  link->onUp(countUp);
+  link->onDown(countDown);
+  ups = 0;
+  downs = 0;
+  lastUpAt = 0;
+}
+void tearDown() {
+  delete link;
+  delete driver;
+}
+
+static void runUntil(uint32_t until) {
+  for (; driver->now < until; driver->now += STEP_MS) {
+    driver->tick();
+    link->poll(driver->now);
+  }
+}
+
+static void bootConnected() {
+  link->begin(0);
+  runUntil(4000);
+  TEST_ASSERT_TRUE(link->connected());
+}
+
+void test_boot_scans_once() {
+  TEST_ASSERT_EQUAL(WIFI_LINK_IDLE, link->state());
+  bootConnected();
+  TEST_ASSERT_EQUAL(1, ups);
+  TEST_ASSERT_EQUAL(1, link->attempts());
+  TEST_ASSERT_FALSE(link->fastReconnect());
+  TEST_ASSERT_EQUAL_UINT32(SCAN_MS, link->outage());
+  TEST_ASSERT_EQUAL(0, driver->pinned);
+}
+
+void test_beacon_loss_reassociates_pinned() {
+  bootConnected();
+  driver->outages = {{5000, 5060}};
+  runUntil(10000);
+  TEST_ASSERT_TRUE(link->connected());
+  TEST_ASSERT_EQUAL(1, downs);
+  TEST_ASSERT_EQUAL(200, link->reason());
+  TEST_ASSERT_TRUE(link->fastReconnect());
+  TEST_ASSERT_EQUAL(1, link->attempts());
+  TEST_ASSERT_TRUE(link->outage() <= WIFI_LINK_SETTLE + PINNED_MS + 2 * STEP_MS);
+}
+
+void test_long_outage_backs_off_and_recovers() {
+  bootConnected();
+  driver->outages = {{30000, 210000}};
+  runUntil(30000 + 60000);
+  // 1, 2, 4, 8, 16 s then the 30 s cap, each after a 3 s failed scan
+  int attempts = link->attempts();
+  TEST_ASSERT_TRUE(attempts >= 5 && attempts <= 7);
+  runUntil(210000);
+  TEST_ASSERT_FALSE(link->connected());
+  int during = driver->connects;
+  runUntil(260000);
+  TEST_ASSERT_TRUE(link->connected());
+  TEST_ASSERT_TRUE(lastUpAt - 210000 <= WIFI_LINK_BACKOFF_MAX + 3000 + SCAN_MS + STEP_MS);
+  // Paced by the cap rather than retrying every loop
+  TEST_ASSERT_TRUE(during <= 2 + 180000 / (WIFI_LINK_BACKOFF_MAX / 2));
+  TEST_ASSERT_EQUAL(2, ups);
+}
+
+void test_moved_channel_falls_back_to_a_scan() {
+  bootConnected();
+  driver->outages = {{10000, 10060}};
+  driver->apChannel = 11;  // Moved while it was down
+  runUntil(20000);
+  TEST_ASSERT_TRUE(link->connected());
+  TEST_ASSERT_FALSE(link->fastReconnect());
+  TEST_ASSERT_EQUAL(2, link->attempts());
+  TEST_ASSERT_EQUAL(1, driver->pinned);
+  // The next drop pins the new channel
+  driver->outages = {{25000, 25060}};
+  runUntil(30000);
+  TEST_ASSERT_TRUE(link->fastReconnect());
+  TEST_ASSERT_EQUAL(2, driver->pinned);
+}
+
+void test_boot_without_access_point() {
+  driver->outages = {{0, 45000}};
+  link->begin(0);
+  runUntil(120000);
+  TEST_ASSERT_TRUE(link->connected());
+  TEST_ASSERT_EQUAL(1, ups);
+  TEST_ASSERT_EQUAL(0, downs);  // Never was up, so never went down
+  TEST_ASSERT_TRUE(lastUpAt >= 45000 && lastUpAt - 45000 <= WIFI_LINK_BACKOFF_MAX + 3000 + SCAN_MS);
+}
+
+void test_silent_driver_times_out() {
+  driver->silent = true;
+  link->begin(0);
+  runUntil(WIFI_LINK_ATTEMPT_TIMEOUT - STEP_MS);
+  TEST_ASSERT_EQUAL(WIFI_LINK_CONNECTING, link->state());
+  runUntil(WIFI_LINK_ATTEMPT_TIMEOUT + STEP_MS);
+  TEST_ASSERT_EQUAL(WIFI_LINK_BACKOFF, link->state());
+  TEST_ASSERT_EQUAL(1, driver->disconnects);
+}
+
+void test_events_apply_in_order() {
+  bootConnected();
+  // Dropped and back before loop() ran: stays up, counted as one drop
+  link->notify(WIFI_EVENT_DISCONNECTED, 8);
+  link->notify(WIFI_EVENT_GOT_IP);
+  link->poll(driver->now);
+  TEST_ASSERT_TRUE(link->connected());
+  TEST_ASSERT_EQUAL(1, downs);
+  TEST_ASSERT_EQUAL(2, ups);
+  // Up then down again: ends down
+  link->notify(WIFI_EVENT_GOT_IP);
+  link->notify(WIFI_EVENT_DISCONNECTED, 8);
+  link->poll(driver->now);
+  TEST_ASSERT_EQUAL(WIFI_LINK_BACKOFF, link->state());
+  TEST_ASSERT_EQUAL(8, link->reason());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_scans_once);
+  RUN_TEST(test_beacon_loss_reassociates_pinned);
+  RUN_TEST(test_long_outage_backs_off_and_recovers);
+  RUN_TEST(test_moved_channel_falls_back_to_a_scan);
+  RUN_TEST(test_boot_without_access_point);
+  RUN_TEST(test_silent_driver_times_out);
+  RUN_TEST(test_events_apply_in_order);
+  return UNITY_END();
+}
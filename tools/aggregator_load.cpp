@@ -0,0 +1,196 @@
+// Load generator for the aggregator: simulated stations on localhost, each
+// polling its own bundle over one keep-alive connection, as fast as the
+// aggregator answers. Every 200 must carry the ETag of its body.
+//   pio run -e aggregator_load
+//   .pio/build/aggregator_load/program -g 1000 > sites.conf
+//   tools/swpc_standin.py --plain &
+//   .pio/build/aggregator/program -s http://localhost:8443 sites.conf &
+//   .pio/build/aggregator_load/program [-p port] [-n stations] [-t seconds] [-c]
+// -c sends If-None-Match with the last ETag, as the firmware does.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+struct Station {
+  int fd;
+  std::string received;
+  std::string etag;
+  double sent;             // µs
+  size_t headLength;       // 0 until the head is in
+  size_t length;           // Head and body
+  int status;
+};
+
+static double nowMicros() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+static uint32_t fnv1a(const char* data, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+  return hash;
+}
+
+// Sites spread over both hemispheres, in the aggregator's sites.conf format
+static void generateSites(int count) {
+  srand(1);
+  for (int i = 0; i < count; i++) {
+    float latitude = rand() % 14000 / 100.0f - 70;
+    float longitude = rand() % 36000 / 100.0f - 180;
+    printf("s%d %.2f %.2f UTC0 Station %d\n", i, latitude, longitude, i);
+  }
+}
+
+static void sendRequest(Station& station, int id, bool conditional) {
+  char request[160];
+  int length = snprintf(request, sizeof(request), "GET /bundle/s%d HTTP/1.1\r\nHost: aggregator\r\n", id);
+  if (conditional && !station.etag.empty()) {
+    length += snprintf(request + length, sizeof(request) - length, "If-None-Match: %s\r\n", station.etag.c_str());
+  }
+  length += snprintf(request + length, sizeof(request) - length, "\r\n");
+  station.received.clear();
+  station.headLength = 0;
+  station.sent = nowMicros();
+  if (send(station.fd, request, length, MSG_NOSIGNAL) != length) {
+    perror("send");
+    exit(1);
+  }
+}
+
+// False until the whole response is in
+static bool parseResponse(Station& station) {
+  if (station.headLength == 0) {
+    size_t end = station.received.find("\r\n\r\n");
+    if (end == std::string::npos) return false;
+    station.headLength = end + 4;
+    station.status = atoi(station.received.c_str() + 9);
+    size_t field = station.received.find("Content-Length: ");
+    size_t bodyLength = field < end && station.status != 304 ? strtoul(station.received.c_str() + field + 16, nullptr, 10) : 0;
+    station.length = station.headLength + bodyLength;
+    field = station.received.find("ETag: ");
+    if (field < end) station.etag = station.received.substr(field + 6, station.received.find("\r\n", field) - field - 6);
+  }
+  return station.received.size() >= station.length;
+}
+
+int main(int argc, char** argv) {
+  int port = 8080;
+  int count = 1000;
+  double seconds = 10;
+  bool conditional = false;
+  int option;
+  while ((option = getopt(argc, argv, "g:p:n:t:c")) != -1) {
+    switch (option) {
+      case 'g': generateSites(atoi(optarg)); return 0;
+      case 'p': port = atoi(optarg); break;
+      case 'n': count = atoi(optarg); break;
+      case 't': seconds = atof(optarg); break;
+      case 'c': conditional = true; break;
+      default:
+        fprintf(stderr, "usage: %s [-g sites] [-p port] [-n stations] [-t seconds] [-c]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int poller = epoll_create1(0);
+  std::vector<Station> stations(count);
+  std::vector<double> latencies;
+  latencies.reserve(1 << 22);
+  uint64_t notModified = 0;
+  uint64_t errors = 0;
+  uint64_t torn = 0;
+  uint64_t bytes = 0;
+
+  // Everyone connects at once, as after an aggregator restart
+  double start = nowMicros();
+  for (int i = 0; i < count; i++) {
+    Station& station = stations[i];
+    station.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(station.fd, (sockaddr*)&address, sizeof(address)) != 0) {
+      perror("connect");
+      return 1;
+    }
+    int yes = 1;
+    setsockopt(station.fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    fcntl(station.fd, F_SETFL, O_NONBLOCK);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u32 = i;
+    epoll_ctl(poller, EPOLL_CTL_ADD, station.fd, &event);
+    sendRequest(station, i, conditional);
+  }
+  double connected = (nowMicros() - start) / 1e3;
+
+  start = nowMicros();
+  double end = start + seconds * 1e6;
+  int finished = 0;
+  epoll_event events[256];
+  char buffer[65536];
+  while (finished < count) {
+    int ready = epoll_wait(poller, events, 256, 1000);
+    for (int e = 0; e < ready; e++) {
+      int id = events[e].data.u32;
+      Station& station = stations[id];
+      for (;;) {
+        ssize_t received = recv(station.fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EAGAIN) break;
+        if (received <= 0) {
+          fprintf(stderr, "station %d: connection closed\n", id);
+          return 1;
+        }
+        station.received.append(buffer, received);
+        bytes += received;
+      }
+      if (!parseResponse(station)) continue;
+      latencies.push_back(nowMicros() - station.sent);
+      if (station.status == 304) {
+        notModified++;
+      } else if (station.status != 200) {
+        errors++;
+      } else {
+        char etag[16];
+        snprintf(etag, sizeof(etag), "\"%08x\"",
+                 fnv1a(station.received.data() + station.headLength, station.length - station.headLength));
+        if (station.etag != etag) torn++;
+      }
+      if (nowMicros() < end) {
+        sendRequest(station, id, conditional);
+      } else {
+        close(station.fd);
+        finished++;
+      }
+    }
+  }
+
+  double elapsed = (nowMicros() - start) / 1e6;
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) {
+    return latencies.empty() ? 0.0 : latencies[(size_t)(p * (latencies.size() - 1))] / 1e3;
+  };
+  printf("%d stations%s: %zu requests in %.1f s, %.0f req/s, %.1f MB/s\n", count, conditional ? ", If-None-Match" : "",
+         latencies.size(), elapsed, latencies.size() / elapsed, bytes / elapsed / 1e6);
+  printf("  304 %llu, errors %llu, torn %llu\n", (unsigned long long)notModified, (unsigned long long)errors,
+         (unsigned long long)torn);
+  printf("  latency p50 %.2f ms, p99 %.2f ms, max %.2f ms; all connected in %.0f ms\n", percentile(0.5),
+         percentile(0.99), percentile(1.0), connected);
+  return errors > 0 || torn > 0;
+}
@@ -0,0 +1,56 @@
+// Decodes a binary event log dump (EVENT_LOG_DUMP_KEY) captured from the
+// serial port into the same text eventLogDrain() prints on the device:
+//   pio run -e eventlog && .pio/build/eventlog/program dump.bin
+// Anything before the dump's magic, such as earlier serial output, is skipped.
+
+#include <stdio.h>
+#include <string.h>
+#include "eventlog.h"
+
+static_assert(sizeof(EventRecord) == 24, "EventRecord layout must match the ESP32's");
+
+int main(int argc, char** argv) {
+  FILE* in = argc > 1 ? fopen(argv[1], "rb") : stdin;
+  if (in == nullptr) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  // Slide over the input until the header's magic lines up
+  uint32_t magic = 0;
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    magic = (magic >> 8) | ((uint32_t)c << 24);
+    if (magic == EVENT_LOG_MAGIC) break;
+  }
+  uint32_t recordSize;
+  if (c == EOF || fread(&recordSize, sizeof(recordSize), 1, in) != 1) {
+    fprintf(stderr, "no event log dump found\n");
+    return 1;
+  }
+  if (recordSize != sizeof(EventRecord)) {
+    fprintf(stderr, "record size %u, this decoder reads %zu\n", recordSize, sizeof(EventRecord));
+    return 1;
+  }
+
+  EventRecord record;
+  char line[128];
+  uint32_t count = 0;
+  uint32_t previous = 0;
+  while (fread(&record, sizeof(record), 1, in) == 1) {
+    if (record.sequence == 0) {
+      fprintf(stderr, "%u events\n", count);
+      return 0;
+    }
+    // Sequences count every record written, so a gap is what the ring lost
+    if (previous != 0 && record.sequence - previous > 1) {
+      printf("-- %u events dropped --\n", record.sequence - previous - 1);
+    }
+    previous = record.sequence;
+    eventLogFormat(record, line, sizeof(line));
+    puts(line);
+    count++;
+  }
+  fprintf(stderr, "dump truncated after %u events\n", count);
+  return 1;
+}
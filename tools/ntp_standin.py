@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""SNTP server that serves a chosen time, to watch the station's clock cross
+a DST change or a large RTC step without waiting for the real date.
+
+    tools/ntp_standin.py --at "2026-11-01 06:59:00" [--port 123]
+
+Point the station at it with NTP_SERVER_1 in config_local.h. The served time
+starts at --at and then runs at the real rate; without --at it is the real
+time plus --skew seconds.
+"""
+import argparse
+import calendar
+import socket
+import struct
+import time
+
+NTP_EPOCH_OFFSET = 2208988800  # 1900-01-01 to 1970-01-01
+
+
+def ntp_timestamp(seconds):
+    whole = int(seconds)
+    return struct.pack("!II", whole + NTP_EPOCH_OFFSET, int((seconds - whole) * 2**32) & 0xFFFFFFFF)
+
+
+def reply(request, now):
+    # Server mode 4, same version as the request, stratum 1, "LOCL" reference
+    version = (request[0] >> 3) & 0x7
+    header = struct.pack("!BBbb", (version << 3) | 4, 1, 6, -20)
+    header += struct.pack("!II", 0, 0) + b"LOCL"
+    return header + ntp_timestamp(now) + request[40:48] + ntp_timestamp(now) + ntp_timestamp(now)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--at", help="UTC time to start from, YYYY-MM-DD HH:MM:SS")
+    parser.add_argument("--skew", type=float, default=0, help="seconds added to the real time")
+    parser.add_argument("--port", type=int, default=123)
+    args = parser.parse_args()
+
+    offset = args.skew
+    if args.at:
+        start = calendar.timegm(time.strptime(args.at, "%Y-%m-%d %H:%M:%S"))
+        offset = start - time.time()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("", args.port))
+    print(f"serving {time.strftime('%Y-%m-%d %H:%M:%S', time.gmtime(time.time() + offset))} UTC on :{args.port}")
+    while True:
+        request, address = sock.recvfrom(512)
+        if len(request) < 48:
+            continue
+        now = time.time() + offset
+        sock.sendto(reply(request, now), address)
+        print(f"{address[0]}: {time.strftime('%H:%M:%S', time.gmtime(now))} UTC")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+"""HTTPS stand-in for services.swpc.noaa.gov that serves test/fixtures, to
+watch the station's keep-alive connection pool without the real service.
+
+    tools/swpc_standin.py [--port 8443] [--gzip] [--plain]
+    tools/swpc_standin.py --compare
+
+Point the station at it with SWPC_BASE_URL "https://<host>:8443" in
+config_local.h (the aggregator: -s http://localhost:8443 with --plain). Any
+path is answered with the fixture of the same file name. Each connection is
+logged when it closes with its requests and handshake time, so a refresh
+should show a few connections carrying several requests each rather than
+one per endpoint.
+
+--compare runs the fetch pool's request pattern against the stand-in through
+a byte-counting proxy and prints connections, full handshakes and wire bytes
+beyond the bodies, for a connection per request, keep-alive over
+FETCH_MAX_WORKERS lanes, and TLS session resumption as a reference.
+"""
+import argparse
+import gzip
+import http.client
+import http.server
+import os
+import socket
+import socketserver
+import ssl
+import subprocess
+import tempfile
+import threading
+import time
+
+FIXTURES = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "test", "fixtures")
+WORKERS = 3  # FETCH_MAX_WORKERS
+
+# One refresh, largest body first as in refreshJobs
+REFRESH = [
+    "/json/ovation_aurora_latest.json",
+    "/json/goes/primary/xrays-1-day.json",
+    "/products/solar-wind/mag-1-day.json",
+    "/products/solar-wind/plasma-1-day.json",
+    "/json/solar_regions.json",
+    "/products/alerts.json",
+    "/products/noaa-planetary-k-index-forecast.json",
+    "/products/noaa-planetary-k-index.json",
+    "/products/daily-geomagnetic-indices.json",
+    "/json/f107_cm_flux.json",
+]
+
+
+def self_signed(directory):
+    cert = os.path.join(directory, "cert.pem")
+    key = os.path.join(directory, "key.pem")
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "30", "-subj", "/CN=swpc-standin",
+                    "-keyout", key, "-out", cert], check=True, capture_output=True)
+    return cert, key
+
+
+def make_handler(fixtures, allow_gzip, quiet):
+    bodies = {}
+
+    class Handler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"  # Keep-alive unless the client says otherwise
+
+        def setup(self):
+            super().setup()
+            self.requests = 0
+            self.sent = 0
+            self.opened = time.perf_counter()
+
+        def do_GET(self):
+            name = os.path.basename(self.path.split("?")[0])
+            if name not in bodies:
+                try:
+                    with open(os.path.join(fixtures, name), "rb") as file:
+                        bodies[name] = file.read()
+                except OSError:
+                    self.send_error(404)
+                    return
+            body = bodies[name]
+            encoded = allow_gzip and "gzip" in self.headers.get("Accept-Encoding", "")
+            if encoded:
+                body = gzip.compress(body, 6)
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            if encoded:
+                self.send_header("Content-Encoding", "gzip")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+            self.requests += 1
+            self.sent += len(body)
+
+        def finish(self):
+            super().finish()
+            if not quiet:
+                print(f"{self.client_address[0]}:{self.client_address[1]} closed after {self.requests} requests, "
+                      f"{self.sent / 1024:.0f} KB, open {time.perf_counter() - self.opened:.1f} s")
+
+        def log_message(self, format, *args):
+            if not quiet:
+                print(f"{self.client_address[0]}:{self.client_address[1]} {format % args}")
+
+    return Handler
+
+
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    daemon_threads = True
+
+
+def serve(port, fixtures, allow_gzip, context, quiet=False):
+    server = Server(("", port), make_handler(fixtures, allow_gzip, quiet))
+    if context is not None:
+        # Handshake in the connection's thread, not in accept()
+        server.socket = context.wrap_socket(server.socket, server_side=True, do_handshake_on_connect=False)
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+    return server
+
+
+class CountingProxy:
+    """TCP relay that adds up the bytes passing in both directions."""
+
+    def __init__(self, target_port):
+        self.target_port = target_port
+        self.lock = threading.Lock()
+        self.reset()
+        self.listener = socket.create_server(("127.0.0.1", 0))
+        self.port = self.listener.getsockname()[1]
+        threading.Thread(target=self.accept, daemon=True).start()
+
+    def reset(self):
+        with self.lock:
+            self.bytes = 0
+            self.connections = 0
+
+    def accept(self):
+        while True:
+            client, _ = self.listener.accept()
+            upstream = socket.create_connection(("127.0.0.1", self.target_port))
+            with self.lock:
+                self.connections += 1
+            threading.Thread(target=self.pipe, args=(client, upstream), daemon=True).start()
+            threading.Thread(target=self.pipe, args=(upstream, client), daemon=True).start()
+
+    def pipe(self, source, sink):
+        try:
+            while True:
+                data = source.recv(65536)
+                if not data:
+                    break
+                with self.lock:
+                    self.bytes += len(data)
+                sink.sendall(data)
+        except OSError:
+            pass
+        finally:
+            try:
+                sink.shutdown(socket.SHUT_WR)
+            except OSError:
+                pass
+
+
+def compare(fixtures):
+    with tempfile.TemporaryDirectory() as directory:
+        cert, key = self_signed(directory)
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(cert, key)
+        context.maximum_version = ssl.TLSVersion.TLSv1_2  # What mbedTLS on the ESP32 negotiates
+        server = serve(0, fixtures, False, context, quiet=True)
+        proxy = CountingProxy(server.server_address[1])
+
+        client = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+        client.check_hostname = False
+        client.verify_mode = ssl.CERT_NONE
+        client.maximum_version = ssl.TLSVersion.TLSv1_2
+        client.set_ciphers("ECDHE-RSA-AES128-GCM-SHA256")
+
+        sizes = {}
+        for path in REFRESH:
+            with open(os.path.join(fixtures, os.path.basename(path)), "rb") as file:
+                sizes[path] = len(file.read())
+
+        def get(connection, path):
+            connection.sendall(f"GET {path} HTTP/1.1\r\nHost: swpc-standin\r\nConnection: keep-alive\r\n\r\n".encode())
+            response = http.client.HTTPResponse(connection)
+            response.begin()
+            if len(response.read()) != sizes[path]:
+                raise RuntimeError(f"short body for {path}")
+
+        def run(name, lanes, reuse_connection, resume):
+            proxy.reset()
+            handshakes = 0
+            resumed = 0
+            handshake_time = 0.0
+            session = None
+            for lane in lanes:
+                connection = None
+                for path in lane:
+                    if connection is None:
+                        start = time.perf_counter()
+                        raw = socket.create_connection(("127.0.0.1", proxy.port))
+                        connection = client.wrap_socket(raw, server_hostname="swpc-standin", session=session)
+                        handshake_time += time.perf_counter() - start
+                        handshakes += 1
+                        resumed += connection.session_reused
+                        if resume:
+                            session = connection.session
+                    get(connection, path)
+                    if not reuse_connection:
+                        connection.close()
+                        connection = None
+                if connection is not None:
+                    connection.close()
+            time.sleep(0.2)  # Let the proxy see the closes
+            overhead = proxy.bytes - sum(sizes.values())
+            print(f"{name:34s} {proxy.connections:5d} {handshakes - resumed:10d} {handshake_time * 1000:10.1f} "
+                  f"{overhead / 1024:11.1f}")
+
+        print(f"{'':34s} {'conns':>5s} {'handshakes':>10s} {'hs ms':>10s} {'overhead KB':>11s}")
+        run("connection per request", [[path] for path in REFRESH], False, False)
+        run(f"keep-alive, {WORKERS} lanes", [REFRESH[i::WORKERS] for i in range(WORKERS)], True, False)
+        run("keep-alive, 1 lane", [REFRESH], True, False)
+        run("session resumption (reference)", [[path] for path in REFRESH], False, True)
+        server.shutdown()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=8443)
+    parser.add_argument("--fixtures", default=FIXTURES, help="directory of the bodies to serve")
+    parser.add_argument("--cert", help="PEM certificate (default: a fresh self-signed one)")
+    parser.add_argument("--key", help="PEM key for --cert")
+    parser.add_argument("--plain", action="store_true", help="serve http:// instead of https://")
+    parser.add_argument("--gzip", action="store_true", help="gzip bodies for clients that accept it")
+    parser.add_argument("--compare", action="store_true", help="measure the request patterns and exit")
+    args = parser.parse_args()
+
+    if args.compare:
+        compare(args.fixtures)
+        return
+
+    context = None
+    directory = None
+    if not args.plain:
+        cert, key = args.cert, args.key
+        if cert is None:
+            directory = tempfile.TemporaryDirectory()
+            cert, key = self_signed(directory.name)
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(cert, key)
+        context.maximum_version = ssl.TLSVersion.TLSv1_2
+    server = serve(args.port, args.fixtures, args.gzip, context)
+    print(f"serving {os.path.abspath(args.fixtures)} on {'http' if args.plain else 'https'}://:{args.port}")
+    try:
+        while True:
+            time.sleep(3600)
+    except KeyboardInterrupt:
+        server.shutdown()
+
+
+if __name__ == "__main__":
+    main()